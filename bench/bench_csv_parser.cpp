@@ -0,0 +1,78 @@
+// Rows-per-second comparison of the CsvParser backends.
+// Usage: bench_csv_parser [num_rows=1000000] [existing_file.csv]
+#include "market_replay/csv_parser.hpp"
+#include "market_replay/logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+// Same schema and value ranges as data/synth_gen.py
+void generate_ticks(const std::string& filename, size_t num_rows) {
+    std::ofstream out(filename);
+    out << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long long> dt(10'000'000, 500'000'000);
+    std::uniform_real_distribution<double> drift(-0.01, 0.01);
+    std::uniform_int_distribution<int> lot(100, 1000);
+    long long ts = 1672583400000000000LL;
+    double mid = 100.0;
+    char buf[160];
+    for (size_t i = 0; i < num_rows; ++i) {
+        ts += dt(rng);
+        mid = std::min(110.0, std::max(90.0, mid + drift(rng)));
+        if (rng() % 10 < 7) {
+            std::snprintf(buf, sizeof(buf), "QUOTE,%lld,SYNTH,,,%.2f,%d,%.2f,%d\n", ts, mid - 0.01, lot(rng) * 10, mid + 0.01, lot(rng) * 10);
+        } else {
+            std::snprintf(buf, sizeof(buf), "TRADE,%lld,SYNTH,%.2f,%d,,,,\n", ts, mid, lot(rng) / 5);
+        }
+        out << buf;
+    }
+}
+
+double run(const std::string& filename, market_replay::CsvParser::Backend backend, size_t& rows_out) {
+    auto start = std::chrono::steady_clock::now();
+    market_replay::CsvParser parser(filename, backend);
+    size_t rows = 0;
+    while (parser.has_more_events()) {
+        if (parser.read_next_event()) ++rows;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    rows_out = rows;
+    return elapsed;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t num_rows = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    std::string filename = argc > 2 ? argv[2] : "bench_ticks.csv";
+    bool generated = argc <= 2;
+
+    market_replay::Logger::init("bench_csv_parser_log.txt", spdlog::level::warn, spdlog::level::warn, false);
+    if (generated) {
+        generate_ticks(filename, num_rows);
+    }
+
+    struct Case { const char* name; market_replay::CsvParser::Backend backend; };
+    const Case cases[] = {{"stream (getline+stod)", market_replay::CsvParser::Backend::STREAM},
+                          {"mmap (string_view+from_chars)", market_replay::CsvParser::Backend::MMAP}};
+    double baseline = 0.0;
+    for (const auto& c : cases) {
+        size_t rows = 0;
+        run(filename, c.backend, rows); // Warm the page cache
+        double secs = run(filename, c.backend, rows);
+        double rows_per_sec = rows / secs;
+        if (baseline == 0.0) baseline = rows_per_sec;
+        std::printf("%-32s rows=%zu time=%.3fs rows/s=%.0f speedup=%.2fx\n", c.name, rows, secs, rows_per_sec, rows_per_sec / baseline);
+    }
+
+    market_replay::Logger::shutdown();
+    if (generated) std::remove(filename.c_str());
+    return 0;
+}
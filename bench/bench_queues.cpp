@@ -0,0 +1,122 @@
+// Throughput and round-trip latency of the dispatcher->strategy channel implementations.
+// Usage: bench_queues [num_items=2000000] [round_trips=100000] [capacity=4096]
+// Spinning policies need a spare core per side; on an oversubscribed machine their numbers
+// mostly measure the scheduler.
+#include "market_replay/utils/blocking_queue.hpp"
+#include "market_replay/utils/spsc_ring_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using market_replay::utils::BlockingQueue;
+using market_replay::utils::IQueue;
+using market_replay::utils::SpscRingBuffer;
+using market_replay::utils::WaitPolicy;
+
+using QueueFactory = std::function<std::unique_ptr<IQueue<uint64_t>>()>;
+
+struct Variant {
+    std::string name;
+    QueueFactory make;
+};
+
+// One producer streams num_items through the queue, one consumer drains it
+double run_throughput(IQueue<uint64_t>& queue, size_t num_items, size_t batch) {
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&]() {
+        uint64_t item = 0;
+        std::vector<uint64_t> out;
+        out.reserve(batch);
+        size_t received = 0;
+        while (received < num_items) {
+            if (batch > 1) {
+                out.clear();
+                received += queue.pop_batch(out, batch);
+            } else if (queue.wait_and_pop(item)) {
+                ++received;
+            }
+        }
+    });
+    if (batch > 1) {
+        std::vector<uint64_t> chunk;
+        chunk.reserve(batch);
+        for (size_t i = 0; i < num_items; ++i) {
+            chunk.push_back(i);
+            if (chunk.size() == batch) queue.push_batch(chunk);
+        }
+        queue.push_batch(chunk);
+    } else {
+        for (size_t i = 0; i < num_items; ++i) queue.push(i);
+    }
+    consumer.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Ping-pong over a pair of queues; returns sorted one-way latencies (half round trip) in ns
+std::vector<double> run_latency(IQueue<uint64_t>& ping, IQueue<uint64_t>& pong, size_t round_trips) {
+    std::thread echo([&]() {
+        uint64_t item = 0;
+        for (size_t i = 0; i < round_trips; ++i) {
+            if (!ping.wait_and_pop(item)) return;
+            pong.push(item);
+        }
+    });
+    std::vector<double> samples;
+    samples.reserve(round_trips);
+    uint64_t item = 0;
+    for (size_t i = 0; i < round_trips; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        ping.push(i);
+        pong.wait_and_pop(item);
+        samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / 2.0);
+    }
+    echo.join();
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())));
+    return sorted[idx];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t num_items = argc > 1 ? std::stoull(argv[1]) : 2'000'000;
+    size_t round_trips = argc > 2 ? std::stoull(argv[2]) : 100'000;
+    size_t capacity = argc > 3 ? std::stoull(argv[3]) : 4096;
+
+    std::vector<Variant> variants = {
+        {"BlockingQueue", [capacity] { return std::make_unique<BlockingQueue<uint64_t>>(capacity); }},
+        {"SpscRing/BUSY_SPIN", [capacity] { return std::make_unique<SpscRingBuffer<uint64_t>>(capacity, WaitPolicy::BUSY_SPIN); }},
+        {"SpscRing/YIELD", [capacity] { return std::make_unique<SpscRingBuffer<uint64_t>>(capacity, WaitPolicy::YIELD); }},
+        {"SpscRing/PARK", [capacity] { return std::make_unique<SpscRingBuffer<uint64_t>>(capacity, WaitPolicy::PARK); }},
+    };
+
+    std::printf("items=%zu round_trips=%zu capacity=%zu hw_threads=%u\n\n",
+                num_items, round_trips, capacity, std::thread::hardware_concurrency());
+    std::printf("%-20s %14s %14s %12s %12s %12s\n", "queue", "Mitems/s", "Mitems/s(b64)", "p50 ns", "p99 ns", "max ns");
+    for (const auto& v : variants) {
+        auto q1 = v.make();
+        double single = run_throughput(*q1, num_items, 1);
+        auto q2 = v.make();
+        double batched = run_throughput(*q2, num_items, 64);
+        auto ping = v.make();
+        auto pong = v.make();
+        auto lat = run_latency(*ping, *pong, round_trips);
+        std::printf("%-20s %14.2f %14.2f %12.0f %12.0f %12.0f\n", v.name.c_str(),
+                    num_items / single / 1e6, num_items / batched / 1e6,
+                    percentile(lat, 0.50), percentile(lat, 0.99), lat.empty() ? 0.0 : lat.back());
+    }
+    return 0;
+}
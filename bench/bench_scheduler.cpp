@@ -0,0 +1,94 @@
+// Events/sec of the MEPQ scheduler implementations under a dispatcher-like workload.
+// Usage: bench_scheduler [num_pops=2000000] [preload_events=500000]
+//
+// "steady" models STREAMING: a small population of acks/fills tens of microseconds out, the
+// 10 ms order-processing tick and the odd late tick. "preload" models PRELOAD: the whole file is
+// pushed up front (1 ms apart) and then drained while acks keep being scheduled.
+#include "market_replay/event_heap.hpp"
+#include "market_replay/timing_wheel_scheduler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+
+using namespace market_replay;
+
+std::unique_ptr<BaseEvent> make_event(long long ts_ns) {
+    return std::make_unique<OrderAckEvent>(Timestamp(std::chrono::nanoseconds(ts_ns)), 0, 0, 0,
+                                           INVALID_SYMBOL_ID, OrderStatus::ACKNOWLEDGED);
+}
+
+long long to_ns(Timestamp ts) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+}
+
+// Returns pops per second
+double run(IEventScheduler& scheduler, size_t num_pops, size_t preload_events) {
+    std::mt19937_64 rng(1234);
+    std::uniform_int_distribution<int> pct(0, 99);
+    std::uniform_int_distribution<long long> ack_us(20, 80);
+    std::uniform_int_distribution<long long> fill_us(50, 150);
+
+    const long long start_ns = 1'700'000'000'000'000'000LL;
+    for (size_t i = 0; i < preload_events; ++i) {
+        scheduler.push(make_event(start_ns + static_cast<long long>(i) * 1'000'000LL));
+    }
+    scheduler.push(make_event(start_ns + 10'000'000LL)); // Order-processing tick
+    for (int i = 0; i < 32; ++i) scheduler.push(make_event(start_ns + ack_us(rng) * 1000));
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t pops = 0;
+    while (pops < num_pops && !scheduler.empty()) {
+        const long long now = to_ns(scheduler.top_timestamp());
+        scheduler.pop(); // Freed straight back into the event pool
+        ++pops;
+
+        int p = pct(rng);
+        if (p < 45) {
+            scheduler.push(make_event(now + ack_us(rng) * 1000));      // Ack
+        } else if (p < 90) {
+            scheduler.push(make_event(now + fill_us(rng) * 1000));     // Fill
+        } else if (p < 95) {
+            scheduler.push(make_event(now + 10'000'000LL));            // Next order-processing tick
+        } else if (p < 97) {
+            scheduler.push(make_event(now));                           // Same-time control event
+        }
+        // Remaining 3%: nothing scheduled, population shrinks a little
+        if (scheduler.size() < 8) scheduler.push(make_event(now + ack_us(rng) * 1000));
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    scheduler.clear();
+    return static_cast<double>(pops) / secs;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t num_pops = argc > 1 ? std::stoull(argv[1]) : 2'000'000;
+    size_t preload_events = argc > 2 ? std::stoull(argv[2]) : 500'000;
+
+    struct Variant {
+        const char* name;
+        std::function<std::unique_ptr<IEventScheduler>()> make;
+    };
+    Variant variants[] = {
+        {"EventHeap", [] { return std::make_unique<EventHeap>(); }},
+        {"TimingWheel(1us x 16384)", [] { return std::make_unique<TimingWheelScheduler>(); }},
+    };
+
+    std::printf("pops=%zu preload_events=%zu\n\n", num_pops, preload_events);
+    std::printf("%-26s %18s %18s\n", "scheduler", "steady Mevents/s", "preload Mevents/s");
+    for (const auto& v : variants) {
+        auto steady = v.make();
+        double steady_rate = run(*steady, num_pops, 0);
+        auto preload = v.make();
+        double preload_rate = run(*preload, num_pops, preload_events);
+        std::printf("%-26s %18.2f %18.2f\n", v.name, steady_rate / 1e6, preload_rate / 1e6);
+    }
+    return 0;
+}
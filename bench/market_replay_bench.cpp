@@ -0,0 +1,529 @@
+// market_replay_bench: end-to-end replay throughput, delivery latency and memory over a matrix of
+// strategy and symbol counts, on reproducible synthetic sessions.
+//
+// Usage: market_replay_bench [--ticks N] [--strategies 1,10,100] [--symbols 1,100,5000]
+//                            [--execution threaded|pooled|inline] [--subscribe partition|all]
+//                            [--order-every N] [--seed S] [--json out.json] [--csv out.csv]
+//                            [--no-fork] [--write session.csv|.mrt|.mrtz]
+//
+// Each configuration replays the same seeded session (data/synth_gen.py's quote/trade mix and
+// one-cent random walk, spread over many symbols and generated on the fly, so 1B ticks need no
+// more memory than 1M) through a Dispatcher with that many strategies. With "partition" each
+// symbol goes to one strategy (or, with fewer symbols than strategies, each strategy takes one
+// symbol); with "all" every strategy takes every symbol. Each strategy submits a market order
+// every --order-every quotes it sees.
+//
+// Reported per configuration: ticks/s and deliveries/s (ticks times the strategies each went to)
+// over the wall-clock time of Dispatcher::run(), the P50/P99/P99.9/max wall-clock time from a
+// tick being queued for a strategy to its on_event starting (Dispatcher::Config::
+// measure_delivery_latency; not measured for inline), and peak RSS. Every configuration runs in
+// a child process of its own, so peak RSS is its own; --no-fork runs them in this process instead
+// (peak RSS is then cumulative), as they always are where there is no fork(), e.g. on Windows.
+// --write saves the session of the first --symbols value instead
+// of benchmarking, to replay through market_replay_sim_cli.
+#include "market_replay/block_tick_file.hpp"
+#include "market_replay/dispatcher.hpp"
+#include "market_replay/latency_histogram.hpp"
+#include "market_replay/logger.hpp"
+#include "market_replay/tick_file.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MARKET_REPLAY_BENCH_HAS_FORK 1
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h> // For GetProcessMemoryInfo
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MARKET_REPLAY_VERSION
+#define MARKET_REPLAY_VERSION "unknown"
+#endif
+
+#if MARKET_REPLAY_EVENT_POOL
+constexpr bool kEventPool = true;
+#else
+constexpr bool kEventPool = false;
+#endif
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+constexpr bool kFixedPointPrices = true;
+#else
+constexpr bool kFixedPointPrices = false;
+#endif
+#ifdef MARKET_REPLAY_PROFILING
+constexpr bool kProfiling = true;
+#else
+constexpr bool kProfiling = false;
+#endif
+#ifdef MARKET_REPLAY_BENCH_HAS_FORK
+constexpr bool kHasFork = true;
+#else
+constexpr bool kHasFork = false;
+#endif
+
+namespace {
+
+using namespace market_replay;
+
+// A synthetic session, generated as it is read. Ticks are 0.1-2us apart, each for a uniformly
+// drawn symbol; 70% are quotes one cent either side of the symbol's mid, the rest trades at the
+// bid or the ask. Mids random-walk by a cent within [90, 110], as in data/synth_gen.py.
+class SyntheticSession : public IMarketDataSource {
+public:
+    SyntheticSession(uint64_t ticks, size_t symbols, uint64_t seed)
+        : remaining_(ticks), rng_(seed), mid_cents_(symbols, 10000) {
+        symbol_ids_.reserve(symbols);
+        for (size_t i = 0; i < symbols; ++i) symbol_ids_.push_back(intern_symbol(symbol_name_for(i)));
+    }
+
+    static std::string symbol_name_for(size_t i) {
+        char name[sizeof("BENCH") + 20]; // Room for any size_t
+        std::snprintf(name, sizeof(name), "BENCH%05zu", i);
+        return name;
+    }
+    const std::vector<SymbolId>& symbol_ids() const { return symbol_ids_; }
+    uint64_t checksum() const { return checksum_; } // FNV-1a over every tick read so far
+
+    std::unique_ptr<BaseEvent> read_next_event() override {
+        if (remaining_ == 0) return nullptr;
+        remaining_--;
+        ts_ns_ += 100 + static_cast<int64_t>(rng_() % 1900);
+        const size_t symbol = symbol_ids_.size() == 1 ? 0 : static_cast<size_t>(rng_() % symbol_ids_.size());
+        int64_t& mid = mid_cents_[symbol];
+        const uint64_t draw = rng_();
+        mid = std::min<int64_t>(11000, std::max<int64_t>(9000, mid + static_cast<int64_t>(draw % 3) - 1));
+        const Timestamp ts{std::chrono::nanoseconds(ts_ns_)};
+        const SymbolId symbol_id = symbol_ids_[symbol];
+        const bool quote = (draw >> 8) % 10 < 7;
+        mix(static_cast<uint64_t>(ts_ns_));
+        mix(symbol_id);
+        mix(static_cast<uint64_t>(mid) << 1 | quote);
+        if (quote) {
+            const Quantity bid_size = static_cast<Quantity>(100 + (draw >> 16) % 901) * 10;
+            const Quantity ask_size = static_cast<Quantity>(100 + (draw >> 32) % 901) * 10;
+            return std::make_unique<QuoteEvent>(ts, symbol_id, static_cast<double>(mid - 1) / 100.0, bid_size,
+                                                static_cast<double>(mid + 1) / 100.0, ask_size);
+        }
+        const int64_t price = (draw >> 16) % 2 ? mid + 1 : mid - 1;
+        return std::make_unique<TradeEvent>(ts, symbol_id, static_cast<double>(price) / 100.0,
+                                            static_cast<Quantity>(10 + (draw >> 32) % 191));
+    }
+    bool has_more_events() const override { return remaining_ > 0; }
+
+private:
+    void mix(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            checksum_ = (checksum_ ^ ((value >> (8 * i)) & 0xFF)) * 1099511628211ULL;
+        }
+    }
+
+    uint64_t remaining_;
+    std::mt19937_64 rng_;
+    int64_t ts_ns_ = 1672583400000000000LL; // 2023-01-01 14:30 UTC
+    std::vector<SymbolId> symbol_ids_;
+    std::vector<int64_t> mid_cents_;
+    uint64_t checksum_ = 14695981039346656037ULL;
+};
+
+// Keeps a mid per symbol it is sent and buys 1 at market every order_every quotes
+class BenchStrategy : public IStrategy {
+public:
+    BenchStrategy(StrategyId id, IOrderSubmitter* order_submitter, std::vector<SymbolId> symbols, uint64_t order_every)
+        : IStrategy(std::move(id), order_submitter, nullptr), symbols_(std::move(symbols)), order_every_(order_every) {}
+
+    void on_init(Timestamp) override {
+        for (SymbolId symbol_id : symbols_) subscribe(symbol_id);
+    }
+    void on_event(const StrategyInputEventVariant& event_variant, Timestamp strategy_arrival_ts) override {
+        std::visit(StrategyEventVisitor(*this, strategy_arrival_ts), event_variant);
+    }
+
+    uint64_t market_events() const { return market_events_; }
+    uint64_t fills() const { return fills_; }
+
+protected:
+    void on_quote(const QuoteEvent& quote, Timestamp strategy_arrival_ts) override {
+        market_events_++;
+        if (quote.symbol_id >= mids_.size()) mids_.resize(static_cast<size_t>(quote.symbol_id) + 1, 0.0);
+        mids_[quote.symbol_id] = (quote.get_bid_price() + quote.get_ask_price()) / 2;
+        if (order_every_ && ++quotes_ % order_every_ == 0) {
+            submit_order(quote.symbol_id, OrderSide::BUY, OrderType::MARKET, INVALID_PRICE, 1, strategy_arrival_ts);
+        }
+    }
+    void on_trade(const TradeEvent&, Timestamp) override { market_events_++; }
+    void on_order_ack(const OrderAckEvent& ack, Timestamp) override {
+        if (ack.status == OrderStatus::FILLED || ack.status == OrderStatus::PARTIALLY_FILLED) fills_++;
+    }
+    void on_sim_control(const SimControlEvent&, Timestamp) override {}
+
+private:
+    std::vector<SymbolId> symbols_; // Empty: every symbol
+    uint64_t order_every_;
+    uint64_t quotes_ = 0;
+    uint64_t market_events_ = 0;
+    uint64_t fills_ = 0;
+    std::vector<double> mids_; // By SymbolId
+};
+
+struct Options {
+    uint64_t ticks = 1'000'000;
+    std::vector<size_t> strategies = {1, 10, 100};
+    std::vector<size_t> symbols = {1, 100, 5000};
+    Dispatcher::StrategyExecution execution = Dispatcher::StrategyExecution::THREADED;
+    bool subscribe_all = false;
+    uint64_t order_every = 10000;
+    uint64_t seed = 42;
+    std::string json_path;
+    std::string csv_path;
+    bool fork = kHasFork;
+    std::string write_path;
+};
+
+// Fixed-size so a child can hand it back through a pipe
+struct Result {
+    size_t strategies = 0;
+    size_t symbols = 0;
+    uint64_t ticks = 0;
+    uint64_t deliveries = 0; // Market events received, summed over strategies
+    uint64_t fills = 0;
+    double wall_s = 0.0;
+    uint64_t latency_count = 0;
+    int64_t p50_ns = 0, p99_ns = 0, p999_ns = 0, max_ns = 0;
+    uint64_t peak_rss_kb = 0;
+    uint64_t checksum = 0;
+};
+
+const char* execution_name(Dispatcher::StrategyExecution execution) {
+    switch (execution) {
+        case Dispatcher::StrategyExecution::INLINE: return "inline";
+        case Dispatcher::StrategyExecution::POOLED: return "pooled";
+        default: return "threaded";
+    }
+}
+
+// Same values as the latency block in src/main.cpp
+LatencyModel::Config cli_latency_config() {
+    LatencyModel::Config cfg;
+    cfg.market_data_feed_latency = string_to_duration_ns("50us");
+    cfg.strategy_processing_latency = string_to_duration_ns("5us");
+    cfg.order_network_latency_strat_to_exch = string_to_duration_ns("20us");
+    cfg.exchange_order_processing_latency = string_to_duration_ns("10us");
+    cfg.exchange_fill_processing_latency = string_to_duration_ns("15us");
+    cfg.ack_network_latency_exch_to_strat = string_to_duration_ns("20us");
+    return cfg;
+}
+
+uint64_t peak_rss_kb() {
+#if defined(MARKET_REPLAY_BENCH_HAS_FORK)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024; // Bytes there
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return static_cast<uint64_t>(counters.PeakWorkingSetSize) / 1024;
+#else
+    return 0; // Unknown
+#endif
+}
+
+// The symbols strategy s of num_strategies is given; empty for every symbol
+std::vector<SymbolId> symbols_for(size_t s, size_t num_strategies, const std::vector<SymbolId>& all, bool subscribe_all) {
+    if (subscribe_all) return {};
+    if (all.size() < num_strategies) return {all[s % all.size()]};
+    std::vector<SymbolId> mine;
+    for (size_t i = s; i < all.size(); i += num_strategies) mine.push_back(all[i]);
+    return mine;
+}
+
+Result run_config(const Options& options, size_t num_strategies, size_t num_symbols) {
+    auto session = std::make_unique<SyntheticSession>(options.ticks, num_symbols, options.seed);
+    SyntheticSession* session_view = session.get();
+    const std::vector<SymbolId> all_symbols = session->symbol_ids();
+
+    Dispatcher::Config config;
+    config.strategy_execution = options.execution;
+    config.measure_delivery_latency = options.execution != Dispatcher::StrategyExecution::INLINE;
+    Dispatcher dispatcher(std::move(session), cli_latency_config(), nullptr, config);
+
+    std::vector<BenchStrategy*> strategies(num_strategies, nullptr);
+    for (size_t s = 0; s < num_strategies; ++s) {
+        std::vector<SymbolId> mine = symbols_for(s, num_strategies, all_symbols, options.subscribe_all);
+        BenchStrategy*& out = strategies[s];
+        const uint64_t order_every = options.order_every;
+        dispatcher.add_strategy("Bench_" + std::to_string(s),
+                                [&out, &mine, order_every](const StrategyId& id, IOrderSubmitter* submitter,
+                                                           std::shared_ptr<MetricsCollector>) {
+                                    auto strategy = std::make_unique<BenchStrategy>(id, submitter, std::move(mine), order_every);
+                                    out = strategy.get();
+                                    return strategy;
+                                });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    dispatcher.run();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    result.strategies = num_strategies;
+    result.symbols = num_symbols;
+    result.ticks = options.ticks;
+    result.wall_s = std::chrono::duration<double>(elapsed).count();
+    result.checksum = session_view->checksum();
+    LatencyHistogram latency;
+    for (size_t s = 0; s < num_strategies; ++s) {
+        result.deliveries += strategies[s]->market_events();
+        result.fills += strategies[s]->fills();
+        if (const LatencyHistogram* h = dispatcher.delivery_latency(static_cast<StrategyIndex>(s))) latency.merge(*h);
+    }
+    result.latency_count = latency.count();
+    result.p50_ns = latency.value_at_percentile(50.0).count();
+    result.p99_ns = latency.value_at_percentile(99.0).count();
+    result.p999_ns = latency.value_at_percentile(99.9).count();
+    result.max_ns = latency.max().count();
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+#ifdef MARKET_REPLAY_BENCH_HAS_FORK
+// In a child process, so its peak RSS is its own
+Result run_config_isolated(const Options& options, size_t num_strategies, size_t num_symbols) {
+    int fds[2];
+    if (pipe(fds) != 0) throw std::runtime_error("pipe() failed");
+    const pid_t pid = fork();
+    if (pid < 0) throw std::runtime_error("fork() failed");
+    if (pid == 0) {
+        close(fds[0]);
+        int status = 1;
+        try {
+            const Result result = run_config(options, num_strategies, num_symbols);
+            status = write(fds[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result)) ? 0 : 1;
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "Configuration %zu strategies x %zu symbols failed: %s\n", num_strategies, num_symbols, e.what());
+        }
+        Logger::shutdown();
+        _exit(status);
+    }
+    close(fds[1]);
+    Result result;
+    const ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (got != static_cast<ssize_t>(sizeof(result)) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("Configuration " + std::to_string(num_strategies) + " strategies x " +
+                                 std::to_string(num_symbols) + " symbols did not complete");
+    }
+    return result;
+}
+#endif
+
+void write_session(const Options& options) {
+    SyntheticSession session(options.ticks, options.symbols.front(), options.seed);
+    const std::string& path = options.write_path;
+    auto ends_with = [&path](const std::string& suffix) {
+        return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    if (ends_with(tick_format::FILE_EXTENSION) || ends_with(block_tick_format::FILE_EXTENSION)) {
+        std::unique_ptr<TickFileWriter> mrt;
+        std::unique_ptr<BlockTickFileWriter> mrtz;
+        if (ends_with(tick_format::FILE_EXTENSION)) mrt = std::make_unique<TickFileWriter>(path);
+        else mrtz = std::make_unique<BlockTickFileWriter>(path);
+        while (session.has_more_events()) {
+            auto event = session.read_next_event();
+            if (mrt) mrt->add(*event);
+            else mrtz->add(*event);
+        }
+    } else {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("Cannot write " + path);
+        out << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+        char line[160];
+        while (session.has_more_events()) {
+            auto event = session.read_next_event();
+            const long long ts = std::chrono::duration_cast<std::chrono::nanoseconds>(event->exchange_timestamp.time_since_epoch()).count();
+            if (event->type == EventType::QUOTE) {
+                const auto& q = static_cast<const QuoteEvent&>(*event);
+                std::snprintf(line, sizeof(line), "QUOTE,%lld,%s,,,%.2f,%llu,%.2f,%llu\n", ts, symbol_name(q.symbol_id).c_str(),
+                              q.get_bid_price(), static_cast<unsigned long long>(q.bid_size), q.get_ask_price(),
+                              static_cast<unsigned long long>(q.ask_size));
+            } else {
+                const auto& t = static_cast<const TradeEvent&>(*event);
+                std::snprintf(line, sizeof(line), "TRADE,%lld,%s,%.2f,%llu,,,,\n", ts, symbol_name(t.symbol_id).c_str(),
+                              t.get_price(), static_cast<unsigned long long>(t.size));
+            }
+            out << line;
+        }
+    }
+    std::printf("Wrote %llu ticks over %zu symbols to %s (checksum %016llx)\n", static_cast<unsigned long long>(options.ticks),
+                options.symbols.front(), path.c_str(), static_cast<unsigned long long>(session.checksum()));
+}
+
+double ticks_per_sec(const Result& r) { return r.wall_s > 0 ? static_cast<double>(r.ticks) / r.wall_s : 0.0; }
+double deliveries_per_sec(const Result& r) { return r.wall_s > 0 ? static_cast<double>(r.deliveries) / r.wall_s : 0.0; }
+
+void write_json(const std::string& path, const Options& options, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write " + path);
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    out << "{\n  \"benchmark\": \"market_replay_bench\",\n"
+        << "  \"version\": \"" << MARKET_REPLAY_VERSION << "\",\n"
+        << "  \"date\": \"" << date << "\",\n"
+        << "  \"build\": {\"compiler\": \"" << __VERSION__ << "\", \"event_pool\": " << (kEventPool ? "true" : "false")
+        << ", \"fixed_point_prices\": " << (kFixedPointPrices ? "true" : "false")
+        << ", \"profiling\": " << (kProfiling ? "true" : "false") << "},\n"
+        << "  \"host\": {\"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n"
+        << "  \"params\": {\"ticks\": " << options.ticks << ", \"seed\": " << options.seed << ", \"execution\": \""
+        << execution_name(options.execution) << "\", \"subscribe\": \"" << (options.subscribe_all ? "all" : "partition")
+        << "\", \"order_every\": " << options.order_every << ", \"isolated\": " << (options.fork ? "true" : "false") << "},\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        char checksum[20];
+        std::snprintf(checksum, sizeof(checksum), "%016llx", static_cast<unsigned long long>(r.checksum));
+        out << "    {\"strategies\": " << r.strategies << ", \"symbols\": " << r.symbols << ", \"ticks\": " << r.ticks
+            << ", \"deliveries\": " << r.deliveries << ", \"fills\": " << r.fills << ", \"wall_s\": " << r.wall_s
+            << ", \"ticks_per_sec\": " << static_cast<uint64_t>(ticks_per_sec(r))
+            << ", \"deliveries_per_sec\": " << static_cast<uint64_t>(deliveries_per_sec(r))
+            << ", \"delivery_latency_ns\": {\"count\": " << r.latency_count << ", \"p50\": " << r.p50_ns << ", \"p99\": " << r.p99_ns
+            << ", \"p99_9\": " << r.p999_ns << ", \"max\": " << r.max_ns << "}"
+            << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"session_checksum\": \"" << checksum << "\"}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+void write_csv(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write " + path);
+    out << "strategies,symbols,ticks,deliveries,fills,wall_s,ticks_per_sec,deliveries_per_sec,"
+           "latency_p50_ns,latency_p99_ns,latency_p99_9_ns,latency_max_ns,peak_rss_kb,session_checksum\n";
+    for (const Result& r : results) {
+        char checksum[20];
+        std::snprintf(checksum, sizeof(checksum), "%016llx", static_cast<unsigned long long>(r.checksum));
+        out << r.strategies << ',' << r.symbols << ',' << r.ticks << ',' << r.deliveries << ',' << r.fills << ',' << r.wall_s << ','
+            << static_cast<uint64_t>(ticks_per_sec(r)) << ',' << static_cast<uint64_t>(deliveries_per_sec(r)) << ','
+            << r.p50_ns << ',' << r.p99_ns << ',' << r.p999_ns << ',' << r.max_ns << ',' << r.peak_rss_kb << ',' << checksum << '\n';
+    }
+}
+
+std::vector<size_t> parse_list(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream ss(text);
+    for (std::string item; std::getline(ss, item, ',');) {
+        const size_t value = std::stoull(item);
+        if (value == 0) throw std::runtime_error("Counts must be positive: " + text);
+        values.push_back(value);
+    }
+    if (values.empty()) throw std::runtime_error("Empty list");
+    return values;
+}
+
+Options parse_options(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error(arg + " needs a value");
+            return argv[++i];
+        };
+        if (arg == "--ticks") options.ticks = std::stoull(value());
+        else if (arg == "--strategies") options.strategies = parse_list(value());
+        else if (arg == "--symbols") options.symbols = parse_list(value());
+        else if (arg == "--execution") {
+            const std::string mode = value();
+            if (mode == "threaded") options.execution = Dispatcher::StrategyExecution::THREADED;
+            else if (mode == "pooled") options.execution = Dispatcher::StrategyExecution::POOLED;
+            else if (mode == "inline") options.execution = Dispatcher::StrategyExecution::INLINE;
+            else throw std::runtime_error("Unknown execution mode: " + mode);
+        } else if (arg == "--subscribe") {
+            const std::string mode = value();
+            if (mode != "partition" && mode != "all") throw std::runtime_error("Unknown subscription mode: " + mode);
+            options.subscribe_all = mode == "all";
+        } else if (arg == "--order-every") options.order_every = std::stoull(value());
+        else if (arg == "--seed") options.seed = std::stoull(value());
+        else if (arg == "--json") options.json_path = value();
+        else if (arg == "--csv") options.csv_path = value();
+        else if (arg == "--no-fork") options.fork = false;
+        else if (arg == "--write") options.write_path = value();
+        else throw std::runtime_error("Unknown option: " + arg);
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\nUsage: %s [--ticks N] [--strategies 1,10,100] [--symbols 1,100,5000] "
+                             "[--execution threaded|pooled|inline] [--subscribe partition|all] [--order-every N] [--seed S] "
+                             "[--json out.json] [--csv out.csv] [--no-fork] [--write session.csv|.mrt|.mrtz]\n",
+                     e.what(), argv[0]);
+        return 1;
+    }
+
+    // The replay's own logging stays out of the measurement
+    Logger::init("market_replay_bench_log.txt", spdlog::level::warn, spdlog::level::warn, false);
+    int exit_code = 0;
+    try {
+        if (!options.write_path.empty()) {
+            write_session(options);
+        } else {
+            std::printf("%llu ticks per configuration, %s strategies, seed %llu\n", static_cast<unsigned long long>(options.ticks),
+                        execution_name(options.execution), static_cast<unsigned long long>(options.seed));
+            std::printf("%10s %8s %8s %12s %14s %10s %10s %10s %10s\n", "strategies", "symbols", "wall_s", "ticks/s",
+                        "deliveries/s", "p50_ns", "p99_ns", "p99.9_ns", "rss_mb");
+            std::fflush(stdout);
+            std::vector<Result> results;
+            for (size_t num_symbols : options.symbols) {
+                for (size_t num_strategies : options.strategies) {
+#ifdef MARKET_REPLAY_BENCH_HAS_FORK
+                    const Result r = options.fork ? run_config_isolated(options, num_strategies, num_symbols)
+                                                  : run_config(options, num_strategies, num_symbols);
+#else
+                    const Result r = run_config(options, num_strategies, num_symbols);
+#endif
+                    std::printf("%10zu %8zu %8.3f %12.0f %14.0f %10lld %10lld %10lld %10.1f\n", r.strategies, r.symbols, r.wall_s,
+                                ticks_per_sec(r), deliveries_per_sec(r), static_cast<long long>(r.p50_ns),
+                                static_cast<long long>(r.p99_ns), static_cast<long long>(r.p999_ns),
+                                static_cast<double>(r.peak_rss_kb) / 1024.0);
+                    std::fflush(stdout);
+                    results.push_back(r);
+                }
+            }
+            if (!options.json_path.empty()) write_json(options.json_path, options, results);
+            if (!options.csv_path.empty()) write_csv(options.csv_path, results);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "market_replay_bench: %s\n", e.what());
+        exit_code = 1;
+    }
+    Logger::shutdown();
+    return exit_code;
+}
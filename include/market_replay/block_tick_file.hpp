@@ -0,0 +1,190 @@
+#ifndef MARKET_REPLAY_BLOCK_TICK_FILE_HPP
+#define MARKET_REPLAY_BLOCK_TICK_FILE_HPP
+
+#include "event.hpp"
+#include "interfaces.hpp" // For IMarketDataSource
+#include "tick_file.hpp"  // For TickRecord and the symbol table
+#include "utils/mapped_file.hpp"
+#include "utils/work_stealing_pool.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace market_replay {
+
+// Block-compressed tick format (.mrtz): the .mrt records cut into blocks of block_records, each
+// compressed on its own so any block can be decoded without the ones before it. Layout, all
+// little-endian:
+//
+//   FileHeader                        (64 bytes)
+//   compressed blocks                 (back to back, from sizeof(FileHeader))
+//   symbol table                      (as in .mrt)
+//   BlockIndexEntry[block_count]      (8-byte aligned, one per block)
+//
+// A block starts with two varints, the time and price quanta: the greatest common divisors of its
+// timestamps and of its prices, in which both are then counted. Per record follow the type byte
+// and, as varints, the timestamp delta to the previous record, the file-local symbol id, the
+// price delta to that symbol's previous price in the block and the size; quotes add the ask - bid
+// spread and the ask size. Deltas are zigzag encoded, the first record of a block is relative to
+// zero. Tick data is dominated by small time steps and one-tick price moves, so most fields take
+// a byte or two and a record 8-12 bytes against 48 in .mrt.
+namespace block_tick_format {
+
+constexpr char MAGIC[8] = {'M', 'R', 'T', 'B', 'L', 'K', '0', '1'};
+constexpr uint32_t VERSION = 2; // 2: the symbol table records tick sizes, as in .mrt
+constexpr uint32_t MIN_VERSION = 1;
+constexpr const char* FILE_EXTENSION = ".mrtz";
+constexpr uint32_t DEFAULT_BLOCK_RECORDS = 4096;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_records; // Records per block; the last block may hold fewer
+    uint64_t record_count;
+    int64_t price_scale;
+    uint64_t symbol_table_offset;
+    uint32_t symbol_count;
+    uint32_t reserved;
+    uint64_t block_count;
+    uint64_t block_index_offset;
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout is part of the file format");
+
+struct BlockIndexEntry {
+    int64_t first_timestamp_ns;
+    uint64_t first_record;
+    uint64_t offset; // Of the compressed block, from the start of the file
+    uint32_t compressed_size;
+    uint32_t record_count;
+};
+static_assert(sizeof(BlockIndexEntry) == 32, "BlockIndexEntry layout is part of the file format");
+
+inline bool has_extension(const std::string& path) {
+    const std::string ext = FILE_EXTENSION;
+    return path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+// Appends the compressed form of records [first, first + count) to `out`
+void encode_block(const tick_format::TickRecord* first, size_t count, std::string& out);
+// Decodes exactly `count` records from [data, data + size) into `out` (replacing its contents).
+// Throws std::runtime_error if the block is truncated, has trailing bytes, or names a symbol id
+// >= symbol_count.
+void decode_block(const char* data, size_t size, uint32_t count, uint32_t symbol_count,
+                  std::vector<tick_format::TickRecord>& out);
+
+} // namespace block_tick_format
+
+// Streams events into a .mrtz file, holding one block of records in memory at a time.
+class BlockTickFileWriter {
+public:
+    explicit BlockTickFileWriter(const std::string& filepath,
+                                 int64_t price_scale = tick_format::DEFAULT_PRICE_SCALE,
+                                 uint32_t block_records = block_tick_format::DEFAULT_BLOCK_RECORDS);
+    ~BlockTickFileWriter(); // Calls finish() if it hasn't been called
+
+    BlockTickFileWriter(const BlockTickFileWriter&) = delete;
+    BlockTickFileWriter& operator=(const BlockTickFileWriter&) = delete;
+
+    // Accepts QuoteEvent and TradeEvent; returns false for anything else.
+    bool add(const BaseEvent& event);
+    // Writes the last block, the symbol table, the block index and the final header. Safe to call more than once.
+    void finish();
+
+    uint64_t record_count() const { return record_count_; }
+    uint64_t bytes_written() const { return offset_; } // Header and blocks so far
+
+private:
+    void flush_block();
+
+    std::string filepath_;
+    std::ofstream out_;
+    int64_t price_scale_;
+    uint32_t block_records_;
+    uint64_t record_count_ = 0;
+    uint64_t offset_ = 0; // Where the next block goes
+    bool finished_ = false;
+    tick_format::SymbolTableWriter symbols_;
+    std::vector<tick_format::TickRecord> pending_; // The block being filled
+    std::string encoded_;                          // Scratch for flush_block()
+    std::vector<block_tick_format::BlockIndexEntry> index_;
+};
+
+// Replays a .mrtz file. Blocks are decoded by io_threads background workers into a ring of
+// blocks_ahead slots: as the replay finishes a block, the slot it came from is refilled with the
+// block blocks_ahead further on, so decoding stays that far ahead of the consumer and the
+// dispatcher only waits when the pool cannot keep up. With io_threads = 0 every block is decoded
+// on the calling thread when it is reached. The whole file is mapped read-only; the workers read
+// from the mapping and only the decoded blocks in the ring take memory.
+class BlockTickFileReader : public IMarketDataSource {
+public:
+    struct Config {
+        size_t io_threads = 2;
+        size_t blocks_ahead = 4; // Decoded blocks in flight or waiting, besides the one being replayed (min 1)
+    };
+
+    explicit BlockTickFileReader(const std::string& filepath); // Throws std::runtime_error on open/format errors
+    BlockTickFileReader(const std::string& filepath, Config config);
+    ~BlockTickFileReader() override; // Waits for decodes in flight
+
+    BlockTickFileReader(const BlockTickFileReader&) = delete;
+    BlockTickFileReader& operator=(const BlockTickFileReader&) = delete;
+
+    // Throws std::runtime_error if a block fails to decode
+    std::unique_ptr<BaseEvent> read_next_event() override;
+    bool has_more_events() const override { return next_record_ < header_.record_count; }
+
+    uint64_t record_count() const { return header_.record_count; }
+    uint64_t block_count() const { return header_.block_count; }
+    int64_t price_scale() const { return header_.price_scale; }
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    const block_tick_format::BlockIndexEntry* blocks_begin() const { return blocks_; }
+    const block_tick_format::BlockIndexEntry* blocks_end() const { return blocks_ + header_.block_count; }
+
+    // Positions the reader on the first record with timestamp >= ts. Only the block holding it
+    // (and those after, as the ring refills) is decoded.
+    void seek_to_timestamp(Timestamp ts);
+
+    // Positions are record numbers; seeking decodes from the block holding the record
+    bool seekable() const override { return true; }
+    uint64_t position() const override { return next_record_; }
+    void seek(uint64_t position) override;
+
+private:
+    struct Slot {
+        std::mutex mutex;
+        std::condition_variable ready_cv;
+        std::vector<tick_format::TickRecord> records; // Belongs to the decoding worker until ready is set
+        bool ready = false;                           // Guarded by mutex
+        std::string error;                            // Guarded by mutex; set instead of records on failure
+        bool scheduled = false;                       // Consumer side: a decode was queued and not yet taken
+    };
+
+    void decode(uint64_t block, std::vector<tick_format::TickRecord>& records) const;
+    void schedule(uint64_t block); // Into slot block % slots_.size(); no-op past the last block
+    void take_next_block();        // Moves the next block of the ring into current_ and refills its slot
+    void restart(uint64_t block);  // Drops the ring and starts decoding from `block`
+    void wait_idle();              // Until no decode is in flight
+    const tick_format::TickRecord* peek(); // The record at next_record_, loading its block if needed
+
+    Config config_;
+    utils::MappedFile file_;
+    block_tick_format::FileHeader header_{};
+    const block_tick_format::BlockIndexEntry* blocks_ = nullptr;
+    std::vector<std::string> symbols_;
+    std::vector<SymbolId> symbol_ids_; // File-local id -> process-wide SymbolId, interned at open
+
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<tick_format::TickRecord> current_; // The block being replayed
+    size_t current_pos_ = 0;
+    uint64_t next_block_ = 0; // Next block to take from the ring
+    uint64_t next_record_ = 0;
+    // Declared last, destroyed first: its destructor runs the decodes still queued while the slots exist
+    std::unique_ptr<utils::WorkStealingPool> io_pool_;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_BLOCK_TICK_FILE_HPP
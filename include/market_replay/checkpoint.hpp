@@ -0,0 +1,117 @@
+#ifndef MARKET_REPLAY_CHECKPOINT_HPP
+#define MARKET_REPLAY_CHECKPOINT_HPP
+
+#include "common.hpp"
+#include "event.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace market_replay {
+
+// Simulation checkpoints (.mrck): the dispatcher's whole state at one point of a replay, so a
+// later run can resume from it instead of replaying everything before it (Dispatcher::resume_from).
+//
+//   header      magic, uint32 version, uint32 flags, int64 sim time ns (fixed width, little-endian)
+//   sections    in Section order, each a one-byte tag followed by its fields
+//
+// Fields are LEB128 varints (signed ones zigzag-encoded), so counts, ids and quantities mostly take
+// a byte or two. Timestamps are stored relative to the checkpoint's sim time and doubles as their
+// 8 raw bytes. Strategy state is an opaque length-prefixed blob per strategy.
+namespace checkpoint_format {
+
+constexpr char MAGIC[8] = {'M', 'R', 'C', 'K', 'P', 'T', '0', '1'};
+constexpr uint32_t VERSION = 2; // 2: order books carry their far levels
+constexpr const char* FILE_EXTENSION = ".mrck";
+constexpr uint32_t FLAG_FIXED_POINT_PRICES = 1; // Market data prices stored as ticks (MARKET_REPLAY_FIXED_POINT_PRICES)
+constexpr size_t HEADER_SIZE = 24;
+
+enum class Section : uint8_t {
+    SYMBOLS = 1,    // SymbolRegistry names and tick sizes, by SymbolId
+    CLOCK = 2,      // Sim time, exchange order ids, ingestion counters
+    SOURCE = 3,     // Where the market data reader is
+    EVENTS = 4,     // MEPQ contents, then the streaming window
+    BOOKS = 5,      // Order books, resting orders included
+    PNL = 6,        // PnLEngine
+    STRATEGIES = 7, // Per strategy: id, next client order id, IStrategy::save_state blob
+    METRICS = 8,    // MetricsCollector totals, histograms and PnL
+    END = 0xFF
+};
+
+} // namespace checkpoint_format
+
+// Appends fields to an in-memory buffer. Timestamps are written relative to base_time.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(Timestamp base_time = Timestamp{}) : base_time_(base_time) {}
+
+    // The fixed-width header, with base_time as the sim time; first thing in a checkpoint
+    void write_header();
+    void write_u8(uint8_t value) { data_.push_back(static_cast<char>(value)); }
+    void write_bool(bool value) { write_u8(value ? 1 : 0); }
+    void write_varint(uint64_t value);
+    void write_svarint(int64_t value) { write_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+    void write_f64(double value);
+    void write_string(std::string_view value);
+    void write_timestamp(Timestamp ts); // Any value, Timestamp::min() and max() included
+    void write_duration(Duration duration) { write_svarint(duration.count()); }
+    void write_section(checkpoint_format::Section section) { write_u8(static_cast<uint8_t>(section)); }
+    // QuoteEvent, TradeEvent, OrderAckEvent or SimControlEvent, with both timestamps
+    void write_event(const BaseEvent& event);
+
+    Timestamp base_time() const { return base_time_; }
+    const std::string& data() const { return data_; }
+    std::string take() { return std::move(data_); }
+
+private:
+    Timestamp base_time_;
+    std::string data_;
+};
+
+// Reads fields back in the order they were written. Throws std::runtime_error on truncated or
+// malformed input.
+class CheckpointReader {
+public:
+    CheckpointReader(std::string_view data, Timestamp base_time) : data_(data), base_time_(base_time) {}
+
+    uint8_t read_u8();
+    bool read_bool() { return read_u8() != 0; }
+    uint64_t read_varint();
+    int64_t read_svarint() {
+        const uint64_t value = read_varint();
+        return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
+    double read_f64();
+    std::string_view read_string(); // Views into the checkpoint's data
+    Timestamp read_timestamp();
+    Duration read_duration() { return Duration(read_svarint()); }
+    void expect_section(checkpoint_format::Section section); // Throws if the next tag is another one
+    std::unique_ptr<BaseEvent> read_event();
+
+    Timestamp base_time() const { return base_time_; }
+    bool at_end() const { return pos_ == data_.size(); }
+
+private:
+    [[noreturn]] void fail(const char* what) const;
+
+    std::string_view data_;
+    size_t pos_ = 0;
+    Timestamp base_time_;
+};
+
+// An encoded checkpoint, header included
+struct Checkpoint {
+    Timestamp sim_time; // Taken before the first event at or after it was dispatched
+    std::string data;
+
+    // Throw std::runtime_error if the file can't be written, or read and recognised
+    void save(const std::string& path) const;
+    static Checkpoint load(const std::string& path);
+    // The sim time from the header, checked; throws std::runtime_error for data that is not a
+    // checkpoint of this build. Sections start at checkpoint_format::HEADER_SIZE.
+    static Timestamp parse_header(std::string_view data);
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_CHECKPOINT_HPP
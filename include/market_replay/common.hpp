@@ -18,6 +18,12 @@ constexpr double PRICE_EPSILON = 1e-9; // For double comparisons
 using Price = double;
 constexpr Price INVALID_PRICE = std::numeric_limits<Price>::quiet_NaN();
 
+// Fixed-point price: a whole number of the symbol's ticks (see SymbolRegistry::set_tick_size).
+// Market data is stored this way when built with MARKET_REPLAY_FIXED_POINT_PRICES.
+using PriceTicks = int64_t;
+constexpr PriceTicks INVALID_PRICE_TICKS = std::numeric_limits<PriceTicks>::min();
+constexpr Price DEFAULT_TICK_SIZE = 0.00001; // Symbols without a configured tick size
+
 
 // Helper to convert string to Timestamp (assuming specific format like epoch ns)
 Timestamp string_to_timestamp(const std::string& ts_str);
@@ -49,6 +55,12 @@ using Quantity = uint64_t;
 using OrderId = uint64_t; 
 using StrategyId = std::string;
 
+// Dense ids for the hot path. Names are only resolved for logging and reports (see symbol_registry.hpp).
+using SymbolId = uint32_t;        // Process-wide, assigned by SymbolRegistry
+using StrategyIndex = uint32_t;   // Per-dispatcher, assigned by Dispatcher::add_strategy in order
+constexpr SymbolId INVALID_SYMBOL_ID = std::numeric_limits<SymbolId>::max();
+constexpr StrategyIndex INVALID_STRATEGY_INDEX = std::numeric_limits<StrategyIndex>::max();
+
 
 struct PnL {
     double realized_pnl = 0.0;
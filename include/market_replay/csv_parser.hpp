@@ -2,31 +2,72 @@
 #define MARKET_REPLAY_CSV_PARSER_HPP
 
 #include "event.hpp"
+#include "interfaces.hpp" // For IMarketDataSource
 #include "logger.hpp"
+#include "utils/mapped_file.hpp"
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <vector>
+#include <array>
 #include <sstream> // For std::stringstream
 
 namespace market_replay {
 
-class CsvParser {
+class CsvParser : public IMarketDataSource {
 public:
-    CsvParser(const std::string& filepath);
-    ~CsvParser();
+    enum class Backend : uint8_t {
+        STREAM, // std::getline + stringstream split + std::stod. Kept as a reference for benchmarks.
+        MMAP    // Whole file mapped, fields tokenized in place as string_views, numbers via from_chars
+    };
+
+    CsvParser(const std::string& filepath, Backend backend = Backend::MMAP);
+    ~CsvParser() override;
 
     // Reads the next event from the CSV. Returns nullptr if EOF or error.
-    std::unique_ptr<BaseEvent> read_next_event();
-    bool has_more_events() const;
+    std::unique_ptr<BaseEvent> read_next_event() override;
+    bool has_more_events() const override;
+
+    // Positions are byte offsets of a line start. line_number() keeps counting from where it was
+    // across a seek, so it is only the file's line number when reading straight through.
+    bool seekable() const override { return true; }
+    uint64_t position() const override;
+    void seek(uint64_t position) override;
+
+    Backend backend() const { return backend_; }
+    long long line_number() const { return line_number_; }
 
 private:
+    // TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE
+    static constexpr size_t kNumFields = 9;
+    using FieldViews = std::array<std::string_view, kNumFields>;
+
+    Backend backend_;
+    long long line_number_ = 0;
+
+    // STREAM backend
     std::ifstream file_stream_;
     std::string current_line_;
-    long long line_number_ = 0;
+
+    // MMAP backend
+    std::unique_ptr<utils::MappedFile> mapped_file_;
+    const char* cursor_ = nullptr;
+    const char* end_ = nullptr;
+
+    // Tick files are usually long runs of the same symbol; skip the registry lookup for repeats.
+    std::string_view last_symbol_; // Points into the registry, stable for the process lifetime
+    SymbolId last_symbol_id_ = INVALID_SYMBOL_ID;
+    SymbolId resolve_symbol(std::string_view symbol);
 
     // Helper to split CSV line
     std::vector<std::string> split_line(const std::string& line, char delimiter = ',');
+
+    std::unique_ptr<BaseEvent> read_next_event_stream();
+    std::unique_ptr<BaseEvent> read_next_event_mmap();
+    std::string_view next_line(); // MMAP: returns the next line without its terminator, advances cursor_
+    static size_t tokenize(std::string_view line, FieldViews& fields); // Returns number of fields found
+    std::unique_ptr<BaseEvent> parse_fields(const FieldViews& fields, size_t num_fields, std::string_view line);
 };
 
 } // namespace market_replay
-#endif // MARKET_REPLAY_CSV_PARSER_HPP
\ No newline at end of file
+#endif // MARKET_REPLAY_CSV_PARSER_HPP
@@ -2,21 +2,33 @@
 #define MARKET_REPLAY_DISPATCHER_HPP
 
 #include "common.hpp"
+#include "checkpoint.hpp"
 #include "event.hpp"
 #include "strategy.hpp"
 #include "latency_model.hpp"
 #include "metrics.hpp"
-#include "csv_parser.hpp"
+#include "market_data_source.hpp"
+#include "merged_market_data_source.hpp"
 #include "interfaces.hpp" // For IOrderSubmitter
 #include "utils/blocking_queue.hpp"
+#include "utils/spsc_ring_buffer.hpp"
+#include "utils/mpsc_queue.hpp"
+#include "utils/work_stealing_pool.hpp"
+#include "utils/profiler.hpp"
 #include "order_book.hpp" // For simple matching
+#include "pnl_engine.hpp"
+#include "event_heap.hpp"
+#include "timing_wheel_scheduler.hpp"
 
 #include <vector>
 #include <string>
 #include <thread>
 #include <map>
-#include <queue> // For std::priority_queue
+#include <optional>
+#include <deque> // For the streaming market data window
 #include <atomic> // For atomic_bool, atomic OrderId
+#include <mutex>
+#include <condition_variable> // Shard window barrier
 
 namespace market_replay {
 
@@ -27,61 +39,239 @@ using StrategyFactory = std::function<std::unique_ptr<IStrategy>(
     std::shared_ptr<MetricsCollector> metrics_collector
 )>;
 
+// Per-strategy channel settings, chosen when the strategy is registered
+struct StrategyOptions {
+    enum class QueueType : uint8_t {
+        BLOCKING,  // utils::BlockingQueue (mutex + condition variables)
+        SPSC_RING  // utils::SpscRingBuffer; the dispatcher thread is the only producer
+    };
+    QueueType queue_type = QueueType::SPSC_RING;
+    size_t queue_capacity = 10000; // SPSC_RING rounds this up to a power of two
+    utils::WaitPolicy wait_policy = utils::WaitPolicy::PARK; // SPSC_RING only
+    std::vector<std::string> symbols; // Subscribed on the strategy's behalf (see IStrategy::subscribe)
+};
 
 class Dispatcher : public IOrderSubmitter {
 public:
+    // How historical market data is brought into the event loop
+    enum class IngestionMode : uint8_t {
+        PRELOAD,  // Drain the whole file into the MEPQ before the first event is dispatched
+        STREAMING // Pull from the parser through a bounded look-ahead window as the loop advances
+    };
+
+    // Data structure behind the MEPQ
+    enum class SchedulerType : uint8_t {
+        HEAP,        // EventHeap: binary heap, O(log N) push/pop
+        TIMING_WHEEL // TimingWheelScheduler: calendar queue, O(1) for events inside its horizon
+    };
+
+    // Where strategy code runs
+    enum class StrategyExecution : uint8_t {
+        THREADED, // A thread per strategy, fed through the channel chosen in StrategyOptions
+        INLINE,   // On the dispatcher thread, as each event is dispatched; orders are matched before the
+                  // next event. No cross-thread handoff, and results are reproducible bit for bit.
+        POOLED    // As tasks on a work-stealing pool of strategy_pool_threads workers, each strategy keeping
+                  // its own queue. Many strategies share few threads; one strategy never runs on two at once.
+    };
+
+    // When to snapshot the simulation state (see checkpoint.hpp) as the replay goes. A checkpoint due
+    // at time T is taken before the first event at or after T is dispatched, once queued strategies
+    // are idle and the orders they sent are matched; due times with no event between them share one.
+    struct CheckpointConfig {
+        std::vector<Timestamp> at;   // Sim times to checkpoint at
+        Duration interval{0};        // Also every interval of sim time from the first event (or the resume); 0 = off
+        std::string path_prefix;     // Each is written to checkpoint_file_path(path_prefix, T); empty = not written
+        bool keep_in_memory = false; // Each is also kept in checkpoints(), e.g. to fork runs without a file
+        bool enabled() const { return !at.empty() || interval > Duration(0); }
+    };
+
+    struct Config {
+        IngestionMode ingestion_mode = IngestionMode::STREAMING;
+        StrategyExecution strategy_execution = StrategyExecution::THREADED;
+        size_t market_data_window_size = 4096; // Parsed-but-undispatched market events held in STREAMING mode
+        SchedulerType scheduler = SchedulerType::HEAP;
+        TimingWheelScheduler::Config timing_wheel; // Used when scheduler == TIMING_WHEEL
+        SimpleOrderBook::Config order_book;        // Ladder geometry for every symbol's book
+        // Set on the (process-wide) SymbolRegistry when the dispatcher is built, before any data is
+        // read; they override the tick sizes recorded in .mrt/.mrtz files. Data already parsed, such
+        // as a MarketDataBuffer shared by a sweep, keeps the tick sizes it was parsed with.
+        TickSizes tick_sizes;
+        // Above 1, symbols are partitioned (by SymbolId modulo num_shards) across shards that each own
+        // their books and their own scheduler, advanced together in conservative time windows.
+        // A window spans the minimum decision-to-exchange latency past the first event any strategy
+        // sees, and the shards wait for the strategies to catch up after each one. Sharding pays off
+        // when most ticks are for symbols no strategy subscribes to (those are batched into one
+        // window); on data the strategies do see, windows run in lockstep with them every lookahead,
+        // so the speed-up is bounded by how many events fall into one latency's worth of data.
+        size_t num_shards = 1;
+        size_t strategy_pool_threads = 0; // POOLED only; 0 means one per hardware thread
+        PnLEngine::Config pnl;            // Positions are marked to each quote's mid as it is dispatched
+        MergedMarketDataSource::Config merge; // Replaying a directory or several files
+        // Replays only this stretch (and these symbols) of the files the dispatcher opens itself;
+        // books start empty at window.start. See open_market_data_source.
+        ReplayWindow replay_window;
+        // When every strategy subscribes to a set of symbols, read only the union of those sets:
+        // the replay window's symbols are filled in with it (if not given), so the reader skips the
+        // rest through the time index. Orders in other symbols then meet an empty book.
+        bool read_subscribed_symbols_only = false;
+        // Times the hot-path stages of run() (see utils::Profiler; needs ENABLE_PROFILING), logging
+        // a table of them at the end and, with a trace path, writing a Chrome trace. The profiler
+        // is process-wide: one profiled run at a time.
+        utils::Profiler::Config profiling;
+        // Record the wall-clock time from an event being queued for a strategy to its on_event
+        // starting (THREADED and POOLED), per strategy: see delivery_latency(). Costs a clock read
+        // on each side of the queue.
+        bool measure_delivery_latency = false;
+        // Periodic snapshots to resume or fork later runs from (see resume_from). Single-shard mode only.
+        CheckpointConfig checkpoints;
+    };
+
     Dispatcher(std::string historical_data_path,
                LatencyModel::Config latency_config,
                std::shared_ptr<MetricsCollector> metrics_collector);
+    Dispatcher(std::string historical_data_path,
+               LatencyModel::Config latency_config,
+               std::shared_ptr<MetricsCollector> metrics_collector,
+               Config dispatcher_config);
+    // Replays several files (e.g. one per symbol) merged by exchange timestamp. A path given to the
+    // constructors above may also be a directory, for every .csv and .mrt file in it.
+    Dispatcher(std::vector<std::string> historical_data_paths,
+               LatencyModel::Config latency_config,
+               std::shared_ptr<MetricsCollector> metrics_collector,
+               Config dispatcher_config);
+    // Replays an already open source (e.g. a MarketDataBufferSource shared by a parameter sweep)
+    Dispatcher(std::unique_ptr<IMarketDataSource> data_source,
+               LatencyModel::Config latency_config,
+               std::shared_ptr<MetricsCollector> metrics_collector,
+               Config dispatcher_config);
     ~Dispatcher();
 
-    void add_strategy(const StrategyId& id, StrategyFactory factory);
+    void add_strategy(const StrategyId& id, StrategyFactory factory, StrategyOptions options = {});
+    // Makes run() carry on from a checkpoint instead of starting at the beginning of the data. The
+    // data and the strategies (ids, in order) must be those of the run that took it; anything else,
+    // the Config, latencies or strategy parameters, may differ, so what-if runs can be forked from
+    // one mid-session state. Strategies get on_init, then restore_state. Throws std::runtime_error
+    // for data that is not a checkpoint or num_shards > 1; run() throws if the strategies or symbol
+    // ids do not match it.
+    void resume_from(Checkpoint checkpoint);
     void run(); // Starts the simulation
+    // Taken by run() with CheckpointConfig::keep_in_memory, in time order
+    const std::vector<Checkpoint>& checkpoints() const { return checkpoints_; }
+    // <prefix><sim time ns>.mrck
+    static std::string checkpoint_file_path(const std::string& prefix, Timestamp sim_time);
+    // Positions and PnL by strategy and symbol, from the fills and quotes dispatched so far; after
+    // run(), the final ones and the equity curve. Dispatcher thread only while running.
+    const PnLEngine& pnl_engine() const { return pnl_engine_; }
+    // Stage timings of the last profiled run()
+    const utils::Profiler::Summary& profile_summary() const { return profile_summary_; }
+    // With Config::measure_delivery_latency, after run(); null for strategies without a queue
+    const LatencyHistogram* delivery_latency(StrategyIndex index) const {
+        const auto& delivery = strategy_runners_.at(index).delivery;
+        return delivery ? &delivery->histogram : nullptr;
+    }
 
     // --- IOrderSubmitter implementation ---
     void submit_order_request(OrderRequest request) override;
 
+    // Events a strategy thread (or task) takes off its queue at once; the most an on_event_batch call gets
+    static constexpr size_t kStrategyPopBatchSize = 64;
+
 private:
+    static constexpr uint64_t kProfileCounterInterval = 256; // Dispatched events between queue depth samples in a trace
+
     // --- Core Data Structures ---
     std::string historical_data_path_;
+    std::vector<std::string> historical_data_paths_; // If given as a list; merged
+    Config config_;
     LatencyModel latency_model_;
     std::shared_ptr<MetricsCollector> metrics_collector_;
-    std::unique_ptr<CsvParser> csv_parser_;
+    std::unique_ptr<IMarketDataSource> data_source_; // Given, or opened in run() (see open_market_data_source)
 
-    // Main Event Priority Queue (MEPQ) for time-ordered event processing by Dispatcher
-    std::priority_queue<std::unique_ptr<BaseEvent>,
-                        std::vector<std::unique_ptr<BaseEvent>>,
-                        EventComparator> main_event_pq_;
+    // Main Event Priority Queue (MEPQ) for time-ordered event processing by Dispatcher.
+    // Equal timestamps pop in insertion order.
+    std::unique_ptr<IEventScheduler> main_event_pq_;
+
+    // Updated as fills and quotes are handed to strategies, on this thread (the coordinator when sharded)
+    PnLEngine pnl_engine_;
+    utils::Profiler::Summary profile_summary_;
+    std::vector<std::string> queue_depth_counters_; // Trace counter name per strategy, alive through the session
+
+    // STREAMING mode: market data already latency-shifted, in feed order, not yet dispatched.
+    // Only dispatcher-generated events (acks, fills, control) and out-of-order ticks go through the MEPQ.
+    std::deque<std::unique_ptr<BaseEvent>> market_data_window_;
+    size_t market_events_ingested_ = 0;
+    size_t pending_market_events_ = 0; // Ingested but not yet dispatched, in the window or the MEPQ
     
-    // Queue for order requests from strategies to dispatcher
-    utils::BlockingQueue<OrderRequest> incoming_order_requests_;
+    // Queue for order requests from strategies to dispatcher. Lock-free for the strategy threads;
+    // the dispatcher takes everything queued in one exchange per drain.
+    utils::MpscQueue<OrderRequest> incoming_order_requests_;
+    std::vector<OrderRequest> inline_order_requests_; // INLINE: submitted from on_event on the dispatcher thread
+    std::vector<OrderRequest> order_request_batch_; // Reused drain buffer
+
+    // measure_delivery_latency: when each event was queued, matched up with it by queue order
+    struct DeliveryLatency {
+        std::vector<int64_t> queued_ns; // steady_clock; a ring large enough that no push overwrites an unread one
+        uint64_t pushed = 0;            // Dispatcher thread
+        uint64_t popped = 0;            // Strategy thread (or task)
+        LatencyHistogram histogram;     // Strategy thread (or task) until its last event
+    };
 
     // Per-strategy resources
     struct StrategyRunner {
         StrategyId id;
+        StrategyIndex index; // Position in strategy_runners_, carried on orders and acks
         std::unique_ptr<IStrategy> strategy_instance;
-        std::unique_ptr<utils::BlockingQueue<StrategyInputEventVariant>> input_queue;
-        std::thread thread;
+        std::unique_ptr<utils::IQueue<StrategyInputEventVariant>> input_queue; // THREADED and POOLED
+        std::thread thread;                          // THREADED only
+        uint64_t events_delivered = 0;               // Dispatcher thread only
+        std::atomic<uint64_t> events_processed{0};   // Published by the strategy thread after on_event returns
+        // POOLED: events pushed but not yet taken by a task. The push that moves it off 0 submits the
+        // task; the task resubmits itself until it brings it back to 0, so at most one is ever live.
+        std::atomic<uint64_t> mailbox_pending{0};
+        bool finished = false;                          // POOLED, strategy task only: on_shutdown has run
+        std::vector<StrategyInputEventVariant> task_batch; // POOLED, strategy task only
+        std::vector<Timestamp> batch_arrival_ts;           // Strategy side only: per event of the batch being run
+        MetricKey fill_latency_key = MetricsCollector::kNoKey; // "<id>_OrderFillAckLatency", interned once
+        std::unique_ptr<DeliveryLatency> delivery;             // measure_delivery_latency only
 
-        StrategyRunner(StrategyId s_id, 
+        StrategyRunner(StrategyId s_id,
+                       StrategyIndex s_index,
                        std::unique_ptr<IStrategy> inst,
-                       std::unique_ptr<utils::BlockingQueue<StrategyInputEventVariant>> q)
-            : id(std::move(s_id)), strategy_instance(std::move(inst)), input_queue(std::move(q)) {}
+                       std::unique_ptr<utils::IQueue<StrategyInputEventVariant>> q)
+            : id(std::move(s_id)), index(s_index), strategy_instance(std::move(inst)), input_queue(std::move(q)) {}
         
         // Need to define move constructor/assignment for vector of StrategyRunner
         StrategyRunner(StrategyRunner&& other) noexcept
             : id(std::move(other.id)),
+              index(other.index),
               strategy_instance(std::move(other.strategy_instance)),
               input_queue(std::move(other.input_queue)),
-              thread(std::move(other.thread)) {}
+              thread(std::move(other.thread)),
+              events_delivered(other.events_delivered),
+              events_processed(other.events_processed.load()),
+              mailbox_pending(other.mailbox_pending.load()),
+              finished(other.finished),
+              task_batch(std::move(other.task_batch)),
+              batch_arrival_ts(std::move(other.batch_arrival_ts)),
+              fill_latency_key(other.fill_latency_key),
+              delivery(std::move(other.delivery)) {}
 
         StrategyRunner& operator=(StrategyRunner&& other) noexcept {
             if (this != &other) {
                 if(thread.joinable()) thread.join(); // Join existing thread if any
                 id = std::move(other.id);
+                index = other.index;
                 strategy_instance = std::move(other.strategy_instance);
                 input_queue = std::move(other.input_queue);
                 thread = std::move(other.thread);
+                events_delivered = other.events_delivered;
+                events_processed.store(other.events_processed.load());
+                mailbox_pending.store(other.mailbox_pending.load());
+                finished = other.finished;
+                task_batch = std::move(other.task_batch);
+                batch_arrival_ts = std::move(other.batch_arrival_ts);
+                fill_latency_key = other.fill_latency_key;
+                delivery = std::move(other.delivery);
             }
             return *this;
         }
@@ -89,37 +279,139 @@ private:
         StrategyRunner(const StrategyRunner&) = delete;
         StrategyRunner& operator=(const StrategyRunner&) = delete;
     };
-    std::vector<StrategyRunner> strategy_runners_;
-    std::map<StrategyId, StrategyRunner*> strategy_map_; // For quick lookup
+    std::vector<StrategyRunner> strategy_runners_; // Indexed by StrategyIndex
+
+    // Market data fan-out, built in run() from each strategy's subscriptions. A symbol some
+    // strategy subscribed to has its own list (those strategies plus the subscribed-to-all ones,
+    // in index order); every other symbol goes to the subscribed-to-all ones only.
+    std::vector<StrategyIndex> all_symbols_subscribers_;
+    std::vector<std::vector<StrategyIndex>> symbol_subscribers_; // By SymbolId; empty if not subscribed to
+    const std::vector<StrategyIndex>& subscribers_of(SymbolId symbol_id) const {
+        return symbol_id < symbol_subscribers_.size() && !symbol_subscribers_[symbol_id].empty()
+            ? symbol_subscribers_[symbol_id] : all_symbols_subscribers_;
+    }
+
+    // POOLED: the workers strategy tasks run on, created in run()
+    std::unique_ptr<utils::WorkStealingPool> strategy_pool_;
+    std::mutex strategy_pool_mutex_;
+    std::condition_variable strategies_finished_cv_;
+    size_t strategies_finished_ = 0; // Guarded by strategy_pool_mutex_
 
     // Simulation state
     Timestamp current_simulation_time_; // Tracks the effective time of the event being processed by dispatcher
+    bool data_feed_ended_signal_pushed_ = false; // END_OF_DATA_FEED is in the MEPQ or already dispatched
     std::atomic<bool> simulation_running_ = {false};
     std::atomic<OrderId> next_exchange_order_id_ = {1};
 
-    // Simple order books per symbol for matching
-    std::map<std::string, SimpleOrderBook> order_books_;
+    // Matching side of the simulated exchange: the books, and the scheduler their acks and fills go to.
+    struct ExchangeContext {
+        IEventScheduler* scheduler = nullptr;
+        // Order books per symbol for matching, indexed by SymbolId (null until first use).
+        // Passive limit orders rest in them and fill as later quotes and trades reach their level.
+        std::vector<std::unique_ptr<SimpleOrderBook>> order_books;
+        std::vector<SimpleOrderBook::Fill> resting_fill_batch; // Reused per market event
+    };
+    ExchangeContext exchange_; // Single-shard mode, over main_event_pq_
 
-    // Active orders (e.g. passive limit orders) could be stored here if complex matching is needed.
-    // For now, fills are immediate or based on next quote/trade.
+    // --- Sharded mode (Config::num_shards > 1) ---
+    // main_event_pq_ then only holds the market data look-ahead; every shard schedules its own
+    // symbols' market data, acks and fills. A window [start, start + lookahead) is safe to run on all
+    // shards at once when lookahead is the minimum decision-to-exchange latency: nothing a strategy
+    // does in response to an event inside the window can reach any book before the window ends.
+    // Events no strategy can react to don't start that clock, so the window stretches over them.
+    struct Shard {
+        size_t index;
+        std::unique_ptr<IEventScheduler> scheduler;
+        ExchangeContext exchange;
+        std::vector<std::unique_ptr<BaseEvent>> outbox; // Strategy-bound events of the last window, in time order
+        size_t outbox_cursor = 0;                       // Merge position, coordinator only
+        uint64_t window_generation_seen = 0;            // Shard thread only
+        std::thread thread; // Shard 0 runs on the coordinator (the thread in run())
+    };
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::mutex shard_mutex_;
+    std::condition_variable shard_window_cv_;  // Coordinator -> shards: a new window is open
+    std::condition_variable shard_done_cv_;    // Shards -> coordinator: last one finished
+    uint64_t shard_window_generation_ = 0;     // Guarded by shard_mutex_
+    size_t shards_busy_ = 0;                   // Guarded by shard_mutex_
+    bool shards_stopping_ = false;             // Guarded by shard_mutex_
+    Timestamp shard_window_end_;               // Guarded by shard_mutex_
 
     // --- Methods ---
     void dispatcher_thread_loop();
     void strategy_thread_loop(StrategyRunner* runner);
+    // One batch through on_event, then publishes events_processed. True once STRATEGY_SHUTDOWN is
+    // reached; anything after it in the batch is dropped.
+    bool run_strategy_batch(StrategyRunner* runner, std::vector<StrategyInputEventVariant>& batch);
+    // POOLED: drains one batch of the mailbox. Takes the pool, as strategy_pool_ is already null
+    // while its destructor runs the last tasks.
+    void strategy_task(utils::WorkStealingPool* pool, StrategyRunner* runner);
 
+    void build_subscriptions(); // After on_init
+    void start_profiling(); // If config_.profiling asks for it
+    void stop_profiling();  // Once strategy threads are joined; fills profile_summary_
+    void sample_queue_depths(); // Into the trace
+    void run_event_loop(); // Single-shard mode
+    void open_data_source(); // Unless one was given to the constructor
     void load_initial_data();
+    void ingest_market_event(std::unique_ptr<BaseEvent> market_event);
+    void refill_market_data_window();
+    std::unique_ptr<BaseEvent> read_market_event(); // From data_source_, timed as PARSE
+    bool has_pending_events() const;
+    bool market_data_exhausted() const;
+    Timestamp next_event_timestamp() const; // Requires has_pending_events()
+    std::unique_ptr<BaseEvent> pop_next_event();
     void process_event_from_mepq(std::unique_ptr<BaseEvent> event);
-    void handle_market_data_event(BaseEvent* event); // QuoteEvent or TradeEvent
+    void handle_market_data_event(std::unique_ptr<BaseEvent> event); // QuoteEvent or TradeEvent, shared out to its subscribers
     void handle_order_ack_event(OrderAckEvent* event);
     void handle_sim_control_event(SimControlEvent* event);
+    // THREADED: onto the strategy's queue. INLINE: straight into on_event on this thread.
+    // POOLED: onto the queue, scheduling the strategy's task if it was idle.
+    void deliver_to_strategy(StrategyRunner& runner, StrategyInputEventVariant event, Timestamp arrival_ts);
+    void enqueue_for_strategy(StrategyRunner& runner, StrategyInputEventVariant event);
+    bool inline_strategies() const { return config_.strategy_execution == StrategyExecution::INLINE; }
+    bool pooled_strategies() const { return config_.strategy_execution == StrategyExecution::POOLED; }
     
+    bool drain_order_requests(); // Into order_request_batch_, in deterministic order; false if none
+    bool order_requests_queued() const;
     void process_incoming_order_requests(); // Called periodically or triggered
-    void simulate_order_lifecycle(OrderRequest order_req);
+    void simulate_order_lifecycle(ExchangeContext& exchange, OrderRequest order_req, OrderId exchange_order_id);
+    // Book update for a quote or trade, plus acks for the resting orders it filled
+    void apply_market_event_to_book(ExchangeContext& exchange, const BaseEvent& event, Timestamp now);
+    void schedule_resting_fills(ExchangeContext& exchange, SymbolId symbol_id, Timestamp exchange_ts, Timestamp now);
 
     OrderId get_next_exchange_order_id() { return next_exchange_order_id_++; }
-    SimpleOrderBook& get_or_create_order_book(const std::string& symbol);
+    SimpleOrderBook& get_or_create_order_book(ExchangeContext& exchange, SymbolId symbol_id);
+    const StrategyId& strategy_id_for(StrategyIndex index) const;
+
+    // Sharded mode (dispatcher_sharded.cpp)
+    void run_sharded();
+    void refill_shard_lookahead();
+    Shard& shard_for(SymbolId symbol_id) { return *shards_[symbol_id % shards_.size()]; }
+    bool visible_to_strategies(SymbolId symbol_id); // Subscribed to, or orders rest on its book
+    void process_order_requests_on_shards(); // Coordinator, between windows while the shards are idle
+    void run_shard_window(Shard& shard, Timestamp window_end);
+    void shard_thread_loop(Shard* shard);
+    void run_window_on_all_shards(Timestamp window_end);
+    void deliver_shard_outboxes(); // Merged into one time-ordered stream
+    void wait_for_strategies_idle();
+    void stop_shard_threads();
+
+    // Checkpoints (dispatcher_checkpoint.cpp); single-shard mode
+    std::optional<Checkpoint> resume_checkpoint_; // Set by resume_from, applied by run()
+    std::vector<Timestamp> pending_checkpoints_;   // CheckpointConfig::at still ahead, ascending
+    Timestamp next_interval_checkpoint_ = Timestamp::max();
+    Timestamp next_checkpoint_ = Timestamp::max(); // The earlier of the two; all the event loop compares against
+    std::vector<Checkpoint> checkpoints_;          // keep_in_memory only
+    void schedule_checkpoints(); // Start of the event loop, once the first event (or the resumed state) is in
+    void take_due_checkpoint(Timestamp next_event_ts); // Requires next_checkpoint_ <= next_event_ts
+    Checkpoint write_checkpoint(Timestamp sim_time);
+    void restore_checkpoint(); // In run(), after on_init and before any strategy thread starts
 
     void shutdown_strategies();
+    void publish_pnl(); // End of run(): final positions and the equity curve to the metrics collector
+    void release_event_storage(); // End of run(): drop leftover events, report and release the event pool
+    EventPool::Stats event_pool_at_start_; // Taken by run(), so the report covers this run only
 };
 
 } // namespace market_replay
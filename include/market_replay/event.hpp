@@ -2,7 +2,10 @@
 #define MARKET_REPLAY_EVENT_HPP
 
 #include "common.hpp"
+#include "symbol_registry.hpp"
+#include "event_pool.hpp"
 #include <string>
+#include <string_view>
 #include <variant>
 #include <memory>
 
@@ -28,45 +31,104 @@ struct BaseEvent {
         : exchange_timestamp(ex_ts), arrival_timestamp(ex_ts), type(et) {}
     virtual ~BaseEvent() = default;
 
+#if MARKET_REPLAY_EVENT_POOL
+    // All event types recycle their storage through the EventPool (sized delete sees the dynamic type)
+    static void* operator new(std::size_t size) { return EventPool::instance().allocate(size); }
+    static void operator delete(void* p, std::size_t size) noexcept { EventPool::instance().deallocate(p, size); }
+#endif
+
     // For priority queue sorting. This is the time the event should be processed by the recipient.
-    virtual Timestamp get_effective_timestamp() const { return arrival_timestamp; }
+    // Non-virtual: it is read in the scheduler's hot loops and no event type needs a different rule.
+    Timestamp get_effective_timestamp() const { return arrival_timestamp; }
 };
 
-struct EventComparator {
-    bool operator()(const std::unique_ptr<BaseEvent>& a, const std::unique_ptr<BaseEvent>& b) const {
-        if (!a || !b) return b == nullptr; // Handle nullptrs, useful for sentinel
-        return a->get_effective_timestamp() > b->get_effective_timestamp(); // Min-heap
-    }
-};
+// Selects the market data constructors that take prices already in the symbol's ticks
+struct PriceTicksTag {};
+inline constexpr PriceTicksTag in_ticks{};
 
+// Market data prices are stored as doubles by default, or as PriceTicks when built with
+// MARKET_REPLAY_FIXED_POINT_PRICES. The get_*() accessors return either form in both builds: the
+// stored one as-is, the other converted with the symbol's tick size. The order book reads ticks,
+// strategies normally read doubles.
 struct QuoteEvent : public BaseEvent {
-    std::string symbol;
+    SymbolId symbol_id;
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+    PriceTicks bid_ticks;
+    Quantity bid_size;
+    PriceTicks ask_ticks;
+    Quantity ask_size;
+#else
     Price bid_price;
     Quantity bid_size;
     Price ask_price;
     Quantity ask_size;
-
-    QuoteEvent(Timestamp ex_ts, std::string sym, Price bp, Quantity bs, Price ap, Quantity as)
-        : BaseEvent(ex_ts, EventType::QUOTE), symbol(std::move(sym)),
+#endif
+
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+    QuoteEvent(Timestamp ex_ts, SymbolId sym, PriceTicksTag, PriceTicks bp, Quantity bs, PriceTicks ap, Quantity as)
+        : BaseEvent(ex_ts, EventType::QUOTE), symbol_id(sym),
+          bid_ticks(bp), bid_size(bs), ask_ticks(ap), ask_size(as) {}
+    QuoteEvent(Timestamp ex_ts, SymbolId sym, Price bp, Quantity bs, Price ap, Quantity as)
+        : QuoteEvent(ex_ts, sym, in_ticks, to_price_ticks(sym, bp), bs, to_price_ticks(sym, ap), as) {}
+
+    Price get_bid_price() const { return from_price_ticks(symbol_id, bid_ticks); }
+    Price get_ask_price() const { return from_price_ticks(symbol_id, ask_ticks); }
+    PriceTicks get_bid_ticks() const { return bid_ticks; }
+    PriceTicks get_ask_ticks() const { return ask_ticks; }
+#else
+    QuoteEvent(Timestamp ex_ts, SymbolId sym, Price bp, Quantity bs, Price ap, Quantity as)
+        : BaseEvent(ex_ts, EventType::QUOTE), symbol_id(sym),
           bid_price(bp), bid_size(bs), ask_price(ap), ask_size(as) {}
+    QuoteEvent(Timestamp ex_ts, SymbolId sym, PriceTicksTag, PriceTicks bp, Quantity bs, PriceTicks ap, Quantity as)
+        : QuoteEvent(ex_ts, sym, from_price_ticks(sym, bp), bs, from_price_ticks(sym, ap), as) {}
+
+    Price get_bid_price() const { return bid_price; }
+    Price get_ask_price() const { return ask_price; }
+    PriceTicks get_bid_ticks() const { return to_price_ticks(symbol_id, bid_price); }
+    PriceTicks get_ask_ticks() const { return to_price_ticks(symbol_id, ask_price); }
+#endif
+    // Convenience for tests and setup code; interns the name
+    QuoteEvent(Timestamp ex_ts, std::string_view sym, Price bp, Quantity bs, Price ap, Quantity as)
+        : QuoteEvent(ex_ts, intern_symbol(sym), bp, bs, ap, as) {}
 };
 
 struct TradeEvent : public BaseEvent {
-    std::string symbol;
+    SymbolId symbol_id;
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+    PriceTicks price_ticks;
+#else
     Price price;
+#endif
     Quantity size;
     // Could add aggressor side if available in data
 
-    TradeEvent(Timestamp ex_ts, std::string sym, Price p, Quantity s)
-        : BaseEvent(ex_ts, EventType::TRADE), symbol(std::move(sym)), price(p), size(s) {}
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+    TradeEvent(Timestamp ex_ts, SymbolId sym, PriceTicksTag, PriceTicks p, Quantity s)
+        : BaseEvent(ex_ts, EventType::TRADE), symbol_id(sym), price_ticks(p), size(s) {}
+    TradeEvent(Timestamp ex_ts, SymbolId sym, Price p, Quantity s)
+        : TradeEvent(ex_ts, sym, in_ticks, to_price_ticks(sym, p), s) {}
+
+    Price get_price() const { return from_price_ticks(symbol_id, price_ticks); }
+    PriceTicks get_price_ticks() const { return price_ticks; }
+#else
+    TradeEvent(Timestamp ex_ts, SymbolId sym, Price p, Quantity s)
+        : BaseEvent(ex_ts, EventType::TRADE), symbol_id(sym), price(p), size(s) {}
+    TradeEvent(Timestamp ex_ts, SymbolId sym, PriceTicksTag, PriceTicks p, Quantity s)
+        : TradeEvent(ex_ts, sym, from_price_ticks(sym, p), s) {}
+
+    Price get_price() const { return price; }
+    PriceTicks get_price_ticks() const { return to_price_ticks(symbol_id, price); }
+#endif
+    TradeEvent(Timestamp ex_ts, std::string_view sym, Price p, Quantity s)
+        : TradeEvent(ex_ts, intern_symbol(sym), p, s) {}
 };
 
 // This struct is used by strategies to request an order, not an event for the MEPQ directly
 // but for the OrderRequestQueue.
 struct OrderRequest {
-    StrategyId strategy_id;
+    StrategyIndex strategy_index; // Dense index of the submitting strategy within its Dispatcher
     OrderId client_order_id; 
-    std::string symbol;
+    SymbolId symbol_id;
     OrderSide side;
     OrderType type;
     Price price;      // Limit price for LIMIT orders, 0 or NaN for MARKET
@@ -76,21 +138,23 @@ struct OrderRequest {
 };
 
 struct OrderAckEvent : public BaseEvent {
-    StrategyId strategy_id; // To route ack to correct strategy
+    StrategyIndex strategy_index; // To route ack to correct strategy
     OrderId client_order_id;
     OrderId exchange_order_id; // Assigned by simulated exchange
-    std::string symbol;
+    SymbolId symbol_id;
     OrderStatus status;
+    OrderSide side = OrderSide::BUY; // Of the order, as in its OrderRequest
     Price last_filled_price = 0.0;
+    PriceTicks last_filled_price_ticks = 0; // Same price in the symbol's ticks
     Quantity last_filled_quantity = 0;
     Quantity cumulative_filled_quantity = 0;
     Quantity leaves_quantity = 0;
     std::string reject_reason;
 
-    OrderAckEvent(Timestamp effective_ts, StrategyId strat_id, OrderId cl_ord_id, OrderId ex_ord_id, std::string sym, OrderStatus st)
+    OrderAckEvent(Timestamp effective_ts, StrategyIndex strat_idx, OrderId cl_ord_id, OrderId ex_ord_id, SymbolId sym, OrderStatus st)
         : BaseEvent(effective_ts, EventType::ORDER_ACK), // effective_ts is when this ack arrives at strategy
-          strategy_id(std::move(strat_id)), client_order_id(cl_ord_id),
-          exchange_order_id(ex_ord_id), symbol(std::move(sym)), status(st) {
+          strategy_index(strat_idx), client_order_id(cl_ord_id),
+          exchange_order_id(ex_ord_id), symbol_id(sym), status(st) {
         this->arrival_timestamp = effective_ts; // Explicitly set for clarity
     }
 };
@@ -103,7 +167,7 @@ struct SimControlEvent : public BaseEvent {
         STRATEGY_SHUTDOWN // Dispatcher to Strategy
     };
     ControlType control_type;
-    StrategyId target_strategy_id; // Optional: if event is for a specific strategy
+    StrategyIndex target_strategy_index = INVALID_STRATEGY_INDEX; // Optional: if event is for a specific strategy
 
     SimControlEvent(Timestamp effective_ts, ControlType ct, EventType evt_type = EventType::SIM_CONTROL_DISPATCHER) 
         : BaseEvent(effective_ts, evt_type), control_type(ct) {
@@ -112,10 +176,43 @@ struct SimControlEvent : public BaseEvent {
 };
 
 
+// Market data is immutable once dispatched and fanned out to every strategy as one shared
+// allocation, so adding strategies costs queue slots rather than per-tick copies.
+template <typename T>
+using SharedEvent = std::shared_ptr<const T>;
+
+#if MARKET_REPLAY_EVENT_POOL
+// Gives a SharedEvent's reference count a pooled slot of its own instead of a global-heap block
+template <typename T>
+struct EventPoolAllocator {
+    using value_type = T;
+    EventPoolAllocator() = default;
+    template <typename U>
+    EventPoolAllocator(const EventPoolAllocator<U>&) noexcept {}
+    T* allocate(std::size_t n) { return static_cast<T*>(EventPool::instance().allocate(n * sizeof(T))); }
+    void deallocate(T* p, std::size_t n) noexcept { EventPool::instance().deallocate(p, n * sizeof(T)); }
+    template <typename U>
+    bool operator==(const EventPoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const EventPoolAllocator<U>&) const noexcept { return false; }
+};
+#endif
+
+// Takes over a market event (of dynamic type T) for fan-out
+template <typename T>
+SharedEvent<T> share_event(std::unique_ptr<BaseEvent> event) {
+    T* raw = static_cast<T*>(event.release());
+#if MARKET_REPLAY_EVENT_POOL
+    return SharedEvent<T>(raw, std::default_delete<T>(), EventPoolAllocator<T>());
+#else
+    return SharedEvent<T>(raw);
+#endif
+}
+
 // For Strategy input queues
 using StrategyInputEventVariant = std::variant<
-    std::unique_ptr<QuoteEvent>,
-    std::unique_ptr<TradeEvent>,
+    SharedEvent<QuoteEvent>,
+    SharedEvent<TradeEvent>,
     std::unique_ptr<OrderAckEvent>,
     std::unique_ptr<SimControlEvent> // For shutdown signal
 >;
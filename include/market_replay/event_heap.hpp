@@ -0,0 +1,60 @@
+#ifndef MARKET_REPLAY_EVENT_HEAP_HPP
+#define MARKET_REPLAY_EVENT_HEAP_HPP
+
+#include "event.hpp"
+#include "event_scheduler.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace market_replay {
+
+// Min-heap of owned events keyed by (effective timestamp, insertion sequence). The key is copied
+// into the heap entry at push time, so sifting compares contiguous 24-byte entries and never
+// dereferences an event. Events with equal timestamps pop in the order they were pushed, which
+// makes replays reproducible regardless of how the heap happens to be laid out.
+class EventHeap final : public IEventScheduler {
+public:
+    struct Entry {
+        Timestamp timestamp;
+        uint64_t sequence;
+        std::unique_ptr<BaseEvent> event;
+    };
+
+    void push(std::unique_ptr<BaseEvent> event) override {
+        const Timestamp ts = event->get_effective_timestamp();
+        heap_.push_back(Entry{ts, next_sequence_++, std::move(event)});
+        std::push_heap(heap_.begin(), heap_.end(), Later{});
+    }
+
+    // Requires !empty()
+    std::unique_ptr<BaseEvent> pop() override {
+        std::pop_heap(heap_.begin(), heap_.end(), Later{});
+        std::unique_ptr<BaseEvent> event = std::move(heap_.back().event);
+        heap_.pop_back();
+        return event;
+    }
+
+    Timestamp top_timestamp() const override { return heap_.front().timestamp; } // Requires !empty()
+    const BaseEvent& top() const { return *heap_.front().event; }     // Requires !empty()
+
+    bool empty() const override { return heap_.empty(); }
+    size_t size() const override { return heap_.size(); }
+    void reserve(size_t n) { heap_.reserve(n); }
+    void clear() override { heap_.clear(); } // Sequence numbers keep increasing
+
+private:
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.timestamp != b.timestamp) return a.timestamp > b.timestamp;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    std::vector<Entry> heap_;
+    uint64_t next_sequence_ = 0;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_EVENT_HEAP_HPP
@@ -0,0 +1,98 @@
+#ifndef MARKET_REPLAY_EVENT_POOL_HPP
+#define MARKET_REPLAY_EVENT_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace market_replay {
+
+// Size-class pool behind BaseEvent::operator new/delete, so every `std::make_unique<QuoteEvent>`
+// (CsvParser, TickFileReader, simulate_order_lifecycle, handle_sim_control_event, ...) reuses a
+// recycled slot instead of going to malloc.
+//
+// Each thread allocates from and frees into a cache of its own, so the hot path takes no lock and
+// writes no shared cache line. A cache keeps up to kMaxCachedSlots free slots per class; past that,
+// frees go back in batches to a lock-free per-class return stack, which a thread whose cache runs
+// dry takes in one exchange (e.g. decode workers reusing what the dispatcher thread freed). Fresh
+// slots are carved from 64 KiB chunks, one chunk per class per thread at a time; only getting a
+// chunk takes a lock. Objects larger than the biggest class fall through to ::operator new.
+class EventPool {
+public:
+    static constexpr size_t kSlotAlign = 64;
+    static constexpr size_t kNumClasses = 4; // 64, 128, 192, 256 bytes
+    static constexpr size_t kMaxPooledSize = kSlotAlign * kNumClasses;
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kMaxCachedSlots = 1024; // Per thread and class
+
+    struct Stats {
+        uint64_t allocations = 0;          // Served by the pool (excludes fallbacks)
+        uint64_t reused = 0;               // Allocations satisfied by a recycled slot (malloc calls avoided)
+        uint64_t bytes_reused = 0;         // Slot bytes handed out again
+        uint64_t fallback_allocations = 0; // Too large for any class
+        uint64_t chunks_allocated = 0;
+        uint64_t bytes_reserved = 0;       // Currently held in chunks
+        uint64_t live = 0;                 // Pooled objects not yet freed
+
+        // The counters accumulated since `start` (e.g. over one run); bytes_reserved and live as now
+        Stats since(const Stats& start) const;
+    };
+
+    static EventPool& instance(); // Never destroyed, so events freed during static destruction stay valid
+
+    void* allocate(size_t size);
+    void deallocate(void* p, size_t size) noexcept;
+
+    // Returns every chunk to the system if no pooled object is alive. Called at the end of
+    // Dispatcher::run(); returns false (and keeps the chunks) if events are still outstanding.
+    // Thread caches notice on their next use and start over.
+    bool release_if_idle();
+
+    // Process-wide, every thread's counters included; Stats::since gives one run's share
+    Stats stats() const;
+
+private:
+    EventPool() = default;
+    EventPool(const EventPool&) = delete;
+    EventPool& operator=(const EventPool&) = delete;
+
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    struct ThreadCache; // event_pool.cpp
+
+    struct alignas(64) SizeClass {
+        std::atomic<FreeSlot*> returned{nullptr}; // Overflow from thread caches, and exited threads' slots
+    };
+
+    // live_ doubles as the guard that keeps chunks from being released under a thread that is using
+    // them: allocations (and cache flushes) count themselves in before touching the pool
+    static constexpr uint64_t kReleasing = uint64_t{1} << 63;
+
+    static size_t class_index(size_t size) { return (size - 1) / kSlotAlign; }
+    static size_t slot_size(size_t idx) { return (idx + 1) * kSlotAlign; }
+
+    ThreadCache* thread_cache(); // nullptr once this thread's cache is gone (thread exit)
+    void enter();                // live_ + 1, waiting out a release in progress
+    char* new_chunk(size_t bytes);
+    void return_slots(size_t idx, FreeSlot* head, FreeSlot* tail) noexcept;
+    void* allocate_uncached(size_t idx);
+
+    std::array<SizeClass, kNumClasses> classes_;
+    std::atomic<uint64_t> live_{0};
+    std::atomic<uint64_t> generation_{0}; // Bumped by each release; caches of an older one are dropped
+    mutable std::mutex mutex_;            // Chunks, the cache registry and retired counters
+    std::vector<char*> chunks_;
+    uint64_t bytes_reserved_ = 0;
+    std::vector<const ThreadCache*> caches_;
+    std::array<uint64_t, kNumClasses> retired_allocations_{};
+    std::array<uint64_t, kNumClasses> retired_reused_{};
+    std::atomic<uint64_t> fallback_allocations_{0};
+    std::atomic<uint64_t> chunks_allocated_{0};
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_EVENT_POOL_HPP
@@ -0,0 +1,26 @@
+#ifndef MARKET_REPLAY_EVENT_SCHEDULER_HPP
+#define MARKET_REPLAY_EVENT_SCHEDULER_HPP
+
+#include "event.hpp"
+#include <memory>
+
+namespace market_replay {
+
+// Time-ordered store for the events the dispatcher schedules for itself (acks, fills, control
+// events, out-of-order or preloaded market data). Implementations must pop in (effective
+// timestamp, push order) order, so equal-timestamp events come out first-in first-out.
+class IEventScheduler {
+public:
+    virtual ~IEventScheduler() = default;
+
+    virtual void push(std::unique_ptr<BaseEvent> event) = 0;
+    virtual std::unique_ptr<BaseEvent> pop() = 0;     // Requires !empty()
+    virtual Timestamp top_timestamp() const = 0;      // Requires !empty()
+
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+    virtual void clear() = 0;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_EVENT_SCHEDULER_HPP
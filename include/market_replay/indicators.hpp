@@ -0,0 +1,536 @@
+#ifndef MARKET_REPLAY_INDICATORS_HPP
+#define MARKET_REPLAY_INDICATORS_HPP
+
+#include "checkpoint.hpp" // For strategies' save_state / restore_state
+#include "common.hpp"
+#include <algorithm> // For std::copy, std::fill
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace market_replay {
+namespace indicators {
+
+// Streaming signal building blocks for strategies. Every update is O(1): windowed indicators keep
+// running sums over a ring of the last `window` inputs instead of rescanning it. The *Basket types
+// hold one indicator for many symbols as structure-of-arrays state and update every lane with one
+// call, which the kernels below run four doubles at a time with AVX2 or two with NEON (both only
+// when the compiler targets them, e.g. ENABLE_NATIVE_ARCH), and as plain loops otherwise.
+//
+// Windowed variances are computed on inputs shifted by a reference value, re-centred on the
+// current mean each time the window wraps, so long runs of prices far from zero do not lose the
+// variance to cancellation or accumulate drift.
+
+// NaN if either side is missing
+inline double mid_price(Price bid, Price ask) { return (bid + ask) / 2.0; }
+// The mid weighted towards the side with less size, i.e. the side more likely to be taken out
+inline double microprice(Price bid, Quantity bid_size, Price ask, Quantity ask_size) {
+    const double total = static_cast<double>(bid_size) + static_cast<double>(ask_size);
+    if (total <= 0.0) return mid_price(bid, ask);
+    return (bid * static_cast<double>(ask_size) + ask * static_cast<double>(bid_size)) / total;
+}
+
+// The last `capacity` values pushed, oldest first
+template <typename T>
+class RingWindow {
+public:
+    explicit RingWindow(size_t capacity) : values_(capacity) {
+        if (capacity == 0) throw std::invalid_argument("RingWindow: capacity must be positive");
+    }
+
+    // Returns the value that fell out of the window, or T{} while it was not yet full
+    T push(T value) {
+        T evicted{};
+        if (size_ == values_.size()) {
+            evicted = std::move(values_[head_]);
+        } else {
+            size_++;
+        }
+        values_[head_] = std::move(value);
+        if (++head_ == values_.size()) head_ = 0;
+        return evicted;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return values_.size(); }
+    bool full() const { return size_ == values_.size(); }
+    // 0 is the oldest value still held
+    const T& operator[](size_t i) const {
+        const size_t start = full() ? head_ : 0;
+        const size_t at = start + i;
+        return values_[at < values_.size() ? at : at - values_.size()];
+    }
+    const T& newest() const { return (*this)[size_ - 1]; }
+    // Where the next push goes; 0 again each time the window has been filled round once
+    size_t head() const { return head_; }
+    void clear() {
+        size_ = 0;
+        head_ = 0;
+    }
+
+    // Slots as stored rather than oldest first, so a restored window wraps where this one would.
+    // Arithmetic T only; restoring into a window of another capacity throws std::runtime_error.
+    void save_state(CheckpointWriter& out) const {
+        static_assert(std::is_arithmetic_v<T>, "RingWindow checkpoints hold numbers");
+        out.write_varint(values_.size());
+        out.write_varint(head_);
+        out.write_varint(size_);
+        for (size_t i = 0; i < size_; ++i) {
+            if constexpr (std::is_floating_point_v<T>) {
+                out.write_f64(static_cast<double>(values_[i]));
+            } else {
+                out.write_svarint(static_cast<int64_t>(values_[i]));
+            }
+        }
+    }
+    void restore_state(CheckpointReader& in) {
+        static_assert(std::is_arithmetic_v<T>, "RingWindow checkpoints hold numbers");
+        const uint64_t capacity = in.read_varint();
+        const uint64_t head = in.read_varint();
+        const uint64_t size = in.read_varint();
+        if (capacity != values_.size() || size > capacity || head >= capacity || (size < capacity && head != size)) {
+            throw std::runtime_error("RingWindow: checkpoint of a window of " + std::to_string(capacity) +
+                                     " does not fit one of " + std::to_string(values_.size()));
+        }
+        head_ = static_cast<size_t>(head);
+        size_ = static_cast<size_t>(size);
+        for (size_t i = 0; i < size_; ++i) {
+            if constexpr (std::is_floating_point_v<T>) {
+                values_[i] = static_cast<T>(in.read_f64());
+            } else {
+                values_[i] = static_cast<T>(in.read_svarint());
+            }
+        }
+    }
+
+private:
+    std::vector<T> values_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+class RollingMean {
+public:
+    explicit RollingMean(size_t window) : window_(window) {}
+
+    void update(double x) {
+        const bool was_full = window_.full();
+        const double evicted = window_.push(x);
+        sum_ += was_full ? x - evicted : x;
+        if (window_.head() == 0) { // Drop the rounding a full round of adds and subtracts has left
+            sum_ = 0.0;
+            for (size_t i = 0; i < window_.size(); ++i) sum_ += window_[i];
+        }
+    }
+    double value() const { return window_.size() ? sum_ / static_cast<double>(window_.size()) : 0.0; }
+    size_t count() const { return window_.size(); }
+    bool ready() const { return window_.full(); }
+    void reset() {
+        window_.clear();
+        sum_ = 0.0;
+    }
+
+private:
+    RingWindow<double> window_;
+    double sum_ = 0.0;
+};
+
+// Mean, population variance and z-score over the last `window` inputs
+class RollingVariance {
+public:
+    explicit RollingVariance(size_t window) : window_(window) {}
+
+    void update(double x) {
+        if (window_.size() == 0) shift_ = x;
+        const bool was_full = window_.full();
+        const double evicted = window_.push(x);
+        const double d = x - shift_;
+        sum_ += d;
+        sum_sq_ += d * d;
+        if (was_full) {
+            const double e = evicted - shift_;
+            sum_ -= e;
+            sum_sq_ -= e * e;
+        }
+        if (window_.head() == 0) recenter();
+    }
+
+    double mean() const { return window_.size() ? shift_ + sum_ / static_cast<double>(window_.size()) : 0.0; }
+    double variance() const {
+        if (window_.size() == 0) return 0.0;
+        const double n = static_cast<double>(window_.size());
+        const double variance = (sum_sq_ - sum_ * sum_ / n) / n;
+        return variance > 0.0 ? variance : 0.0;
+    }
+    double stddev() const { return std::sqrt(variance()); }
+    // Deviations of `x` from the mean; 0 while the window is flat
+    double zscore(double x) const {
+        const double sd = stddev();
+        return sd > 0.0 ? (x - mean()) / sd : 0.0;
+    }
+    size_t count() const { return window_.size(); }
+    bool ready() const { return window_.full(); }
+    void reset() {
+        window_.clear();
+        sum_ = sum_sq_ = shift_ = 0.0;
+    }
+
+    // The running sums go with the window, so a restored instance continues bit for bit
+    void save_state(CheckpointWriter& out) const {
+        window_.save_state(out);
+        out.write_f64(shift_);
+        out.write_f64(sum_);
+        out.write_f64(sum_sq_);
+    }
+    void restore_state(CheckpointReader& in) {
+        window_.restore_state(in);
+        shift_ = in.read_f64();
+        sum_ = in.read_f64();
+        sum_sq_ = in.read_f64();
+    }
+
+private:
+    void recenter() {
+        shift_ = mean();
+        sum_ = sum_sq_ = 0.0;
+        for (size_t i = 0; i < window_.size(); ++i) {
+            const double d = window_[i] - shift_;
+            sum_ += d;
+            sum_sq_ += d * d;
+        }
+    }
+
+    RingWindow<double> window_;
+    double shift_ = 0.0; // Inputs are accumulated as x - shift_
+    double sum_ = 0.0;
+    double sum_sq_ = 0.0;
+};
+
+// Exponentially weighted moving average, seeded with the first input
+class Ewma {
+public:
+    explicit Ewma(double alpha) : alpha_(alpha) {
+        if (!(alpha > 0.0 && alpha <= 1.0)) throw std::invalid_argument("Ewma: alpha must be in (0, 1]");
+    }
+    // The alpha whose center of mass matches a simple average over `span` inputs
+    static double alpha_for_span(double span) { return 2.0 / (span + 1.0); }
+    // The alpha that halves an input's weight every `half_life` inputs
+    static double alpha_for_half_life(double half_life) { return 1.0 - std::exp(std::log(0.5) / half_life); }
+
+    void update(double x) {
+        value_ = count_++ ? value_ + alpha_ * (x - value_) : x;
+    }
+    double value() const { return value_; }
+    double alpha() const { return alpha_; }
+    size_t count() const { return count_; }
+    void reset() {
+        value_ = 0.0;
+        count_ = 0;
+    }
+
+private:
+    double alpha_;
+    double value_ = 0.0;
+    size_t count_ = 0;
+};
+
+// Volume-weighted average price of every trade since the last reset()
+class Vwap {
+public:
+    void update(Price price, Quantity size) {
+        notional_ += price * static_cast<double>(size);
+        volume_ += static_cast<double>(size);
+    }
+    double value() const { return volume_ > 0.0 ? notional_ / volume_ : INVALID_PRICE; }
+    double volume() const { return volume_; }
+    void reset() { notional_ = volume_ = 0.0; }
+
+private:
+    double notional_ = 0.0;
+    double volume_ = 0.0;
+};
+
+// VWAP of the last `window` trades
+class RollingVwap {
+public:
+    explicit RollingVwap(size_t window) : window_(window) {}
+
+    void update(Price price, Quantity size) {
+        const Fill fill{price * static_cast<double>(size), static_cast<double>(size)};
+        const bool was_full = window_.full();
+        const Fill evicted = window_.push(fill);
+        notional_ += fill.notional;
+        volume_ += fill.volume;
+        if (was_full) {
+            notional_ -= evicted.notional;
+            volume_ -= evicted.volume;
+        }
+        if (window_.head() == 0) {
+            notional_ = volume_ = 0.0;
+            for (size_t i = 0; i < window_.size(); ++i) {
+                notional_ += window_[i].notional;
+                volume_ += window_[i].volume;
+            }
+        }
+    }
+    double value() const { return volume_ > 0.0 ? notional_ / volume_ : INVALID_PRICE; }
+    double volume() const { return volume_; }
+    bool ready() const { return window_.full(); }
+
+private:
+    struct Fill {
+        double notional = 0.0;
+        double volume = 0.0;
+    };
+    RingWindow<Fill> window_;
+    double notional_ = 0.0;
+    double volume_ = 0.0;
+};
+
+// One indicator per symbol, made from a prototype the first time a symbol is seen. Dense by SymbolId.
+template <typename Indicator>
+class PerSymbol {
+public:
+    explicit PerSymbol(Indicator prototype) : prototype_(std::move(prototype)) {}
+
+    Indicator& operator[](SymbolId symbol_id) {
+        if (symbol_id >= indicators_.size()) indicators_.resize(static_cast<size_t>(symbol_id) + 1, prototype_);
+        return indicators_[symbol_id];
+    }
+    // Null for a symbol never seen
+    const Indicator* find(SymbolId symbol_id) const {
+        return symbol_id < indicators_.size() ? &indicators_[symbol_id] : nullptr;
+    }
+    size_t size() const { return indicators_.size(); } // Ids below it are all found
+
+private:
+    Indicator prototype_;
+    std::vector<Indicator> indicators_;
+};
+
+namespace kernels {
+
+// state[i] += alpha * (x[i] - state[i])
+inline void ewma_update(double* state, const double* x, double alpha, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d a = _mm256_set1_pd(alpha);
+    for (; i + 4 <= n; i += 4) {
+        const __m256d s = _mm256_loadu_pd(state + i);
+        const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), s);
+        _mm256_storeu_pd(state + i, _mm256_add_pd(s, _mm256_mul_pd(a, d)));
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    const float64x2_t a = vdupq_n_f64(alpha);
+    for (; i + 2 <= n; i += 2) {
+        const float64x2_t s = vld1q_f64(state + i);
+        vst1q_f64(state + i, vfmaq_f64(s, a, vsubq_f64(vld1q_f64(x + i), s)));
+    }
+#endif
+    for (; i < n; ++i) state[i] += alpha * (x[i] - state[i]);
+}
+
+// Adds x - shift to sum and its square to sum_sq; subtracts old - shift likewise, if old is given
+inline void moments_update(double* sum, double* sum_sq, const double* x, const double* old, const double* shift, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        const __m256d k = _mm256_loadu_pd(shift + i);
+        const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), k);
+        __m256d s = _mm256_add_pd(_mm256_loadu_pd(sum + i), d);
+        __m256d q = _mm256_add_pd(_mm256_loadu_pd(sum_sq + i), _mm256_mul_pd(d, d));
+        if (old) {
+            const __m256d e = _mm256_sub_pd(_mm256_loadu_pd(old + i), k);
+            s = _mm256_sub_pd(s, e);
+            q = _mm256_sub_pd(q, _mm256_mul_pd(e, e));
+        }
+        _mm256_storeu_pd(sum + i, s);
+        _mm256_storeu_pd(sum_sq + i, q);
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    for (; i + 2 <= n; i += 2) {
+        const float64x2_t k = vld1q_f64(shift + i);
+        const float64x2_t d = vsubq_f64(vld1q_f64(x + i), k);
+        float64x2_t s = vaddq_f64(vld1q_f64(sum + i), d);
+        float64x2_t q = vfmaq_f64(vld1q_f64(sum_sq + i), d, d);
+        if (old) {
+            const float64x2_t e = vsubq_f64(vld1q_f64(old + i), k);
+            s = vsubq_f64(s, e);
+            q = vfmsq_f64(q, e, e);
+        }
+        vst1q_f64(sum + i, s);
+        vst1q_f64(sum_sq + i, q);
+    }
+#endif
+    for (; i < n; ++i) {
+        const double d = x[i] - shift[i];
+        sum[i] += d;
+        sum_sq[i] += d * d;
+        if (old) {
+            const double e = old[i] - shift[i];
+            sum[i] -= e;
+            sum_sq[i] -= e * e;
+        }
+    }
+}
+
+// out[i] = (x[i] - mean) / stddev over `count` inputs accumulated as above; 0 where the variance is not positive
+inline void zscores(double* out, const double* x, const double* sum, const double* sum_sq, const double* shift,
+                    double count, size_t n) {
+    const double inv_n = 1.0 / count;
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d vn = _mm256_set1_pd(inv_n);
+    const __m256d zero = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        const __m256d mean_d = _mm256_mul_pd(_mm256_loadu_pd(sum + i), vn);
+        const __m256d var = _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(sum_sq + i), vn), _mm256_mul_pd(mean_d, mean_d));
+        const __m256d positive = _mm256_cmp_pd(var, zero, _CMP_GT_OQ);
+        const __m256d dev = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(shift + i)), mean_d);
+        const __m256d z = _mm256_div_pd(dev, _mm256_sqrt_pd(_mm256_max_pd(var, zero)));
+        _mm256_storeu_pd(out + i, _mm256_and_pd(z, positive));
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    const float64x2_t vn = vdupq_n_f64(inv_n);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    for (; i + 2 <= n; i += 2) {
+        const float64x2_t mean_d = vmulq_f64(vld1q_f64(sum + i), vn);
+        const float64x2_t var = vsubq_f64(vmulq_f64(vld1q_f64(sum_sq + i), vn), vmulq_f64(mean_d, mean_d));
+        const uint64x2_t positive = vcgtq_f64(var, zero);
+        const float64x2_t dev = vsubq_f64(vsubq_f64(vld1q_f64(x + i), vld1q_f64(shift + i)), mean_d);
+        const float64x2_t z = vdivq_f64(dev, vsqrtq_f64(vmaxq_f64(var, zero)));
+        vst1q_f64(out + i, vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(z), positive)));
+    }
+#endif
+    for (; i < n; ++i) {
+        const double mean_d = sum[i] * inv_n;
+        const double var = sum_sq[i] * inv_n - mean_d * mean_d;
+        out[i] = var > 0.0 ? (x[i] - shift[i] - mean_d) / std::sqrt(var) : 0.0;
+    }
+}
+
+} // namespace kernels
+
+// Ewma for `size` symbols sampled together, e.g. a basket's mids on a clock. Lane i is symbol i of
+// whatever order the caller keeps; every update() takes one input per lane.
+class EwmaBasket {
+public:
+    EwmaBasket(size_t size, double alpha) : alpha_(alpha), values_(size) {
+        if (!(alpha > 0.0 && alpha <= 1.0)) throw std::invalid_argument("EwmaBasket: alpha must be in (0, 1]");
+    }
+
+    void update(const double* x) {
+        if (count_++ == 0) {
+            values_.assign(x, x + values_.size());
+        } else {
+            kernels::ewma_update(values_.data(), x, alpha_, values_.size());
+        }
+    }
+    void update(const std::vector<double>& x) { update(checked(x)); }
+
+    size_t size() const { return values_.size(); }
+    size_t count() const { return count_; }
+    double value(size_t lane) const { return values_[lane]; }
+    const std::vector<double>& values() const { return values_; }
+
+private:
+    const double* checked(const std::vector<double>& x) const {
+        if (x.size() != values_.size()) throw std::invalid_argument("EwmaBasket: one input per lane expected");
+        return x.data();
+    }
+
+    double alpha_;
+    std::vector<double> values_;
+    size_t count_ = 0;
+};
+
+// RollingVariance for `size` symbols sampled together: mean, variance and z-score of each lane's
+// last `window` inputs. The window history is kept one sample (all lanes) per row.
+class RollingZScoreBasket {
+public:
+    RollingZScoreBasket(size_t size, size_t window)
+        : size_(size), window_(window), history_(size * window), shift_(size), sum_(size), sum_sq_(size), last_(size) {
+        if (window == 0) throw std::invalid_argument("RollingZScoreBasket: window must be positive");
+    }
+
+    void update(const double* x) {
+        if (count_ == 0) shift_.assign(x, x + size_);
+        double* row = &history_[head_ * size_];
+        const bool was_full = count_ == window_;
+        if (was_full) {
+            kernels::moments_update(sum_.data(), sum_sq_.data(), x, row, shift_.data(), size_);
+        } else {
+            kernels::moments_update(sum_.data(), sum_sq_.data(), x, nullptr, shift_.data(), size_);
+            count_++;
+        }
+        std::copy(x, x + size_, row);
+        std::copy(x, x + size_, last_.begin());
+        if (++head_ == window_) {
+            head_ = 0;
+            recenter();
+        }
+    }
+    void update(const std::vector<double>& x) {
+        if (x.size() != size_) throw std::invalid_argument("RollingZScoreBasket: one input per lane expected");
+        update(x.data());
+    }
+
+    // The z-score of each lane's latest input into `out` (size() of them)
+    void zscores(double* out) const {
+        if (count_ == 0) {
+            std::fill(out, out + size_, 0.0);
+            return;
+        }
+        kernels::zscores(out, last_.data(), sum_.data(), sum_sq_.data(), shift_.data(), static_cast<double>(count_), size_);
+    }
+    std::vector<double> zscores() const {
+        std::vector<double> out(size_);
+        zscores(out.data());
+        return out;
+    }
+    double mean(size_t lane) const { return count_ ? shift_[lane] + sum_[lane] / static_cast<double>(count_) : 0.0; }
+    double variance(size_t lane) const {
+        if (count_ == 0) return 0.0;
+        const double n = static_cast<double>(count_);
+        const double variance = (sum_sq_[lane] - sum_[lane] * sum_[lane] / n) / n;
+        return variance > 0.0 ? variance : 0.0;
+    }
+
+    size_t size() const { return size_; }
+    size_t count() const { return count_; }
+    bool ready() const { return count_ == window_; }
+
+private:
+    void recenter() {
+        for (size_t lane = 0; lane < size_; ++lane) shift_[lane] = mean(lane);
+        std::fill(sum_.begin(), sum_.end(), 0.0);
+        std::fill(sum_sq_.begin(), sum_sq_.end(), 0.0);
+        for (size_t row = 0; row < count_; ++row) {
+            kernels::moments_update(sum_.data(), sum_sq_.data(), &history_[row * size_], nullptr, shift_.data(), size_);
+        }
+    }
+
+    size_t size_;
+    size_t window_;
+    std::vector<double> history_; // window_ rows of size_ lanes
+    std::vector<double> shift_;   // Per lane, as in RollingVariance
+    std::vector<double> sum_;
+    std::vector<double> sum_sq_;
+    std::vector<double> last_;
+    size_t head_ = 0;  // Row the next sample goes to
+    size_t count_ = 0; // Rows filled, up to window_
+};
+
+} // namespace indicators
+} // namespace market_replay
+
+#endif // MARKET_REPLAY_INDICATORS_HPP
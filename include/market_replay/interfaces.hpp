@@ -16,5 +16,21 @@ public:
     // For queueing, by value (move semantics) is often good.
 };
 
+// Interface for anything that yields historical market data (QuoteEvent/TradeEvent) in file order
+class IMarketDataSource {
+public:
+    virtual ~IMarketDataSource() = default;
+    // Returns nullptr at EOF or for a record that couldn't be decoded (callers keep going while has_more_events())
+    virtual std::unique_ptr<BaseEvent> read_next_event() = 0;
+    virtual bool has_more_events() const = 0;
+
+    // Optional random access, used to replay a time window from a TimeIndex. position() is an
+    // opaque, source-specific offset of the next event (a byte offset, a record number) that
+    // seek() returns to; it only has to be meaningful to the same file.
+    virtual bool seekable() const { return false; }
+    virtual uint64_t position() const { return 0; }
+    virtual void seek(uint64_t /*position*/) {}
+};
+
 } // namespace market_replay
 #endif // MARKET_REPLAY_INTERFACES_HPP
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef MARKET_REPLAY_LATENCY_DISTRIBUTION_HPP
+#define MARKET_REPLAY_LATENCY_DISTRIBUTION_HPP
+
+#include "common.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace market_replay {
+
+// Stateless generator: a 64-bit draw is a pure function of (seed, stream, key), so the same order or
+// tick gets the same latency however threads, shards or pooled tasks interleave. SplitMix64's mixer,
+// a few multiplies per draw.
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+inline uint64_t keyed_draw(uint64_t seed, uint64_t stream, uint64_t key) {
+    return mix64(seed ^ mix64(key * 0xD1B54A32D192ED03ULL + stream));
+}
+
+// Sampling table for one latency leg, built once up front so that a sample is a table lookup:
+//   - constant: no table at all, the common case;
+//   - lognormal: inverse-CDF table at kTableSize evenly spaced quantiles, linearly interpolated;
+//   - empirical: Walker alias table over histogram buckets, uniform within the chosen bucket.
+// sample() maps a uniform 64-bit word to a duration; every sample lies within [min(), max()].
+class LatencyDistribution {
+public:
+    static constexpr size_t kTableSize = 4096; // Quantile intervals of the inverse-CDF table
+
+    // One histogram bucket of measured latencies, [lower, upper)
+    struct Bucket {
+        Duration lower;
+        Duration upper;
+        double weight; // Sample count or any non-negative weight
+    };
+
+    LatencyDistribution() = default; // Constant zero
+    static LatencyDistribution constant(Duration value);
+    // floor + X with X lognormal of the given median and shape sigma (the stddev of ln X).
+    // The table spans the 1/(2 kTableSize) .. 1 - 1/(2 kTableSize) quantiles, which bounds the tails.
+    static LatencyDistribution lognormal(Duration median, double sigma, Duration floor = Duration(0));
+    static LatencyDistribution empirical(const std::vector<Bucket>& buckets);
+    // Histogram CSV: "lower_ns,upper_ns,count" per line; a header line and '#' comments are skipped.
+    // Throws std::runtime_error if the file cannot be read or holds no usable bucket.
+    static LatencyDistribution load_histogram(const std::string& path);
+
+    bool is_constant() const { return kind_ == Kind::CONSTANT; }
+    Duration min() const { return Duration(min_ns_); }
+    Duration max() const { return Duration(max_ns_); }
+
+    Duration sample(uint64_t u) const {
+        if (kind_ == Kind::CONSTANT) return Duration(min_ns_);
+        return Duration(kind_ == Kind::QUANTILES ? sample_quantiles(u) : sample_alias(u));
+    }
+    // Samples for keys first_key .. first_key + count - 1 of one stream, same values as keyed_draw + sample
+    void sample_batch(uint64_t seed, uint64_t stream, uint64_t first_key, Duration* out, size_t count) const;
+
+private:
+    enum class Kind : uint8_t { CONSTANT, QUANTILES, ALIAS };
+
+    struct AliasSlot {
+        uint32_t threshold; // Keep this bucket if the coin (16 bits) is below it, else take alias
+        uint32_t alias;
+        int64_t lower_ns;
+        int64_t width_ns;
+    };
+
+    int64_t sample_quantiles(uint64_t u) const {
+        const size_t index = static_cast<size_t>(u >> 52); // Top 12 bits pick the interval
+        const int64_t lo = quantiles_ns_[index];
+        const int64_t hi = quantiles_ns_[index + 1];
+        const uint64_t frac = (u >> 32) & 0xFFFFF;       // Next 20 bits interpolate inside it
+        return lo + static_cast<int64_t>((static_cast<uint64_t>(hi - lo) * frac) >> 20);
+    }
+    int64_t sample_alias(uint64_t u) const {
+        size_t index = static_cast<size_t>(((u >> 32) * alias_.size()) >> 32);
+        if (((u >> 16) & 0xFFFF) >= alias_[index].threshold) index = alias_[index].alias;
+        const AliasSlot& slot = alias_[index];
+        return slot.lower_ns + static_cast<int64_t>((static_cast<uint64_t>(slot.width_ns) * (u & 0xFFFF)) >> 16);
+    }
+
+    Kind kind_ = Kind::CONSTANT;
+    int64_t min_ns_ = 0;
+    int64_t max_ns_ = 0;
+    std::vector<int64_t> quantiles_ns_; // kTableSize + 1 points, QUANTILES only
+    std::vector<AliasSlot> alias_;      // ALIAS only
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_LATENCY_DISTRIBUTION_HPP
@@ -0,0 +1,70 @@
+#ifndef MARKET_REPLAY_LATENCY_HISTOGRAM_HPP
+#define MARKET_REPLAY_LATENCY_HISTOGRAM_HPP
+
+#include "common.hpp"
+#include "utils/bit_ops.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace market_replay {
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Fixed-memory log-linear histogram of nanosecond latencies, HdrHistogram style.
+//
+// Values below 2^kPrecisionBits get a bucket each; above that every power of two is split into
+// 2^(kPrecisionBits - 1) equal buckets, so any value is known to within 1/2^(kPrecisionBits - 1)
+// (under 1.6%) over the whole int64 range. record() is a count-leading-zeros, a shift and an
+// increment. Histograms of the same geometry merge by adding counts, so per-thread or per-run
+// histograms combine exactly.
+class LatencyHistogram {
+public:
+    static constexpr int kPrecisionBits = 7;
+    static constexpr size_t kSubBuckets = size_t{1} << (kPrecisionBits - 1);
+    static constexpr size_t kNumBuckets = (64 - kPrecisionBits + 2) * kSubBuckets; // Covers all of uint64
+
+    LatencyHistogram() : counts_(kNumBuckets, 0) {}
+
+    void record(Duration latency) { record_ns(latency.count()); }
+    void record_ns(int64_t ns) {
+        const uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+        counts_[bucket_index(value)]++;
+        if (total_count_ == 0 || value < min_ns_) min_ns_ = value;
+        if (value > max_ns_) max_ns_ = value;
+        total_count_++;
+        sum_ns_ += value;
+    }
+    void merge(const LatencyHistogram& other);
+    void reset();
+    // Non-empty buckets and the totals, for checkpoints (see checkpoint.hpp); restore replaces the contents
+    void save_state(CheckpointWriter& out) const;
+    void restore_state(CheckpointReader& in);
+
+    uint64_t count() const { return total_count_; }
+    Duration min() const { return Duration(static_cast<int64_t>(min_ns_)); }
+    Duration max() const { return Duration(static_cast<int64_t>(max_ns_)); }
+    Duration mean() const;
+    // Highest value equivalent to the bucket holding the given percentile (0-100), capped at max()
+    Duration value_at_percentile(double percentile) const;
+
+    // Bucket geometry, for dumps: [lower, lower + width) holds count(index) values
+    static size_t bucket_index(uint64_t value) {
+        if (value < 2 * kSubBuckets) return static_cast<size_t>(value);
+        const int magnitude = utils::highest_set_bit(value) - kPrecisionBits + 1;
+        return static_cast<size_t>(magnitude) * kSubBuckets + static_cast<size_t>(value >> magnitude);
+    }
+    static uint64_t bucket_lower(size_t index);
+    static uint64_t bucket_width(size_t index);
+    uint64_t bucket_count(size_t index) const { return counts_[index]; }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t total_count_ = 0;
+    uint64_t min_ns_ = 0;
+    uint64_t max_ns_ = 0;
+    uint64_t sum_ns_ = 0; // Overflows only past 580 years of summed latency
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_LATENCY_HISTOGRAM_HPP
@@ -3,12 +3,36 @@
 
 #include "common.hpp"
 #include "event.hpp"
-#include <random> // For potential future use with distributions
+#include "latency_distribution.hpp"
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace market_replay {
 
 class LatencyModel {
 public:
+    // The six legs of the round trip, in the order an order travels them
+    enum class Leg : uint8_t {
+        MARKET_DATA_FEED,
+        STRATEGY_PROCESSING,
+        ORDER_NETWORK,
+        EXCHANGE_ORDER_PROCESSING,
+        EXCHANGE_FILL_PROCESSING,
+        ACK_NETWORK
+    };
+    static constexpr size_t kNumLegs = 6;
+
+    // A distribution per leg; a null entry falls back to the next level (symbol -> venue -> default
+    // distributions -> the fixed duration in Config). Shared so that configs stay cheap to copy.
+    struct LegDistributions {
+        std::array<std::shared_ptr<const LatencyDistribution>, kNumLegs> legs{};
+
+        void set(Leg leg, LatencyDistribution dist) { legs[static_cast<size_t>(leg)] = std::make_shared<const LatencyDistribution>(std::move(dist)); }
+    };
+
     // Configurable latencies
     struct Config {
         Duration market_data_feed_latency = std::chrono::microseconds(50);  // Exchange source to strategy input queue
@@ -17,33 +41,75 @@ public:
         Duration exchange_order_processing_latency = std::chrono::microseconds(10); // Exchange internal for ack
         Duration exchange_fill_processing_latency = std::chrono::microseconds(15);  // Exchange internal for fill (can be > ack)
         Duration ack_network_latency_exch_to_strat = std::chrono::microseconds(20);   // Exchange output to strategy input (for ack/fill)
+
+        // Stochastic legs. Samples are keyed by (seed, leg, tick sequence or exchange order id), so a run
+        // is reproducible for a given seed whatever the strategy execution mode or shard count.
+        LegDistributions distributions;
+        std::unordered_map<std::string, std::string> symbol_venues;         // Symbol name -> venue name
+        std::unordered_map<std::string, LegDistributions> venue_overrides;  // By venue name
+        std::unordered_map<std::string, LegDistributions> symbol_overrides; // By symbol name, wins over its venue
+        uint64_t seed = 0x5EEDULL;
     };
 
     explicit LatencyModel(Config config); // Constructor that takes a Config
     LatencyModel();                      // Default constructor (will use Config's defaults)
 
-    // Latency for market data (quote/trade) from exchange to strategy's input queue
-    Duration get_market_data_latency(const BaseEvent& event) const;
+    // The fixed latencies market_replay_sim_cli runs with; the sweep tool starts every scenario from them
+    static Config cli_config();
+
+    // Latency for market data (quote/trade) from exchange to strategy's input queue.
+    // sequence numbers the ticks of a run (the dispatcher passes its ingestion count).
+    Duration get_market_data_latency(const BaseEvent& event, uint64_t sequence = 0) const;
+
+    // The order-path legs are keyed by the exchange order id; fills additionally by their own key so
+    // several fills of one order draw independently.
 
     // Timestamp when an order (sent at `strategy_decision_ts`) arrives at the exchange
-    Timestamp get_order_arrival_at_exchange_ts(Timestamp strategy_decision_ts) const;
-    
+    Timestamp get_order_arrival_at_exchange_ts(Timestamp strategy_decision_ts,
+                                               SymbolId symbol_id = INVALID_SYMBOL_ID, uint64_t key = 0) const;
+
     // Timestamp when a simple ACK for an order (that arrived at `order_arrival_at_exchange_ts`)
     // arrives back at the strategy's input queue.
-    Timestamp get_ack_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts) const;
+    Timestamp get_ack_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts,
+                                             SymbolId symbol_id = INVALID_SYMBOL_ID, uint64_t key = 0) const;
 
     // Timestamp when a FILL for an order (that arrived at `order_arrival_at_exchange_ts`)
     // arrives back at the strategy's input queue.
-    Timestamp get_fill_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts) const;
-    
+    Timestamp get_fill_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts,
+                                              SymbolId symbol_id = INVALID_SYMBOL_ID, uint64_t key = 0) const;
+
     // The time a strategy is assumed to take to process an event and decide on an action
-    Duration get_strategy_processing_latency() const;
+    Duration get_strategy_processing_latency(SymbolId symbol_id = INVALID_SYMBOL_ID, uint64_t key = 0) const;
+
+    // Lower bound on the time from a strategy seeing an event to its order reaching the exchange
+    // (processing plus order network latency, minimum over every symbol's distributions): the safe
+    // lookahead for the sharded dispatcher.
+    Duration min_decision_to_exchange_latency() const;
 
+    // One leg's samples for keys first_key .. first_key + count - 1, equal to sampling them one by one
+    void sample_batch(Leg leg, SymbolId symbol_id, uint64_t first_key, Duration* out, size_t count) const;
+
+    const LatencyDistribution& distribution(Leg leg, SymbolId symbol_id = INVALID_SYMBOL_ID) const {
+        return *legs_for(symbol_id)[static_cast<size_t>(leg)];
+    }
 
 private:
+    using LegTable = std::array<const LatencyDistribution*, kNumLegs>;
+
+    const LegTable& legs_for(SymbolId symbol_id) const {
+        return symbol_id < symbol_legs_.size() ? symbol_legs_[symbol_id] : default_legs_;
+    }
+    Duration sample(Leg leg, SymbolId symbol_id, uint64_t key) const {
+        const LatencyDistribution& dist = distribution(leg, symbol_id);
+        if (dist.is_constant()) return dist.min(); // No draw at all for fixed legs
+        return dist.sample(keyed_draw(config_.seed, static_cast<uint64_t>(leg), key));
+    }
+
     Config config_;
-    // std::mt19937 random_generator_; // For distributions if needed
+    std::vector<std::shared_ptr<const LatencyDistribution>> constant_legs_; // Built from the fixed durations
+    LegTable default_legs_{};
+    std::vector<LegTable> symbol_legs_; // By SymbolId, for symbols with a venue or symbol override
 };
 
 } // namespace market_replay
-#endif // MARKET_REPLAY_LATENCY_MODEL_HPP
\ No newline at end of file
+#endif // MARKET_REPLAY_LATENCY_MODEL_HPP
@@ -6,12 +6,49 @@
 #include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
+#include "market_replay/common.hpp" // For Timestamp
+#include <chrono>
 #include <string>
 #include <memory> // For std::shared_ptr
 
+// Levels below this are compiled out of the LOG_* macros, arguments and all. One of spdlog's
+// SPDLOG_LEVEL_* values; set from CMake by LOG_ACTIVE_LEVEL.
+#ifndef MARKET_REPLAY_LOG_ACTIVE_LEVEL
+#define MARKET_REPLAY_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
 namespace market_replay {
 class Logger {
 public:
+    struct Config {
+        std::string log_file_name = "replay_log.txt";
+        spdlog::level::level_enum console_level = spdlog::level::info;
+        spdlog::level::level_enum file_level = spdlog::level::debug;
+        bool async = true;
+        size_t async_q_size = 8192;
+        size_t async_threads = 1;
+        // What a logging thread does when the async queue is full: wait for the writer, or
+        // overwrite the oldest queued message (counted, and reported by shutdown())
+        spdlog::async_overflow_policy overflow_policy = spdlog::async_overflow_policy::block;
+        spdlog::level::level_enum flush_level = spdlog::level::info; // Every message at or above it flushes the sinks
+        std::chrono::seconds flush_interval{0};                      // Background flush of everything; 0 for none
+    };
+
+    // For replays: the file gets info and up from a large async queue that never blocks the
+    // caller, the console only warnings, and only warnings and errors flush straight away.
+    // Everything else is flushed once a second by spdlog's own thread.
+    static Config replay_profile(const std::string& log_file_name) {
+        Config config;
+        config.log_file_name = log_file_name;
+        config.console_level = spdlog::level::warn;
+        config.file_level = spdlog::level::info;
+        config.async_q_size = 1 << 16;
+        config.overflow_policy = spdlog::async_overflow_policy::overrun_oldest;
+        config.flush_level = spdlog::level::warn;
+        config.flush_interval = std::chrono::seconds(1);
+        return config;
+    }
+
     // Call once at the beginning of main()
     static void init(const std::string& log_file_name = "replay_log.txt", 
                      spdlog::level::level_enum console_level = spdlog::level::info,
@@ -19,7 +56,17 @@ public:
                      bool async = true,
                      size_t async_q_size = 8192,
                      size_t async_threads = 1) {
-        
+        Config config;
+        config.log_file_name = log_file_name;
+        config.console_level = console_level;
+        config.file_level = file_level;
+        config.async = async;
+        config.async_q_size = async_q_size;
+        config.async_threads = async_threads;
+        init(config);
+    }
+
+    static void init(const Config& config) {
         if (Logger::is_initialized_) {
             spdlog::warn("Logger already initialized.");
             return;
@@ -27,36 +74,38 @@ public:
 
         try {
             auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-            console_sink->set_level(console_level);
+            console_sink->set_level(config.console_level);
             // Format: [Timestamp] [Logger Name] [Thread ID] [Level] Message
             console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%t] [%^%l%$] %v");
 
 
-            auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_file_name, true); // true to truncate
-            file_sink->set_level(file_level);
+            auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(config.log_file_name, true); // true to truncate
+            file_sink->set_level(config.file_level);
             file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%t] [%l] %v");
 
             std::shared_ptr<spdlog::logger> logger;
-            if (async) {
-                spdlog::init_thread_pool(async_q_size, async_threads);
+            if (config.async) {
+                spdlog::init_thread_pool(config.async_q_size, config.async_threads);
                 logger = std::make_shared<spdlog::async_logger>("MarketReplaySim",
                                                                 spdlog::sinks_init_list{console_sink, file_sink},
                                                                 spdlog::thread_pool(),
-                                                                spdlog::async_overflow_policy::block);
+                                                                config.overflow_policy);
             } else {
                  logger = std::make_shared<spdlog::logger>("MarketReplaySim",
                                                           spdlog::sinks_init_list{console_sink, file_sink});
             }
             
             spdlog::set_default_logger(logger);
-            spdlog::set_level(std::min(console_level, file_level)); // Global level set to the more verbose of the two
-            spdlog::flush_on(spdlog::level::info); 
+            spdlog::set_level(std::min(config.console_level, config.file_level)); // Global level set to the more verbose of the two
+            spdlog::flush_on(config.flush_level);
+            if (config.flush_interval.count() > 0) spdlog::flush_every(config.flush_interval);
             
             Logger::is_initialized_ = true;
+            Logger::async_ = config.async;
             spdlog::info("Logger initialized. Console Level: {}, File Level: {}, Async: {}", 
-                spdlog::level::to_string_view(console_level), 
-                spdlog::level::to_string_view(file_level),
-                async);
+                spdlog::level::to_string_view(config.console_level), 
+                spdlog::level::to_string_view(config.file_level),
+                config.async);
 
         } catch (const spdlog::spdlog_ex& ex) {
             std::cerr << "Log initialization failed: " << ex.what() << std::endl;
@@ -66,6 +115,13 @@ public:
 
     static void shutdown() {
         if (Logger::is_initialized_) {
+            if (Logger::async_) {
+                if (auto pool = spdlog::thread_pool()) {
+                    if (size_t dropped = pool->overrun_counter()) {
+                        spdlog::warn("Logger: {} messages were dropped by a full async queue.", dropped);
+                    }
+                }
+            }
             spdlog::info("Logger shutting down.");
             spdlog::shutdown();
             Logger::is_initialized_ = false;
@@ -74,18 +130,82 @@ public:
     
     static bool is_initialized() { return Logger::is_initialized_; }
 
+    // Whether a message at `level` would go anywhere; the LOG_* macros check it before their
+    // arguments are evaluated. Uninitialized, everything goes to the console.
+    static bool should_log(spdlog::level::level_enum level) {
+        return !Logger::is_initialized_ || spdlog::default_logger_raw()->should_log(level);
+    }
+
 private:
     // To prevent multiple initializations if init() is called more than once.
     inline static bool is_initialized_ = false; 
+    inline static bool async_ = false;
+};
+
+// A Timestamp as a log argument, formatted (as epoch nanoseconds, like timestamp_to_string) into
+// the message buffer only if the message is logged
+struct LogTimestamp {
+    Timestamp ts;
 };
+inline LogTimestamp log_ts(Timestamp ts) { return LogTimestamp{ts}; }
+
 } // namespace market_replay
 
-// Global macros for convenience
-#define LOG_TRACE(...)    if(market_replay::Logger::is_initialized()) spdlog::trace(__VA_ARGS__); else std::cout << "LOG_TRACE: " << fmt::format(__VA_ARGS__) << std::endl
-#define LOG_DEBUG(...)    if(market_replay::Logger::is_initialized()) spdlog::debug(__VA_ARGS__); else std::cout << "LOG_DEBUG: " << fmt::format(__VA_ARGS__) << std::endl
-#define LOG_INFO(...)     if(market_replay::Logger::is_initialized()) spdlog::info(__VA_ARGS__); else std::cout << "LOG_INFO: " << fmt::format(__VA_ARGS__) << std::endl
-#define LOG_WARN(...)     if(market_replay::Logger::is_initialized()) spdlog::warn(__VA_ARGS__); else std::cerr << "LOG_WARN: " << fmt::format(__VA_ARGS__) << std::endl
-#define LOG_ERROR(...)    if(market_replay::Logger::is_initialized()) spdlog::error(__VA_ARGS__); else std::cerr << "LOG_ERROR: " << fmt::format(__VA_ARGS__) << std::endl
-#define LOG_CRITICAL(...) if(market_replay::Logger::is_initialized()) spdlog::critical(__VA_ARGS__); else std::cerr << "LOG_CRITICAL: " << fmt::format(__VA_ARGS__) << std::endl
+template <>
+struct fmt::formatter<market_replay::LogTimestamp> : fmt::formatter<market_replay::Timestamp::rep> {
+    template <typename FormatContext>
+    auto format(const market_replay::LogTimestamp& value, FormatContext& ctx) const {
+        return fmt::formatter<market_replay::Timestamp::rep>::format(value.ts.time_since_epoch().count(), ctx);
+    }
+};
+
+// Global macros for convenience. Each expands to a single statement that evaluates its arguments
+// only when the level is compiled in (MARKET_REPLAY_LOG_ACTIVE_LEVEL) and enabled at run time.
+#define MR_LOG_AT(level, stream, prefix, ...) \
+    do { \
+        if (market_replay::Logger::should_log(level)) { \
+            if (market_replay::Logger::is_initialized()) { \
+                spdlog::default_logger_raw()->log(level, __VA_ARGS__); \
+            } else { \
+                stream << prefix << fmt::format(__VA_ARGS__) << std::endl; \
+            } \
+        } \
+    } while (0)
+// A compiled-out level: still type-checked, never evaluated
+#define MR_LOG_DISCARD(...) \
+    do { \
+        if (false) (void)fmt::format(__VA_ARGS__); \
+    } while (0)
+
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(...)    MR_LOG_AT(spdlog::level::trace, std::cout, "LOG_TRACE: ", __VA_ARGS__)
+#else
+#define LOG_TRACE(...)    MR_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)    MR_LOG_AT(spdlog::level::debug, std::cout, "LOG_DEBUG: ", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)    MR_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(...)     MR_LOG_AT(spdlog::level::info, std::cout, "LOG_INFO: ", __VA_ARGS__)
+#else
+#define LOG_INFO(...)     MR_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define LOG_WARN(...)     MR_LOG_AT(spdlog::level::warn, std::cerr, "LOG_WARN: ", __VA_ARGS__)
+#else
+#define LOG_WARN(...)     MR_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define LOG_ERROR(...)    MR_LOG_AT(spdlog::level::err, std::cerr, "LOG_ERROR: ", __VA_ARGS__)
+#else
+#define LOG_ERROR(...)    MR_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
+#define LOG_CRITICAL(...) MR_LOG_AT(spdlog::level::critical, std::cerr, "LOG_CRITICAL: ", __VA_ARGS__)
+#else
+#define LOG_CRITICAL(...) MR_LOG_DISCARD(__VA_ARGS__)
+#endif
 
-#endif // MARKET_REPLAY_LOGGER_HPP
\ No newline at end of file
+#endif // MARKET_REPLAY_LOGGER_HPP
@@ -0,0 +1,49 @@
+#ifndef MARKET_REPLAY_MARKET_DATA_BUFFER_HPP
+#define MARKET_REPLAY_MARKET_DATA_BUFFER_HPP
+
+#include "event.hpp"
+#include "interfaces.hpp" // For IMarketDataSource
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace market_replay {
+
+// A whole tick file decoded once and held in memory, read-only from then on. Any number of
+// dispatchers (e.g. the runs of a parameter sweep) can replay it concurrently through their own
+// MarketDataBufferSource, without re-reading or re-parsing the file.
+class MarketDataBuffer {
+public:
+    using Record = std::variant<QuoteEvent, TradeEvent>; // Stored by value, contiguous
+
+    // Reads every event from the CSV or .mrt file at path (see open_market_data_source)
+    static std::shared_ptr<const MarketDataBuffer> load(const std::string& path);
+
+    const std::vector<Record>& records() const { return records_; }
+    size_t size() const { return records_.size(); }
+    const std::string& source_path() const { return source_path_; }
+
+private:
+    MarketDataBuffer() = default;
+
+    std::string source_path_;
+    std::vector<Record> records_;
+};
+
+// Replays a MarketDataBuffer: each read hands out a fresh copy of the next record, which the
+// dispatcher is then free to re-time and share with strategies.
+class MarketDataBufferSource : public IMarketDataSource {
+public:
+    explicit MarketDataBufferSource(std::shared_ptr<const MarketDataBuffer> buffer);
+
+    std::unique_ptr<BaseEvent> read_next_event() override;
+    bool has_more_events() const override { return next_ < buffer_->size(); }
+
+private:
+    std::shared_ptr<const MarketDataBuffer> buffer_;
+    size_t next_ = 0;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_MARKET_DATA_BUFFER_HPP
@@ -0,0 +1,34 @@
+#ifndef MARKET_REPLAY_MARKET_DATA_SOURCE_HPP
+#define MARKET_REPLAY_MARKET_DATA_SOURCE_HPP
+
+#include "interfaces.hpp"
+#include "merged_market_data_source.hpp"
+#include "time_index.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace market_replay {
+
+// Opens the right reader for `path` by extension: ".mrt" -> TickFileReader, ".mrtz" ->
+// BlockTickFileReader, anything else -> CsvParser. A directory is replayed as the merge of every
+// market data file in it (see below). A restricted `window` wraps each file in a
+// WindowedMarketDataSource, over its TimeIndex sidecar (built on first use) when it is seekable.
+// Throws std::runtime_error if the file can't be opened.
+std::unique_ptr<IMarketDataSource> open_market_data_source(const std::string& path,
+                                                           MergedMarketDataSource::Config merge_config = {},
+                                                           const ReplayWindow& window = {});
+
+// Several files replayed as one stream in exchange_timestamp order (MergedMarketDataSource); a
+// single path is opened as is. Ties between files go to the one listed first. Merged .mrtz files
+// are decoded on the merge's io_threads, not by threads of their own.
+std::unique_ptr<IMarketDataSource> open_market_data_source(const std::vector<std::string>& paths,
+                                                           MergedMarketDataSource::Config merge_config = {},
+                                                           const ReplayWindow& window = {});
+
+// The .csv, .mrt and .mrtz files directly inside `directory`, sorted by name. Throws std::runtime_error
+// if it is not a directory.
+std::vector<std::string> list_market_data_files(const std::string& directory);
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_MARKET_DATA_SOURCE_HPP
@@ -0,0 +1,81 @@
+#ifndef MARKET_REPLAY_MERGED_MARKET_DATA_SOURCE_HPP
+#define MARKET_REPLAY_MERGED_MARKET_DATA_SOURCE_HPP
+
+#include "event.hpp"
+#include "interfaces.hpp" // For IMarketDataSource
+#include "utils/loser_tree.hpp"
+#include "utils/work_stealing_pool.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace market_replay {
+
+// Streams many time-sorted sources (e.g. one file per symbol per day) as one, in exchange_timestamp
+// order; equal timestamps come in source order. A loser tree over the head event of each source
+// picks the next one in log2(k) comparisons.
+//
+// Every source is read through two blocks of at most block_events decoded events: the merge
+// consumes one while a pool of io_threads workers decodes the next block into the other, so
+// parsing overlaps the replay and memory stays at 2 * block_events * k events however long the
+// files. With io_threads = 0 blocks are read on the calling thread as they are needed. Sources
+// opened for a merge by open_market_data_source do no read-ahead of their own (a .mrtz reader
+// gets io_threads = 0), so this config alone sizes the threads and the memory.
+//
+// The first block of every source is read up front and in source order, so symbols a file starts
+// with are interned deterministically. Each source keeps its file open for the whole replay.
+class MergedMarketDataSource : public IMarketDataSource {
+public:
+    struct Config {
+        size_t block_events = 1024; // Per source and block
+        size_t io_threads = 2;
+    };
+
+    explicit MergedMarketDataSource(std::vector<std::unique_ptr<IMarketDataSource>> sources);
+    MergedMarketDataSource(std::vector<std::unique_ptr<IMarketDataSource>> sources, Config config);
+    ~MergedMarketDataSource() override; // Waits for prefetches in flight
+
+    MergedMarketDataSource(const MergedMarketDataSource&) = delete;
+    MergedMarketDataSource& operator=(const MergedMarketDataSource&) = delete;
+
+    std::unique_ptr<BaseEvent> read_next_event() override;
+    bool has_more_events() const override;
+
+    size_t num_sources() const { return readers_.size(); }
+
+private:
+    // Leaf key: (exchange timestamp, source index); Timestamp::max() once the source is done
+    using MergeKey = std::pair<Timestamp, size_t>;
+
+    struct Reader {
+        std::unique_ptr<IMarketDataSource> source; // Only used by the one fill in flight, or by the merge
+        // Merge side
+        std::vector<std::unique_ptr<BaseEvent>> front;
+        size_t front_pos = 0;
+        bool fill_pending = false; // A fill into back has been scheduled and not yet taken
+        bool source_done = false;  // Nothing left to read once front and a pending back are used up
+        // Handed over from the fill: back belongs to the filling worker until back_ready is set
+        std::mutex mutex;
+        std::condition_variable ready_cv;
+        std::vector<std::unique_ptr<BaseEvent>> back;
+        bool back_ready = false;       // Guarded by mutex
+        bool back_source_done = false; // Guarded by mutex
+    };
+
+    bool fill_block(Reader& reader, std::vector<std::unique_ptr<BaseEvent>>& block); // True if the source is drained
+    void schedule_fill(Reader* reader);
+    bool advance(Reader& reader); // Moves to the next block once front is used up; false when exhausted
+    MergeKey head_key(size_t index) const;
+
+    Config config_;
+    std::vector<std::unique_ptr<Reader>> readers_;
+    utils::LoserTree<MergeKey> tree_;
+    // Declared last, destroyed first: its destructor runs the fills still queued while the readers exist
+    std::unique_ptr<utils::WorkStealingPool> io_pool_;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_MERGED_MARKET_DATA_SOURCE_HPP
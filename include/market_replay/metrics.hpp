@@ -2,25 +2,40 @@
 #define MARKET_REPLAY_METRICS_HPP
 
 #include "common.hpp"
+#include "latency_histogram.hpp"
 #include "logger.hpp" // For logging within metrics
-#include <vector>
+#include "symbol_registry.hpp"
+#include "utils/mpsc_queue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
 #include <fstream>
 #include <iomanip> 
+#include <memory>
+#include <vector>
 #include <string>
+#include <string_view>
 #include <map>
 #include <mutex> // For thread safety
+#include <thread>
+#include <unordered_map>
 
 namespace market_replay {
 
+class CheckpointWriter;
+class CheckpointReader;
+
 struct SimulatedTrade {
     Timestamp timestamp; // Timestamp of fill ack arrival at strategy
     std::string strategy_id;
-    std::string symbol;
+    SymbolId symbol_id;
     OrderSide side;
     Price price;
     Quantity quantity;
     OrderId client_order_id;
     OrderId exchange_order_id;
+    PriceTicks price_ticks = INVALID_PRICE_TICKS; // Exact fill price if known (OrderAckEvent::last_filled_price_ticks)
 };
 
 struct LatencyRecord {
@@ -30,32 +45,185 @@ struct LatencyRecord {
     std::string notes; // e.g., "MarketDataToStrategy", "OrderDecisionToFillAck"
 };
 
+// Whole-run totals, e.g. one line of a parameter sweep summary
+struct MetricsSummary {
+    size_t trade_count = 0;
+    Quantity total_quantity = 0;
+    double total_volume_traded = 0.0; // Notional, over all strategies and symbols
+    long long net_position = 0;       // Summed over all strategies and symbols
+    double realized_pnl = 0.0;        // As published by the dispatcher (record_pnl), summed
+    double unrealized_pnl = 0.0;
+    size_t latency_records = 0;
+    Duration mean_latency{0};
+    Duration max_latency{0};
+};
+
+// Interned metric name (a strategy id, a latency source, a note); 0 is the empty name
+using MetricKey = uint32_t;
+
+// Records trades and latencies from any number of threads without a shared lock.
+//
+// Each recording thread appends compact records (interned keys, no strings) to a buffer of its own;
+// a full buffer is handed to a background writer through a lock-free queue and the thread carries on
+// with a recycled one. The writer appends trades to the trades file as it goes, folds each latency
+// into a fixed-size histogram for its source and keeps the running totals and positions, so memory
+// stays flat however long the run. It also asks every thread to hand over partial buffers each
+// flush_interval, which bounds how stale the files get. Output lines are grouped by recording
+// thread, not globally time ordered.
+//
+// The latency file is a per-source percentile table written at report time; the one-line-per-event
+// log is opt-in through Config::raw_latency_log_path. An empty file path skips that output (totals
+// are still kept).
 class MetricsCollector {
 public:
+    struct Config {
+        size_t records_per_buffer = 1024;                  // Per thread and record kind
+        std::chrono::milliseconds flush_interval{100};     // Writer wake-up period
+        std::string raw_latency_log_path;                  // Every latency sample as a CSV line; empty = off
+        std::string histogram_dump_path;                   // Non-empty histogram buckets per source; empty = off
+        std::string equity_curve_path;                     // Snapshots from record_equity_snapshot; empty = off
+    };
+
+    static constexpr MetricKey kNoKey = 0;
+
     MetricsCollector(std::string trades_filepath, std::string latency_filepath, std::string pnl_filepath);
-    ~MetricsCollector();
+    MetricsCollector(std::string trades_filepath, std::string latency_filepath, std::string pnl_filepath, Config config);
+    ~MetricsCollector(); // Writes whatever is still buffered, then stops the writer
+
+    MetricsCollector(const MetricsCollector&) = delete;
+    MetricsCollector& operator=(const MetricsCollector&) = delete;
+
+    // Any thread. Meant to be called once per name and the key kept; takes a lock.
+    MetricKey intern_key(std::string_view name);
 
     void record_trade(const SimulatedTrade& trade);
+    void record_latency(MetricKey source, Duration latency, Timestamp event_time, MetricKey notes = kNoKey);
+    // Convenience overload: interns through the calling thread's own name cache
     void record_latency(const std::string& source_desc, Duration latency, Timestamp event_time, const std::string& notes = "");
-    
-    void update_pnl(const std::string& strategy_id, const std::string& symbol, Price fill_price, Quantity filled_quantity, OrderSide side);
+
+    void update_pnl(const std::string& strategy_id, SymbolId symbol_id, Price fill_price, Quantity filled_quantity, OrderSide side);
+    // Fixed-point variant: the notional is accumulated from an exact tick product
+    void update_pnl(const std::string& strategy_id, SymbolId symbol_id, PriceTicks fill_price_ticks, Quantity filled_quantity, OrderSide side);
+    // Final position and PnL for the pair from the dispatcher's PnLEngine; reported in place of what
+    // the recorded trades add up to
+    void record_pnl(const std::string& strategy_id, SymbolId symbol_id, const PnL& pnl);
+    void record_equity_snapshot(const std::string& strategy_id, Timestamp timestamp, double realized_pnl, double unrealized_pnl);
+
+    // flush(), then the latency percentile table, histogram dump, PnL summary and equity curve.
+    // Like flush(), only once every recording thread is done.
     void report_final_metrics();
+    // Hands every buffered record to the writer and waits until it has been written.
+    // Recording threads must have stopped (partial buffers are taken from them directly).
+    void flush();
+    MetricsSummary summary(); // Flushes first
+    // Latency histograms by source name, e.g. to merge over several runs. Flushes first.
+    std::map<std::string, LatencyHistogram> latency_histograms();
+
+    // Totals, latency histograms, PnL and the equity curve so far, for checkpoints (see
+    // checkpoint.hpp); flushes first, so recording threads must be idle. The trades and raw latency
+    // files are not part of it: a restored collector's files start from the restore.
+    void save_state(CheckpointWriter& out);
+    void restore_state(CheckpointReader& in); // Replaces whatever was recorded so far
 
 private:
+    struct TradeRecord {
+        Timestamp timestamp;
+        MetricKey strategy;
+        SymbolId symbol_id;
+        OrderSide side;
+        Price price;
+        PriceTicks price_ticks;
+        Quantity quantity;
+        OrderId client_order_id;
+        OrderId exchange_order_id;
+    };
+    struct LatencySample {
+        Timestamp event_time;
+        MetricKey source;
+        MetricKey notes;
+        Duration latency;
+    };
+
+    struct ProducerBuffer;
+    struct Chunk {
+        ProducerBuffer* owner; // Recycled back to it once written
+        std::vector<TradeRecord> trades;
+        std::vector<LatencySample> latencies;
+    };
+    // One per recording thread; only that thread touches current and key_cache
+    struct ProducerBuffer {
+        std::unique_ptr<Chunk> current;
+        utils::MpscQueue<std::unique_ptr<Chunk>> recycled; // Writer -> this thread
+        std::vector<std::unique_ptr<Chunk>> spare;
+        std::unordered_map<std::string, MetricKey> key_cache;
+        uint64_t flush_epoch_seen = 0;
+        std::atomic<bool> collector_alive{true}; // Lets the thread drop its handle once we are gone
+    };
+
+    ProducerBuffer& local_buffer(); // The calling thread's, created on first use
+    Chunk& writable_chunk(ProducerBuffer& buffer); // Hands over a full or stale chunk first
+    void hand_over(ProducerBuffer& buffer);
+    MetricKey intern_cached(ProducerBuffer& buffer, const std::string& name);
+    const std::string& key_name(MetricKey key);
+
+    void writer_loop();
+    void write_chunk(Chunk& chunk); // Writer thread
+    void write_output(); // Writer thread: pending text to the files
+    void apply_fill(const std::string& strategy_id, SymbolId symbol_id, double trade_value, Quantity filled_quantity, OrderSide side);
+    void write_latency_percentiles();
+    void write_histogram_dump();
+    void write_pnl_summary();
+    void write_equity_curve();
+    std::map<std::pair<StrategyId, SymbolId>, PnL> final_pnl() const; // Caller holds totals_mutex_
+
     std::string trades_filepath_;
     std::string latency_filepath_;
     std::string pnl_filepath_;
+    Config config_;
+    const uint64_t uid_; // Tells this collector's thread-local buffers from a dead one's at the same address
 
-    std::vector<SimulatedTrade> trades_log_;
-    std::vector<LatencyRecord> latency_log_;
-    std::map<std::pair<StrategyId, std::string>, PnL> pnl_by_strategy_symbol_; // {Strategy, Symbol} -> PnL
+    // Key registry
+    std::mutex keys_mutex_;
+    std::deque<std::string> key_names_; // By MetricKey; deque keeps references stable
+    std::unordered_map<std::string, MetricKey> key_index_;
 
-    mutable std::mutex mtx_; // Protects all shared data structures
+    std::mutex buffers_mutex_; // Registration only
+    std::vector<std::shared_ptr<ProducerBuffer>> buffers_;
 
-    void write_trades_log();
-    void write_latency_log();
-    void write_pnl_summary();
+    // Producers -> writer
+    utils::MpscQueue<std::unique_ptr<Chunk>> full_chunks_;
+    std::atomic<uint64_t> flush_epoch_{0}; // Bumped by the writer: producers hand over partial chunks
+
+    std::thread writer_;
+    std::mutex writer_mutex_;
+    std::condition_variable writer_cv_; // Wakes the writer
+    std::condition_variable flushed_cv_; // Writer -> flush()
+    uint64_t flush_requested_ = 0;  // Guarded by writer_mutex_
+    uint64_t flush_completed_ = 0;  // Guarded by writer_mutex_
+    bool writer_stopping_ = false;  // Guarded by writer_mutex_
+
+    // Writer thread state
+    std::FILE* trades_file_ = nullptr;
+    std::FILE* latency_file_ = nullptr;
+    std::string trades_text_;
+    std::string latency_text_;
+    std::vector<std::unique_ptr<Chunk>> drained_;
+
+    // Totals and positions: written by the writer, read by summary() and report_final_metrics()
+    mutable std::mutex totals_mutex_;
+    MetricsSummary totals_;
+    Duration total_latency_{0};
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms_; // By source MetricKey, created on first sample
+    std::map<std::pair<StrategyId, SymbolId>, PnL> pnl_by_strategy_symbol_; // {Strategy, Symbol} -> PnL, from trades
+    std::map<std::pair<StrategyId, SymbolId>, PnL> published_pnl_;          // From record_pnl(), takes precedence
+    struct EquityPoint {
+        StrategyId strategy_id;
+        Timestamp timestamp;
+        double realized_pnl;
+        double unrealized_pnl;
+    };
+    std::vector<EquityPoint> equity_curve_;
 };
 
 } // namespace market_replay
-#endif // MARKET_REPLAY_METRICS_HPP
\ No newline at end of file
+#endif // MARKET_REPLAY_METRICS_HPP
@@ -2,52 +2,180 @@
 #define MARKET_REPLAY_ORDER_BOOK_HPP
 
 #include "common.hpp"
-#include "event.hpp" // For QuoteEvent
-#include <map>
+#include "event.hpp" // For QuoteEvent, TradeEvent
 #include <string>
+#include <map>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace market_replay {
 
-// A very simplified representation of an order book for a single symbol
-// Mainly to get current BBO for matching market orders.
+class CheckpointWriter;
+class CheckpointReader;
+
+// Price-level book for a single symbol, rebuilt from the L1 feed plus our own resting orders.
+//
+// Prices are handled as integer ticks of the symbol's tick size (SymbolRegistry::set_tick_size), so
+// level indexing and every comparison is exact; doubles only appear at the API boundary.
+// Each side is a flat ladder of levels indexed by tick offset from a base tick. A level holds the
+// displayed market quantity last seen there and an intrusive FIFO list of resting strategy orders.
+// The ladder follows the market while nothing of ours rests on it; once an order pins it, levels
+// beyond its max_levels span are kept in a sparse map instead, so no price is ever out of reach.
+// Top of book is kept directly, so BBO reads and a quote that does not move the market are O(1);
+// the only per-quote walk is over levels the market just retreated from.
+//
+// Fill model for resting orders (no order-by-order feed, so queue position is estimated):
+//   - joining a level puts the order behind the displayed market quantity there;
+//   - a trade at our price first eats the quantity ahead of us, then fills us in FIFO order;
+//   - a trade through our price, or an opposite quote strictly crossing it, fills at our limit price;
+//   - displayed size shrinking at our level only ever moves us forward (cancels assumed behind us
+//     unless there is no longer that much quantity ahead).
 class SimpleOrderBook {
 public:
-    SimpleOrderBook(std::string symbol) : symbol_(std::move(symbol)) {}
+    struct Config {
+        size_t max_levels = 1 << 16; // Per-side dense ladder span in ticks; levels beyond it are kept sparsely
+    };
+
+    // A resting order (partially) executed by market activity
+    struct Fill {
+        OrderId exchange_order_id;
+        OrderId client_order_id;
+        StrategyIndex strategy_index;
+        OrderSide side;
+        PriceTicks price_ticks;
+        Price price;
+        Quantity quantity;
+        Quantity cumulative_quantity;
+        Quantity leaves_quantity; // 0 means the order is gone from the book
+    };
 
-    void update_quote(const QuoteEvent& quote);
+    explicit SimpleOrderBook(SymbolId symbol_id);
+    SimpleOrderBook(SymbolId symbol_id, Config config);
 
-    std::optional<Price> get_bid_price() const { return best_bid_price_; }
-    std::optional<Quantity> get_bid_size() const { return best_bid_size_; }
-    std::optional<Price> get_ask_price() const { return best_ask_price_; }
-    std::optional<Quantity> get_ask_size() const { return best_ask_size_; }
+    // Market data. Executions of resting orders are appended to fills.
+    void update_quote(const QuoteEvent& quote, std::vector<Fill>& fills);
+    void apply_trade(const TradeEvent& trade, std::vector<Fill>& fills);
 
-    const std::string& get_symbol() const { return symbol_; }
+    // Top of book; nullopt while a side is empty
+    std::optional<Price> get_bid_price() const;
+    std::optional<Quantity> get_bid_size() const;
+    std::optional<Price> get_ask_price() const;
+    std::optional<Quantity> get_ask_size() const;
+    bool has_bid() const { return best_bid_size_ > 0; }
+    bool has_ask() const { return best_ask_size_ > 0; }
+    PriceTicks best_bid_ticks() const { return best_bid_ticks_; } // Meaningful only if has_bid()
+    PriceTicks best_ask_ticks() const { return best_ask_ticks_; }
+
+    SymbolId get_symbol_id() const { return symbol_id_; }
+    const std::string& get_symbol() const { return symbol_name(symbol_id_); } // For logging
 
     // Tries to match a market order, returns fill price and quantity.
     // Reduces liquidity from the book.
     std::pair<Price, Quantity> match_market_order(OrderSide side, Quantity quantity);
 
-    // Tries to match a limit order. If aggressive, behaves like market.
-    // If passive, it would be added to a real book. Here, we just check immediate fill.
-    // Returns fill price and quantity.
+    // Immediate part of a limit order: crosses against the opposite best if marketable.
+    // Returns fill price and quantity; any remainder is for add_limit_order.
     std::pair<Price, Quantity> match_limit_order(OrderSide side, Price limit_price, Quantity quantity);
 
+    // Rests the unfilled part of a limit order at its price, at the back of the level's queue.
+    // already_filled seeds the cumulative quantity reported on later fills.
+    // Returns false if the price or quantity is invalid or the order id is already resting.
+    bool add_limit_order(OrderId exchange_order_id, StrategyIndex strategy_index, OrderId client_order_id,
+                         OrderSide side, Price price, Quantity leaves, Quantity already_filled = 0);
+    bool cancel_order(OrderId exchange_order_id);
+
+    // Displayed market quantity estimated to be ahead of a resting order; nullopt if not resting
+    std::optional<Quantity> queue_ahead(OrderId exchange_order_id) const;
+    // Displayed market quantity last seen at a price (0 if unknown)
+    Quantity market_depth(OrderSide side, Price price) const;
+    size_t resting_order_count() const { return order_index_.size(); }
+
+    // Top of book, ladders and resting orders as they are laid out, for checkpoints (see
+    // checkpoint.hpp), so a restored book matches exactly as this one would. Only non-empty levels
+    // are written. Restoring replaces the contents; the Config stays this book's.
+    void save_state(CheckpointWriter& out) const;
+    void restore_state(CheckpointReader& in);
 
 private:
-    std::string symbol_;
-    std::optional<Price> best_bid_price_;
-    std::optional<Quantity> best_bid_size_;
-    std::optional<Price> best_ask_price_;
-    std::optional<Quantity> best_ask_size_;
-    Timestamp last_trade_price_ts_;
-    Price last_trade_price_ = INVALID_PRICE;
-
-
-    // For a more complex book:
-    // std::map<Price, Quantity, std::greater<Price>> bids_; // Price -> Total Quantity
-    // std::map<Price, Quantity, std::less<Price>> asks_;    // Price -> Total Quantity
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t kInitialLevels = 1024;
+
+    struct Level {
+        Quantity market_quantity = 0; // Displayed size last seen at this price
+        uint32_t head = kNil;         // Oldest resting order (front of our queue)
+        uint32_t tail = kNil;
+    };
+
+    // One side of the book. levels[i] is tick base_tick + i; ticks the dense window cannot reach
+    // while a resting order pins it are in far, which is empty otherwise.
+    struct Ladder {
+        std::vector<Level> levels;
+        PriceTicks base_tick = 0;
+        std::map<PriceTicks, Level> far;
+        size_t resting_orders = 0;
+        PriceTicks best_resting_tick = 0; // Most aggressive tick with a resting order; valid while resting_orders > 0
+
+        bool in_window(PriceTicks tick) const {
+            return tick >= base_tick && tick - base_tick < static_cast<PriceTicks>(levels.size());
+        }
+        Level* find(PriceTicks tick);
+        const Level* find(PriceTicks tick) const;
+        // The next tick with a level after `tick`, moving away from the top of book on side; past
+        // the last one, a tick beyond any limit (so walks stop there)
+        PriceTicks next_tick(OrderSide side, PriceTicks tick) const;
+        void prune(PriceTicks tick); // Drops a far level that has nothing left on it
+    };
+
+    struct RestingOrder {
+        OrderId exchange_order_id;
+        OrderId client_order_id;
+        StrategyIndex strategy_index;
+        OrderSide side;
+        PriceTicks tick;
+        Price price;
+        Quantity leaves;
+        Quantity cumulative;
+        Quantity queue_ahead;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    PriceTicks to_tick(Price price) const { return to_price_ticks(symbol_id_, price); }
+    Price to_price(PriceTicks ticks) const { return from_price_ticks(symbol_id_, ticks); }
+    Ladder& ladder(OrderSide side) { return side == OrderSide::BUY ? bids_ : asks_; }
+    const Ladder& ladder(OrderSide side) const { return side == OrderSide::BUY ? bids_ : asks_; }
+    // For a buy, higher ticks are more aggressive; for a sell, lower ones
+    static bool more_aggressive(OrderSide side, PriceTicks a, PriceTicks b) { return side == OrderSide::BUY ? a > b : a < b; }
+
+    Level* level_for(Ladder& ladder, PriceTicks tick); // Grows or re-bases the ladder, or adds a far level
+    void set_market_quantity(OrderSide side, PriceTicks tick, Quantity quantity);
+    // The market's best on side moved from old_best_tick back to new_best_tick: nothing is shown at
+    // old_best_tick or anything between it and new_best_tick (exclusive) anymore.
+    void retreat(OrderSide side, PriceTicks old_best_tick, PriceTicks new_best_tick);
+    std::pair<Price, Quantity> take_best(OrderSide side, Quantity quantity); // Opposite side must be non-empty
+    void unlink(Ladder& ladder, Level& level, uint32_t index);
+    void refresh_best_resting(Ladder& ladder, OrderSide side);
+    // Fills resting orders on side at ticks at least as aggressive as limit_tick, most aggressive first.
+    // At limit_tick itself the queue ahead is consumed first when respect_queue is set.
+    void execute_against(OrderSide side, PriceTicks limit_tick, Quantity volume, bool respect_queue, std::vector<Fill>& fills);
+
+    SymbolId symbol_id_;
+    Config config_;
+
+    // Top of book, kept outside the ladder so BBO reads and the common quote update stay O(1).
+    // A side is empty while its size is 0.
+    PriceTicks best_bid_ticks_ = 0;
+    Quantity best_bid_size_ = 0;
+    PriceTicks best_ask_ticks_ = 0;
+    Quantity best_ask_size_ = 0;
+
+    Ladder bids_;
+    Ladder asks_;
+    std::vector<RestingOrder> orders_; // Slots reused through free_orders_
+    std::vector<uint32_t> free_orders_;
+    std::unordered_map<OrderId, uint32_t> order_index_; // exchange_order_id -> slot
 };
 
 } // namespace market_replay
-#endif // MARKET_REPLAY_ORDER_BOOK_HPP
\ No newline at end of file
+#endif // MARKET_REPLAY_ORDER_BOOK_HPP
@@ -0,0 +1,93 @@
+#ifndef MARKET_REPLAY_PNL_ENGINE_HPP
+#define MARKET_REPLAY_PNL_ENGINE_HPP
+
+#include "common.hpp"
+#include "symbol_registry.hpp"
+#include <vector>
+
+namespace market_replay {
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Position, realized and unrealized PnL for every strategy and symbol, kept up to date as fills and
+// quotes are dispatched; the dispatcher thread is its only user.
+//
+// One flat array of positions, a row of symbols per strategy, and one mark per symbol. Everything
+// is integer ticks (x quantity), so accounting is exact: a fill is a few integer operations on one
+// slot and a quote only stores its symbol's mark, with unrealized PnL worked out when it is read.
+// Open positions are carried at average cost. With a snapshot_interval, every strategy's equity is
+// sampled each time the simulation clock crosses a multiple of it.
+class PnLEngine {
+public:
+    struct Config {
+        Duration snapshot_interval{0}; // Equity curve sampling period on the simulation clock; 0 = off
+    };
+
+    struct Position {
+        long long quantity = 0;         // Signed: + for long, - for short
+        PriceTicks open_cost_ticks = 0; // Ticks x quantity paid for the open quantity, signed like it
+        PriceTicks realized_ticks = 0;  // Ticks x quantity
+        PriceTicks volume_ticks = 0;    // Notional traded, ticks x quantity
+        uint64_t fills = 0;
+    };
+
+    struct EquitySnapshot {
+        Timestamp timestamp;
+        StrategyIndex strategy_index;
+        double realized_pnl;
+        double unrealized_pnl;
+    };
+
+    PnLEngine();
+    explicit PnLEngine(Config config);
+
+    void reset(size_t num_strategies); // Clears everything; call before a run
+
+    void on_fill(StrategyIndex strategy, SymbolId symbol_id, OrderSide side, PriceTicks price_ticks, Quantity quantity);
+    // Marks the symbol to the mid. One-sided or crossed-out quotes (either side missing) keep the old mark.
+    void on_quote(SymbolId symbol_id, PriceTicks bid_ticks, PriceTicks ask_ticks) {
+        if (bid_ticks == INVALID_PRICE_TICKS || ask_ticks == INVALID_PRICE_TICKS) return;
+        if (symbol_id >= marks_.size()) grow_symbols(symbol_id);
+        marks_[symbol_id] = bid_ticks + ask_ticks;
+    }
+    // Call with each event's time before applying it; takes the snapshots it has moved past
+    void advance_to(Timestamp now) {
+        if (now >= next_snapshot_) take_snapshots(now);
+    }
+
+    const Position& position(StrategyIndex strategy, SymbolId symbol_id) const;
+    PnL pnl(StrategyIndex strategy, SymbolId symbol_id) const; // In price units
+    double realized_pnl(StrategyIndex strategy) const;         // Over all symbols
+    double unrealized_pnl(StrategyIndex strategy) const;
+    size_t num_strategies() const { return num_strategies_; }
+    size_t symbol_capacity() const { return symbol_stride_; } // Every SymbolId traded so far is below this
+    const std::vector<EquitySnapshot>& snapshots() const { return snapshots_; }
+
+    // Positions, marks and the equity curve so far, for checkpoints (see checkpoint.hpp). Restoring
+    // replaces them and keeps this engine's Config: the snapshot clock carries on only if it has an interval.
+    void save_state(CheckpointWriter& out) const;
+    void restore_state(CheckpointReader& in);
+
+private:
+    // Mid prices are kept doubled (bid + ask ticks), which keeps half-tick mids exact
+    static constexpr PriceTicks kNoMark = INVALID_PRICE_TICKS;
+
+    Position& slot(StrategyIndex strategy, SymbolId symbol_id) {
+        return positions_[static_cast<size_t>(strategy) * symbol_stride_ + symbol_id];
+    }
+    void grow_symbols(SymbolId symbol_id); // Widens every strategy's row and the marks
+    PriceTicks unrealized_ticks_x2(const Position& position, SymbolId symbol_id) const;
+    void take_snapshots(Timestamp now);
+
+    Config config_;
+    size_t num_strategies_ = 0;
+    size_t symbol_stride_ = 0;
+    std::vector<Position> positions_; // [strategy * symbol_stride_ + symbol]
+    std::vector<PriceTicks> marks_;   // By SymbolId, doubled mid; sized symbol_stride_
+    Timestamp next_snapshot_;
+    std::vector<EquitySnapshot> snapshots_;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_PNL_ENGINE_HPP
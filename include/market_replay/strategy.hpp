@@ -1,18 +1,45 @@
 #ifndef MARKET_REPLAY_STRATEGY_HPP
 #define MARKET_REPLAY_STRATEGY_HPP
 
+#include "checkpoint.hpp" // For the save_state/restore_state hooks
 #include "event.hpp"
+#include "indicators.hpp" // Rolling signals for strategy code
 #include "interfaces.hpp"
 #include "logger.hpp" // For logging within strategy
 #include "metrics.hpp"
 #include <string>
+#include <algorithm> // For std::find
 #include <memory> // For std::shared_ptr
+#include <vector>
 
 namespace market_replay {
 
+class Dispatcher;
+
+// A contiguous run of queued events handed to IStrategy::on_event_batch, in queue order, each with
+// the arrival timestamp on_event would have been given. Valid only for the duration of the call.
+class StrategyEventBatch {
+public:
+    StrategyEventBatch(const StrategyInputEventVariant* events, const Timestamp* arrival_ts, size_t size)
+        : events_(events), arrival_ts_(arrival_ts), size_(size) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const StrategyInputEventVariant& operator[](size_t i) const { return events_[i]; }
+    Timestamp arrival_ts(size_t i) const { return arrival_ts_[i]; }
+    const StrategyInputEventVariant* begin() const { return events_; }
+    const StrategyInputEventVariant* end() const { return events_ + size_; }
+
+private:
+    const StrategyInputEventVariant* events_;
+    const Timestamp* arrival_ts_;
+    size_t size_;
+};
+
 class IStrategy {
 public:
     friend struct StrategyEventVisitor;
+    friend class Dispatcher; // Assigns strategy_index_
     IStrategy(StrategyId id, 
               IOrderSubmitter* order_submitter, 
               std::shared_ptr<MetricsCollector> metrics_collector)
@@ -23,28 +50,75 @@ public:
          {}
     virtual ~IStrategy() = default;
 
-    // Called once when the strategy thread starts, before event loop
+    // Called once on the dispatcher thread when the run starts, before any event is delivered
     virtual void on_init(Timestamp current_sim_time) {} 
     // Called for each event from the strategy's input queue
     virtual void on_event(const StrategyInputEventVariant& event_variant, Timestamp strategy_arrival_ts) = 0;
+    // How events are grouped into on_event_batch calls (see set_event_batching)
+    enum class EventBatching : uint8_t {
+        NONE,           // on_event per event; on_event_batch is never called
+        SAME_TIMESTAMP, // One call per run of events with the same arrival timestamp
+        DRAINED         // One call per drain of the input queue (up to Dispatcher::kStrategyPopBatchSize)
+    };
+    // Called instead of on_event once the strategy opts into batching. A batch never reaches past
+    // the end of what was drained from the queue, so a run of equal timestamps can come in more
+    // than one call; INLINE strategies get one event per call. Defaults to on_event per event.
+    virtual void on_event_batch(const StrategyEventBatch& batch) {
+        for (size_t i = 0; i < batch.size(); ++i) on_event(batch[i], batch.arrival_ts(i));
+    }
     // Called once when the strategy thread is about to shut down
     virtual void on_shutdown(Timestamp current_sim_time) {}
 
+    // Checkpoint hooks (see Dispatcher::CheckpointConfig). save_state is called on the dispatcher
+    // thread while the strategy is idle, to write whatever it needs to carry on from there;
+    // restore_state reads it back in a run resumed from the checkpoint, after on_init. Timestamps
+    // written with write_timestamp are compact near the checkpoint's sim time. By default nothing
+    // is kept: a resumed strategy starts fresh, apart from its client order ids.
+    virtual void save_state(CheckpointWriter& /*out*/) const {}
+    virtual void restore_state(CheckpointReader& /*in*/) {}
+
     const StrategyId& get_id() const { return id_; }
+    StrategyIndex get_index() const { return strategy_index_; }
+
+    // Market data this strategy is sent. Until it subscribes to a symbol it gets every quote and
+    // trade; from the first subscription on, only those of the symbols it subscribed to. The
+    // dispatcher reads the set once, after on_init.
+    bool subscribes_to_all() const { return subscriptions_.empty(); }
+    const std::vector<SymbolId>& subscriptions() const { return subscriptions_; }
+    EventBatching event_batching() const { return event_batching_; }
 
 protected:
     OrderId get_next_client_order_id() { return next_client_order_id_++; }
+
+    // Call from the constructor or on_init (see subscriptions())
+    void subscribe(SymbolId symbol_id) {
+        if (std::find(subscriptions_.begin(), subscriptions_.end(), symbol_id) == subscriptions_.end()) {
+            subscriptions_.push_back(symbol_id);
+        }
+    }
+    void subscribe(std::string_view symbol) { subscribe(intern_symbol(symbol)); }
+
+    // Opt into on_event_batch. Call from the constructor or on_init.
+    void set_event_batching(EventBatching batching) { event_batching_ = batching; }
+
+    // Top-of-book prices for signal code; see indicators.hpp for the rolling statistics to feed them to
+    static double mid_price(const QuoteEvent& quote) {
+        return indicators::mid_price(quote.get_bid_price(), quote.get_ask_price());
+    }
+    static double microprice(const QuoteEvent& quote) {
+        return indicators::microprice(quote.get_bid_price(), quote.bid_size, quote.get_ask_price(), quote.ask_size);
+    }
     
     // Helper to submit order
-    void submit_order(const std::string& symbol, OrderSide side, OrderType type, Price price, Quantity quantity, Timestamp decision_ts) {
+    void submit_order(SymbolId symbol_id, OrderSide side, OrderType type, Price price, Quantity quantity, Timestamp decision_ts) {
         if (!order_submitter_) {
             LOG_WARN("Strategy {}: Order submitter not set, cannot submit order.", id_);
             return;
         }
         OrderRequest req{
-            id_,
+            strategy_index_,
             get_next_client_order_id(),
-            symbol,
+            symbol_id,
             side,
             type,
             price,
@@ -52,18 +126,24 @@ protected:
             decision_ts // This is critical: when the strategy made the decision.
         };
         LOG_DEBUG("Strategy {}: Submitting order ClientID={}, Symbol={}, Side={}, Type={}, Px={}, Qty={}, DecisionTS={}",
-                  id_, req.client_order_id, req.symbol, (req.side == OrderSide::BUY ? "BUY" : "SELL"),
-                  (req.type == OrderType::LIMIT ? "LIMIT" : "MARKET"), req.price, req.quantity, timestamp_to_string(req.request_timestamp));
+                  id_, req.client_order_id, symbol_name(req.symbol_id), (req.side == OrderSide::BUY ? "BUY" : "SELL"),
+                  (req.type == OrderType::LIMIT ? "LIMIT" : "MARKET"), req.price, req.quantity, log_ts(req.request_timestamp));
         order_submitter_->submit_order_request(std::move(req));
 
         if(metrics_collector_) {
+            if (order_submitted_key_ == MetricsCollector::kNoKey) {
+                order_submitted_key_ = metrics_collector_->intern_key(id_ + "_OrderSubmitted");
+            }
             metrics_collector_->record_latency(
-                id_ + "_OrderSubmitted", 
+                order_submitted_key_,
                 Duration(0), // Latency from what? This is just a marker.
                 decision_ts 
             );
         }
     }
+    void submit_order(std::string_view symbol, OrderSide side, OrderType type, Price price, Quantity quantity, Timestamp decision_ts) {
+        submit_order(intern_symbol(symbol), side, type, price, quantity, decision_ts);
+    }
 
     // Specific handlers, called by on_event after visitation
     virtual void on_quote(const QuoteEvent& quote_event, Timestamp strategy_arrival_ts) = 0;
@@ -73,9 +153,15 @@ protected:
 
 
     StrategyId id_;
+    StrategyIndex strategy_index_ = INVALID_STRATEGY_INDEX; // Set by the Dispatcher before on_init
     IOrderSubmitter* order_submitter_; // Not owned
     std::shared_ptr<MetricsCollector> metrics_collector_; // Optional, shared
     OrderId next_client_order_id_;
+    MetricKey order_submitted_key_ = MetricsCollector::kNoKey; // Interned on the first order
+
+private:
+    std::vector<SymbolId> subscriptions_; // Empty: every symbol
+    EventBatching event_batching_ = EventBatching::NONE;
 };
 
 // Visitor for StrategyInputEventVariant
@@ -85,12 +171,11 @@ struct StrategyEventVisitor {
 
     StrategyEventVisitor(IStrategy& strat, Timestamp ts) : strategy_(strat), arrival_ts_(ts) {}
 
-    // Need to provide const and non-const overloads if unique_ptr content is modified.
-    // Here, we pass const ref of event, so const unique_ptr<T>& is fine.
-    void operator()(const std::unique_ptr<QuoteEvent>& ev) {
+    // Market data handles are shared with every other strategy: handlers only ever see a const ref.
+    void operator()(const SharedEvent<QuoteEvent>& ev) {
         static_cast<IStrategy&>(strategy_).on_quote(*ev, arrival_ts_);
     }
-    void operator()(const std::unique_ptr<TradeEvent>& ev) {
+    void operator()(const SharedEvent<TradeEvent>& ev) {
         static_cast<IStrategy&>(strategy_).on_trade(*ev, arrival_ts_);
     }
     void operator()(const std::unique_ptr<OrderAckEvent>& ev) {
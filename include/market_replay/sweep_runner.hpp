@@ -0,0 +1,68 @@
+#ifndef MARKET_REPLAY_SWEEP_RUNNER_HPP
+#define MARKET_REPLAY_SWEEP_RUNNER_HPP
+
+#include "dispatcher.hpp"
+#include "market_data_buffer.hpp"
+#include "metrics.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace market_replay {
+
+// Runs many independent simulations over one in-memory copy of the tick data, several at a time.
+// Every scenario gets its own Dispatcher, LatencyModel, strategies and MetricsCollector; the only
+// thing shared is the read-only MarketDataBuffer. A summary line is appended to one CSV file as
+// each scenario finishes, so a long sweep can be watched (or salvaged) while it runs.
+class SweepRunner {
+public:
+    struct StrategySpec {
+        StrategyId id;
+        StrategyFactory factory; // Called once per scenario, from the worker thread running it
+        StrategyOptions options;
+    };
+
+    struct Scenario {
+        std::string name; // Unique; used in the summary and for per-run output file names
+        LatencyModel::Config latency;
+        Dispatcher::Config dispatcher;
+        std::vector<StrategySpec> strategies;
+    };
+
+    struct Result {
+        std::string name;
+        bool ok = false;
+        std::string error; // Set if the run threw
+        MetricsSummary metrics;
+        std::map<std::string, LatencyHistogram> latency_histograms; // By source; merge() to pool runs
+        std::chrono::milliseconds wall_time{0};
+    };
+
+    struct Config {
+        size_t num_threads = 0; // Concurrent simulations; 0 means std::thread::hardware_concurrency()
+        std::string summary_path = "sweep_summary.csv";
+        std::string per_run_output_dir; // If set, each run also writes <dir>/<name>_{trades,latency,pnl}.csv
+    };
+
+    explicit SweepRunner(std::shared_ptr<const MarketDataBuffer> data);
+    SweepRunner(std::shared_ptr<const MarketDataBuffer> data, Config config);
+
+    // Blocks until every scenario has run. Results are in scenario order.
+    std::vector<Result> run(const std::vector<Scenario>& scenarios);
+
+private:
+    Result run_scenario(const Scenario& scenario) const;
+    void append_summary_line(std::ofstream& summary, const Scenario& scenario, const Result& result);
+
+    std::shared_ptr<const MarketDataBuffer> data_;
+    Config config_;
+    std::mutex summary_mutex_;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_SWEEP_RUNNER_HPP
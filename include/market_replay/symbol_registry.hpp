@@ -0,0 +1,92 @@
+#ifndef MARKET_REPLAY_SYMBOL_REGISTRY_HPP
+#define MARKET_REPLAY_SYMBOL_REGISTRY_HPP
+
+#include "common.hpp"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility> // For std::pair
+#include <vector>
+
+namespace market_replay {
+
+// Process-wide symbol interning. Ids are dense (0, 1, 2, ...) in first-seen order and never reused,
+// so per-symbol state can live in plain vectors indexed by SymbolId. Names are stored once and
+// references returned by name() stay valid for the lifetime of the process.
+//
+// Thread-safe. intern() only takes the exclusive lock for symbols it has never seen; readers that
+// need to resolve many names should cache the ids (e.g. CsvParser remembers the last symbol it saw).
+//
+// Each symbol also has a tick size, the unit of its PriceTicks. Lookups are lock-free because
+// they sit on the market data path. Configure tick sizes before loading data: prices already
+// converted to ticks are not rescaled. Binary tick files record the tick sizes they were written
+// with and apply them when opened, unless one is configured already.
+class SymbolRegistry {
+public:
+    static SymbolRegistry& instance();
+    ~SymbolRegistry();
+
+    SymbolId intern(std::string_view name);
+    SymbolId find(std::string_view name) const; // INVALID_SYMBOL_ID if never interned
+    const std::string& name(SymbolId id) const; // Returns a shared "<invalid>" string for unknown ids
+    size_t size() const;
+
+    // Returns false (and changes nothing) for unknown ids or a non-positive tick size
+    bool set_tick_size(SymbolId id, Price tick_size);
+    // As set_tick_size, but a tick size already set wins: for the ones recorded in data files
+    bool set_tick_size_if_unset(SymbolId id, Price tick_size);
+    bool has_tick_size(SymbolId id) const; // Set by one of the above, rather than the default
+    Price tick_size(SymbolId id) const { return 1.0 / ticks_per_unit(id); }
+    // 1 / tick size, snapped to a whole number when it is one (0.01 -> 100), so that
+    // converting ticks back with a division is correctly rounded
+    double ticks_per_unit(SymbolId id) const {
+        const size_t chunk = id / kTickChunkSize;
+        if (chunk >= kMaxTickChunks) return kDefaultTicksPerUnit;
+        const std::atomic<double>* values = tick_chunks_[chunk].load(std::memory_order_acquire);
+        return values ? values[id % kTickChunkSize].load(std::memory_order_relaxed) : kDefaultTicksPerUnit;
+    }
+
+private:
+    SymbolRegistry() = default;
+
+    static constexpr double kDefaultTicksPerUnit = 100000.0; // 1 / DEFAULT_TICK_SIZE
+    static constexpr size_t kTickChunkSize = 1024;
+    static constexpr size_t kMaxTickChunks = 1024; // Ids past ~1M keep the default tick size
+
+    mutable std::shared_mutex mtx_;
+    std::deque<std::string> names_; // deque: push_back never moves existing strings
+    std::unordered_map<std::string_view, SymbolId> ids_; // Keys view into names_
+    // Allocated on the first set_tick_size in a chunk (under mtx_) and only freed at exit
+    std::array<std::atomic<std::atomic<double>*>, kMaxTickChunks> tick_chunks_{};
+    std::vector<bool> tick_size_set_; // By SymbolId, under mtx_
+
+    bool store_tick_size(SymbolId id, Price tick_size); // Caller holds mtx_ exclusively
+};
+
+inline SymbolId intern_symbol(std::string_view name) { return SymbolRegistry::instance().intern(name); }
+inline const std::string& symbol_name(SymbolId id) { return SymbolRegistry::instance().name(id); }
+
+// Tick sizes by symbol name, as configured
+using TickSizes = std::vector<std::pair<std::string, Price>>;
+// "EURUSD=0.00001,ES=0.25". Throws std::invalid_argument on a malformed entry.
+TickSizes parse_tick_sizes(std::string_view spec);
+// Interns each symbol and sets its tick size. Throws std::invalid_argument for an invalid size.
+void apply_tick_sizes(const TickSizes& tick_sizes);
+
+// Price <-> tick conversion with the symbol's tick size. NaN maps to INVALID_PRICE_TICKS and back.
+inline PriceTicks to_price_ticks(SymbolId id, Price price) {
+    if (std::isnan(price)) return INVALID_PRICE_TICKS;
+    return static_cast<PriceTicks>(std::llround(price * SymbolRegistry::instance().ticks_per_unit(id)));
+}
+inline Price from_price_ticks(SymbolId id, PriceTicks ticks) {
+    if (ticks == INVALID_PRICE_TICKS) return INVALID_PRICE;
+    return static_cast<Price>(ticks) / SymbolRegistry::instance().ticks_per_unit(id);
+}
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_SYMBOL_REGISTRY_HPP
@@ -0,0 +1,169 @@
+#ifndef MARKET_REPLAY_TICK_FILE_HPP
+#define MARKET_REPLAY_TICK_FILE_HPP
+
+#include "event.hpp"
+#include "interfaces.hpp" // For IMarketDataSource
+#include "utils/mapped_file.hpp"
+#include <algorithm> // For std::min
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace market_replay {
+
+// Compact binary tick format (.mrt). Layout, all little-endian:
+//
+//   FileHeader                        (72 bytes)
+//   TickRecord[record_count]          (48 bytes each, starting at records_offset)
+//   symbol table                      (symbol_count x {uint16 length, bytes, int64 tick_size})
+//   IndexEntry[index_count]           (one every index_stride records: first timestamp -> record index)
+//
+// Prices are fixed-point: price_ticks / price_scale. Symbols are interned to file-local ids. Each
+// symbol's tick size is recorded in price_scale units, 0 if none was configured when the file was
+// written; version 1 files have no tick sizes.
+namespace tick_format {
+
+constexpr char MAGIC[8] = {'M', 'R', 'T', 'I', 'C', 'K', '0', '1'};
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t MIN_VERSION = 1; // Oldest version still read
+constexpr const char* FILE_EXTENSION = ".mrt";
+constexpr int64_t DEFAULT_PRICE_SCALE = 100000000; // 1e-8 resolution
+constexpr uint32_t DEFAULT_INDEX_STRIDE = 4096;
+
+enum class RecordType : uint8_t {
+    QUOTE = 1,
+    TRADE = 2
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+    int64_t price_scale;
+    uint64_t records_offset;
+    uint64_t symbol_table_offset;
+    uint32_t symbol_count;
+    uint32_t index_stride;
+    uint64_t index_offset;
+    uint64_t index_count;
+};
+static_assert(sizeof(FileHeader) == 72, "FileHeader layout is part of the file format");
+
+// QUOTE: price/size are the bid, ask_price/ask_size the ask. TRADE: price/size, ask fields zero.
+struct TickRecord {
+    int64_t timestamp_ns;
+    uint32_t symbol_id;
+    RecordType type;
+    uint8_t reserved[3];
+    int64_t price;
+    uint64_t size;
+    int64_t ask_price;
+    uint64_t ask_size;
+};
+static_assert(sizeof(TickRecord) == 48, "TickRecord layout is part of the file format");
+
+struct IndexEntry {
+    int64_t timestamp_ns;
+    uint64_t record_index;
+};
+static_assert(sizeof(IndexEntry) == 16, "IndexEntry layout is part of the file format");
+
+inline bool has_extension(const std::string& path) {
+    const std::string ext = FILE_EXTENSION;
+    return path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+// File-local symbol ids, as written by both tick file formats: {uint16 length, bytes} per symbol,
+// followed by its tick size in tick_size_scale units when that is non-zero
+class SymbolTableWriter {
+public:
+    uint32_t local_id(SymbolId symbol_id); // Assigns the next id on first use; throws for names over 64 KiB
+    size_t size() const { return symbols_.size(); }
+    uint64_t write(std::ofstream& out, int64_t tick_size_scale = 0) const; // Returns the bytes written
+
+private:
+    std::vector<uint32_t> local_ids_; // Global SymbolId -> file-local id (UINT32_MAX if unused)
+    std::vector<std::string> symbols_; // File-local id -> name
+    std::vector<SymbolId> symbol_ids_; // File-local id -> global SymbolId
+};
+
+// Event <-> record conversion shared by both formats. to_record() takes quotes and trades only;
+// to_event() returns nullptr for an unknown symbol id or record type.
+bool to_record(const BaseEvent& event, int64_t price_scale, SymbolTableWriter& symbols, TickRecord& record);
+std::unique_ptr<BaseEvent> to_event(const TickRecord& record, int64_t price_scale, const std::vector<SymbolId>& symbol_ids);
+
+// Parses `count` entries from [p, end) and interns them. With a tick_size_scale the entries carry
+// tick sizes, which are set on symbols that have none configured. False if the table is truncated.
+bool read_symbol_table(const char* p, const char* end, uint32_t count,
+                       std::vector<std::string>& names, std::vector<SymbolId>& ids, int64_t tick_size_scale = 0);
+
+} // namespace tick_format
+
+// Streams records to disk as they are added, so converting a multi-GB CSV needs no more memory
+// than the symbol table and the sparse index.
+class TickFileWriter {
+public:
+    explicit TickFileWriter(const std::string& filepath,
+                            int64_t price_scale = tick_format::DEFAULT_PRICE_SCALE,
+                            uint32_t index_stride = tick_format::DEFAULT_INDEX_STRIDE);
+    ~TickFileWriter(); // Calls finish() if it hasn't been called
+
+    TickFileWriter(const TickFileWriter&) = delete;
+    TickFileWriter& operator=(const TickFileWriter&) = delete;
+
+    // Accepts QuoteEvent and TradeEvent; returns false for anything else.
+    bool add(const BaseEvent& event);
+    // Writes the symbol table, index and final header. Safe to call more than once.
+    void finish();
+
+    uint64_t record_count() const { return record_count_; }
+
+private:
+    std::string filepath_;
+    std::ofstream out_;
+    int64_t price_scale_;
+    uint32_t index_stride_;
+    uint64_t record_count_ = 0;
+    bool finished_ = false;
+    tick_format::SymbolTableWriter symbols_;
+    std::vector<tick_format::IndexEntry> index_;
+};
+
+// Replays a .mrt file from a single read-only mapping; decoding a record is a handful of loads.
+class TickFileReader : public IMarketDataSource {
+public:
+    explicit TickFileReader(const std::string& filepath); // Throws std::runtime_error on open/format errors
+
+    std::unique_ptr<BaseEvent> read_next_event() override;
+    bool has_more_events() const override { return next_record_ < header_.record_count; }
+
+    uint64_t record_count() const { return header_.record_count; }
+    int64_t price_scale() const { return header_.price_scale; }
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    const tick_format::IndexEntry* index_begin() const { return index_; }
+    const tick_format::IndexEntry* index_end() const { return index_ + header_.index_count; }
+
+    // Positions the reader on the first record with timestamp >= ts (uses the sparse index)
+    void seek_to_timestamp(Timestamp ts);
+
+    // Positions are record numbers
+    bool seekable() const override { return true; }
+    uint64_t position() const override { return next_record_; }
+    void seek(uint64_t position) override { next_record_ = std::min<uint64_t>(position, header_.record_count); }
+
+private:
+    utils::MappedFile file_;
+    tick_format::FileHeader header_{};
+    const tick_format::TickRecord* records_ = nullptr;
+    const tick_format::IndexEntry* index_ = nullptr;
+    std::vector<std::string> symbols_;
+    std::vector<SymbolId> symbol_ids_; // File-local id -> process-wide SymbolId, interned at open
+    uint64_t next_record_ = 0;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_TICK_FILE_HPP
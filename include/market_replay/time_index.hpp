@@ -0,0 +1,148 @@
+#ifndef MARKET_REPLAY_TIME_INDEX_HPP
+#define MARKET_REPLAY_TIME_INDEX_HPP
+
+#include "event.hpp"
+#include "interfaces.hpp" // For IMarketDataSource
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace market_replay {
+
+// Sidecar index over a seekable market data file (CSV, .mrt or .mrtz): one entry every
+// rows_per_entry events holding the source position of its first event, its first and last
+// timestamps, and a bitmap of the symbols in it. Built by one pass over the file and saved next
+// to it as <file>.idx; later runs load it instead, as long as the file's size and modification
+// time still match. Layout, all little-endian:
+//
+//   FileHeader                        (48 bytes)
+//   Entry[entry_count]                (32 bytes each)
+//   uint64 bitmap words               (words_per_entry per entry; bit i = index-local symbol i)
+//   symbol table                      (as in .mrt)
+class TimeIndex {
+public:
+    static constexpr char MAGIC[8] = {'M', 'R', 'T', 'I', 'D', 'X', '0', '1'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* FILE_SUFFIX = ".idx";
+    static constexpr uint32_t DEFAULT_ROWS_PER_ENTRY = 4096;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t rows_per_entry;
+        uint64_t source_size;
+        int64_t source_mtime; // std::filesystem::file_time_type ticks
+        uint64_t entry_count;
+        uint32_t symbol_count;
+        uint32_t words_per_entry;
+    };
+    static_assert(sizeof(FileHeader) == 48, "FileHeader layout is part of the file format");
+
+    struct Entry {
+        int64_t first_timestamp_ns;
+        int64_t last_timestamp_ns;
+        uint64_t position; // source.position() before its first event
+        uint64_t events;
+    };
+    static_assert(sizeof(Entry) == 32, "Entry layout is part of the file format");
+
+    // Reads `source` from where it is to the end; throws std::runtime_error if it isn't seekable.
+    // The source is left exhausted.
+    static TimeIndex build(IMarketDataSource& source, uint32_t rows_per_entry = DEFAULT_ROWS_PER_ENTRY);
+    static TimeIndex load(const std::string& index_path); // Throws std::runtime_error
+    void save(const std::string& index_path) const;       // Throws std::runtime_error
+
+    // The sidecar of source_path if it is up to date and has the requested granularity; otherwise
+    // builds one from `source` (seeking it back to where it was) and tries to save it, logging
+    // rather than failing if the directory is read-only.
+    static std::shared_ptr<const TimeIndex> load_or_build(const std::string& source_path, IMarketDataSource& source,
+                                                          uint32_t rows_per_entry = DEFAULT_ROWS_PER_ENTRY);
+    static std::string sidecar_path(const std::string& source_path) { return source_path + FILE_SUFFIX; }
+
+    const std::vector<Entry>& entries() const { return entries_; }
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    uint32_t rows_per_entry() const { return rows_per_entry_; }
+
+    // First entry a replay starting at ts has to read: the last one starting before ts
+    size_t find(Timestamp ts) const;
+
+    // Bitmap of `symbols` in index-local bits, for intersects(). Symbols the file never has are dropped.
+    std::vector<uint64_t> symbol_mask(const std::vector<SymbolId>& symbols) const;
+    bool intersects(size_t entry, const std::vector<uint64_t>& mask) const {
+        const uint64_t* bits = &bitmaps_[entry * words_per_entry_];
+        for (size_t w = 0; w < mask.size(); ++w) {
+            if (bits[w] & mask[w]) return true;
+        }
+        return false;
+    }
+    bool contains(size_t entry, SymbolId symbol_id) const;
+
+private:
+    bool matches(uint64_t source_size, int64_t source_mtime) const {
+        return source_size_ == source_size && source_mtime_ == source_mtime;
+    }
+
+    uint32_t rows_per_entry_ = DEFAULT_ROWS_PER_ENTRY;
+    uint64_t source_size_ = 0;
+    int64_t source_mtime_ = 0;
+    std::vector<Entry> entries_;
+    size_t words_per_entry_ = 0;
+    std::vector<uint64_t> bitmaps_;   // [entry * words_per_entry_ + word]
+    std::vector<std::string> symbols_; // Index-local bit -> name
+    std::vector<SymbolId> symbol_ids_; // Index-local bit -> process-wide SymbolId
+    std::vector<uint32_t> bits_;       // Process-wide SymbolId -> index-local bit (UINT32_MAX if absent)
+};
+
+// What part of the data to replay. Times are exchange timestamps, both ends inclusive.
+struct ReplayWindow {
+    Timestamp start = Timestamp::min();
+    Timestamp end = Timestamp::max();
+    std::vector<SymbolId> symbols; // Only these symbols' events; empty for all
+    // Seekable files get a TimeIndex sidecar of this granularity, so the prefix before start and
+    // the stretches without any of the symbols are skipped instead of read
+    uint32_t index_rows = TimeIndex::DEFAULT_ROWS_PER_ENTRY;
+    bool use_index = true;
+
+    bool restricted() const { return start != Timestamp::min() || end != Timestamp::max() || !symbols.empty(); }
+};
+
+// The events of `source` that fall in a ReplayWindow, in source order. With an index, the source
+// is seeked straight to the first entry the window needs, and every run of entries holding none
+// of the window's symbols is jumped over; the remaining events are filtered one by one. Without
+// one, the whole source is read and filtered. Reading stops at the first event past the end.
+class WindowedMarketDataSource : public IMarketDataSource {
+public:
+    struct Stats {
+        uint64_t entries_skipped = 0; // Index entries jumped over for their symbols
+        uint64_t events_filtered = 0; // Read but outside the window
+    };
+
+    WindowedMarketDataSource(std::unique_ptr<IMarketDataSource> source, ReplayWindow window,
+                             std::shared_ptr<const TimeIndex> index);
+
+    std::unique_ptr<BaseEvent> read_next_event() override;
+    bool has_more_events() const override { return next_ != nullptr; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::unique_ptr<BaseEvent> fetch(); // The next event in the window, or nullptr once there are none
+    bool wanted(SymbolId symbol_id) const {
+        return window_.symbols.empty() || (symbol_id < wanted_.size() && wanted_[symbol_id]);
+    }
+    bool seek_to_entry(size_t entry); // First entry at or after it with a wanted symbol; false if none in the window
+
+    std::unique_ptr<IMarketDataSource> source_;
+    ReplayWindow window_;
+    std::shared_ptr<const TimeIndex> index_; // Null: filter sequentially
+    std::vector<uint64_t> mask_;             // Window symbols as index bits; empty for all
+    std::vector<bool> wanted_;               // By SymbolId
+    size_t entry_ = 0;                       // Index entry the source is in
+    bool done_ = false;
+    std::unique_ptr<BaseEvent> next_; // Read ahead so has_more_events() is exact
+    Stats stats_;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_TIME_INDEX_HPP
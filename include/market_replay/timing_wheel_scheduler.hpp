@@ -0,0 +1,83 @@
+#ifndef MARKET_REPLAY_TIMING_WHEEL_SCHEDULER_HPP
+#define MARKET_REPLAY_TIMING_WHEEL_SCHEDULER_HPP
+
+#include "event_scheduler.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace market_replay {
+
+// Calendar queue: a ring of fixed-width time buckets covering [cursor, cursor + horizon), backed
+// by an overflow heap for anything beyond the horizon (or behind the cursor). Pushes that land
+// inside the horizon, which is nearly everything the dispatcher schedules (acks and fills tens of
+// microseconds out, the 10 ms order-processing tick), are a bucket append. The next occupied
+// bucket is found with a two-level bitmap scan. Overflow entries migrate into buckets as the cursor
+// advances, so a preloaded file costs one heap pop per event rather than a heap pop per pop.
+//
+// Within a bucket entries are kept sorted by (timestamp, sequence), so the pop order is identical
+// to EventHeap's.
+class TimingWheelScheduler final : public IEventScheduler {
+public:
+    struct Config {
+        Duration bucket_width = std::chrono::microseconds(1);
+        size_t num_buckets = 16384; // Rounded up to a power of two; horizon = bucket_width * num_buckets
+    };
+
+    TimingWheelScheduler();
+    explicit TimingWheelScheduler(Config config);
+
+    void push(std::unique_ptr<BaseEvent> event) override;
+    std::unique_ptr<BaseEvent> pop() override;
+    Timestamp top_timestamp() const override;
+
+    bool empty() const override { return wheel_count_ == 0 && overflow_.empty(); }
+    size_t size() const override { return wheel_count_ + overflow_.size(); }
+    void clear() override;
+
+    size_t num_buckets() const { return num_buckets_; }
+    size_t overflow_size() const { return overflow_.size(); }
+
+private:
+    struct Entry {
+        Timestamp timestamp;
+        uint64_t sequence;
+        std::unique_ptr<BaseEvent> event;
+    };
+    struct Bucket {
+        std::vector<Entry> entries; // Sorted ascending; [head, size) are live
+        size_t head = 0;
+    };
+
+    static bool earlier(const Entry& a, const Entry& b) {
+        if (a.timestamp != b.timestamp) return a.timestamp < b.timestamp;
+        return a.sequence < b.sequence;
+    }
+
+    int64_t tick_of(Timestamp ts) const;
+    bool in_horizon(int64_t tick) const { return tick >= cursor_tick_ && tick < cursor_tick_ + static_cast<int64_t>(num_buckets_); }
+    int64_t tick_of_bucket(size_t bucket) const;
+
+    void insert_into_wheel(Entry entry, int64_t tick);
+    void push_overflow(Entry entry);
+    Entry pop_overflow();
+    void migrate_overflow();
+    size_t first_bucket() const; // Requires wheel_count_ > 0
+    size_t next_occupied_word(size_t from_word) const; // First non-zero occupied_ word at or after from_word, wrapping
+
+    int64_t bucket_width_ns_;
+    size_t num_buckets_;
+    size_t mask_;
+    std::vector<Bucket> buckets_;
+    std::vector<uint64_t> occupied_; // One bit per bucket
+    std::vector<uint64_t> summary_;  // One bit per non-zero occupied_ word, so a scan skips 4096 buckets per load
+    int64_t cursor_tick_ = 0;
+    size_t wheel_count_ = 0;
+    std::vector<Entry> overflow_; // Min-heap on (timestamp, sequence)
+    uint64_t next_sequence_ = 0;
+
+    mutable size_t cached_first_bucket_ = 0;
+    mutable bool first_bucket_valid_ = false;
+};
+
+} // namespace market_replay
+#endif // MARKET_REPLAY_TIMING_WHEEL_SCHEDULER_HPP
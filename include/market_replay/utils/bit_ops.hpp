@@ -0,0 +1,37 @@
+#ifndef MARKET_REPLAY_BIT_OPS_HPP
+#define MARKET_REPLAY_BIT_OPS_HPP
+
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h> // _BitScanForward64, _BitScanReverse64
+#endif
+
+namespace market_replay {
+namespace utils {
+
+// Index of the lowest set bit; value must not be 0
+inline int count_trailing_zeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// Index of the highest set bit, i.e. floor(log2(value)); value must not be 0
+inline int highest_set_bit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+} // namespace utils
+} // namespace market_replay
+
+#endif // MARKET_REPLAY_BIT_OPS_HPP
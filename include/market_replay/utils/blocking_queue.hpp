@@ -1,6 +1,7 @@
 #ifndef MARKET_REPLAY_BLOCKING_QUEUE_HPP
 #define MARKET_REPLAY_BLOCKING_QUEUE_HPP
 
+#include "queue.hpp"
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -11,8 +12,9 @@
 namespace market_replay {
 namespace utils {
 
+// Mutex + condition variable queue. Safe for any number of producers and consumers.
 template <typename T>
-class BlockingQueue {
+class BlockingQueue final : public IQueue<T> {
 public:
     BlockingQueue(size_t max_size = 0) : max_size_(max_size) {} // 0 means unbounded
 
@@ -21,7 +23,7 @@ public:
     BlockingQueue(BlockingQueue&&) = default; 
     BlockingQueue& operator=(BlockingQueue&&) = default;
 
-    void push(T item) {
+    void push(T item) override {
         {
             std::unique_lock<std::mutex> lock(mutex_);
             if (max_size_ > 0) {
@@ -34,7 +36,26 @@ public:
         cv_consumer_.notify_one();
     }
 
-    bool wait_and_pop(T& item) {
+    void push_batch(std::vector<T>& items) override {
+        size_t next = 0;
+        while (next < items.size()) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (max_size_ > 0) {
+                    cv_producer_.wait(lock, [this] { return queue_.size() < max_size_ || shutdown_requested_; });
+                }
+                if (shutdown_requested_) break;
+                // Take as many as fit under one lock acquisition
+                while (next < items.size() && (max_size_ == 0 || queue_.size() < max_size_)) {
+                    queue_.push(std::move(items[next++]));
+                }
+            }
+            cv_consumer_.notify_one();
+        }
+        items.clear();
+    }
+
+    bool wait_and_pop(T& item) override {
         std::unique_lock<std::mutex> lock(mutex_);
         cv_consumer_.wait(lock, [this] { return !queue_.empty() || shutdown_requested_; });
         
@@ -50,7 +71,20 @@ public:
         return false; // Should be covered by shutdown_requested_ check
     }
     
-    std::optional<T> try_pop() {
+    size_t pop_batch(std::vector<T>& out, size_t max_items) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_consumer_.wait(lock, [this] { return !queue_.empty() || shutdown_requested_; });
+        size_t popped = 0;
+        while (popped < max_items && !queue_.empty()) {
+            out.push_back(std::move(queue_.front()));
+            queue_.pop();
+            ++popped;
+        }
+        if (popped > 0) cv_producer_.notify_all();
+        return popped;
+    }
+
+    std::optional<T> try_pop() override {
         std::lock_guard<std::mutex> lock(mutex_);
         if (queue_.empty() || shutdown_requested_) { // Check shutdown_requested_ here too
             return std::nullopt;
@@ -80,17 +114,17 @@ public:
         return false;
     }
 
-    bool empty() const {
+    bool empty() const override {
         std::lock_guard<std::mutex> lock(mutex_);
         return queue_.empty();
     }
 
-    size_t size() const {
+    size_t size() const override {
         std::lock_guard<std::mutex> lock(mutex_);
         return queue_.size();
     }
 
-    void shutdown() {
+    void shutdown() override {
         {
             std::lock_guard<std::mutex> lock(mutex_);
             shutdown_requested_ = true;
@@ -99,7 +133,7 @@ public:
         cv_producer_.notify_all();
     }
 
-    bool is_shutdown() const {
+    bool is_shutdown() const override {
         std::lock_guard<std::mutex> lock(mutex_);
         return shutdown_requested_;
     }
@@ -0,0 +1,90 @@
+#ifndef MARKET_REPLAY_FIELD_PARSERS_HPP
+#define MARKET_REPLAY_FIELD_PARSERS_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+// Allocation-free, locale-independent parsers for the numeric fields in tick files.
+// All of them return false (and leave `out` untouched) unless the whole field is consumed.
+namespace market_replay {
+namespace utils {
+
+inline bool parse_int64(std::string_view field, int64_t& out) {
+    if (field.empty()) return false;
+    const char* first = field.data();
+    if (*first == '+') ++first; // from_chars doesn't accept a leading '+'
+    auto [ptr, ec] = std::from_chars(first, field.data() + field.size(), out);
+    return ec == std::errc() && ptr == field.data() + field.size();
+}
+
+inline bool parse_uint64(std::string_view field, uint64_t& out) {
+    if (field.empty()) return false;
+    auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), out);
+    return ec == std::errc() && ptr == field.data() + field.size();
+}
+
+// Plain decimals ("-12.3450") go through an exact integer-mantissa path: for up to 15 significant
+// digits mantissa / 10^k is correctly rounded, so the result matches std::stod bit for bit.
+// Anything else (exponents, very long mantissas) falls back to strtod on a bounded copy.
+inline bool parse_decimal(std::string_view field, double& out) {
+    static constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (field.empty()) return false;
+
+    const char* p = field.data();
+    const char* end = p + field.size();
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction_digits = 0;
+    bool seen_point = false;
+    bool simple = true;
+    for (; p < end; ++p) {
+        const char c = *p;
+        if (c >= '0' && c <= '9') {
+            if (digits == 0 && c == '0' && !seen_point) continue; // Leading zeros don't count towards precision
+            mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+            ++digits;
+            if (seen_point) ++fraction_digits;
+        } else if (c == '.' && !seen_point) {
+            seen_point = true;
+        } else {
+            simple = false;
+            break;
+        }
+    }
+    // Reject "", "-", "." and friends; they'd slip through the digit loop above.
+    if (simple && p == end && field.find_first_of("0123456789") != std::string_view::npos) {
+        if (digits > 15 || fraction_digits > 22) {
+            simple = false;
+        } else {
+            const double value = static_cast<double>(mantissa) / kPow10[fraction_digits];
+            out = negative ? -value : value;
+            return true;
+        }
+    }
+    if (simple) return false;
+
+    char buffer[64];
+    if (field.size() >= sizeof(buffer)) return false;
+    std::memcpy(buffer, field.data(), field.size());
+    buffer[field.size()] = '\0';
+    char* parse_end = nullptr;
+    const double value = std::strtod(buffer, &parse_end);
+    if (parse_end != buffer + field.size()) return false;
+    out = value;
+    return true;
+}
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_FIELD_PARSERS_HPP
@@ -0,0 +1,66 @@
+#ifndef MARKET_REPLAY_LOSER_TREE_HPP
+#define MARKET_REPLAY_LOSER_TREE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace market_replay {
+namespace utils {
+
+// Tournament tree of losers over k keys, for k-way merging. Each internal node keeps the index of
+// the loser of the match played there and the overall winner sits on top, so replacing the
+// winner's key replays one leaf-to-root path: log2(k) comparisons, each against a single stored
+// loser rather than both children as a heap does. Keys must be totally ordered by Less; make them
+// unique (e.g. append the leaf index) for a stable merge.
+template <typename Key, typename Less = std::less<Key>>
+class LoserTree {
+public:
+    LoserTree() = default;
+    explicit LoserTree(std::vector<Key> keys, Less less = Less()) : less_(std::move(less)) { reset(std::move(keys)); }
+
+    void reset(std::vector<Key> keys) {
+        keys_ = std::move(keys);
+        const size_t k = keys_.size();
+        nodes_.assign(k == 0 ? 1 : k, 0);
+        if (k < 2) return;
+        // Play the initial tournament bottom-up; leaves are the virtual nodes k .. 2k-1
+        std::vector<size_t> winners(2 * k);
+        for (size_t i = 0; i < k; ++i) winners[k + i] = i;
+        for (size_t node = k - 1; node >= 1; --node) {
+            const size_t a = winners[2 * node];
+            const size_t b = winners[2 * node + 1];
+            const bool b_wins = less_(keys_[b], keys_[a]);
+            winners[node] = b_wins ? b : a;
+            nodes_[node] = b_wins ? a : b;
+        }
+        nodes_[0] = winners[1];
+    }
+
+    size_t size() const { return keys_.size(); }
+    bool empty() const { return keys_.empty(); }
+    size_t winner() const { return nodes_[0]; } // Requires !empty()
+    const Key& winner_key() const { return keys_[nodes_[0]]; }
+    const Key& key(size_t leaf) const { return keys_[leaf]; }
+
+    // Gives the current winner a new key (its next element, or a sentinel once it runs dry) and
+    // replays its path to the root
+    void replace_winner(Key key) {
+        size_t winner = nodes_[0];
+        keys_[winner] = std::move(key);
+        for (size_t node = (winner + keys_.size()) / 2; node >= 1; node /= 2) {
+            if (less_(keys_[nodes_[node]], keys_[winner])) std::swap(nodes_[node], winner);
+        }
+        nodes_[0] = winner;
+    }
+
+private:
+    std::vector<Key> keys_;    // By leaf
+    std::vector<size_t> nodes_; // [0] the winner, [1, k) the loser of each internal match
+    Less less_;
+};
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_LOSER_TREE_HPP
@@ -0,0 +1,44 @@
+#ifndef MARKET_REPLAY_MAPPED_FILE_HPP
+#define MARKET_REPLAY_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace market_replay {
+namespace utils {
+
+// Read-only view of a whole file. Uses mmap where available and falls back to reading the
+// file into memory otherwise, so callers can always treat the contents as one contiguous buffer.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filepath); // Throws std::runtime_error if the file can't be opened
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+    const std::string& path() const { return path_; }
+
+    // Hint that the mapping will be read front to back (no-op without madvise)
+    void advise_sequential() const;
+
+private:
+    std::string path_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool is_mapped_ = false;         // true if data_ came from mmap and must be munmap'd
+    std::vector<char> fallback_buffer_; // Owns the contents when mmap isn't available
+
+    void release();
+};
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_MAPPED_FILE_HPP
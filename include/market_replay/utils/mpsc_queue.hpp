@@ -0,0 +1,85 @@
+#ifndef MARKET_REPLAY_MPSC_QUEUE_HPP
+#define MARKET_REPLAY_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <vector>
+
+namespace market_replay {
+namespace utils {
+
+// Unbounded lock-free multi-producer/single-consumer queue. Producers push onto an intrusive
+// stack with one CAS; the consumer takes everything at once with a single exchange and
+// restores push order. There is no per-item consumer operation, so the only shared cache line
+// is the stack head.
+//
+// Ordering: items from one producer come out in the order that producer pushed them; items from
+// different producers come out in the order their pushes linearized.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    ~MpscQueue() { free_list(head_.exchange(nullptr, std::memory_order_acquire)); }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread. Dropped if the queue has been shut down.
+    void push(T item) {
+        if (shutdown_.load(std::memory_order_relaxed)) return;
+        Node* node = new Node{std::move(item), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    // Consumer thread only. Appends every queued item to out in FIFO order; returns how many.
+    size_t drain(std::vector<T>& out) {
+        Node* list = head_.exchange(nullptr, std::memory_order_acquire);
+        if (!list) return 0;
+        // The stack is newest-first; reverse it in place
+        Node* fifo = nullptr;
+        size_t count = 0;
+        while (list) {
+            Node* next = list->next;
+            list->next = fifo;
+            fifo = list;
+            list = next;
+            ++count;
+        }
+        out.reserve(out.size() + count);
+        while (fifo) {
+            Node* next = fifo->next;
+            out.push_back(std::move(fifo->value));
+            delete fifo;
+            fifo = next;
+        }
+        return count;
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+    void shutdown() { shutdown_.store(true, std::memory_order_release); }
+    bool is_shutdown() const { return shutdown_.load(std::memory_order_acquire); }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    static void free_list(Node* node) {
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    std::atomic<Node*> head_{nullptr};
+    std::atomic<bool> shutdown_{false};
+};
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_MPSC_QUEUE_HPP
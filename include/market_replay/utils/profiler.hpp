@@ -0,0 +1,189 @@
+#ifndef MARKET_REPLAY_PROFILER_HPP
+#define MARKET_REPLAY_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+namespace market_replay {
+namespace utils {
+
+// The hot-path stages the profiler times
+enum class ProfileStage : uint8_t {
+    PARSE,             // Reading one event off the data source
+    MEPQ_PUSH,
+    MEPQ_POP,
+    BOOK_UPDATE,       // Applying a tick to its book, resting fills included
+    FAN_OUT,           // Handing a tick to every strategy subscribed to it
+    QUEUE_WAIT,        // A THREADED strategy blocked on its empty queue
+    STRATEGY_ON_EVENT,
+    ORDER_LIFECYCLE,   // Simulating one order request against its book
+    COUNT
+};
+const char* profile_stage_name(ProfileStage stage);
+
+// The TSC on x86, steady_clock nanoseconds elsewhere. Only turned into time when reported.
+inline uint64_t profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Process-wide stage timer. Each thread accumulates a count, total and maximum per stage in a
+// slot of its own, so the hot path takes no lock and shares no cache line; the slots (those of
+// threads that have exited included) are merged when the session stops. With a trace path, every
+// timed scope and counter sample is also appended to the thread's buffer, up to max_trace_events
+// per thread, and written on stop() as Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+// A stage timed inside another counts towards both.
+//
+// Instrumentation goes through the MR_PROFILE_* macros below, which expand to nothing unless the
+// build defines MARKET_REPLAY_PROFILING (ENABLE_PROFILING). Compiled in but not started, a scope
+// costs one relaxed load. One session at a time: start() and stop() must not race timed threads.
+class Profiler {
+public:
+    struct Config {
+        bool enabled = false;              // Read by the Dispatcher: run() starts and stops a session
+        std::string trace_path;            // Empty for the summary only
+        size_t max_trace_events = 1 << 20; // Per thread; later ones are dropped, and counted
+    };
+
+    struct StageStats {
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+        uint64_t mean_ns() const { return count ? total_ns / count : 0; }
+    };
+    struct Summary {
+        std::array<StageStats, static_cast<size_t>(ProfileStage::COUNT)> stages;
+        uint64_t wall_ns = 0;             // start() to stop()
+        uint64_t trace_events = 0;        // Written to the trace
+        uint64_t trace_events_dropped = 0;
+        const StageStats& operator[](ProfileStage stage) const { return stages[static_cast<size_t>(stage)]; }
+    };
+
+    // Throws std::runtime_error if a session is already running
+    static void start(const Config& config);
+    // Ends the session, writes the trace if one was asked for (throws std::runtime_error if it
+    // can't be), and returns the merged stats
+    static Summary stop();
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static bool tracing() { return tracing_.load(std::memory_order_relaxed); }
+
+    static void record(ProfileStage stage, uint64_t begin_ticks, uint64_t end_ticks) {
+        ThreadSlot& slot = this_thread_slot();
+        StageTicks& stats = slot.stages[static_cast<size_t>(stage)];
+        const uint64_t elapsed = end_ticks - begin_ticks;
+        stats.count++;
+        stats.total += elapsed;
+        if (elapsed > stats.max) stats.max = elapsed;
+        if (tracing()) append_trace(slot, {begin_ticks, elapsed, nullptr, stage});
+    }
+    // A sample of a value over time (e.g. a queue depth), kept for the trace only. `name` is held
+    // by pointer and must stay valid until stop().
+    static void record_counter(const char* name, int64_t value) {
+        append_trace(this_thread_slot(), {profile_ticks(), static_cast<uint64_t>(value), name, ProfileStage::COUNT});
+    }
+    // Labels the calling thread's track in the trace
+    static void name_this_thread(std::string name) { this_thread_slot().name = std::move(name); }
+
+    // Stage, count, total, mean and max, one line per stage that ran
+    static void write_summary(std::ostream& out, const Summary& summary);
+    static void log_summary(const Summary& summary);
+
+private:
+    struct StageTicks {
+        uint64_t count = 0;
+        uint64_t total = 0;
+        uint64_t max = 0;
+    };
+    struct TraceRecord {
+        uint64_t begin;
+        uint64_t value;      // Duration in ticks for a stage; the sample for a counter
+        const char* counter; // Null for a stage
+        ProfileStage stage;
+    };
+    struct ThreadSlot {
+        std::array<StageTicks, static_cast<size_t>(ProfileStage::COUNT)> stages{};
+        std::vector<TraceRecord> trace;
+        uint64_t dropped = 0;
+        uint32_t thread_id = 0;
+        std::string name;
+        std::atomic<bool> retired{false}; // Its thread has exited; freed by the next start()
+    };
+
+    struct SlotHandle {
+        ThreadSlot* slot;
+        ~SlotHandle() { slot->retired.store(true, std::memory_order_release); }
+    };
+    static ThreadSlot& this_thread_slot() {
+        thread_local SlotHandle handle{register_thread()};
+        return *handle.slot;
+    }
+    static ThreadSlot* register_thread();
+    struct Session; // Slot registry and session clocks, in profiler.cpp
+    static Session& session();
+    static void append_trace(ThreadSlot& slot, const TraceRecord& record) {
+        if (slot.trace.size() < max_trace_events_.load(std::memory_order_relaxed)) {
+            slot.trace.push_back(record);
+        } else {
+            slot.dropped++;
+        }
+    }
+
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<bool> tracing_{false};
+    static inline std::atomic<size_t> max_trace_events_{0};
+};
+
+// Times its own lifetime as one `stage`, if the profiler is running when it is constructed
+class ScopedProfile {
+public:
+    explicit ScopedProfile(ProfileStage stage)
+        : stage_(stage), active_(Profiler::enabled()), begin_(active_ ? profile_ticks() : 0) {}
+    ~ScopedProfile() {
+        if (active_) Profiler::record(stage_, begin_, profile_ticks());
+    }
+    ScopedProfile(const ScopedProfile&) = delete;
+    ScopedProfile& operator=(const ScopedProfile&) = delete;
+
+private:
+    ProfileStage stage_;
+    bool active_;
+    uint64_t begin_;
+};
+
+} // namespace utils
+} // namespace market_replay
+
+#ifdef MARKET_REPLAY_PROFILING
+#define MR_PROFILE_CONCAT_INNER(a, b) a##b
+#define MR_PROFILE_CONCAT(a, b) MR_PROFILE_CONCAT_INNER(a, b)
+// Times the rest of the enclosing block as ProfileStage::stage
+#define MR_PROFILE_SCOPE(stage) \
+    ::market_replay::utils::ScopedProfile MR_PROFILE_CONCAT(mr_profile_scope_, __LINE__)(::market_replay::utils::ProfileStage::stage)
+// Samples a counter into the trace; `value` is only evaluated while tracing
+#define MR_PROFILE_COUNTER(name, value) \
+    do { \
+        if (::market_replay::utils::Profiler::tracing()) \
+            ::market_replay::utils::Profiler::record_counter((name), static_cast<int64_t>(value)); \
+    } while (0)
+#define MR_PROFILE_THREAD_NAME(name) \
+    do { \
+        if (::market_replay::utils::Profiler::tracing()) ::market_replay::utils::Profiler::name_this_thread(name); \
+    } while (0)
+#else
+#define MR_PROFILE_SCOPE(stage) ((void)0)
+#define MR_PROFILE_COUNTER(name, value) ((void)0)
+#define MR_PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // MARKET_REPLAY_PROFILER_HPP
@@ -0,0 +1,36 @@
+#ifndef MARKET_REPLAY_QUEUE_HPP
+#define MARKET_REPLAY_QUEUE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace market_replay {
+namespace utils {
+
+// Common interface for the queues that feed strategy threads, so the channel implementation
+// can be chosen per strategy. Shutdown semantics are shared by every implementation:
+// push() after shutdown() drops the item, wait_and_pop()/pop_batch() keep draining what was
+// queued before shutdown and only then report false/0, try_pop() returns nullopt once shut down.
+template <typename T>
+class IQueue {
+public:
+    virtual ~IQueue() = default;
+
+    virtual void push(T item) = 0;
+    virtual void push_batch(std::vector<T>& items) = 0; // Moves every item in; items is left cleared
+    virtual bool wait_and_pop(T& item) = 0;
+    // Blocks until at least one item is available, then appends up to max_items to out.
+    // Returns the number appended (0 only on shutdown with nothing left).
+    virtual size_t pop_batch(std::vector<T>& out, size_t max_items) = 0;
+    virtual std::optional<T> try_pop() = 0;
+
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+    virtual void shutdown() = 0;
+    virtual bool is_shutdown() const = 0;
+};
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_QUEUE_HPP
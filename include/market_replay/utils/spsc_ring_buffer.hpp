@@ -0,0 +1,250 @@
+#ifndef MARKET_REPLAY_SPSC_RING_BUFFER_HPP
+#define MARKET_REPLAY_SPSC_RING_BUFFER_HPP
+
+#include "queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace market_replay {
+namespace utils {
+
+inline constexpr size_t kCacheLineSize = 64;
+
+// What a side of the ring does while it has nothing to do (consumer: empty, producer: full)
+enum class WaitPolicy : uint8_t {
+    BUSY_SPIN, // Pause-instruction spin. Lowest wake-up latency, burns a core per waiting side.
+    YIELD,     // std::this_thread::yield() between polls
+    PARK       // Spin briefly, then sleep on a condition variable until the other side signals
+};
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Bounded lock-free single-producer/single-consumer ring. Exactly one thread may push and exactly
+// one (other) thread may pop; shutdown()/is_shutdown()/size() may be called from anywhere.
+// Capacity is rounded up to a power of two. Head and tail live on separate cache lines and each
+// side keeps a cached copy of the other's index, so the shared lines are only touched when the
+// cached view says the ring is full/empty.
+template <typename T>
+class SpscRingBuffer final : public IQueue<T> {
+public:
+    explicit SpscRingBuffer(size_t capacity, WaitPolicy policy = WaitPolicy::PARK)
+        : capacity_(round_up_pow2(capacity)), mask_(capacity_ - 1), slots_(capacity_), policy_(policy) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // --- Producer side ---
+
+    void push(T item) override {
+        if (shutdown_.load(std::memory_order_relaxed)) return; // Don't push if shutting down
+        const size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (wait_for_space(tail) == 0) return;
+        slots_[tail & mask_] = std::move(item);
+        publish_tail(tail + 1);
+    }
+
+    void push_batch(std::vector<T>& items) override {
+        size_t next = 0;
+        while (next < items.size() && !shutdown_.load(std::memory_order_relaxed)) {
+            const size_t tail = producer_.tail.load(std::memory_order_relaxed);
+            size_t free_slots = wait_for_space(tail);
+            if (free_slots == 0) break;
+            size_t n = std::min(free_slots, items.size() - next);
+            for (size_t i = 0; i < n; ++i) {
+                slots_[(tail + i) & mask_] = std::move(items[next + i]);
+            }
+            next += n;
+            publish_tail(tail + n); // One release store (and at most one wake-up) per chunk
+        }
+        items.clear();
+    }
+
+    // --- Consumer side ---
+
+    bool wait_and_pop(T& item) override {
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (wait_for_items(head) == 0) return false;
+        item = std::move(slots_[head & mask_]);
+        publish_head(head + 1);
+        return true;
+    }
+
+    size_t pop_batch(std::vector<T>& out, size_t max_items) override {
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        size_t n = std::min(wait_for_items(head), max_items);
+        for (size_t i = 0; i < n; ++i) {
+            out.push_back(std::move(slots_[(head + i) & mask_]));
+        }
+        if (n > 0) publish_head(head + n);
+        return n;
+    }
+
+    std::optional<T> try_pop() override {
+        if (shutdown_.load(std::memory_order_acquire)) return std::nullopt;
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (consumer_.cached_tail == head) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (consumer_.cached_tail == head) return std::nullopt;
+        }
+        T item = std::move(slots_[head & mask_]);
+        publish_head(head + 1);
+        return item;
+    }
+
+    // --- Any thread ---
+
+    bool empty() const override { return size() == 0; }
+
+    size_t size() const override {
+        const size_t head = consumer_.head.load(std::memory_order_acquire); // Head first: tail can only be ahead of it
+        const size_t tail = producer_.tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t capacity() const { return capacity_; }
+    WaitPolicy wait_policy() const { return policy_; }
+
+    void shutdown() override {
+        shutdown_.store(true, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_); // Serialize with a side that is about to park
+        }
+        consumer_cv_.notify_all();
+        producer_cv_.notify_all();
+    }
+
+    bool is_shutdown() const override { return shutdown_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr unsigned kSpinsBeforePark = 256;
+
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    // Returns the number of free slots (>= 1), or 0 if shut down while waiting
+    size_t wait_for_space(size_t tail) {
+        size_t free_slots = capacity_ - (tail - producer_.cached_head);
+        if (free_slots > 0) return free_slots;
+        unsigned spins = 0;
+        for (;;) {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            free_slots = capacity_ - (tail - producer_.cached_head);
+            if (free_slots > 0) return free_slots;
+            if (shutdown_.load(std::memory_order_acquire)) return 0;
+            idle(spins, producer_waiting_, producer_cv_, [this, tail] {
+                return tail - consumer_.head.load(std::memory_order_acquire) < capacity_;
+            });
+        }
+    }
+
+    // Returns the number of readable items (>= 1), or 0 if shut down and fully drained
+    size_t wait_for_items(size_t head) {
+        size_t available = consumer_.cached_tail - head;
+        if (available > 0) return available;
+        unsigned spins = 0;
+        for (;;) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            available = consumer_.cached_tail - head;
+            if (available > 0) return available;
+            if (shutdown_.load(std::memory_order_acquire)) {
+                // Items pushed before shutdown() are still delivered
+                consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+                return consumer_.cached_tail - head;
+            }
+            idle(spins, consumer_waiting_, consumer_cv_, [this, head] {
+                return producer_.tail.load(std::memory_order_acquire) != head;
+            });
+        }
+    }
+
+    template <typename Ready>
+    void idle(unsigned& spins, std::atomic<bool>& waiting, std::condition_variable& cv, Ready ready) {
+        switch (policy_) {
+            case WaitPolicy::BUSY_SPIN:
+                cpu_relax();
+                return;
+            case WaitPolicy::YIELD:
+                std::this_thread::yield();
+                return;
+            case WaitPolicy::PARK: {
+                if (++spins < kSpinsBeforePark) {
+                    cpu_relax();
+                    return;
+                }
+                spins = 0;
+                std::unique_lock<std::mutex> lock(park_mutex_);
+                waiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in wake()
+                cv.wait(lock, [&] { return ready() || shutdown_.load(std::memory_order_acquire); });
+                waiting.store(false, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    void wake(std::atomic<bool>& waiting, std::condition_variable& cv) {
+        if (policy_ != WaitPolicy::PARK) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Index store before the waiting-flag load
+        if (waiting.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> lock(park_mutex_);
+            }
+            cv.notify_one();
+        }
+    }
+
+    void publish_tail(size_t new_tail) {
+        producer_.tail.store(new_tail, std::memory_order_release);
+        wake(consumer_waiting_, consumer_cv_);
+    }
+
+    void publish_head(size_t new_head) {
+        consumer_.head.store(new_head, std::memory_order_release);
+        wake(producer_waiting_, producer_cv_);
+    }
+
+    // Written by the producer, read by the consumer
+    struct alignas(kCacheLineSize) ProducerState {
+        std::atomic<size_t> tail{0};
+        size_t cached_head = 0; // Producer's last view of consumer_.head
+    };
+    // Written by the consumer, read by the producer
+    struct alignas(kCacheLineSize) ConsumerState {
+        std::atomic<size_t> head{0};
+        size_t cached_tail = 0; // Consumer's last view of producer_.tail
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::vector<T> slots_;
+    const WaitPolicy policy_;
+
+    ProducerState producer_;
+    ConsumerState consumer_;
+
+    // Cold path: only used by PARK and shutdown
+    alignas(kCacheLineSize) std::atomic<bool> shutdown_{false};
+    std::atomic<bool> consumer_waiting_{false};
+    std::atomic<bool> producer_waiting_{false};
+    std::mutex park_mutex_;
+    std::condition_variable consumer_cv_;
+    std::condition_variable producer_cv_;
+};
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_SPSC_RING_BUFFER_HPP
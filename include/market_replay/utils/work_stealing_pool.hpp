@@ -0,0 +1,66 @@
+#ifndef MARKET_REPLAY_WORK_STEALING_POOL_HPP
+#define MARKET_REPLAY_WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace market_replay {
+namespace utils {
+
+// Fixed-size thread pool with one task deque per worker. A task submitted from a worker goes on
+// that worker's own deque, one submitted from outside is spread round-robin. Workers take their
+// own tasks oldest first, so a task that keeps resubmitting itself (a strategy draining its
+// mailbox a batch at a time) cannot starve the others queued behind it; an idle worker steals
+// the newest task from a busy one. Workers sleep only when no deque has anything left.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0; // Executed by a worker other than the one it was queued on
+    };
+
+    explicit WorkStealingPool(size_t num_threads); // 0 means std::thread::hardware_concurrency()
+    ~WorkStealingPool(); // Runs every task already submitted, then joins the workers
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task); // Any thread, including from inside a task
+    size_t size() const { return workers_.size(); }
+    Stats stats() const;
+
+private:
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks; // Owner pops the front, thieves the back
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+    };
+
+    void worker_loop(size_t index);
+    bool pop_local(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_worker_{0}; // Round-robin target for outside submissions
+    std::atomic<size_t> queued_{0};      // Submitted but not yet taken, over all deques
+    std::atomic<size_t> sleepers_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stopping_ = false; // Guarded by sleep_mutex_
+};
+
+} // namespace utils
+} // namespace market_replay
+#endif // MARKET_REPLAY_WORK_STEALING_POOL_HPP
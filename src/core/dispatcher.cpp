@@ -1,6 +1,7 @@
 #include "market_replay/dispatcher.hpp"
 #include "market_replay/logger.hpp"
-#include <algorithm> // For std::find_if
+#include <algorithm> // For std::find, std::find_if, std::sort
+#include <tuple>     // For std::tie
 #include <chrono>    // For std::this_thread::sleep_for
 
 // Forward declare the factory from basic_strategy.cpp (or other strategy files)
@@ -13,14 +14,79 @@ namespace market_replay {
 
 namespace market_replay {
 
+namespace {
+
+int64_t steady_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The timestamp a queued event is delivered with; Timestamp::min() for an empty handle
+Timestamp effective_timestamp_of(const StrategyInputEventVariant& event) {
+    static_assert(std::variant_size_v<StrategyInputEventVariant> == 4, "One case per alternative");
+    const BaseEvent* base = nullptr;
+    switch (event.index()) {
+        case 0: base = std::get<0>(event).get(); break;
+        case 1: base = std::get<1>(event).get(); break;
+        case 2: base = std::get<2>(event).get(); break;
+        case 3: base = std::get<3>(event).get(); break;
+    }
+    return base ? base->get_effective_timestamp() : Timestamp::min();
+}
+
+} // namespace
+
 Dispatcher::Dispatcher(std::string historical_data_path,
                        LatencyModel::Config latency_config,
                        std::shared_ptr<MetricsCollector> metrics_collector)
+    : Dispatcher(std::move(historical_data_path), latency_config, std::move(metrics_collector), Config{}) {}
+
+Dispatcher::Dispatcher(std::string historical_data_path,
+                       LatencyModel::Config latency_config,
+                       std::shared_ptr<MetricsCollector> metrics_collector,
+                       Config dispatcher_config)
     : historical_data_path_(std::move(historical_data_path)),
+      config_(dispatcher_config),
       latency_model_(latency_config),
       metrics_collector_(metrics_collector),
+      pnl_engine_(dispatcher_config.pnl),
       current_simulation_time_(Timestamp::min()) { // Initialize to a very early time
-    LOG_INFO("Dispatcher: Initialized. Data: {}, Latency configured.", historical_data_path_);
+    if (config_.market_data_window_size == 0) {
+        config_.market_data_window_size = 1; // Need at least one event of look-ahead to merge with the MEPQ
+    }
+    if (config_.num_shards == 0) {
+        config_.num_shards = 1;
+    }
+    apply_tick_sizes(config_.tick_sizes);
+    if (config_.scheduler == SchedulerType::TIMING_WHEEL) {
+        main_event_pq_ = std::make_unique<TimingWheelScheduler>(config_.timing_wheel);
+    } else {
+        main_event_pq_ = std::make_unique<EventHeap>();
+    }
+    exchange_.scheduler = main_event_pq_.get();
+    if (config_.num_shards > 1 && config_.checkpoints.enabled()) {
+        LOG_WARN("Dispatcher: Checkpoints need num_shards == 1; none will be taken.");
+        config_.checkpoints = CheckpointConfig{};
+    }
+    LOG_INFO("Dispatcher: Initialized. Data: {}, Latency configured, Ingestion: {}, Scheduler: {}, Shards: {}.", historical_data_path_,
+             config_.ingestion_mode == IngestionMode::STREAMING ? "STREAMING" : "PRELOAD",
+             config_.scheduler == SchedulerType::TIMING_WHEEL ? "TIMING_WHEEL" : "HEAP", config_.num_shards);
+}
+
+Dispatcher::Dispatcher(std::vector<std::string> historical_data_paths,
+                       LatencyModel::Config latency_config,
+                       std::shared_ptr<MetricsCollector> metrics_collector,
+                       Config dispatcher_config)
+    : Dispatcher("<" + std::to_string(historical_data_paths.size()) + " files>", latency_config,
+                 std::move(metrics_collector), dispatcher_config) {
+    historical_data_paths_ = std::move(historical_data_paths);
+}
+
+Dispatcher::Dispatcher(std::unique_ptr<IMarketDataSource> data_source,
+                       LatencyModel::Config latency_config,
+                       std::shared_ptr<MetricsCollector> metrics_collector,
+                       Config dispatcher_config)
+    : Dispatcher("<in-memory>", latency_config, std::move(metrics_collector), dispatcher_config) {
+    data_source_ = std::move(data_source);
 }
 
 Dispatcher::~Dispatcher() {
@@ -28,6 +94,8 @@ Dispatcher::~Dispatcher() {
     if (simulation_running_.load()) {
         simulation_running_.store(false); // Signal threads
     }
+    stop_shard_threads(); // Only still running if run() was left by an exception
+    strategy_pool_.reset(); // Lets any strategy task still queued drain its mailbox before the queues go
     // Shutdown queues to unblock threads
     incoming_order_requests_.shutdown();
     for (auto& runner : strategy_runners_) {
@@ -41,12 +109,19 @@ Dispatcher::~Dispatcher() {
     LOG_INFO("Dispatcher: All threads joined. Shutdown complete.");
 }
 
-void Dispatcher::add_strategy(const StrategyId& id, StrategyFactory factory) {
+void Dispatcher::add_strategy(const StrategyId& id, StrategyFactory factory, StrategyOptions options) {
     if (simulation_running_.load()) {
         LOG_ERROR("Dispatcher: Cannot add strategy while simulation is running.");
         return;
     }
-    auto input_queue = std::make_unique<utils::BlockingQueue<StrategyInputEventVariant>>(10000); // Bounded queue
+    std::unique_ptr<utils::IQueue<StrategyInputEventVariant>> input_queue;
+    if (inline_strategies()) {
+        // Called directly from the dispatcher thread, no channel needed
+    } else if (options.queue_type == StrategyOptions::QueueType::SPSC_RING) {
+        input_queue = std::make_unique<utils::SpscRingBuffer<StrategyInputEventVariant>>(options.queue_capacity, options.wait_policy);
+    } else {
+        input_queue = std::make_unique<utils::BlockingQueue<StrategyInputEventVariant>>(options.queue_capacity); // Bounded queue
+    }
     
     // The factory creates the strategy instance
     auto strategy_instance = factory(id, this, metrics_collector_);
@@ -55,8 +130,22 @@ void Dispatcher::add_strategy(const StrategyId& id, StrategyFactory factory) {
         return;
     }
 
-    strategy_runners_.emplace_back(id, std::move(strategy_instance), std::move(input_queue));
-    strategy_map_[id] = &strategy_runners_.back();
+    const auto index = static_cast<StrategyIndex>(strategy_runners_.size());
+    strategy_instance->strategy_index_ = index;
+    for (const auto& symbol : options.symbols) strategy_instance->subscribe(symbol);
+    strategy_runners_.emplace_back(id, index, std::move(strategy_instance), std::move(input_queue));
+    if (metrics_collector_) {
+        strategy_runners_.back().fill_latency_key = metrics_collector_->intern_key(id + "_OrderFillAckLatency");
+    }
+    if (config_.measure_delivery_latency && strategy_runners_.back().input_queue) {
+        // Up to a full queue (at most twice queue_capacity once rounded up) plus a batch taken
+        // but not yet run can be outstanding
+        size_t ring = 1;
+        while (ring < 2 * (options.queue_capacity + kStrategyPopBatchSize)) ring <<= 1;
+        auto delivery = std::make_unique<DeliveryLatency>();
+        delivery->queued_ns.resize(ring);
+        strategy_runners_.back().delivery = std::move(delivery);
+    }
     LOG_INFO("Dispatcher: Added strategy '{}'", id);
 }
 
@@ -67,25 +156,61 @@ void Dispatcher::strategy_thread_loop(StrategyRunner* runner) {
         return;
     }
 
-    runner->strategy_instance->on_init(current_simulation_time_); // Pass current dispatcher time
+    std::vector<StrategyInputEventVariant> batch;
+    batch.reserve(kStrategyPopBatchSize);
+    MR_PROFILE_THREAD_NAME("strategy " + runner->id);
+    bool shutdown_received = false;
+    // Drain until the STRATEGY_SHUTDOWN event (or a hard queue shutdown): the dispatcher can finish
+    // its loop well before this thread has consumed everything already queued for it.
+    while (!shutdown_received) {
+        size_t popped = 0;
+        {
+            MR_PROFILE_SCOPE(QUEUE_WAIT);
+            popped = runner->input_queue->pop_batch(batch, kStrategyPopBatchSize);
+        }
+        if (popped == 0) break;
+        shutdown_received = run_strategy_batch(runner, batch);
+    }
+    
+    runner->strategy_instance->on_shutdown(current_simulation_time_);
+    LOG_INFO("Strategy Thread [{}]: Exited event loop and shut down.", runner->id);
+}
 
-    StrategyInputEventVariant event_variant;
-    while (simulation_running_.load() && runner->input_queue->wait_and_pop(event_variant)) {
-        Timestamp event_arrival_ts = Timestamp::min(); // This should be the effective_timestamp of the event
-        
-        // Determine the effective arrival timestamp from the variant
-        std::visit([&event_arrival_ts](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (!std::is_same_v<T, std::monostate>) { // Check if it's not an empty variant
-                 if (arg) event_arrival_ts = arg->get_effective_timestamp();
-            }
-        }, event_variant);
+
+bool Dispatcher::run_strategy_batch(StrategyRunner* runner, std::vector<StrategyInputEventVariant>& batch) {
+    IStrategy& strategy = *runner->strategy_instance;
+    const IStrategy::EventBatching batching = strategy.event_batching();
+    auto& arrival_ts = runner->batch_arrival_ts;
+    arrival_ts.resize(batch.size());
+    // Events [group_begin, end) go to the strategy as one on_event_batch call
+    size_t group_begin = 0;
+    const auto run_group = [&](size_t end) {
+        if (end > group_begin) {
+            MR_PROFILE_SCOPE(STRATEGY_ON_EVENT);
+            strategy.on_event_batch(StrategyEventBatch(&batch[group_begin], &arrival_ts[group_begin], end - group_begin));
+        }
+        group_begin = end;
+    };
+
+    bool shutdown_received = false;
+    uint64_t processed = 0;
+    size_t i = 0;
+    for (; i < batch.size(); ++i) {
+        auto& event_variant = batch[i];
+        if (DeliveryLatency* delivery = runner->delivery.get()) {
+            const int64_t queued = delivery->queued_ns[delivery->popped++ & (delivery->queued_ns.size() - 1)];
+            delivery->histogram.record_ns(steady_clock_ns() - queued);
+        }
+        const Timestamp event_arrival_ts = effective_timestamp_of(event_variant);
 
         if(event_arrival_ts == Timestamp::min() && !runner->input_queue->is_shutdown()){
             LOG_WARN("Strategy Thread [{}]: Popped an event variant with no valid event or timestamp.", runner->id);
+            run_group(i);
+            group_begin = i + 1;
+            processed++;
             continue; // Skip if event is somehow invalid
         }
-        
+    
         // Check for shutdown signal (a specific SimControlEvent or just queue shutdown)
         bool is_shutdown_event = false;
         if (auto* p_sc_event = std::get_if<std::unique_ptr<SimControlEvent>>(&event_variant)) {
@@ -96,102 +221,303 @@ void Dispatcher::strategy_thread_loop(StrategyRunner* runner) {
 
         if (is_shutdown_event) {
             LOG_INFO("Strategy Thread [{}]: Received shutdown signal via event. Exiting loop.", runner->id);
-            break; 
+            shutdown_received = true;
+            break;
         }
-        
-        // Record latency: time from event's scheduled arrival to when strategy starts processing
-        // This would be: actual_processing_start_time (now) - event_arrival_ts
-        // For now, assume they are close if strategy thread is not backlogged.
-        if (metrics_collector_ && event_arrival_ts != Timestamp::min()) {
-            auto now = std::chrono::system_clock::now(); // Approximation of processing start
-            // This metric is tricky because event_arrival_ts is from the *simulation* clock.
-            // True strategy processing latency relative to sim clock:
-            // Need strategy to record its own current_sim_time when it starts processing.
-            // For now, we use event_arrival_ts as the "official" time.
+
+        if (batching == IStrategy::EventBatching::NONE) {
+            MR_PROFILE_SCOPE(STRATEGY_ON_EVENT);
+            strategy.on_event(event_variant, event_arrival_ts);
+            group_begin = i + 1;
+        } else {
+            if (batching == IStrategy::EventBatching::SAME_TIMESTAMP && i > group_begin &&
+                event_arrival_ts != arrival_ts[group_begin]) {
+                run_group(i);
+            }
+            arrival_ts[i] = event_arrival_ts;
         }
-        
-        runner->strategy_instance->on_event(event_variant, event_arrival_ts);
+        processed++;
+    }
+    if (batching != IStrategy::EventBatching::NONE) run_group(i);
+    batch.clear(); // Drops this thread's references to shared market data
+    // Release: orders submitted from on_event are visible to whoever sees this count
+    runner->events_processed.fetch_add(processed, std::memory_order_release);
+    return shutdown_received;
+}
+
+void Dispatcher::strategy_task(utils::WorkStealingPool* pool, StrategyRunner* runner) {
+    // Only count what has been published: every event behind mailbox_pending is already in the queue
+    const uint64_t available = runner->mailbox_pending.load(std::memory_order_acquire);
+    auto& batch = runner->task_batch;
+    while (batch.size() < std::min<uint64_t>(available, kStrategyPopBatchSize)) {
+        std::optional<StrategyInputEventVariant> event = runner->input_queue->try_pop();
+        if (!event) break; // Queue shut down under us
+        batch.push_back(std::move(*event));
+    }
+    const uint64_t taken = batch.size();
+    if (taken == 0) {
+        LOG_WARN("Strategy Task [{}]: Mailbox closed with {} events pending.", runner->id, available);
+        return;
+    }
+
+    if (runner->finished) {
+        batch.clear(); // Stragglers behind the shutdown signal, e.g. the fallback one
+    } else if (run_strategy_batch(runner, batch)) {
+        runner->strategy_instance->on_shutdown(current_simulation_time_);
+        runner->finished = true;
+        LOG_INFO("Strategy Task [{}]: Shut down.", runner->id);
+        std::lock_guard<std::mutex> lock(strategy_pool_mutex_);
+        strategies_finished_++;
+        strategies_finished_cv_.notify_all();
+    }
+
+    // Anything pushed meanwhile is ours to handle too: the pushes that saw a non-zero count did not submit
+    if (runner->mailbox_pending.fetch_sub(taken, std::memory_order_acq_rel) != taken) {
+        pool->submit([this, pool, runner] { strategy_task(pool, runner); });
     }
-    
-    runner->strategy_instance->on_shutdown(current_simulation_time_);
-    LOG_INFO("Strategy Thread [{}]: Exited event loop and shut down.", runner->id);
 }
 
 
+void Dispatcher::open_data_source() {
+    if (data_source_) return;
+    LOG_INFO("Dispatcher: Opening historical data from {}", historical_data_path_);
+    data_source_ = historical_data_paths_.empty()
+        ? open_market_data_source(historical_data_path_, config_.merge, config_.replay_window)
+        : open_market_data_source(historical_data_paths_, config_.merge, config_.replay_window);
+}
+
 void Dispatcher::load_initial_data() {
-    LOG_INFO("Dispatcher: Loading historical data from {}", historical_data_path_);
-    csv_parser_ = std::make_unique<CsvParser>(historical_data_path_);
-    
-    int count = 0;
-    while (csv_parser_->has_more_events()) {
-        std::unique_ptr<BaseEvent> market_event = csv_parser_->read_next_event();
-        if (market_event) {
-            // Apply latency for market data arrival at strategy
-            Duration md_latency = latency_model_.get_market_data_latency(*market_event);
-            market_event->arrival_timestamp = market_event->exchange_timestamp + md_latency;
-            
-            main_event_pq_.push(std::move(market_event));
-            count++;
-        }
-    }
-    LOG_INFO("Dispatcher: Loaded {} market events into MEPQ.", count);
-
-    if (!main_event_pq_.empty()) {
-         // Add a SimControlEvent to mark the end of the data feed, scheduled after the last market data event.
-        Timestamp last_event_arrival_ts = main_event_pq_.top()->get_effective_timestamp(); // This is sorted by arrival at strategy
-        // Actually, we need last exchange timestamp to schedule correctly
-        // This requires iterating or storing last exchange_ts during load.
-        // For now, schedule it slightly after the last known effective arrival.
-        // A better way: when CsvParser returns nullptr for the first time, then schedule END_OF_DATA_FEED.
-        // This is handled in the main loop now.
+    open_data_source();
+
+    if (config_.ingestion_mode == IngestionMode::PRELOAD) {
+        while (data_source_->has_more_events()) {
+            std::unique_ptr<BaseEvent> market_event = read_market_event();
+            if (market_event) {
+                Duration md_latency = latency_model_.get_market_data_latency(*market_event, market_events_ingested_);
+                market_event->arrival_timestamp = market_event->exchange_timestamp + md_latency;
+                MR_PROFILE_SCOPE(MEPQ_PUSH);
+                main_event_pq_->push(std::move(market_event));
+                market_events_ingested_++;
+                pending_market_events_++;
+            }
+        }
+        LOG_INFO("Dispatcher: Loaded {} market events into MEPQ.", market_events_ingested_);
     } else {
+        refill_market_data_window();
+        LOG_INFO("Dispatcher: Streaming market data, window primed with {} events.", market_data_window_.size());
+    }
+
+    if (!has_pending_events()) {
         LOG_WARN("Dispatcher: No market data loaded. Simulation might be empty.");
-        // Schedule an immediate end of data if nothing loaded.
-        auto end_event = std::make_unique<SimControlEvent>(
-            std::chrono::system_clock::now(), // Or some logical start time
-            SimControlEvent::ControlType::END_OF_DATA_FEED);
-        main_event_pq_.push(std::move(end_event));
     }
 }
 
+void Dispatcher::ingest_market_event(std::unique_ptr<BaseEvent> market_event) {
+    // Apply latency for market data arrival at strategy
+    Duration md_latency = latency_model_.get_market_data_latency(*market_event, market_events_ingested_);
+    market_event->arrival_timestamp = market_event->exchange_timestamp + md_latency;
+    market_events_ingested_++;
+    pending_market_events_++;
+
+    if (!market_data_window_.empty() &&
+        market_event->get_effective_timestamp() < market_data_window_.back()->get_effective_timestamp()) {
+        // The window relies on feed order. A tick that goes backwards still gets replayed in time order via the MEPQ.
+        LOG_DEBUG("Dispatcher: Out-of-order market event at {} routed through MEPQ.",
+                  log_ts(market_event->get_effective_timestamp()));
+        MR_PROFILE_SCOPE(MEPQ_PUSH);
+        main_event_pq_->push(std::move(market_event));
+        return;
+    }
+    market_data_window_.push_back(std::move(market_event));
+}
+
+void Dispatcher::refill_market_data_window() {
+    if (!data_source_ || config_.ingestion_mode != IngestionMode::STREAMING) return;
+    while (market_data_window_.size() < config_.market_data_window_size && data_source_->has_more_events()) {
+        std::unique_ptr<BaseEvent> market_event = read_market_event();
+        if (market_event) {
+            ingest_market_event(std::move(market_event));
+        }
+    }
+}
+
+std::unique_ptr<BaseEvent> Dispatcher::read_market_event() {
+    MR_PROFILE_SCOPE(PARSE);
+    return data_source_->read_next_event();
+}
+
+bool Dispatcher::has_pending_events() const {
+    return !main_event_pq_->empty() || !market_data_window_.empty();
+}
+
+bool Dispatcher::market_data_exhausted() const {
+    return (!data_source_ || !data_source_->has_more_events()) && pending_market_events_ == 0;
+}
+
+Timestamp Dispatcher::next_event_timestamp() const {
+    if (market_data_window_.empty()) return main_event_pq_->top_timestamp();
+    if (main_event_pq_->empty()) return market_data_window_.front()->get_effective_timestamp();
+    return std::min(market_data_window_.front()->get_effective_timestamp(),
+                    main_event_pq_->top_timestamp());
+}
+
+std::unique_ptr<BaseEvent> Dispatcher::pop_next_event() {
+    std::unique_ptr<BaseEvent> event;
+    // Market data wins ties: what the exchange published at time t is seen before anything generated internally at t.
+    if (!market_data_window_.empty() &&
+        (main_event_pq_->empty() ||
+         market_data_window_.front()->get_effective_timestamp() <= main_event_pq_->top_timestamp())) {
+        event = std::move(market_data_window_.front());
+        market_data_window_.pop_front();
+        // Top up at half empty rather than empty, so a tick that arrives ahead of its feed position
+        // (jittered latency) is still read before the loop passes its arrival time
+        if (market_data_window_.size() <= config_.market_data_window_size / 2) {
+            refill_market_data_window();
+        }
+    } else {
+        // MEPQ is only accessed by this thread.
+        MR_PROFILE_SCOPE(MEPQ_POP);
+        event = main_event_pq_->pop();
+    }
+    return event;
+}
+
 void Dispatcher::run() {
     if (strategy_runners_.empty()) {
         LOG_WARN("Dispatcher: No strategies added. Running simulation without strategies.");
     }
     simulation_running_.store(true);
+    event_pool_at_start_ = EventPool::instance().stats();
+    pnl_engine_.reset(strategy_runners_.size());
+    start_profiling();
 
     // Start strategy threads
+    if (pooled_strategies()) {
+        strategy_pool_ = std::make_unique<utils::WorkStealingPool>(config_.strategy_pool_threads);
+        strategies_finished_ = 0;
+        LOG_INFO("Dispatcher: Running {} strategies on a pool of {} threads.", strategy_runners_.size(), strategy_pool_->size());
+    }
+    // Every on_init runs here, before any strategy thread exists, so subscriptions made in it are
+    // in place before the first event and a strategy's own thread sees what on_init set up
     for (auto& runner : strategy_runners_) {
-        LOG_INFO("Dispatcher: Starting thread for strategy '{}'", runner.id);
-        runner.thread = std::thread(&Dispatcher::strategy_thread_loop, this, &runner);
+        runner.strategy_instance->on_init(current_simulation_time_);
+    }
+    build_subscriptions();
+    data_feed_ended_signal_pushed_ = false;
+    if (resume_checkpoint_) restore_checkpoint(); // Before any strategy thread can look at its strategy
+    if (!inline_strategies() && !pooled_strategies()) {
+        for (auto& runner : strategy_runners_) {
+            LOG_INFO("Dispatcher: Starting thread for strategy '{}'", runner.id);
+            runner.thread = std::thread(&Dispatcher::strategy_thread_loop, this, &runner);
+        }
+    }
+
+    if (config_.num_shards > 1) {
+        run_sharded();
+    } else {
+        run_event_loop();
+    }
+
+    LOG_INFO("Dispatcher: Main event loop finished.");
+    simulation_running_.store(false); // Ensure it's set for any cleanup logic
+    shutdown_strategies();
+    stop_profiling(); // Every thread that times anything has finished
+    publish_pnl();
+    release_event_storage();
+    LOG_INFO("Dispatcher: Run completed.");
+}
+
+void Dispatcher::start_profiling() {
+    if (!config_.profiling.enabled) return;
+#ifndef MARKET_REPLAY_PROFILING
+    LOG_WARN("Dispatcher: Profiling requested, but this build has it compiled out (ENABLE_PROFILING=OFF).");
+#endif
+    queue_depth_counters_.clear();
+    for (const auto& runner : strategy_runners_) queue_depth_counters_.push_back("queue depth " + runner.id);
+    utils::Profiler::start(config_.profiling);
+    MR_PROFILE_THREAD_NAME("dispatcher");
+}
+
+void Dispatcher::stop_profiling() {
+    if (!utils::Profiler::enabled()) return;
+    profile_summary_ = utils::Profiler::stop();
+    utils::Profiler::log_summary(profile_summary_);
+}
+
+void Dispatcher::sample_queue_depths() {
+    MR_PROFILE_COUNTER("mepq depth", main_event_pq_->size());
+    MR_PROFILE_COUNTER("market data window", market_data_window_.size());
+    for (size_t i = 0; i < strategy_runners_.size() && i < queue_depth_counters_.size(); ++i) {
+        if (strategy_runners_[i].input_queue) {
+            MR_PROFILE_COUNTER(queue_depth_counters_[i].c_str(), strategy_runners_[i].input_queue->size());
+        }
+    }
+}
+
+void Dispatcher::build_subscriptions() {
+    all_symbols_subscribers_.clear();
+    symbol_subscribers_.clear();
+    std::vector<SymbolId> subscribed; // Union over the strategies that chose their symbols
+    for (const auto& runner : strategy_runners_) {
+        const IStrategy& strategy = *runner.strategy_instance;
+        if (strategy.subscribes_to_all()) {
+            all_symbols_subscribers_.push_back(runner.index);
+            continue;
+        }
+        for (SymbolId symbol_id : strategy.subscriptions()) {
+            if (symbol_id >= symbol_subscribers_.size()) symbol_subscribers_.resize(static_cast<size_t>(symbol_id) + 1);
+            symbol_subscribers_[symbol_id].push_back(runner.index);
+            if (std::find(subscribed.begin(), subscribed.end(), symbol_id) == subscribed.end()) subscribed.push_back(symbol_id);
+        }
+    }
+    for (auto& subscribers : symbol_subscribers_) {
+        if (subscribers.empty()) continue;
+        subscribers.insert(subscribers.end(), all_symbols_subscribers_.begin(), all_symbols_subscribers_.end());
+        std::sort(subscribers.begin(), subscribers.end()); // Delivery in strategy order, as without subscriptions
+    }
+    LOG_INFO("Dispatcher: {} of {} strategies take every symbol; {} symbols subscribed to individually.",
+             all_symbols_subscribers_.size(), strategy_runners_.size(), subscribed.size());
+
+    if (config_.read_subscribed_symbols_only && all_symbols_subscribers_.empty() && !strategy_runners_.empty() &&
+        config_.replay_window.symbols.empty()) {
+        config_.replay_window.symbols = subscribed;
+        LOG_INFO("Dispatcher: Reading only the {} subscribed symbols.", subscribed.size());
     }
+}
 
-    // Load data (this will populate MEPQ)
-    load_initial_data();
+void Dispatcher::run_event_loop() {
+    // Open the data (PRELOAD populates the MEPQ, STREAMING primes the look-ahead window). A resumed
+    // run has both, and the reader, back from restore_checkpoint() already.
+    if (!resume_checkpoint_) load_initial_data();
 
     // Add a periodic event to process incoming order requests
     // This ensures order requests are handled even if no market data is flowing.
-    if (!main_event_pq_.empty()) {
-        Timestamp next_check_time = main_event_pq_.top()->get_effective_timestamp();
+    // INLINE needs none: orders are only ever submitted from within this loop, which matches them
+    // before the next event.
+    if (inline_strategies() || resume_checkpoint_) {
+        // No-op (a resumed MEPQ has its own, see restore_checkpoint)
+    } else if (has_pending_events()) {
+        Timestamp next_check_time = next_event_timestamp();
         auto order_proc_event = std::make_unique<SimControlEvent>(
             next_check_time, SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS);
-        main_event_pq_.push(std::move(order_proc_event));
+        main_event_pq_->push(std::move(order_proc_event));
     } else { // If no market data, prime with a process order request event now
          auto order_proc_event = std::make_unique<SimControlEvent>(
             std::chrono::system_clock::now(), // Effectively now
             SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS);
-        main_event_pq_.push(std::move(order_proc_event));
+        main_event_pq_->push(std::move(order_proc_event));
     }
 
 
+    schedule_checkpoints();
     LOG_INFO("Dispatcher: Starting main event loop.");
-    bool data_feed_ended_signal_pushed = false;
+    uint64_t events_dispatched = 0;
 
     while (simulation_running_.load()) {
         process_incoming_order_requests(); // Process any pending orders quickly
 
-        if (main_event_pq_.empty()) {
-            if (incoming_order_requests_.empty() && !data_feed_ended_signal_pushed) {
+        if (!has_pending_events()) {
+            if (!order_requests_queued() && !data_feed_ended_signal_pushed_) {
                  // All market data processed, no pending orders, and no outstanding acks in MEPQ.
                 LOG_INFO("Dispatcher: MEPQ and OrderRequestQueue are empty. Signaling end of data feed to strategies.");
                 auto end_event = std::make_unique<SimControlEvent>(
@@ -202,9 +528,9 @@ void Dispatcher::run() {
                 // Push this control event to MEPQ, so it gets dispatched to strategies in time order.
                 // Or directly push to strategies if MEPQ is truly done with other events.
                 // For consistency, push to MEPQ.
-                main_event_pq_.push(std::move(end_event));
-                data_feed_ended_signal_pushed = true; // ensure this is done once
-            } else if (incoming_order_requests_.empty() && data_feed_ended_signal_pushed) {
+                main_event_pq_->push(std::move(end_event));
+                data_feed_ended_signal_pushed_ = true; // ensure this is done once
+            } else if (!order_requests_queued() && data_feed_ended_signal_pushed_) {
                  // If still empty after end_of_data_feed was pushed and presumably processed,
                  // then it's time to break.
                  LOG_INFO("Dispatcher: MEPQ is empty after END_OF_DATA_FEED processed. Ending simulation loop.");
@@ -213,15 +539,16 @@ void Dispatcher::run() {
             // If there are still order requests, the loop continues, process_incoming_order_requests will
             // generate new OrderAckEvents for MEPQ.
             // Sleep a bit to avoid busy-waiting if MEPQ is temporarily empty but sim not over.
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (!inline_strategies()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
         }
 
-        std::unique_ptr<BaseEvent> current_event_ptr;
-        // Critical section for accessing MEPQ top & pop
-        // No, MEPQ is only accessed by this thread.
-        current_event_ptr = std::move(const_cast<std::unique_ptr<BaseEvent>&>(main_event_pq_.top()));
-        main_event_pq_.pop();
+        if (next_checkpoint_ != Timestamp::max()) {
+            const Timestamp next_ts = next_event_timestamp();
+            if (next_checkpoint_ <= next_ts) take_due_checkpoint(next_ts);
+        }
+
+        std::unique_ptr<BaseEvent> current_event_ptr = pop_next_event();
         
         if (!current_event_ptr) {
             LOG_WARN("Dispatcher: Popped a nullptr from MEPQ. Skipping.");
@@ -229,48 +556,43 @@ void Dispatcher::run() {
         }
 
         current_simulation_time_ = current_event_ptr->get_effective_timestamp();
+        if (++events_dispatched % kProfileCounterInterval == 0 && utils::Profiler::tracing()) sample_queue_depths();
         
         // Log the event being dispatched
         // LOG_TRACE("Dispatcher: Processing event type {} at sim_time {}", 
-        //           static_cast<int>(current_event_ptr->type), timestamp_to_string(current_simulation_time_));
+        //           static_cast<int>(current_event_ptr->type), log_ts(current_simulation_time_));
 
         process_event_from_mepq(std::move(current_event_ptr));
 
-        // If CsvParser is exhausted and not yet signaled, add END_OF_DATA_FEED to MEPQ
-        if (csv_parser_ && !csv_parser_->has_more_events() && !data_feed_ended_signal_pushed) {
-            LOG_INFO("Dispatcher: CsvParser has no more events. Scheduling END_OF_DATA_FEED.");
+        // Once every ingested market event has been dispatched, add END_OF_DATA_FEED to MEPQ
+        if (!data_feed_ended_signal_pushed_ && market_data_exhausted()) {
+            LOG_INFO("Dispatcher: All {} market events dispatched. Scheduling END_OF_DATA_FEED.", market_events_ingested_);
              auto end_event = std::make_unique<SimControlEvent>(
                 current_simulation_time_ + Duration(1), // Schedule it just after current event
                 SimControlEvent::ControlType::END_OF_DATA_FEED,
                 EventType::SIM_CONTROL_STRATEGY); 
-            main_event_pq_.push(std::move(end_event));
-            data_feed_ended_signal_pushed = true;
+            main_event_pq_->push(std::move(end_event));
+            data_feed_ended_signal_pushed_ = true;
         }
     }
-
-    LOG_INFO("Dispatcher: Main event loop finished.");
-    simulation_running_.store(false); // Ensure it's set for any cleanup logic
-    shutdown_strategies();
-    LOG_INFO("Dispatcher: Run completed.");
 }
 
 void Dispatcher::process_event_from_mepq(std::unique_ptr<BaseEvent> event) {
     if (!event) return;
 
-    // Update order books if it's a market data event BEFORE dispatching to strategies
-    if (event->type == EventType::QUOTE) {
-        auto* q_event = static_cast<QuoteEvent*>(event.get());
-        get_or_create_order_book(q_event->symbol).update_quote(*q_event);
-    } else if (event->type == EventType::TRADE) {
-        // auto* t_event = static_cast<TradeEvent*>(event.get());
-        // Potentially update last trade price in order book here if needed for matching logic
+    if (event->type == EventType::QUOTE || event->type == EventType::TRADE) {
+        pending_market_events_--;
     }
 
+    // Update order books if it's a market data event BEFORE dispatching to strategies.
+    // This is also where resting orders get filled.
+    apply_market_event_to_book(exchange_, *event, current_simulation_time_);
+
 
     switch (event->type) {
         case EventType::QUOTE:
         case EventType::TRADE:
-            handle_market_data_event(event.get());
+            handle_market_data_event(std::move(event));
             break;
         case EventType::ORDER_ACK:
             handle_order_ack_event(static_cast<OrderAckEvent*>(event.get()));
@@ -285,55 +607,80 @@ void Dispatcher::process_event_from_mepq(std::unique_ptr<BaseEvent> event) {
     }
 }
 
-void Dispatcher::handle_market_data_event(BaseEvent* event) {
+void Dispatcher::apply_market_event_to_book(ExchangeContext& exchange, const BaseEvent& event, Timestamp now) {
+    if (event.type == EventType::QUOTE) {
+        MR_PROFILE_SCOPE(BOOK_UPDATE);
+        const auto& q_event = static_cast<const QuoteEvent&>(event);
+        get_or_create_order_book(exchange, q_event.symbol_id).update_quote(q_event, exchange.resting_fill_batch);
+        if (!exchange.resting_fill_batch.empty()) schedule_resting_fills(exchange, q_event.symbol_id, q_event.exchange_timestamp, now);
+    } else if (event.type == EventType::TRADE) {
+        MR_PROFILE_SCOPE(BOOK_UPDATE);
+        const auto& t_event = static_cast<const TradeEvent&>(event);
+        get_or_create_order_book(exchange, t_event.symbol_id).apply_trade(t_event, exchange.resting_fill_batch);
+        if (!exchange.resting_fill_batch.empty()) schedule_resting_fills(exchange, t_event.symbol_id, t_event.exchange_timestamp, now);
+    }
+}
+
+void Dispatcher::handle_market_data_event(std::unique_ptr<BaseEvent> event) {
     // This event's arrival_timestamp is when it should reach the strategy.
     // current_simulation_time_ is already set to this.
-    StrategyInputEventVariant event_variant;
+    // Ownership moves into a single shared, read-only handle; each strategy queue gets a reference to it.
+    if (strategy_runners_.empty()) return;
+    const Timestamp arrival_ts = event->get_effective_timestamp();
+    pnl_engine_.advance_to(arrival_ts);
     if (event->type == EventType::QUOTE) {
-        // Need to copy, as multiple strategies might consume it.
-        // Or use shared_ptr if events are large and copying is too much.
-        // For now, unique_ptr and make_unique for each strategy queue.
-        auto q_event = static_cast<QuoteEvent*>(event);
-        // LOG_DEBUG("Dispatching Quote {} to strategies at {}", q_event->symbol, timestamp_to_string(q_event->arrival_timestamp));
-        for (auto& runner : strategy_runners_) {
-            auto q_copy = std::make_unique<QuoteEvent>(*q_event); // Copy
-            q_copy->arrival_timestamp = event->arrival_timestamp; // Ensure arrival time is propagated
-            runner.input_queue->push(std::move(q_copy));
+        const auto& quote = static_cast<const QuoteEvent&>(*event);
+        // LOG_DEBUG("Dispatching Quote {} to strategies at {}", symbol_name(quote.symbol_id), log_ts(quote.arrival_timestamp));
+        if (quote.bid_size > 0 && quote.ask_size > 0) {
+            pnl_engine_.on_quote(quote.symbol_id, quote.get_bid_ticks(), quote.get_ask_ticks());
+        }
+        const auto& subscribers = subscribers_of(quote.symbol_id);
+        if (subscribers.empty()) return; // Marked, and nobody to share it with
+        MR_PROFILE_SCOPE(FAN_OUT);
+        SharedEvent<QuoteEvent> q_event = share_event<QuoteEvent>(std::move(event));
+        for (StrategyIndex index : subscribers) {
+            deliver_to_strategy(strategy_runners_[index], q_event, arrival_ts);
         }
     } else if (event->type == EventType::TRADE) {
-        auto t_event = static_cast<TradeEvent*>(event);
-        // LOG_DEBUG("Dispatching Trade {} to strategies at {}", t_event->symbol, timestamp_to_string(t_event->arrival_timestamp));
-        for (auto& runner : strategy_runners_) {
-            auto t_copy = std::make_unique<TradeEvent>(*t_event); // Copy
-            t_copy->arrival_timestamp = event->arrival_timestamp;
-            runner.input_queue->push(std::move(t_copy));
+        const auto& trade = static_cast<const TradeEvent&>(*event);
+        // LOG_DEBUG("Dispatching Trade {} to strategies at {}", symbol_name(trade.symbol_id), log_ts(trade.arrival_timestamp));
+        const auto& subscribers = subscribers_of(trade.symbol_id);
+        if (subscribers.empty()) return;
+        MR_PROFILE_SCOPE(FAN_OUT);
+        SharedEvent<TradeEvent> t_event = share_event<TradeEvent>(std::move(event));
+        for (StrategyIndex index : subscribers) {
+            deliver_to_strategy(strategy_runners_[index], t_event, arrival_ts);
         }
     }
 }
 
 void Dispatcher::handle_order_ack_event(OrderAckEvent* event) {
     // Route to the specific strategy
-    // LOG_DEBUG("Dispatching OrderAck for ClientID {} (Strategy {}) at {}", event->client_order_id, event->strategy_id, timestamp_to_string(event->arrival_timestamp));
-    auto it = strategy_map_.find(event->strategy_id);
-    if (it != strategy_map_.end()) {
+    // LOG_DEBUG("Dispatching OrderAck for ClientID {} (Strategy {}) at {}", event->client_order_id, event->strategy_index, log_ts(event->arrival_timestamp));
+    if (event->strategy_index < strategy_runners_.size()) {
+        pnl_engine_.advance_to(event->arrival_timestamp);
+        if ((event->status == OrderStatus::FILLED || event->status == OrderStatus::PARTIALLY_FILLED) && event->last_filled_quantity > 0) {
+            pnl_engine_.on_fill(event->strategy_index, event->symbol_id, event->side,
+                                event->last_filled_price_ticks, event->last_filled_quantity);
+        }
         auto ack_copy = std::make_unique<OrderAckEvent>(*event); // Copy
         ack_copy->arrival_timestamp = event->arrival_timestamp;
-        it->second->input_queue->push(std::move(ack_copy));
+        deliver_to_strategy(strategy_runners_[event->strategy_index], std::move(ack_copy), event->arrival_timestamp);
     } else {
-        LOG_WARN("Dispatcher: No strategy found for ID '{}' to send OrderAck.", event->strategy_id);
+        LOG_WARN("Dispatcher: No strategy found for index {} to send OrderAck.", event->strategy_index);
     }
 }
 
 void Dispatcher::handle_sim_control_event(SimControlEvent* event) {
-    LOG_DEBUG("Dispatcher: Processing SimControlEvent type {} at {}", static_cast<int>(event->control_type), timestamp_to_string(event->arrival_timestamp));
+    LOG_DEBUG("Dispatcher: Processing SimControlEvent type {} at {}", static_cast<int>(event->control_type), log_ts(event->arrival_timestamp));
     if (event->type == EventType::SIM_CONTROL_DISPATCHER) {
         if (event->control_type == SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS) {
             process_incoming_order_requests();
             // Schedule next check
-            if (simulation_running_.load() && !main_event_pq_.empty()) { // Only reschedule if sim is ongoing and there are future events
+            if (simulation_running_.load() && has_pending_events()) { // Only reschedule if sim is ongoing and there are future events
                 Timestamp next_check_time = current_simulation_time_ + std::chrono::milliseconds(10); // Check every 10ms of sim time
                  // Ensure it's not scheduled past the next genuine event if that's sooner.
-                if (!main_event_pq_.empty() && next_check_time > main_event_pq_.top()->get_effective_timestamp()){
+                if (next_check_time > next_event_timestamp()){
                     // If next MEPQ event is sooner, schedule this check just before or at that time.
                     // This logic can be complex. A simpler way: process orders at start of each event loop iteration.
                     // For now, fixed interval from current time, or rely on loop start.
@@ -342,64 +689,125 @@ void Dispatcher::handle_sim_control_event(SimControlEvent* event) {
                 }
                 auto next_proc_event = std::make_unique<SimControlEvent>(
                     next_check_time, SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS);
-                main_event_pq_.push(std::move(next_proc_event));
+                main_event_pq_->push(std::move(next_proc_event));
             }
         }
     } else if (event->type == EventType::SIM_CONTROL_STRATEGY) {
          if (event->control_type == SimControlEvent::ControlType::END_OF_DATA_FEED) {
             LOG_INFO("Dispatcher: END_OF_DATA_FEED detected by dispatcher. Signaling strategies to prepare for shutdown.");
             // This event, when processed from MEPQ, means all prior market data and acks are done.
-            // Now, tell strategies they can wind down.
+            // Now, tell strategies they can wind down (INLINE: shutdown_strategies() does it directly).
             for (auto& runner : strategy_runners_) {
+                if (!runner.input_queue) continue;
                 auto shutdown_signal = std::make_unique<SimControlEvent>(
                     event->arrival_timestamp, // Deliver at this same sim time
                     SimControlEvent::ControlType::STRATEGY_SHUTDOWN,
                     EventType::SIM_CONTROL_STRATEGY
                 );
-                runner.input_queue->push(std::move(shutdown_signal));
+                enqueue_for_strategy(runner, std::move(shutdown_signal));
+            }
+            if (inline_strategies()) {
+                // Nothing scheduled past the end of the feed reaches a strategy, as on the threaded path
+                simulation_running_.store(false);
             }
         }
     }
 }
 
 
+void Dispatcher::deliver_to_strategy(StrategyRunner& runner, StrategyInputEventVariant event, Timestamp arrival_ts) {
+    runner.events_delivered++;
+    if (!runner.input_queue) {
+        MR_PROFILE_SCOPE(STRATEGY_ON_EVENT);
+        if (runner.strategy_instance->event_batching() == IStrategy::EventBatching::NONE) {
+            runner.strategy_instance->on_event(event, arrival_ts);
+        } else {
+            runner.strategy_instance->on_event_batch(StrategyEventBatch(&event, &arrival_ts, 1));
+        }
+        runner.events_processed.store(runner.events_delivered, std::memory_order_relaxed);
+        return;
+    }
+    enqueue_for_strategy(runner, std::move(event));
+}
+
+void Dispatcher::enqueue_for_strategy(StrategyRunner& runner, StrategyInputEventVariant event) {
+    if (DeliveryLatency* delivery = runner.delivery.get()) {
+        // Published to the strategy side by the queue push
+        delivery->queued_ns[delivery->pushed++ & (delivery->queued_ns.size() - 1)] = steady_clock_ns();
+    }
+    runner.input_queue->push(std::move(event));
+    if (pooled_strategies() && runner.mailbox_pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        utils::WorkStealingPool* pool = strategy_pool_.get();
+        StrategyRunner* target = &runner;
+        pool->submit([this, pool, target] { strategy_task(pool, target); });
+    }
+}
+
 void Dispatcher::submit_order_request(OrderRequest request) {
     // This is called by a strategy thread. Queue it for the dispatcher thread.
     // The request.request_timestamp is when the strategy made the decision.
     LOG_DEBUG("Dispatcher: Received order request from Strategy {} (ClientID {}) for {} {} @ {} Qty {}. DecisionTS: {}",
-              request.strategy_id, request.client_order_id, (request.side == OrderSide::BUY ? "BUY" : "SELL"),
-              request.symbol, request.price, request.quantity, timestamp_to_string(request.request_timestamp));
+              strategy_id_for(request.strategy_index), request.client_order_id, (request.side == OrderSide::BUY ? "BUY" : "SELL"),
+              symbol_name(request.symbol_id), request.price, request.quantity, log_ts(request.request_timestamp));
+    if (inline_strategies()) {
+        inline_order_requests_.push_back(std::move(request)); // On the dispatcher thread, from on_event
+        return;
+    }
     incoming_order_requests_.push(std::move(request));
 }
 
+bool Dispatcher::order_requests_queued() const {
+    return !inline_order_requests_.empty() || !incoming_order_requests_.empty();
+}
+
+bool Dispatcher::drain_order_requests() {
+    if (inline_strategies()) {
+        if (inline_order_requests_.empty()) return false;
+        order_request_batch_.swap(inline_order_requests_); // Both vectors keep their capacity
+    } else if (incoming_order_requests_.drain(order_request_batch_) == 0) {
+        return false;
+    }
+    // Strategy threads race each other to push. Ordering a drained batch by decision time (then
+    // strategy and client id) keeps the exchange-side sequence independent of thread timing.
+    std::sort(order_request_batch_.begin(), order_request_batch_.end(),
+              [](const OrderRequest& a, const OrderRequest& b) {
+                  return std::tie(a.request_timestamp, a.strategy_index, a.client_order_id) <
+                         std::tie(b.request_timestamp, b.strategy_index, b.client_order_id);
+              });
+    return true;
+}
+
 void Dispatcher::process_incoming_order_requests() {
-    std::optional<OrderRequest> opt_req;
-    while ((opt_req = incoming_order_requests_.try_pop()).has_value()) {
-        simulate_order_lifecycle(std::move(opt_req.value()));
+    if (!drain_order_requests()) return;
+    for (auto& request : order_request_batch_) {
+        simulate_order_lifecycle(exchange_, std::move(request), get_next_exchange_order_id());
     }
+    order_request_batch_.clear();
 }
 
-void Dispatcher::simulate_order_lifecycle(OrderRequest order_req) {
-    LOG_INFO("Dispatcher: Simulating lifecycle for order ClientID {} from Strategy {}", order_req.client_order_id, order_req.strategy_id);
+void Dispatcher::simulate_order_lifecycle(ExchangeContext& exchange, OrderRequest order_req, OrderId exchange_order_id) {
+    MR_PROFILE_SCOPE(ORDER_LIFECYCLE);
+    LOG_DEBUG("Dispatcher: Simulating lifecycle for order ClientID {} from Strategy {}", order_req.client_order_id, strategy_id_for(order_req.strategy_index));
 
-    OrderId exchange_order_id = get_next_exchange_order_id();
     Timestamp decision_ts = order_req.request_timestamp; // When strategy decided.
 
     // Add strategy's own processing delay before it "sends" the order
-    Timestamp order_effectively_sent_ts = decision_ts + latency_model_.get_strategy_processing_latency();
+    // Stochastic legs are keyed by the exchange order id, assigned in deterministic drain order
+    Timestamp order_effectively_sent_ts = decision_ts + latency_model_.get_strategy_processing_latency(order_req.symbol_id, exchange_order_id);
     
-    Timestamp order_arrival_at_exchange_ts = latency_model_.get_order_arrival_at_exchange_ts(order_effectively_sent_ts);
+    Timestamp order_arrival_at_exchange_ts = latency_model_.get_order_arrival_at_exchange_ts(order_effectively_sent_ts, order_req.symbol_id, exchange_order_id);
 
     // 1. Send PENDING_NEW or NEW ack (acknowledging receipt by exchange system)
-    Timestamp ack_arrival_strat_ts = latency_model_.get_ack_arrival_at_strategy_ts(order_arrival_at_exchange_ts);
+    Timestamp ack_arrival_strat_ts = latency_model_.get_ack_arrival_at_strategy_ts(order_arrival_at_exchange_ts, order_req.symbol_id, exchange_order_id);
     
     auto new_ack = std::make_unique<OrderAckEvent>(
-        ack_arrival_strat_ts, order_req.strategy_id, order_req.client_order_id, exchange_order_id,
-        order_req.symbol, OrderStatus::ACKNOWLEDGED // Or NEW, depending on model
+        ack_arrival_strat_ts, order_req.strategy_index, order_req.client_order_id, exchange_order_id,
+        order_req.symbol_id, OrderStatus::ACKNOWLEDGED // Or NEW, depending on model
     );
+    new_ack->side = order_req.side;
     new_ack->leaves_quantity = order_req.quantity; // Initially, all leaves
-    main_event_pq_.push(std::move(new_ack));
-    LOG_DEBUG("Dispatcher: Scheduled ACKNOWLEDGED for ClientID {} at {}", order_req.client_order_id, timestamp_to_string(ack_arrival_strat_ts));
+    exchange.scheduler->push(std::move(new_ack));
+    LOG_DEBUG("Dispatcher: Scheduled ACKNOWLEDGED for ClientID {} at {}", order_req.client_order_id, log_ts(ack_arrival_strat_ts));
 
     // 2. Simulate fill attempt
     // Fill simulation needs the state of the order book AT order_arrival_at_exchange_ts.
@@ -407,7 +815,7 @@ void Dispatcher::simulate_order_lifecycle(OrderRequest order_req) {
     // order_req is processed. This assumes order_req processing is timely.
     // A more accurate simulation would snapshot the book or queue order processing against book states.
     
-    SimpleOrderBook& book = get_or_create_order_book(order_req.symbol);
+    SimpleOrderBook& book = get_or_create_order_book(exchange, order_req.symbol_id);
     Price fill_price = INVALID_PRICE;
     Quantity filled_qty = 0;
 
@@ -418,60 +826,139 @@ void Dispatcher::simulate_order_lifecycle(OrderRequest order_req) {
     }
 
     if (filled_qty > 0 && !std::isnan(fill_price)) {
-        Timestamp fill_arrival_strat_ts = latency_model_.get_fill_arrival_at_strategy_ts(order_arrival_at_exchange_ts);
+        Timestamp fill_arrival_strat_ts = latency_model_.get_fill_arrival_at_strategy_ts(order_arrival_at_exchange_ts, order_req.symbol_id, exchange_order_id);
         // Ensure fill ack arrives after or at same time as initial ack
         if (fill_arrival_strat_ts < ack_arrival_strat_ts) {
              fill_arrival_strat_ts = ack_arrival_strat_ts + Duration(1); // Ensure causality
         }
 
         auto fill_ack = std::make_unique<OrderAckEvent>(
-            fill_arrival_strat_ts, order_req.strategy_id, order_req.client_order_id, exchange_order_id,
-            order_req.symbol, (filled_qty == order_req.quantity ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED)
+            fill_arrival_strat_ts, order_req.strategy_index, order_req.client_order_id, exchange_order_id,
+            order_req.symbol_id, (filled_qty == order_req.quantity ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED)
         );
+        fill_ack->side = order_req.side;
         fill_ack->last_filled_price = fill_price;
+        fill_ack->last_filled_price_ticks = to_price_ticks(order_req.symbol_id, fill_price);
         fill_ack->last_filled_quantity = filled_qty;
         fill_ack->cumulative_filled_quantity = filled_qty; // Assuming no prior partial fills for this simple model
         fill_ack->leaves_quantity = order_req.quantity - filled_qty;
-        main_event_pq_.push(std::move(fill_ack));
+        exchange.scheduler->push(std::move(fill_ack));
         LOG_DEBUG("Dispatcher: Scheduled FILL for ClientID {} ({} units at {}) at {}", 
-                  order_req.client_order_id, filled_qty, fill_price, timestamp_to_string(fill_arrival_strat_ts));
+                  order_req.client_order_id, filled_qty, fill_price, log_ts(fill_arrival_strat_ts));
 
         if (metrics_collector_) {
             metrics_collector_->record_latency(
-                order_req.strategy_id + "_OrderFillAckLatency",
+                strategy_runners_[order_req.strategy_index].fill_latency_key,
                 fill_arrival_strat_ts - decision_ts, // Total latency from decision to fill ack
                 fill_arrival_strat_ts
             );
         }
+    }
 
-    } else if (order_req.type == OrderType::LIMIT) {
-        // Passive limit order, no immediate fill. It's now "on the book".
-        // Our simple model doesn't keep a full passive book for matching against future ticks.
-        // It's just ACKNOWLEDGED. For it to fill, a future QUOTE or TRADE would need to cross it,
-        // and we'd need logic here or in `handle_market_data_event` to check active limit orders.
-        // This is out of scope for a basic implementation.
-        LOG_INFO("Dispatcher: Limit order ClientID {} for {} is passive, no immediate fill.", order_req.client_order_id, order_req.symbol);
-    } else { // Market order that couldn't fill (e.g. no liquidity)
+    if (order_req.type == OrderType::LIMIT) {
+        if (filled_qty < order_req.quantity) {
+            // The rest joins the back of its price level and fills as later quotes/trades reach it
+            if (book.add_limit_order(exchange_order_id, order_req.strategy_index, order_req.client_order_id, order_req.side,
+                                     order_req.price, order_req.quantity - filled_qty, filled_qty)) {
+                LOG_DEBUG("Dispatcher: Limit order ClientID {} for {} resting {} @ {}.", order_req.client_order_id,
+                         symbol_name(order_req.symbol_id), order_req.quantity - filled_qty, order_req.price);
+            } else {
+                auto reject = std::make_unique<OrderAckEvent>(
+                    ack_arrival_strat_ts + Duration(1), order_req.strategy_index, order_req.client_order_id, exchange_order_id,
+                    order_req.symbol_id, OrderStatus::REJECTED);
+                reject->side = order_req.side;
+                reject->cumulative_filled_quantity = filled_qty;
+                reject->reject_reason = "Price cannot rest in the order book";
+                exchange.scheduler->push(std::move(reject));
+            }
+        }
+    } else if (filled_qty == 0) { // Market order that couldn't fill (e.g. no liquidity)
         LOG_WARN("Dispatcher: Market order ClientID {} for {} could not be filled (Qty: {}). This might mean it's rejected or remains pending.",
-            order_req.client_order_id, order_req.symbol, order_req.quantity);
+            order_req.client_order_id, symbol_name(order_req.symbol_id), order_req.quantity);
         // Could send a REJECTED ack here or model it differently.
         // For now, it's just ACKNOWLEDGED and not filled.
     }
 }
 
 
-SimpleOrderBook& Dispatcher::get_or_create_order_book(const std::string& symbol) {
-    auto it = order_books_.find(symbol);
-    if (it == order_books_.end()) {
-        LOG_INFO("Dispatcher: Creating new order book for symbol {}", symbol);
-        it = order_books_.emplace(std::piecewise_construct,
-                                  std::forward_as_tuple(symbol),
-                                  std::forward_as_tuple(symbol)).first;
+void Dispatcher::schedule_resting_fills(ExchangeContext& exchange, SymbolId symbol_id, Timestamp exchange_ts, Timestamp now) {
+    // The fill happened when the print/quote did at the exchange; it cannot be delivered before
+    // the dispatcher has seen the market event that caused it.
+    for (const auto& fill : exchange.resting_fill_batch) {
+        // Keyed per execution, so every partial fill of an order draws its own latency
+        const uint64_t fill_key = mix64(fill.exchange_order_id) ^ static_cast<uint64_t>(fill.cumulative_quantity);
+        Timestamp fill_arrival_strat_ts = latency_model_.get_fill_arrival_at_strategy_ts(exchange_ts, symbol_id, fill_key);
+        if (fill_arrival_strat_ts < now) fill_arrival_strat_ts = now;
+        auto fill_ack = std::make_unique<OrderAckEvent>(
+            fill_arrival_strat_ts, fill.strategy_index, fill.client_order_id, fill.exchange_order_id, symbol_id,
+            (fill.leaves_quantity == 0 ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED));
+        fill_ack->side = fill.side;
+        fill_ack->last_filled_price = fill.price;
+        fill_ack->last_filled_price_ticks = fill.price_ticks;
+        fill_ack->last_filled_quantity = fill.quantity;
+        fill_ack->cumulative_filled_quantity = fill.cumulative_quantity;
+        fill_ack->leaves_quantity = fill.leaves_quantity;
+        exchange.scheduler->push(std::move(fill_ack));
+        LOG_DEBUG("Dispatcher: Scheduled resting FILL for ClientID {} ({} units at {}) at {}",
+                  fill.client_order_id, fill.quantity, fill.price, log_ts(fill_arrival_strat_ts));
+    }
+    exchange.resting_fill_batch.clear();
+}
+
+SimpleOrderBook& Dispatcher::get_or_create_order_book(ExchangeContext& exchange, SymbolId symbol_id) {
+    if (symbol_id >= exchange.order_books.size()) {
+        exchange.order_books.resize(static_cast<size_t>(symbol_id) + 1);
+    }
+    auto& book = exchange.order_books[symbol_id];
+    if (!book) {
+        LOG_DEBUG("Dispatcher: Creating new order book for symbol {}", symbol_name(symbol_id));
+        book = std::make_unique<SimpleOrderBook>(symbol_id, config_.order_book);
+    }
+    return *book;
+}
+
+const StrategyId& Dispatcher::strategy_id_for(StrategyIndex index) const {
+    static const StrategyId unknown = "<unknown>";
+    return index < strategy_runners_.size() ? strategy_runners_[index].id : unknown;
+}
+
+void Dispatcher::release_event_storage() {
+    // Anything still scheduled is past the end of the run
+    main_event_pq_->clear();
+    market_data_window_.clear();
+
+    // Runs sharing the process (a sweep) count towards each other's figures while they overlap
+    const EventPool::Stats stats = EventPool::instance().stats().since(event_pool_at_start_);
+    LOG_INFO("Dispatcher: Event pool this run: {} allocations, {} served from recycled slots ({} bytes reused), {} oversize, {} chunks ({} KiB) held",
+             stats.allocations, stats.reused, stats.bytes_reused, stats.fallback_allocations,
+             stats.bytes_reserved / EventPool::kChunkSize, stats.bytes_reserved / 1024);
+    if (!EventPool::instance().release_if_idle()) {
+        LOG_DEBUG("Dispatcher: {} events still alive elsewhere, event pool chunks kept.", stats.live);
+    }
+}
+
+void Dispatcher::publish_pnl() {
+    if (!metrics_collector_) return;
+    for (const auto& runner : strategy_runners_) {
+        for (SymbolId symbol_id = 0; symbol_id < pnl_engine_.symbol_capacity(); ++symbol_id) {
+            if (pnl_engine_.position(runner.index, symbol_id).fills == 0) continue;
+            metrics_collector_->record_pnl(runner.id, symbol_id, pnl_engine_.pnl(runner.index, symbol_id));
+        }
+    }
+    for (const auto& snapshot : pnl_engine_.snapshots()) {
+        metrics_collector_->record_equity_snapshot(strategy_id_for(snapshot.strategy_index), snapshot.timestamp,
+                                                   snapshot.realized_pnl, snapshot.unrealized_pnl);
     }
-    return it->second;
 }
 
 void Dispatcher::shutdown_strategies() {
+    if (inline_strategies()) {
+        for (auto& runner : strategy_runners_) {
+            runner.strategy_instance->on_shutdown(current_simulation_time_);
+        }
+        LOG_INFO("Dispatcher: All inline strategies shut down.");
+        return;
+    }
     LOG_INFO("Dispatcher: Initiating shutdown of strategy threads...");
     // Signal strategy threads to shutdown via their queues using a special event
     // This is now handled by the END_OF_DATA_FEED -> STRATEGY_SHUTDOWN chain
@@ -486,11 +973,24 @@ void Dispatcher::shutdown_strategies() {
                 SimControlEvent::ControlType::STRATEGY_SHUTDOWN,
                 EventType::SIM_CONTROL_STRATEGY
             );
-            runner.input_queue->push(std::move(final_shutdown_signal));
-            runner.input_queue->shutdown(); // Then hard shutdown the queue
+            enqueue_for_strategy(runner, std::move(final_shutdown_signal));
+            // Tasks pop without blocking, so their queues must stay open until they are done
+            if (!pooled_strategies()) runner.input_queue->shutdown(); // Then hard shutdown the queue
         }
     }
 
+    if (pooled_strategies()) {
+        {
+            std::unique_lock<std::mutex> lock(strategy_pool_mutex_);
+            strategies_finished_cv_.wait(lock, [this] { return strategies_finished_ == strategy_runners_.size(); });
+        }
+        const auto stats = strategy_pool_->stats();
+        strategy_pool_.reset(); // Runs whatever straggler tasks are left, then joins
+        for (auto& runner : strategy_runners_) runner.input_queue->shutdown();
+        LOG_INFO("Dispatcher: All strategy tasks finished ({} tasks run, {} stolen).", stats.executed, stats.stolen);
+        return;
+    }
+
     for (auto& runner : strategy_runners_) {
         if (runner.thread.joinable()) {
             LOG_DEBUG("Dispatcher: Joining thread for strategy '{}'...", runner.id);
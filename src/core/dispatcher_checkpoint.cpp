@@ -0,0 +1,281 @@
+#include "market_replay/dispatcher.hpp"
+#include "market_replay/logger.hpp"
+#include "market_replay/symbol_registry.hpp"
+#include <algorithm> // For std::sort, std::max
+#include <stdexcept>
+
+namespace market_replay {
+
+// Checkpoints. One is taken at the top of the event loop, just before the first event at or after
+// its sim time is popped: the strategies are waited on until idle and their queued order requests
+// matched first, so the whole state lives in the dispatcher, the books, the PnL engine, the
+// metrics collector and the strategies themselves. Resuming puts all of it back and carries on
+// the loop from there. Latency draws are keyed by market event and exchange order counters, both
+// part of the checkpoint, so a resumed run sees the same latencies as the run that took it.
+
+namespace {
+
+using checkpoint_format::Section;
+
+void write_symbols(CheckpointWriter& out) {
+    const SymbolRegistry& registry = SymbolRegistry::instance();
+    const size_t count = registry.size();
+    out.write_varint(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto id = static_cast<SymbolId>(i);
+        out.write_string(registry.name(id));
+        out.write_f64(registry.ticks_per_unit(id));
+    }
+}
+
+// Symbol ids in the checkpoint (events, books, positions) are only valid if every name gets the
+// same id here, i.e. this process has not interned other symbols first
+void restore_symbols(CheckpointReader& in) {
+    SymbolRegistry& registry = SymbolRegistry::instance();
+    const uint64_t count = in.read_varint();
+    for (uint64_t i = 0; i < count; ++i) {
+        const std::string_view name = in.read_string();
+        const double ticks_per_unit = in.read_f64();
+        const SymbolId id = registry.intern(name);
+        if (id != i) {
+            throw std::runtime_error("Checkpoint: symbol " + std::string(name) + " has id " + std::to_string(i) +
+                                     " in the checkpoint but " + std::to_string(id) + " in this process");
+        }
+        if (registry.ticks_per_unit(id) != ticks_per_unit) registry.set_tick_size(id, 1.0 / ticks_per_unit);
+    }
+}
+
+// Popped in order and pushed back in the same order, which keeps equal timestamps in their order
+void write_scheduled_events(CheckpointWriter& out, IEventScheduler& scheduler) {
+    std::vector<std::unique_ptr<BaseEvent>> events;
+    events.reserve(scheduler.size());
+    while (!scheduler.empty()) events.push_back(scheduler.pop());
+    out.write_varint(events.size());
+    for (const auto& event : events) out.write_event(*event);
+    for (auto& event : events) scheduler.push(std::move(event));
+}
+
+} // namespace
+
+std::string Dispatcher::checkpoint_file_path(const std::string& prefix, Timestamp sim_time) {
+    return prefix + std::to_string(sim_time.time_since_epoch().count()) + checkpoint_format::FILE_EXTENSION;
+}
+
+void Dispatcher::resume_from(Checkpoint checkpoint) {
+    if (simulation_running_.load()) {
+        LOG_ERROR("Dispatcher: Cannot resume from a checkpoint while simulation is running.");
+        return;
+    }
+    if (config_.num_shards > 1) {
+        throw std::runtime_error("Dispatcher: resuming from a checkpoint requires num_shards == 1");
+    }
+    checkpoint.sim_time = Checkpoint::parse_header(checkpoint.data);
+    resume_checkpoint_ = std::move(checkpoint);
+}
+
+void Dispatcher::schedule_checkpoints() {
+    const CheckpointConfig& config = config_.checkpoints;
+    pending_checkpoints_.clear();
+    next_interval_checkpoint_ = Timestamp::max();
+    next_checkpoint_ = Timestamp::max();
+    if (!config.enabled() || !has_pending_events()) return;
+
+    // A resumed run starts from its checkpoint's time and does not take that one again
+    const Timestamp start = resume_checkpoint_ ? resume_checkpoint_->sim_time : next_event_timestamp();
+    for (Timestamp at : config.at) {
+        if (!resume_checkpoint_ || at > start) pending_checkpoints_.push_back(at);
+    }
+    std::sort(pending_checkpoints_.begin(), pending_checkpoints_.end());
+    if (config.interval > Duration::zero()) next_interval_checkpoint_ = start + config.interval;
+    next_checkpoint_ = pending_checkpoints_.empty() ? next_interval_checkpoint_
+                                                    : std::min(pending_checkpoints_.front(), next_interval_checkpoint_);
+    LOG_INFO("Dispatcher: {} checkpoints at fixed times, every {}ns otherwise.", pending_checkpoints_.size(),
+             config.interval.count());
+}
+
+void Dispatcher::take_due_checkpoint(Timestamp next_event_ts) {
+    // Several may be due when the feed has a gap; with no event between them they would all be the
+    // same state, so one is taken, labelled with the latest
+    Timestamp sim_time = Timestamp::min();
+    size_t due = 0;
+    while (due < pending_checkpoints_.size() && pending_checkpoints_[due] <= next_event_ts) {
+        sim_time = pending_checkpoints_[due++];
+    }
+    pending_checkpoints_.erase(pending_checkpoints_.begin(), pending_checkpoints_.begin() + static_cast<std::ptrdiff_t>(due));
+    if (next_interval_checkpoint_ <= next_event_ts) {
+        const Duration interval = config_.checkpoints.interval;
+        const Timestamp last_due = next_interval_checkpoint_ + ((next_event_ts - next_interval_checkpoint_) / interval) * interval;
+        sim_time = std::max(sim_time, last_due);
+        next_interval_checkpoint_ = last_due + interval;
+    }
+    next_checkpoint_ = pending_checkpoints_.empty() ? next_interval_checkpoint_
+                                                    : std::min(pending_checkpoints_.front(), next_interval_checkpoint_);
+
+    wait_for_strategies_idle();
+    process_incoming_order_requests();
+    Checkpoint checkpoint = write_checkpoint(sim_time);
+    LOG_INFO("Dispatcher: Checkpoint at {} ({} bytes, {} events pending).", log_ts(sim_time), checkpoint.data.size(),
+             main_event_pq_->size() + market_data_window_.size());
+    if (!config_.checkpoints.path_prefix.empty()) {
+        const std::string path = checkpoint_file_path(config_.checkpoints.path_prefix, sim_time);
+        try {
+            checkpoint.save(path);
+            LOG_INFO("Dispatcher: Checkpoint written to {}", path);
+        } catch (const std::runtime_error& e) {
+            LOG_ERROR("Dispatcher: {}", e.what()); // The replay itself is unaffected
+        }
+    }
+    if (config_.checkpoints.keep_in_memory) checkpoints_.push_back(std::move(checkpoint));
+}
+
+Checkpoint Dispatcher::write_checkpoint(Timestamp sim_time) {
+    CheckpointWriter out(sim_time);
+    out.write_header();
+
+    out.write_section(Section::SYMBOLS);
+    write_symbols(out);
+
+    out.write_section(Section::CLOCK);
+    out.write_timestamp(current_simulation_time_);
+    out.write_varint(next_exchange_order_id_.load());
+    out.write_varint(market_events_ingested_);
+    out.write_varint(pending_market_events_);
+    out.write_bool(data_feed_ended_signal_pushed_);
+
+    out.write_section(Section::SOURCE);
+    const bool seekable = data_source_ && data_source_->seekable();
+    out.write_bool(seekable);
+    out.write_varint(seekable ? data_source_->position() : 0);
+
+    out.write_section(Section::EVENTS);
+    write_scheduled_events(out, *main_event_pq_);
+    out.write_varint(market_data_window_.size());
+    for (const auto& event : market_data_window_) out.write_event(*event);
+
+    out.write_section(Section::BOOKS);
+    size_t books = 0;
+    for (const auto& book : exchange_.order_books) books += book ? 1 : 0;
+    out.write_varint(books);
+    for (size_t symbol_id = 0; symbol_id < exchange_.order_books.size(); ++symbol_id) {
+        if (!exchange_.order_books[symbol_id]) continue;
+        out.write_varint(symbol_id);
+        exchange_.order_books[symbol_id]->save_state(out);
+    }
+
+    out.write_section(Section::PNL);
+    pnl_engine_.save_state(out);
+
+    out.write_section(Section::STRATEGIES);
+    out.write_varint(strategy_runners_.size());
+    for (const auto& runner : strategy_runners_) {
+        out.write_string(runner.id);
+        out.write_varint(runner.strategy_instance->next_client_order_id_);
+        CheckpointWriter state(sim_time);
+        runner.strategy_instance->save_state(state);
+        out.write_string(state.data());
+    }
+
+    // A blob as well, so a run without a collector can still resume from it
+    out.write_section(Section::METRICS);
+    out.write_bool(metrics_collector_ != nullptr);
+    if (metrics_collector_) {
+        CheckpointWriter metrics(sim_time);
+        metrics_collector_->save_state(metrics);
+        out.write_string(metrics.data());
+    }
+
+    out.write_section(Section::END);
+    return Checkpoint{sim_time, out.take()};
+}
+
+void Dispatcher::restore_checkpoint() {
+    const Checkpoint& checkpoint = *resume_checkpoint_;
+    LOG_INFO("Dispatcher: Resuming from the checkpoint at {}.", log_ts(checkpoint.sim_time));
+    CheckpointReader in(std::string_view(checkpoint.data).substr(checkpoint_format::HEADER_SIZE), checkpoint.sim_time);
+
+    in.expect_section(Section::SYMBOLS);
+    restore_symbols(in);
+
+    in.expect_section(Section::CLOCK);
+    current_simulation_time_ = in.read_timestamp();
+    next_exchange_order_id_.store(in.read_varint());
+    market_events_ingested_ = in.read_varint();
+    pending_market_events_ = in.read_varint();
+    data_feed_ended_signal_pushed_ = in.read_bool();
+
+    in.expect_section(Section::SOURCE);
+    const bool seekable = in.read_bool();
+    const uint64_t position = in.read_varint();
+    open_data_source();
+    if (seekable && data_source_->seekable()) {
+        data_source_->seek(position);
+    } else {
+        // Merged and windowed sources have no position of their own: read past what was ingested
+        uint64_t skipped = 0;
+        while (skipped < market_events_ingested_ && data_source_->has_more_events()) {
+            if (read_market_event()) ++skipped;
+        }
+        LOG_INFO("Dispatcher: Skipped {} market events to reach the checkpoint.", skipped);
+    }
+
+    in.expect_section(Section::EVENTS);
+    main_event_pq_->clear();
+    bool order_processing_scheduled = false;
+    for (uint64_t n = in.read_varint(); n > 0; --n) {
+        std::unique_ptr<BaseEvent> event = in.read_event();
+        if (event->type == EventType::SIM_CONTROL_DISPATCHER &&
+            static_cast<const SimControlEvent&>(*event).control_type == SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS) {
+            order_processing_scheduled = true;
+        }
+        main_event_pq_->push(std::move(event));
+    }
+    market_data_window_.clear();
+    for (uint64_t n = in.read_varint(); n > 0; --n) market_data_window_.push_back(in.read_event());
+    // Taken by an INLINE run, resumed by one that runs strategies on threads
+    if (!inline_strategies() && !order_processing_scheduled) {
+        main_event_pq_->push(std::make_unique<SimControlEvent>(
+            has_pending_events() ? next_event_timestamp() : current_simulation_time_,
+            SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS));
+    }
+
+    in.expect_section(Section::BOOKS);
+    exchange_.order_books.clear();
+    for (uint64_t n = in.read_varint(); n > 0; --n) {
+        const auto symbol_id = static_cast<SymbolId>(in.read_varint());
+        get_or_create_order_book(exchange_, symbol_id).restore_state(in);
+    }
+
+    in.expect_section(Section::PNL);
+    pnl_engine_.restore_state(in);
+
+    in.expect_section(Section::STRATEGIES);
+    const uint64_t strategies = in.read_varint();
+    if (strategies != strategy_runners_.size() || pnl_engine_.num_strategies() != strategy_runners_.size()) {
+        throw std::runtime_error("Checkpoint has " + std::to_string(strategies) + " strategies, this dispatcher " +
+                                 std::to_string(strategy_runners_.size()));
+    }
+    for (auto& runner : strategy_runners_) {
+        const std::string_view id = in.read_string();
+        if (id != runner.id) {
+            throw std::runtime_error("Checkpoint has strategy " + std::string(id) + " where this dispatcher has " + runner.id);
+        }
+        runner.strategy_instance->next_client_order_id_ = in.read_varint();
+        CheckpointReader state(in.read_string(), checkpoint.sim_time);
+        runner.strategy_instance->restore_state(state);
+    }
+
+    in.expect_section(Section::METRICS);
+    if (in.read_bool()) {
+        const std::string_view metrics = in.read_string();
+        if (metrics_collector_) {
+            CheckpointReader metrics_in(metrics, checkpoint.sim_time);
+            metrics_collector_->restore_state(metrics_in);
+        }
+    }
+
+    in.expect_section(Section::END);
+    LOG_INFO("Dispatcher: Resumed at {} with {} events pending, {} market events ingested.",
+             log_ts(current_simulation_time_), main_event_pq_->size() + market_data_window_.size(), market_events_ingested_);
+}
+
+} // namespace market_replay
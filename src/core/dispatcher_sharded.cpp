@@ -0,0 +1,256 @@
+#include "market_replay/dispatcher.hpp"
+#include "market_replay/logger.hpp"
+#include <algorithm> // For std::max, std::min
+
+namespace market_replay {
+
+// Sharded mode. The thread in run() is the coordinator: it owns the data source, the strategy
+// channels and the order-request queue, and runs shard 0 itself. Each round:
+//   1. drain order requests and simulate them against the owning shard's book (the shards are idle);
+//   2. open the window [start, end), start being the earliest pending event on any shard or in the
+//      look-ahead, and hand each shard its market data for the window. The window ends lookahead
+//      past the first event a strategy could react to; market data for symbols no strategy
+//      subscribes to and no order rests on cannot lead to an order, so it stretches the window
+//      (up to market_data_window_size events) instead of opening one window per tick;
+//   3. every shard runs the window in parallel: book updates and resting fills for its symbols;
+//   4. merge the shards' outboxes into one time-ordered stream for the strategies;
+//   5. wait until every strategy has processed all it was sent, so any order it submitted in
+//      response is queued before the next round drains it.
+// With lookahead no larger than the minimum decision-to-exchange latency, an order reacting to an
+// event inside a window cannot reach a book before the window ends, so the book state every order
+// is matched against is the same as in a sequential replay. Step 5 also makes sharded runs
+// deterministic regardless of how strategy threads are scheduled, at the price of a round trip to
+// every busy strategy per window: while strategies see the data, shards and strategies advance in
+// lockstep, one lookahead at a time (see Config::num_shards).
+
+void Dispatcher::run_sharded() {
+    const Duration lookahead = std::max(latency_model_.min_decision_to_exchange_latency(), Duration(1));
+
+    shards_.clear();
+    for (size_t i = 0; i < config_.num_shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        if (config_.scheduler == SchedulerType::TIMING_WHEEL) {
+            shard->scheduler = std::make_unique<TimingWheelScheduler>(config_.timing_wheel);
+        } else {
+            shard->scheduler = std::make_unique<EventHeap>();
+        }
+        shard->exchange.scheduler = shard->scheduler.get();
+        shards_.push_back(std::move(shard));
+    }
+    {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        shards_stopping_ = false;
+        for (auto& shard : shards_) shard->window_generation_seen = shard_window_generation_;
+    }
+    for (size_t i = 1; i < shards_.size(); ++i) {
+        shards_[i]->thread = std::thread(&Dispatcher::shard_thread_loop, this, shards_[i].get());
+    }
+    LOG_INFO("Dispatcher: Sharded event loop with {} shards, {}ns lookahead.", shards_.size(), lookahead.count());
+
+    open_data_source();
+    refill_shard_lookahead();
+
+    // Like END_OF_DATA_FEED in the single-shard loop, the run ends just after the last market event
+    Timestamp end_ts = Timestamp::max();
+    Timestamp last_market_ts = Timestamp::min();
+    size_t windows = 0;
+
+    while (simulation_running_.load()) {
+        process_order_requests_on_shards();
+
+        Timestamp shard_start = Timestamp::max();
+        for (const auto& shard : shards_) {
+            if (!shard->scheduler->empty()) shard_start = std::min(shard_start, shard->scheduler->top_timestamp());
+        }
+        const Timestamp window_start =
+            main_event_pq_->empty() ? shard_start : std::min(shard_start, main_event_pq_->top_timestamp());
+        if (window_start == Timestamp::max() || window_start >= end_ts) break;
+        // The window ends lookahead past the first event a strategy may react to: anything already on
+        // a shard (acks, fills, order arrivals), or market data it is sent or that can fill its orders.
+        // Market data no strategy can see rides along in the same window, up to a bounded batch.
+        Timestamp window_end = shard_start == Timestamp::max() ? Timestamp::max() : shard_start + lookahead;
+        size_t routed = 0;
+
+        // Market data is routed to its shard only once its window opens
+        while (!main_event_pq_->empty() && main_event_pq_->top_timestamp() < window_end) {
+            if (routed >= config_.market_data_window_size && main_event_pq_->top_timestamp() > window_start) {
+                window_end = main_event_pq_->top_timestamp();
+                break;
+            }
+            std::unique_ptr<BaseEvent> market_event;
+            {
+                MR_PROFILE_SCOPE(MEPQ_POP);
+                market_event = main_event_pq_->pop();
+            }
+            const Timestamp ts = market_event->get_effective_timestamp();
+            last_market_ts = std::max(last_market_ts, ts);
+            const SymbolId symbol_id = market_event->type == EventType::QUOTE
+                ? static_cast<const QuoteEvent&>(*market_event).symbol_id
+                : static_cast<const TradeEvent&>(*market_event).symbol_id;
+            if (visible_to_strategies(symbol_id)) window_end = std::min(window_end, ts + lookahead);
+            routed++;
+            {
+                MR_PROFILE_SCOPE(MEPQ_PUSH);
+                shard_for(symbol_id).scheduler->push(std::move(market_event));
+            }
+            if (main_event_pq_->empty()) refill_shard_lookahead();
+        }
+        if (end_ts == Timestamp::max() && main_event_pq_->empty() && !data_source_->has_more_events()) {
+            end_ts = last_market_ts + Duration(1);
+            LOG_INFO("Dispatcher: All {} market events routed to shards.", market_events_ingested_);
+        }
+        window_end = std::min(window_end, end_ts);
+
+        run_window_on_all_shards(window_end);
+        deliver_shard_outboxes();
+        if (utils::Profiler::tracing()) sample_queue_depths();
+        wait_for_strategies_idle();
+        windows++;
+        refill_shard_lookahead();
+    }
+
+    LOG_INFO("Dispatcher: Sharded event loop ran {} windows.", windows);
+    stop_shard_threads();
+    for (auto& shard : shards_) shard->scheduler->clear(); // Anything left is past the end of the run
+    shards_.clear();
+}
+
+void Dispatcher::refill_shard_lookahead() {
+    // PRELOAD reads everything up front; STREAMING keeps market_data_window_size events ahead
+    while (data_source_->has_more_events() &&
+           (config_.ingestion_mode == IngestionMode::PRELOAD || main_event_pq_->size() < config_.market_data_window_size)) {
+        std::unique_ptr<BaseEvent> market_event = read_market_event();
+        if (market_event) {
+            Duration md_latency = latency_model_.get_market_data_latency(*market_event, market_events_ingested_);
+            market_event->arrival_timestamp = market_event->exchange_timestamp + md_latency;
+            MR_PROFILE_SCOPE(MEPQ_PUSH);
+            main_event_pq_->push(std::move(market_event));
+            market_events_ingested_++;
+        }
+    }
+}
+
+void Dispatcher::process_order_requests_on_shards() {
+    if (!drain_order_requests()) return;
+    for (auto& request : order_request_batch_) {
+        Shard& shard = shard_for(request.symbol_id);
+        simulate_order_lifecycle(shard.exchange, std::move(request), get_next_exchange_order_id());
+    }
+    order_request_batch_.clear();
+}
+
+void Dispatcher::run_shard_window(Shard& shard, Timestamp window_end) {
+    IEventScheduler& scheduler = *shard.scheduler;
+    while (!scheduler.empty() && scheduler.top_timestamp() < window_end) {
+        std::unique_ptr<BaseEvent> event;
+        {
+            MR_PROFILE_SCOPE(MEPQ_POP);
+            event = scheduler.pop();
+        }
+        apply_market_event_to_book(shard.exchange, *event, event->get_effective_timestamp());
+        shard.outbox.push_back(std::move(event));
+    }
+}
+
+void Dispatcher::shard_thread_loop(Shard* shard) {
+    LOG_DEBUG("Shard Thread [{}]: Starting.", shard->index);
+    MR_PROFILE_THREAD_NAME("shard " + std::to_string(shard->index));
+    for (;;) {
+        Timestamp window_end;
+        {
+            std::unique_lock<std::mutex> lock(shard_mutex_);
+            shard_window_cv_.wait(lock, [&] {
+                return shards_stopping_ || shard_window_generation_ != shard->window_generation_seen;
+            });
+            if (shards_stopping_) break;
+            shard->window_generation_seen = shard_window_generation_;
+            window_end = shard_window_end_;
+        }
+        run_shard_window(*shard, window_end);
+        {
+            std::lock_guard<std::mutex> lock(shard_mutex_);
+            if (--shards_busy_ == 0) shard_done_cv_.notify_one();
+        }
+    }
+    LOG_DEBUG("Shard Thread [{}]: Exiting.", shard->index);
+}
+
+void Dispatcher::run_window_on_all_shards(Timestamp window_end) {
+    if (shards_.size() > 1) {
+        {
+            std::lock_guard<std::mutex> lock(shard_mutex_);
+            shard_window_end_ = window_end;
+            shards_busy_ = shards_.size() - 1;
+            shard_window_generation_++;
+        }
+        shard_window_cv_.notify_all();
+    }
+    run_shard_window(*shards_[0], window_end);
+    if (shards_.size() > 1) {
+        std::unique_lock<std::mutex> lock(shard_mutex_);
+        shard_done_cv_.wait(lock, [&] { return shards_busy_ == 0; });
+    }
+}
+
+void Dispatcher::deliver_shard_outboxes() {
+    // Ties go to market data (as in the single-shard loop), then to the lower shard
+    auto goes_first = [](const BaseEvent& a, const BaseEvent& b) {
+        if (a.get_effective_timestamp() != b.get_effective_timestamp()) {
+            return a.get_effective_timestamp() < b.get_effective_timestamp();
+        }
+        return a.type != EventType::ORDER_ACK && b.type == EventType::ORDER_ACK;
+    };
+    for (;;) {
+        Shard* next = nullptr;
+        for (auto& shard : shards_) {
+            if (shard->outbox_cursor == shard->outbox.size()) continue;
+            if (!next || goes_first(*shard->outbox[shard->outbox_cursor], *next->outbox[next->outbox_cursor])) {
+                next = shard.get();
+            }
+        }
+        if (!next) break;
+
+        std::unique_ptr<BaseEvent> event = std::move(next->outbox[next->outbox_cursor++]);
+        current_simulation_time_ = event->get_effective_timestamp();
+        if (event->type == EventType::ORDER_ACK) {
+            handle_order_ack_event(static_cast<OrderAckEvent*>(event.get()));
+        } else {
+            handle_market_data_event(std::move(event));
+        }
+    }
+    for (auto& shard : shards_) {
+        shard->outbox.clear();
+        shard->outbox_cursor = 0;
+    }
+}
+
+bool Dispatcher::visible_to_strategies(SymbolId symbol_id) {
+    if (!subscribers_of(symbol_id).empty()) return true;
+    // Orders are only added between windows, so a book without any cannot fill one inside a window
+    const auto& books = shard_for(symbol_id).exchange.order_books;
+    return symbol_id < books.size() && books[symbol_id] && books[symbol_id]->resting_order_count() > 0;
+}
+
+void Dispatcher::wait_for_strategies_idle() {
+    // Runners sent nothing this window are already caught up and cost one load each
+    for (auto& runner : strategy_runners_) {
+        while (runner.events_processed.load(std::memory_order_acquire) < runner.events_delivered &&
+               !runner.input_queue->is_shutdown()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Dispatcher::stop_shard_threads() {
+    {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        shards_stopping_ = true;
+    }
+    shard_window_cv_.notify_all();
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+} // namespace market_replay
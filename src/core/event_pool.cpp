@@ -0,0 +1,239 @@
+#include "market_replay/event_pool.hpp"
+#include <algorithm> // For std::find
+#include <new>
+#include <thread> // For std::this_thread::yield
+
+namespace market_replay {
+
+namespace {
+
+// Set once this thread's cache has been destroyed; later frees (static destruction) bypass it
+thread_local bool thread_cache_gone = false;
+
+// Counters only ever written by their owning thread, so a plain load and store is enough; stats()
+// reads them from other threads
+inline void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+struct EventPool::ThreadCache {
+    struct Class {
+        FreeSlot* free = nullptr;
+        size_t count = 0;
+        char* bump = nullptr; // Unused tail of this thread's newest chunk for the class
+        char* bump_end = nullptr;
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> reused{0};
+    };
+
+    explicit ThreadCache(EventPool& owner) : pool(owner), generation(owner.generation_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(pool.mutex_);
+        pool.caches_.push_back(this);
+    }
+
+    ~ThreadCache() {
+        // Free slots go back for other threads; a chunk's uncarved tail waits for release_if_idle
+        pool.enter();
+        if (generation == pool.generation_.load(std::memory_order_acquire)) {
+            for (size_t i = 0; i < kNumClasses; ++i) {
+                if (!classes[i].free) continue;
+                FreeSlot* tail = classes[i].free;
+                while (tail->next) tail = tail->next;
+                pool.return_slots(i, classes[i].free, tail);
+            }
+        }
+        pool.live_.fetch_sub(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex_);
+            for (size_t i = 0; i < kNumClasses; ++i) {
+                pool.retired_allocations_[i] += classes[i].allocations.load(std::memory_order_relaxed);
+                pool.retired_reused_[i] += classes[i].reused.load(std::memory_order_relaxed);
+            }
+            pool.caches_.erase(std::find(pool.caches_.begin(), pool.caches_.end(), this));
+        }
+        thread_cache_gone = true;
+    }
+
+    // The pool was released since this cache last looked: everything it points into is gone
+    void sync() {
+        const uint64_t current = pool.generation_.load(std::memory_order_acquire);
+        if (generation == current) return;
+        generation = current;
+        for (auto& c : classes) {
+            c.free = nullptr;
+            c.count = 0;
+            c.bump = nullptr;
+            c.bump_end = nullptr;
+        }
+    }
+
+    EventPool& pool;
+    uint64_t generation;
+    std::array<Class, kNumClasses> classes;
+};
+
+EventPool& EventPool::instance() {
+    static EventPool* pool = new EventPool(); // Intentionally leaked, see header
+    return *pool;
+}
+
+EventPool::Stats EventPool::Stats::since(const Stats& start) const {
+    Stats s = *this;
+    s.allocations -= start.allocations;
+    s.reused -= start.reused;
+    s.bytes_reused -= start.bytes_reused;
+    s.fallback_allocations -= start.fallback_allocations;
+    s.chunks_allocated -= start.chunks_allocated;
+    return s;
+}
+
+EventPool::ThreadCache* EventPool::thread_cache() {
+    if (thread_cache_gone) return nullptr;
+    thread_local ThreadCache cache(*this);
+    return &cache;
+}
+
+void EventPool::enter() {
+    // Counted in first: release_if_idle only starts from live_ == 0, so from here on it cannot
+    if (live_.fetch_add(1, std::memory_order_acquire) & kReleasing) {
+        while (live_.load(std::memory_order_acquire) & kReleasing) std::this_thread::yield();
+    }
+}
+
+char* EventPool::new_chunk(size_t bytes) {
+    char* chunk = static_cast<char*>(::operator new(bytes, std::align_val_t(kSlotAlign)));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunks_.push_back(chunk);
+        bytes_reserved_ += bytes;
+    }
+    chunks_allocated_.fetch_add(1, std::memory_order_relaxed);
+    return chunk;
+}
+
+void EventPool::return_slots(size_t idx, FreeSlot* head, FreeSlot* tail) noexcept {
+    std::atomic<FreeSlot*>& returned = classes_[idx].returned;
+    tail->next = returned.load(std::memory_order_relaxed);
+    while (!returned.compare_exchange_weak(tail->next, head, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+void* EventPool::allocate(size_t size) {
+    if (size == 0) size = 1;
+    if (size > kMaxPooledSize) {
+        fallback_allocations_.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    const size_t idx = class_index(size);
+    enter(); // Counts the new object as live
+    ThreadCache* cache = thread_cache();
+    if (!cache) return allocate_uncached(idx);
+    cache->sync();
+    ThreadCache::Class& c = cache->classes[idx];
+
+    if (!c.free) {
+        c.free = classes_[idx].returned.exchange(nullptr, std::memory_order_acquire);
+        for (FreeSlot* slot = c.free; slot; slot = slot->next) c.count++;
+    }
+    bump(c.allocations);
+    if (c.free) {
+        FreeSlot* slot = c.free;
+        c.free = slot->next;
+        c.count--;
+        bump(c.reused);
+        return slot;
+    }
+    if (c.bump == nullptr || c.bump + slot_size(idx) > c.bump_end) {
+        c.bump = new_chunk(kChunkSize);
+        c.bump_end = c.bump + kChunkSize;
+    }
+    void* p = c.bump;
+    c.bump += slot_size(idx);
+    return p;
+}
+
+// Only after this thread's cache is gone, i.e. during thread or static destruction
+void* EventPool::allocate_uncached(size_t idx) {
+    FreeSlot* slots = classes_[idx].returned.exchange(nullptr, std::memory_order_acquire);
+    if (!slots) return new_chunk(slot_size(idx));
+    if (slots->next) {
+        FreeSlot* tail = slots->next;
+        while (tail->next) tail = tail->next;
+        return_slots(idx, slots->next, tail);
+    }
+    return slots;
+}
+
+void EventPool::deallocate(void* p, size_t size) noexcept {
+    if (!p) return;
+    if (size == 0) size = 1;
+    if (size > kMaxPooledSize) {
+        ::operator delete(p);
+        return;
+    }
+    const size_t idx = class_index(size);
+    auto* slot = static_cast<FreeSlot*>(p);
+    // No release can start while this object is alive, so the cache and the chunks are safe to use
+    ThreadCache* cache = thread_cache();
+    if (!cache) {
+        return_slots(idx, slot, slot);
+    } else {
+        cache->sync();
+        ThreadCache::Class& c = cache->classes[idx];
+        slot->next = c.free;
+        c.free = slot;
+        if (++c.count > kMaxCachedSlots) {
+            // Half of them back for other threads, e.g. the dispatcher freeing what decode workers allocated
+            FreeSlot* tail = c.free;
+            for (size_t i = 1; i < kMaxCachedSlots / 2; ++i) tail = tail->next;
+            FreeSlot* head = c.free;
+            c.free = tail->next;
+            c.count -= kMaxCachedSlots / 2;
+            return_slots(idx, head, tail);
+        }
+    }
+    live_.fetch_sub(1, std::memory_order_release); // After the slot is put away: release_if_idle relies on this order
+}
+
+bool EventPool::release_if_idle() {
+    uint64_t idle = 0;
+    if (!live_.compare_exchange_strong(idle, kReleasing, std::memory_order_acq_rel)) return false;
+    // Nothing is alive and nobody is allocating: every allocation is counted in live_ before it starts
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& c : classes_) c.returned.store(nullptr, std::memory_order_relaxed);
+        for (char* chunk : chunks_) {
+            ::operator delete(chunk, std::align_val_t(kSlotAlign));
+        }
+        chunks_.clear();
+        bytes_reserved_ = 0;
+    }
+    generation_.fetch_add(1, std::memory_order_release);
+    live_.fetch_sub(kReleasing, std::memory_order_release);
+    return true;
+}
+
+EventPool::Stats EventPool::stats() const {
+    Stats s;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < kNumClasses; ++i) {
+        uint64_t allocations = retired_allocations_[i];
+        uint64_t reused = retired_reused_[i];
+        for (const ThreadCache* cache : caches_) {
+            allocations += cache->classes[i].allocations.load(std::memory_order_relaxed);
+            reused += cache->classes[i].reused.load(std::memory_order_relaxed);
+        }
+        s.allocations += allocations;
+        s.reused += reused;
+        s.bytes_reused += reused * slot_size(i);
+    }
+    s.fallback_allocations = fallback_allocations_.load(std::memory_order_relaxed);
+    s.chunks_allocated = chunks_allocated_.load(std::memory_order_relaxed);
+    s.live = live_.load(std::memory_order_relaxed) & ~kReleasing;
+    s.bytes_reserved = bytes_reserved_;
+    return s;
+}
+
+} // namespace market_replay
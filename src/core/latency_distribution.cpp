@@ -0,0 +1,148 @@
+#include "market_replay/latency_distribution.hpp"
+#include <algorithm> // For std::min, std::max, std::fill
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace market_replay {
+
+namespace {
+
+// Standard normal quantile (Acklam's rational approximation, relative error below 1.2e-9)
+double inverse_normal_cdf(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double p_low = 0.02425;
+    if (p < p_low) {
+        const double q = std::sqrt(-2 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - p_low) {
+        const double q = std::sqrt(-2 * std::log(1 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    const double q = p - 0.5;
+    const double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+} // namespace
+
+LatencyDistribution LatencyDistribution::constant(Duration value) {
+    LatencyDistribution dist;
+    dist.min_ns_ = dist.max_ns_ = std::max<int64_t>(value.count(), 0);
+    return dist;
+}
+
+LatencyDistribution LatencyDistribution::lognormal(Duration median, double sigma, Duration floor) {
+    if (median.count() <= 0 || !(sigma > 0)) {
+        return constant(floor + std::max(median, Duration(0))); // Degenerate: no spread
+    }
+    LatencyDistribution dist;
+    dist.kind_ = Kind::QUANTILES;
+    dist.quantiles_ns_.resize(kTableSize + 1);
+    const double mu = std::log(static_cast<double>(median.count()));
+    for (size_t i = 0; i <= kTableSize; ++i) {
+        const double p = (static_cast<double>(i) + 0.5) / static_cast<double>(kTableSize + 1);
+        const double x = std::exp(mu + sigma * inverse_normal_cdf(p));
+        dist.quantiles_ns_[i] = floor.count() + static_cast<int64_t>(std::llround(x));
+    }
+    dist.min_ns_ = dist.quantiles_ns_.front();
+    dist.max_ns_ = dist.quantiles_ns_.back();
+    return dist;
+}
+
+LatencyDistribution LatencyDistribution::empirical(const std::vector<Bucket>& buckets) {
+    std::vector<Bucket> usable;
+    double total = 0.0;
+    for (const auto& bucket : buckets) {
+        if (bucket.weight > 0 && bucket.upper >= bucket.lower && bucket.lower.count() >= 0) {
+            usable.push_back(bucket);
+            total += bucket.weight;
+        }
+    }
+    if (usable.empty()) {
+        throw std::runtime_error("Latency histogram has no bucket with a positive weight");
+    }
+
+    LatencyDistribution dist;
+    dist.kind_ = Kind::ALIAS;
+    dist.min_ns_ = usable.front().lower.count();
+    dist.max_ns_ = usable.front().upper.count();
+    const size_t n = usable.size();
+    dist.alias_.resize(n);
+    // Vose's method: scale weights to mean 1, pair each under-full bucket with an over-full one
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        dist.alias_[i] = {0, static_cast<uint32_t>(i), usable[i].lower.count(), (usable[i].upper - usable[i].lower).count()};
+        dist.min_ns_ = std::min(dist.min_ns_, usable[i].lower.count());
+        dist.max_ns_ = std::max(dist.max_ns_, usable[i].upper.count());
+        scaled[i] = usable[i].weight * static_cast<double>(n) / total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t s = small.back();
+        small.pop_back();
+        const uint32_t l = large.back();
+        dist.alias_[s].threshold = static_cast<uint32_t>(std::lround(scaled[s] * 65536.0));
+        dist.alias_[s].alias = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    for (uint32_t i : large) dist.alias_[i].threshold = 65536; // Rounding leftovers keep themselves
+    for (uint32_t i : small) dist.alias_[i].threshold = 65536;
+    return dist;
+}
+
+LatencyDistribution LatencyDistribution::load_histogram(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open latency histogram: " + path);
+    }
+    std::vector<Bucket> buckets;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::stringstream ss(line);
+        std::string lower, upper, count;
+        if (!std::getline(ss, lower, ',') || !std::getline(ss, upper, ',') || !std::getline(ss, count, ',')) {
+            throw std::runtime_error("Malformed latency histogram line in " + path + ": " + line);
+        }
+        try {
+            buckets.push_back({Duration(std::stoll(lower)), Duration(std::stoll(upper)), std::stod(count)});
+        } catch (const std::logic_error&) { // std::invalid_argument, std::out_of_range
+            if (buckets.empty()) continue; // Header
+            throw std::runtime_error("Malformed latency histogram line in " + path + ": " + line);
+        }
+    }
+    return empirical(buckets);
+}
+
+void LatencyDistribution::sample_batch(uint64_t seed, uint64_t stream, uint64_t first_key, Duration* out, size_t count) const {
+    if (kind_ == Kind::CONSTANT) {
+        std::fill(out, out + count, Duration(min_ns_));
+        return;
+    }
+    if (kind_ == Kind::QUANTILES) {
+        for (size_t i = 0; i < count; ++i) out[i] = Duration(sample_quantiles(keyed_draw(seed, stream, first_key + i)));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) out[i] = Duration(sample_alias(keyed_draw(seed, stream, first_key + i)));
+}
+
+} // namespace market_replay
@@ -1,45 +1,105 @@
 #include "market_replay/latency_model.hpp"
 #include "market_replay/event.hpp" // For BaseEvent if type-specific latency needed
+#include <algorithm> // For std::min
 
 namespace market_replay {
 
-LatencyModel::LatencyModel(Config config) : config_(config) {
-    // If using random distributions, initialize here, e.g., with a fixed seed for determinism
-    // random_generator_.seed(std::random_device{}()); // Or a fixed seed
+LatencyModel::LatencyModel(Config config) : config_(std::move(config)) {
+    const Duration fixed[kNumLegs] = {
+        config_.market_data_feed_latency, config_.strategy_processing_latency,
+        config_.order_network_latency_strat_to_exch, config_.exchange_order_processing_latency,
+        config_.exchange_fill_processing_latency, config_.ack_network_latency_exch_to_strat};
+    for (size_t leg = 0; leg < kNumLegs; ++leg) {
+        constant_legs_.push_back(std::make_shared<const LatencyDistribution>(LatencyDistribution::constant(fixed[leg])));
+        const auto& configured = config_.distributions.legs[leg];
+        default_legs_[leg] = configured ? configured.get() : constant_legs_[leg].get();
+    }
+
+    // Resolve overrides into one table per SymbolId up front, so a sample is an index and a lookup
+    auto apply = [](LegTable& table, const LegDistributions& overrides) {
+        for (size_t leg = 0; leg < kNumLegs; ++leg) {
+            if (overrides.legs[leg]) table[leg] = overrides.legs[leg].get();
+        }
+    };
+    auto table_for = [this](const std::string& symbol) -> LegTable& {
+        const SymbolId id = intern_symbol(symbol);
+        if (id >= symbol_legs_.size()) symbol_legs_.resize(static_cast<size_t>(id) + 1, default_legs_);
+        return symbol_legs_[id];
+    };
+    for (const auto& [symbol, venue] : config_.symbol_venues) {
+        auto it = config_.venue_overrides.find(venue);
+        if (it != config_.venue_overrides.end()) apply(table_for(symbol), it->second);
+    }
+    for (const auto& [symbol, overrides] : config_.symbol_overrides) {
+        apply(table_for(symbol), overrides);
+    }
+}
+
+LatencyModel::LatencyModel() : LatencyModel(Config{}) {
+}
+
+LatencyModel::Config LatencyModel::cli_config() {
+    Config cfg;
+    cfg.market_data_feed_latency = string_to_duration_ns("50us");
+    cfg.strategy_processing_latency = string_to_duration_ns("5us");
+    cfg.order_network_latency_strat_to_exch = string_to_duration_ns("20us");
+    cfg.exchange_order_processing_latency = string_to_duration_ns("10us");
+    cfg.exchange_fill_processing_latency = string_to_duration_ns("15us");
+    cfg.ack_network_latency_exch_to_strat = string_to_duration_ns("20us");
+    return cfg;
+}
+
+Duration LatencyModel::get_market_data_latency(const BaseEvent& event, uint64_t sequence) const {
+    SymbolId symbol_id = INVALID_SYMBOL_ID;
+    if (event.type == EventType::QUOTE) {
+        symbol_id = static_cast<const QuoteEvent&>(event).symbol_id;
+    } else if (event.type == EventType::TRADE) {
+        symbol_id = static_cast<const TradeEvent&>(event).symbol_id;
+    }
+    return sample(Leg::MARKET_DATA_FEED, symbol_id, sequence);
 }
 
-LatencyModel::LatencyModel() : config_({}) { // or just config_() for C++11 onwards
+Duration LatencyModel::get_strategy_processing_latency(SymbolId symbol_id, uint64_t key) const {
+    return sample(Leg::STRATEGY_PROCESSING, symbol_id, key);
 }
 
-Duration LatencyModel::get_market_data_latency(const BaseEvent& /*event*/) const {
-    // Could make this event-dependent (e.g. different latency for different symbols/exchanges)
-    return config_.market_data_feed_latency;
+Duration LatencyModel::min_decision_to_exchange_latency() const {
+    auto decision_to_exchange = [](const LegTable& table) {
+        return table[static_cast<size_t>(Leg::STRATEGY_PROCESSING)]->min() +
+               table[static_cast<size_t>(Leg::ORDER_NETWORK)]->min();
+    };
+    Duration lowest = decision_to_exchange(default_legs_);
+    for (const auto& table : symbol_legs_) {
+        lowest = std::min(lowest, decision_to_exchange(table));
+    }
+    return lowest;
 }
 
-Duration LatencyModel::get_strategy_processing_latency() const {
-    return config_.strategy_processing_latency;
+void LatencyModel::sample_batch(Leg leg, SymbolId symbol_id, uint64_t first_key, Duration* out, size_t count) const {
+    distribution(leg, symbol_id).sample_batch(config_.seed, static_cast<uint64_t>(leg), first_key, out, count);
 }
 
-Timestamp LatencyModel::get_order_arrival_at_exchange_ts(Timestamp strategy_decision_ts) const {
+Timestamp LatencyModel::get_order_arrival_at_exchange_ts(Timestamp strategy_decision_ts, SymbolId symbol_id, uint64_t key) const {
     // strategy_decision_ts is when the strategy finished its logic and called submit_order.
     // This includes its internal processing.
-    return strategy_decision_ts + config_.order_network_latency_strat_to_exch;
+    return strategy_decision_ts + sample(Leg::ORDER_NETWORK, symbol_id, key);
 }
 
-Timestamp LatencyModel::get_ack_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts) const {
-    Timestamp ack_leaves_exchange_ts = order_arrival_at_exchange_ts + config_.exchange_order_processing_latency;
-    return ack_leaves_exchange_ts + config_.ack_network_latency_exch_to_strat;
+Timestamp LatencyModel::get_ack_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts, SymbolId symbol_id, uint64_t key) const {
+    Timestamp ack_leaves_exchange_ts = order_arrival_at_exchange_ts + sample(Leg::EXCHANGE_ORDER_PROCESSING, symbol_id, key);
+    return ack_leaves_exchange_ts + sample(Leg::ACK_NETWORK, symbol_id, key);
 }
 
-Timestamp LatencyModel::get_fill_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts) const {
+Timestamp LatencyModel::get_fill_arrival_at_strategy_ts(Timestamp order_arrival_at_exchange_ts, SymbolId symbol_id, uint64_t key) const {
     // Assumes fill processing starts after order arrival.
     // If fill processing is separate from ack, it could be:
     // fill_leaves_exchange_ts = order_arrival_at_exchange_ts + config_.exchange_fill_processing_latency
     // return fill_leaves_exchange_ts + config_.ack_network_latency_exch_to_strat;
     // Or, if a fill implies an ack path:
-    Timestamp processing_done_ts = order_arrival_at_exchange_ts + config_.exchange_fill_processing_latency;
-    return processing_done_ts + config_.ack_network_latency_exch_to_strat;
+    Timestamp processing_done_ts = order_arrival_at_exchange_ts + sample(Leg::EXCHANGE_FILL_PROCESSING, symbol_id, key);
+    // The return trip of a fill is drawn apart from the ack's for the same key
+    return processing_done_ts + sample(Leg::ACK_NETWORK, symbol_id, ~key);
 }
 
 
-} // namespace market_replay
\ No newline at end of file
+} // namespace market_replay
@@ -1,66 +1,333 @@
 #include "market_replay/order_book.hpp"
+#include "market_replay/checkpoint.hpp"
 #include "market_replay/logger.hpp"
+#include <algorithm>
 #include <cmath> // For std::isnan
+#include <iterator> // For std::prev
+#include <limits>
 
 namespace market_replay {
 
-void SimpleOrderBook::update_quote(const QuoteEvent& quote) {
-    if (quote.symbol != symbol_) return;
+SimpleOrderBook::Level* SimpleOrderBook::Ladder::find(PriceTicks tick) {
+    if (in_window(tick)) return &levels[static_cast<size_t>(tick - base_tick)];
+    if (far.empty()) return nullptr;
+    auto it = far.find(tick);
+    return it == far.end() ? nullptr : &it->second;
+}
+
+const SimpleOrderBook::Level* SimpleOrderBook::Ladder::find(PriceTicks tick) const {
+    return const_cast<Ladder*>(this)->find(tick);
+}
+
+PriceTicks SimpleOrderBook::Ladder::next_tick(OrderSide side, PriceTicks tick) const {
+    const PriceTicks first = base_tick;
+    const PriceTicks last = base_tick + static_cast<PriceTicks>(levels.size()) - 1;
+    if (side == OrderSide::BUY) {
+        if (in_window(tick - 1)) return tick - 1;
+        PriceTicks next = std::numeric_limits<PriceTicks>::min();
+        if (!levels.empty() && last < tick) next = last;
+        auto it = far.lower_bound(tick);
+        if (it != far.begin()) next = std::max(next, std::prev(it)->first);
+        return next;
+    }
+    if (in_window(tick + 1)) return tick + 1;
+    PriceTicks next = std::numeric_limits<PriceTicks>::max();
+    if (!levels.empty() && first > tick) next = first;
+    auto it = far.upper_bound(tick);
+    if (it != far.end()) next = std::min(next, it->first);
+    return next;
+}
+
+void SimpleOrderBook::Ladder::prune(PriceTicks tick) {
+    if (far.empty() || in_window(tick)) return;
+    auto it = far.find(tick);
+    if (it != far.end() && it->second.market_quantity == 0 && it->second.head == kNil) far.erase(it);
+}
+
+SimpleOrderBook::SimpleOrderBook(SymbolId symbol_id) : SimpleOrderBook(symbol_id, Config{}) {}
+
+SimpleOrderBook::SimpleOrderBook(SymbolId symbol_id, Config config)
+    : symbol_id_(symbol_id), config_(config) {
+    if (config_.max_levels < kInitialLevels) config_.max_levels = kInitialLevels;
+}
+
+std::optional<Price> SimpleOrderBook::get_bid_price() const {
+    return has_bid() ? std::optional<Price>(to_price(best_bid_ticks_)) : std::nullopt;
+}
+std::optional<Quantity> SimpleOrderBook::get_bid_size() const {
+    return has_bid() ? std::optional<Quantity>(best_bid_size_) : std::nullopt;
+}
+std::optional<Price> SimpleOrderBook::get_ask_price() const {
+    return has_ask() ? std::optional<Price>(to_price(best_ask_ticks_)) : std::nullopt;
+}
+std::optional<Quantity> SimpleOrderBook::get_ask_size() const {
+    return has_ask() ? std::optional<Quantity>(best_ask_size_) : std::nullopt;
+}
 
-    if (quote.bid_price > 0 && quote.bid_size > 0) {
-        best_bid_price_ = quote.bid_price;
+SimpleOrderBook::Level* SimpleOrderBook::level_for(Ladder& ladder, PriceTicks tick) {
+    if (Level* level = ladder.find(tick)) return level;
+
+    const PriceTicks size = static_cast<PriceTicks>(ladder.levels.size());
+    const PriceTicks max_levels = static_cast<PriceTicks>(config_.max_levels);
+    if (size == 0 || (ladder.resting_orders == 0 &&
+                      std::max(ladder.base_tick + size - 1, tick) - std::min(ladder.base_tick, tick) + 1 > max_levels)) {
+        // First use, or the market drifted out of span with nothing of ours to keep: re-centre
+        const PriceTicks new_size = size == 0 ? static_cast<PriceTicks>(kInitialLevels) : size;
+        ladder.levels.assign(static_cast<size_t>(new_size), Level{});
+        ladder.base_tick = tick - new_size / 2;
+        ladder.far.clear(); // Only market sizes from where the market was
+        return ladder.find(tick);
+    }
+
+    const PriceTicks lo = std::min(ladder.base_tick, tick);
+    const PriceTicks hi = std::max(ladder.base_tick + size - 1, tick);
+    if (hi - lo + 1 > max_levels) return &ladder.far[tick]; // Pinned by a resting order: kept sparsely
+
+    // Grow geometrically towards the new tick so a drifting market re-allocates O(log span) times
+    const PriceTicks new_size = std::min(max_levels, std::max(hi - lo + 1, size * 2));
+    const PriceTicks new_base = tick < ladder.base_tick ? ladder.base_tick + size - new_size : ladder.base_tick;
+    std::vector<Level> grown(static_cast<size_t>(new_size));
+    std::copy(ladder.levels.begin(), ladder.levels.end(), grown.begin() + (ladder.base_tick - new_base));
+    ladder.levels.swap(grown);
+    ladder.base_tick = new_base;
+    // Far levels the window now covers move into it
+    for (auto it = ladder.far.lower_bound(new_base); it != ladder.far.end() && ladder.in_window(it->first);) {
+        ladder.levels[static_cast<size_t>(it->first - new_base)] = it->second;
+        it = ladder.far.erase(it);
+    }
+    return ladder.find(tick);
+}
+
+void SimpleOrderBook::set_market_quantity(OrderSide side, PriceTicks tick, Quantity quantity) {
+    Ladder& l = ladder(side);
+    Level* level = level_for(l, tick);
+    level->market_quantity = quantity;
+    for (uint32_t i = level->head; i != kNil; i = orders_[i].next) {
+        orders_[i].queue_ahead = std::min(orders_[i].queue_ahead, quantity);
+    }
+    if (quantity == 0) l.prune(tick);
+}
+
+void SimpleOrderBook::retreat(OrderSide side, PriceTicks old_best_tick, PriceTicks new_best_tick) {
+    Ladder& l = ladder(side);
+    if (l.levels.empty()) return;
+    const PriceTicks cleared_from = side == OrderSide::BUY ? new_best_tick + 1 : old_best_tick;
+    const PriceTicks cleared_to = side == OrderSide::BUY ? old_best_tick : new_best_tick - 1;
+    auto clear = [this](Level& level) {
+        level.market_quantity = 0;
+        for (uint32_t i = level.head; i != kNil; i = orders_[i].next) {
+            orders_[i].queue_ahead = 0; // Whoever was ahead of us has gone
+        }
+    };
+    // Walk only the cleared range that is inside the ladder, then the far levels in it
+    const PriceTicks from = std::max(cleared_from, l.base_tick);
+    const PriceTicks to = std::min(cleared_to, l.base_tick + static_cast<PriceTicks>(l.levels.size()) - 1);
+    for (PriceTicks tick = from; tick <= to; ++tick) clear(l.levels[static_cast<size_t>(tick - l.base_tick)]);
+    for (auto it = l.far.lower_bound(cleared_from); it != l.far.end() && it->first <= cleared_to;) {
+        clear(it->second);
+        it = it->second.head == kNil ? l.far.erase(it) : std::next(it);
+    }
+}
+
+void SimpleOrderBook::update_quote(const QuoteEvent& quote, std::vector<Fill>& fills) {
+    if (quote.symbol_id != symbol_id_) return;
+
+    // INVALID_PRICE_TICKS (a NaN price) is negative, so it clears the side like any bad price
+    const PriceTicks bid_ticks = quote.get_bid_ticks();
+    if (bid_ticks > 0 && quote.bid_size > 0) {
+        if (has_bid() && bid_ticks < best_bid_ticks_) retreat(OrderSide::BUY, best_bid_ticks_, bid_ticks);
+        best_bid_ticks_ = bid_ticks;
         best_bid_size_ = quote.bid_size;
+        set_market_quantity(OrderSide::BUY, bid_ticks, quote.bid_size);
     } else { // Clear side if price/size is invalid
-        best_bid_price_ = std::nullopt;
-        best_bid_size_ = std::nullopt;
+        if (has_bid()) retreat(OrderSide::BUY, best_bid_ticks_, best_bid_ticks_ - 1);
+        best_bid_size_ = 0;
     }
 
-    if (quote.ask_price > 0 && quote.ask_size > 0) {
-        best_ask_price_ = quote.ask_price;
+    const PriceTicks ask_ticks = quote.get_ask_ticks();
+    if (ask_ticks > 0 && quote.ask_size > 0) {
+        if (has_ask() && ask_ticks > best_ask_ticks_) retreat(OrderSide::SELL, best_ask_ticks_, ask_ticks);
+        best_ask_ticks_ = ask_ticks;
         best_ask_size_ = quote.ask_size;
+        set_market_quantity(OrderSide::SELL, ask_ticks, quote.ask_size);
     } else {
-        best_ask_price_ = std::nullopt;
-        best_ask_size_ = std::nullopt;
+        if (has_ask()) retreat(OrderSide::SELL, best_ask_ticks_, best_ask_ticks_ + 1);
+        best_ask_size_ = 0;
     }
-    // LOG_DEBUG("OrderBook [{}]: Updated. Bid: {}@{}, Ask: {}@{}", symbol_,
-    //     best_bid_price_.value_or(0.0), best_bid_size_.value_or(0),
-    //     best_ask_price_.value_or(0.0), best_ask_size_.value_or(0));
+
+    // An opposite quote strictly through a resting order means that liquidity traded with us
+    if (bids_.resting_orders > 0 && has_ask() && best_ask_ticks_ < bids_.best_resting_tick) {
+        execute_against(OrderSide::BUY, best_ask_ticks_ + 1, best_ask_size_, false, fills);
+    }
+    if (asks_.resting_orders > 0 && has_bid() && best_bid_ticks_ > asks_.best_resting_tick) {
+        execute_against(OrderSide::SELL, best_bid_ticks_ - 1, best_bid_size_, false, fills);
+    }
+    // LOG_DEBUG("OrderBook [{}]: Updated. Bid: {}@{}, Ask: {}@{}", get_symbol(),
+    //     get_bid_price().value_or(0.0), best_bid_size_, get_ask_price().value_or(0.0), best_ask_size_);
 }
 
-std::pair<Price, Quantity> SimpleOrderBook::match_market_order(OrderSide side, Quantity quantity) {
-    if (quantity == 0) return {INVALID_PRICE, 0};
+void SimpleOrderBook::apply_trade(const TradeEvent& trade, std::vector<Fill>& fills) {
+    const PriceTicks tick = trade.get_price_ticks();
+    if (trade.symbol_id != symbol_id_ || tick <= 0 || trade.size == 0) return;
 
-    Price fill_price = INVALID_PRICE;
-    Quantity filled_quantity = 0;
+    // No aggressor side in the feed, so the print is offered to both sides of our book
+    if (bids_.resting_orders > 0 && bids_.best_resting_tick >= tick) {
+        execute_against(OrderSide::BUY, tick, trade.size, true, fills);
+    }
+    if (asks_.resting_orders > 0 && asks_.best_resting_tick <= tick) {
+        execute_against(OrderSide::SELL, tick, trade.size, true, fills);
+    }
+    for (Ladder* l : {&bids_, &asks_}) {
+        if (Level* level = l->find(tick)) {
+            level->market_quantity -= std::min(level->market_quantity, trade.size);
+            l->prune(tick);
+        }
+    }
+}
 
-    if (side == OrderSide::BUY) {
-        if (best_ask_price_ && best_ask_size_ && *best_ask_size_ > 0) {
-            fill_price = *best_ask_price_;
-            filled_quantity = std::min(quantity, *best_ask_size_);
-            *best_ask_size_ -= filled_quantity;
-            if (*best_ask_size_ == 0) { // Liquidity consumed
-                best_ask_price_ = std::nullopt;
+void SimpleOrderBook::execute_against(OrderSide side, PriceTicks limit_tick, Quantity volume, bool respect_queue,
+                                      std::vector<Fill>& fills) {
+    Ladder& l = ladder(side);
+    // From most to least aggressive
+    for (PriceTicks tick = l.best_resting_tick;
+         volume > 0 && l.resting_orders > 0 && !more_aggressive(side, limit_tick, tick);
+         tick = l.next_tick(side, tick)) {
+        Level* level = l.find(tick);
+        if (!level || level->head == kNil) continue;
+
+        // At the print price the market queue ahead of each order trades first. market_done is how
+        // much of it this print has consumed so far, walking the queue front to back.
+        const bool at_limit = respect_queue && tick == limit_tick;
+        Quantity market_done = 0;
+        for (uint32_t i = level->head; i != kNil;) {
+            RestingOrder& order = orders_[i];
+            const uint32_t next = order.next;
+            if (at_limit) {
+                const Quantity between = order.queue_ahead > market_done ? order.queue_ahead - market_done : 0;
+                const Quantity eaten = std::min(between, volume);
+                volume -= eaten;
+                market_done += eaten;
+                order.queue_ahead -= std::min(order.queue_ahead, market_done);
             }
-        } else {
-            LOG_WARN("OrderBook [{}]: Cannot match BUY market order, no ask liquidity.", symbol_);
-        }
-    } else { // SELL
-        if (best_bid_price_ && best_bid_size_ && *best_bid_size_ > 0) {
-            fill_price = *best_bid_price_;
-            filled_quantity = std::min(quantity, *best_bid_size_);
-            *best_bid_size_ -= filled_quantity;
-            if (*best_bid_size_ == 0) { // Liquidity consumed
-                best_bid_price_ = std::nullopt;
+            const Quantity filled = (order.queue_ahead == 0 || !at_limit) ? std::min(order.leaves, volume) : 0;
+            if (filled > 0) {
+                volume -= filled;
+                order.leaves -= filled;
+                order.cumulative += filled;
+                fills.push_back({order.exchange_order_id, order.client_order_id, order.strategy_index, order.side,
+                                 order.tick, order.price, filled, order.cumulative, order.leaves});
+                LOG_DEBUG("OrderBook [{}]: Resting {} ExchID {} filled {} @ {} (leaves {})", get_symbol(),
+                          (side == OrderSide::BUY ? "BUY" : "SELL"), order.exchange_order_id, filled, order.price, order.leaves);
+                if (order.leaves == 0) {
+                    order_index_.erase(order.exchange_order_id);
+                    unlink(l, *level, i);
+                }
             }
-        } else {
-            LOG_WARN("OrderBook [{}]: Cannot match SELL market order, no bid liquidity.", symbol_);
+            i = next;
         }
+        if (level->head == kNil) l.prune(tick);
     }
-    if (filled_quantity > 0) {
-         LOG_DEBUG("OrderBook [{}]: Matched MKT {} {} @ {}. New AskSz: {}, New BidSz: {}", symbol_,
-            (side == OrderSide::BUY ? "BUY" : "SELL"), filled_quantity, fill_price,
-            best_ask_size_.value_or(0), best_bid_size_.value_or(0));
+    refresh_best_resting(l, side);
+}
+
+void SimpleOrderBook::unlink(Ladder& l, Level& level, uint32_t index) {
+    RestingOrder& order = orders_[index];
+    if (order.prev != kNil) orders_[order.prev].next = order.next; else level.head = order.next;
+    if (order.next != kNil) orders_[order.next].prev = order.prev; else level.tail = order.prev;
+    free_orders_.push_back(index);
+    --l.resting_orders;
+}
+
+void SimpleOrderBook::refresh_best_resting(Ladder& l, OrderSide side) {
+    if (l.resting_orders == 0) return;
+    PriceTicks tick = l.best_resting_tick;
+    for (const Level* level = l.find(tick); !level || level->head == kNil; level = l.find(tick)) {
+        tick = l.next_tick(side, tick); // Terminates: every resting order sits on a level
+    }
+    l.best_resting_tick = tick;
+}
+
+bool SimpleOrderBook::add_limit_order(OrderId exchange_order_id, StrategyIndex strategy_index, OrderId client_order_id,
+                                      OrderSide side, Price price, Quantity leaves, Quantity already_filled) {
+    const PriceTicks tick = to_tick(price);
+    if (leaves == 0 || tick <= 0) return false;
+    if (order_index_.count(exchange_order_id)) return false;
+
+    Ladder& l = ladder(side);
+    Level* level = level_for(l, tick);
+
+    // Improving the market means nobody is ahead of us
+    const bool improves = side == OrderSide::BUY ? (!has_bid() || tick > best_bid_ticks_)
+                                                 : (!has_ask() || tick < best_ask_ticks_);
+    uint32_t index;
+    if (!free_orders_.empty()) {
+        index = free_orders_.back();
+        free_orders_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(orders_.size());
+        orders_.emplace_back();
     }
+    orders_[index] = RestingOrder{exchange_order_id, client_order_id, strategy_index, side, tick, to_price(tick),
+                                  leaves, already_filled, improves ? 0 : level->market_quantity, level->tail, kNil};
+    if (level->tail != kNil) orders_[level->tail].next = index; else level->head = index;
+    level->tail = index;
+    order_index_.emplace(exchange_order_id, index);
+
+    if (l.resting_orders == 0 || more_aggressive(side, tick, l.best_resting_tick)) l.best_resting_tick = tick;
+    ++l.resting_orders;
+    LOG_DEBUG("OrderBook [{}]: Resting {} ExchID {} {} @ {}, {} ahead", get_symbol(),
+              (side == OrderSide::BUY ? "BUY" : "SELL"), exchange_order_id, leaves, price, orders_[index].queue_ahead);
+    return true;
+}
+
+bool SimpleOrderBook::cancel_order(OrderId exchange_order_id) {
+    auto it = order_index_.find(exchange_order_id);
+    if (it == order_index_.end()) return false;
+    const uint32_t index = it->second;
+    order_index_.erase(it);
+    const RestingOrder& order = orders_[index];
+    const OrderSide side = order.side;
+    Ladder& l = ladder(side);
+    const PriceTicks tick = order.tick;
+    unlink(l, *l.find(tick), index);
+    l.prune(tick);
+    refresh_best_resting(l, side);
+    return true;
+}
+
+std::optional<Quantity> SimpleOrderBook::queue_ahead(OrderId exchange_order_id) const {
+    auto it = order_index_.find(exchange_order_id);
+    if (it == order_index_.end()) return std::nullopt;
+    return orders_[it->second].queue_ahead;
+}
+
+Quantity SimpleOrderBook::market_depth(OrderSide side, Price price) const {
+    const Level* level = ladder(side).find(to_tick(price));
+    return level ? level->market_quantity : 0;
+}
+
+std::pair<Price, Quantity> SimpleOrderBook::take_best(OrderSide side, Quantity quantity) {
+    // A BUY lifts the ask, a SELL hits the bid
+    const OrderSide book_side = side == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+    Quantity& best_size = side == OrderSide::BUY ? best_ask_size_ : best_bid_size_;
+    const PriceTicks best_ticks = side == OrderSide::BUY ? best_ask_ticks_ : best_bid_ticks_;
+    const Quantity filled_quantity = std::min(quantity, best_size);
+    best_size -= filled_quantity; // Reaching 0 empties the side
+    set_market_quantity(book_side, best_ticks, best_size);
+    return {to_price(best_ticks), filled_quantity};
+}
+
+std::pair<Price, Quantity> SimpleOrderBook::match_market_order(OrderSide side, Quantity quantity) {
+    if (quantity == 0) return {INVALID_PRICE, 0};
+
+    if (side == OrderSide::BUY ? !has_ask() : !has_bid()) {
+        LOG_WARN("OrderBook [{}]: Cannot match {} market order, no {} liquidity.", get_symbol(),
+                 (side == OrderSide::BUY ? "BUY" : "SELL"), (side == OrderSide::BUY ? "ask" : "bid"));
+        return {INVALID_PRICE, 0};
+    }
+    auto [fill_price, filled_quantity] = take_best(side, quantity);
+    LOG_DEBUG("OrderBook [{}]: Matched MKT {} {} @ {}. New AskSz: {}, New BidSz: {}", get_symbol(),
+              (side == OrderSide::BUY ? "BUY" : "SELL"), filled_quantity, fill_price, best_ask_size_, best_bid_size_);
     return {fill_price, filled_quantity};
 }
 
@@ -68,43 +335,127 @@ std::pair<Price, Quantity> SimpleOrderBook::match_market_order(OrderSide side, Q
 std::pair<Price, Quantity> SimpleOrderBook::match_limit_order(OrderSide side, Price limit_price, Quantity quantity) {
     if (quantity == 0 || std::isnan(limit_price)) return {INVALID_PRICE, 0};
 
-    Price fill_price = INVALID_PRICE;
-    Quantity filled_quantity = 0;
+    // Buy limit order is aggressive if limit >= best ask, sell limit if limit <= best bid
+    const PriceTicks limit_ticks = to_tick(limit_price);
+    const bool marketable = side == OrderSide::BUY ? (has_ask() && limit_ticks >= best_ask_ticks_)
+                                                   : (has_bid() && limit_ticks <= best_bid_ticks_);
+    if (!marketable) {
+        // Passive or unfillable at current market
+        LOG_DEBUG("OrderBook [{}]: {} limit order {} @ {} is passive or unfillable.", get_symbol(),
+                  (side == OrderSide::BUY ? "BUY" : "SELL"), quantity, limit_price);
+        return {INVALID_PRICE, 0};
+    }
+    auto [fill_price, filled_quantity] = take_best(side, quantity); // Filled at the opposite best
+    LOG_DEBUG("OrderBook [{}]: Matched LMT {} {} @ {} (Limit {}). New AskSz: {}, New BidSz: {}", get_symbol(),
+              (side == OrderSide::BUY ? "BUY" : "SELL"), filled_quantity, fill_price, limit_price,
+              best_ask_size_, best_bid_size_);
+    return {fill_price, filled_quantity};
+}
 
-    if (side == OrderSide::BUY) {
-        // Buy limit order is aggressive if limit_price >= best_ask_price
-        if (best_ask_price_ && *best_ask_price_ > 0 && limit_price >= (*best_ask_price_ - PRICE_EPSILON)) {
-            fill_price = *best_ask_price_; // Filled at ask
-            filled_quantity = std::min(quantity, *best_ask_size_);
-            *best_ask_size_ -= filled_quantity;
-             if (*best_ask_size_ == 0) {
-                best_ask_price_ = std::nullopt;
-            }
-        } else {
-            // Passive or unfillable at current market
-            LOG_DEBUG("OrderBook [{}]: BUY limit order {} for {} @ {} is passive or unfillable.", symbol_, quantity, limit_price, best_ask_price_.value_or(0.0));
+
+void SimpleOrderBook::save_state(CheckpointWriter& out) const {
+    out.write_svarint(best_bid_ticks_);
+    out.write_varint(best_bid_size_);
+    out.write_svarint(best_ask_ticks_);
+    out.write_varint(best_ask_size_);
+    for (const Ladder* l : {&bids_, &asks_}) {
+        out.write_varint(l->levels.size());
+        out.write_svarint(l->base_tick);
+        out.write_varint(l->resting_orders);
+        out.write_svarint(l->best_resting_tick);
+        size_t used = 0;
+        for (const Level& level : l->levels) used += (level.market_quantity != 0 || level.head != kNil);
+        out.write_varint(used);
+        for (size_t i = 0; i < l->levels.size(); ++i) {
+            const Level& level = l->levels[i];
+            if (level.market_quantity == 0 && level.head == kNil) continue;
+            out.write_varint(i);
+            out.write_varint(level.market_quantity);
+            out.write_varint(level.head); // kNil is a 5-byte varint
+            out.write_varint(level.tail);
         }
-    } else { // SELL
-        // Sell limit order is aggressive if limit_price <= best_bid_price
-        if (best_bid_price_ && *best_bid_size_ > 0 && limit_price <= (*best_bid_price_ + PRICE_EPSILON)) {
-            fill_price = *best_bid_price_; // Filled at bid
-            filled_quantity = std::min(quantity, *best_bid_size_);
-            *best_bid_size_ -= filled_quantity;
-            if (*best_bid_size_ == 0) {
-                best_bid_price_ = std::nullopt;
-            }
-        } else {
-            // Passive or unfillable
-            LOG_DEBUG("OrderBook [{}]: SELL limit order {} for {} @ {} is passive or unfillable.", symbol_, quantity, limit_price, best_bid_price_.value_or(0.0));
+        out.write_varint(l->far.size());
+        for (const auto& [tick, level] : l->far) {
+            out.write_svarint(tick);
+            out.write_varint(level.market_quantity);
+            out.write_varint(level.head);
+            out.write_varint(level.tail);
         }
     }
-    if (filled_quantity > 0) {
-         LOG_DEBUG("OrderBook [{}]: Matched LMT {} {} @ {} (Limit {}). New AskSz: {}, New BidSz: {}", symbol_,
-            (side == OrderSide::BUY ? "BUY" : "SELL"), filled_quantity, fill_price, limit_price,
-            best_ask_size_.value_or(0), best_bid_size_.value_or(0));
+    // Every slot, free ones included, so slot numbers (and the links between them) stay valid
+    out.write_varint(orders_.size());
+    for (const RestingOrder& order : orders_) {
+        out.write_varint(order.exchange_order_id);
+        out.write_varint(order.client_order_id);
+        out.write_varint(order.strategy_index);
+        out.write_u8(static_cast<uint8_t>(order.side));
+        out.write_svarint(order.tick);
+        out.write_f64(order.price);
+        out.write_varint(order.leaves);
+        out.write_varint(order.cumulative);
+        out.write_varint(order.queue_ahead);
+        out.write_varint(order.prev);
+        out.write_varint(order.next);
     }
-    return {fill_price, filled_quantity};
+    out.write_varint(free_orders_.size());
+    for (uint32_t index : free_orders_) out.write_varint(index);
 }
 
+void SimpleOrderBook::restore_state(CheckpointReader& in) {
+    best_bid_ticks_ = in.read_svarint();
+    best_bid_size_ = in.read_varint();
+    best_ask_ticks_ = in.read_svarint();
+    best_ask_size_ = in.read_varint();
+    for (Ladder* l : {&bids_, &asks_}) {
+        l->levels.assign(static_cast<size_t>(in.read_varint()), Level{});
+        l->base_tick = in.read_svarint();
+        l->resting_orders = static_cast<size_t>(in.read_varint());
+        l->best_resting_tick = in.read_svarint();
+        for (uint64_t used = in.read_varint(); used > 0; --used) {
+            const uint64_t i = in.read_varint();
+            Level level;
+            level.market_quantity = in.read_varint();
+            level.head = static_cast<uint32_t>(in.read_varint());
+            level.tail = static_cast<uint32_t>(in.read_varint());
+            if (i < l->levels.size()) l->levels[i] = level;
+        }
+        l->far.clear();
+        for (uint64_t far = in.read_varint(); far > 0; --far) {
+            const PriceTicks tick = in.read_svarint();
+            Level& level = l->far[tick];
+            level.market_quantity = in.read_varint();
+            level.head = static_cast<uint32_t>(in.read_varint());
+            level.tail = static_cast<uint32_t>(in.read_varint());
+        }
+    }
+    orders_.resize(static_cast<size_t>(in.read_varint()));
+    for (RestingOrder& order : orders_) {
+        order.exchange_order_id = in.read_varint();
+        order.client_order_id = in.read_varint();
+        order.strategy_index = static_cast<StrategyIndex>(in.read_varint());
+        order.side = static_cast<OrderSide>(in.read_u8());
+        order.tick = in.read_svarint();
+        order.price = in.read_f64();
+        order.leaves = in.read_varint();
+        order.cumulative = in.read_varint();
+        order.queue_ahead = in.read_varint();
+        order.prev = static_cast<uint32_t>(in.read_varint());
+        order.next = static_cast<uint32_t>(in.read_varint());
+    }
+    free_orders_.resize(static_cast<size_t>(in.read_varint()));
+    for (uint32_t& index : free_orders_) index = static_cast<uint32_t>(in.read_varint());
+
+    // The index holds exactly the orders linked into a level
+    order_index_.clear();
+    auto index_level = [this](const Level& level) {
+        for (uint32_t i = level.head; i != kNil && i < orders_.size(); i = orders_[i].next) {
+            order_index_.emplace(orders_[i].exchange_order_id, i);
+        }
+    };
+    for (const Ladder* l : {&bids_, &asks_}) {
+        for (const Level& level : l->levels) index_level(level);
+        for (const auto& far : l->far) index_level(far.second);
+    }
+}
 
-} // namespace market_replay
\ No newline at end of file
+} // namespace market_replay
@@ -0,0 +1,204 @@
+#include "market_replay/pnl_engine.hpp"
+#include "market_replay/checkpoint.hpp"
+#include <algorithm> // For std::min, std::max
+#include <cstdlib>   // For std::llabs
+
+namespace market_replay {
+
+namespace {
+
+// value * num / den truncated toward zero, for 0 < num < den, without overflowing the product as
+// long as den * den fits: the cost basis times a quantity can exceed 64 bits where the result can't
+PriceTicks mul_div(PriceTicks value, long long num, long long den) {
+    const PriceTicks quotient = value / den;
+    const PriceTicks remainder = value % den; // Same sign as quotient, so the two parts add up
+    return quotient * num + remainder * num / den;
+}
+
+} // namespace
+
+PnLEngine::PnLEngine() : PnLEngine(Config{}) {}
+
+PnLEngine::PnLEngine(Config config) : config_(config) {
+    reset(0);
+}
+
+void PnLEngine::reset(size_t num_strategies) {
+    num_strategies_ = num_strategies;
+    symbol_stride_ = 0;
+    positions_.clear();
+    marks_.clear();
+    snapshots_.clear();
+    // The first event starts the snapshot clock
+    next_snapshot_ = config_.snapshot_interval > Duration(0) ? Timestamp::min() : Timestamp::max();
+}
+
+void PnLEngine::grow_symbols(SymbolId symbol_id) {
+    const size_t stride = std::max<size_t>(std::max<size_t>(16, symbol_stride_ * 2), static_cast<size_t>(symbol_id) + 1);
+    std::vector<Position> widened(num_strategies_ * stride);
+    for (size_t strategy = 0; strategy < num_strategies_; ++strategy) {
+        std::copy_n(positions_.begin() + strategy * symbol_stride_, symbol_stride_, widened.begin() + strategy * stride);
+    }
+    positions_.swap(widened);
+    marks_.resize(stride, kNoMark);
+    symbol_stride_ = stride;
+}
+
+void PnLEngine::on_fill(StrategyIndex strategy, SymbolId symbol_id, OrderSide side, PriceTicks price_ticks, Quantity quantity) {
+    if (strategy >= num_strategies_ || quantity == 0 || price_ticks == INVALID_PRICE_TICKS) return;
+    if (symbol_id >= symbol_stride_) grow_symbols(symbol_id);
+    Position& position = slot(strategy, symbol_id);
+    const long long direction = side == OrderSide::BUY ? 1 : -1;
+    const long long fill_quantity = static_cast<long long>(quantity);
+
+    position.fills++;
+    position.volume_ticks += price_ticks * fill_quantity;
+    if (marks_[symbol_id] == kNoMark) marks_[symbol_id] = 2 * price_ticks; // Until the first quote
+
+    long long opening = fill_quantity;
+    if (position.quantity != 0 && (position.quantity > 0) != (direction > 0)) {
+        // Closes some or all of the position at its average cost. A full close takes the whole
+        // basis, so rounding in partial closes never outlives the position.
+        const long long open = std::llabs(position.quantity);
+        const long long closed = std::min(fill_quantity, open);
+        const PriceTicks closed_cost = closed == open
+            ? position.open_cost_ticks
+            : mul_div(position.open_cost_ticks, closed, open);
+        const long long held = position.quantity > 0 ? 1 : -1;
+        position.realized_ticks += held * closed * price_ticks - closed_cost;
+        position.open_cost_ticks -= closed_cost;
+        position.quantity += direction * closed;
+        opening -= closed;
+    }
+    if (opening > 0) { // Opens or adds to a position, possibly after flipping through flat
+        position.open_cost_ticks += direction * opening * price_ticks;
+        position.quantity += direction * opening;
+    }
+}
+
+PriceTicks PnLEngine::unrealized_ticks_x2(const Position& position, SymbolId symbol_id) const {
+    if (position.quantity == 0 || marks_[symbol_id] == kNoMark) return 0;
+    return position.quantity * marks_[symbol_id] - 2 * position.open_cost_ticks;
+}
+
+const PnLEngine::Position& PnLEngine::position(StrategyIndex strategy, SymbolId symbol_id) const {
+    static const Position flat;
+    if (strategy >= num_strategies_ || symbol_id >= symbol_stride_) return flat;
+    return positions_[static_cast<size_t>(strategy) * symbol_stride_ + symbol_id];
+}
+
+PnL PnLEngine::pnl(StrategyIndex strategy, SymbolId symbol_id) const {
+    PnL pnl;
+    const Position& p = position(strategy, symbol_id);
+    if (p.fills == 0) return pnl;
+    pnl.current_position = p.quantity;
+    pnl.realized_pnl = from_price_ticks(symbol_id, p.realized_ticks);
+    pnl.unrealized_pnl = from_price_ticks(symbol_id, unrealized_ticks_x2(p, symbol_id)) / 2;
+    pnl.total_volume_traded = from_price_ticks(symbol_id, p.volume_ticks);
+    return pnl;
+}
+
+double PnLEngine::realized_pnl(StrategyIndex strategy) const {
+    double total = 0.0;
+    if (strategy >= num_strategies_) return total;
+    for (SymbolId symbol_id = 0; symbol_id < symbol_stride_; ++symbol_id) {
+        const Position& p = positions_[static_cast<size_t>(strategy) * symbol_stride_ + symbol_id];
+        if (p.realized_ticks != 0) total += from_price_ticks(symbol_id, p.realized_ticks);
+    }
+    return total;
+}
+
+double PnLEngine::unrealized_pnl(StrategyIndex strategy) const {
+    double total = 0.0;
+    if (strategy >= num_strategies_) return total;
+    for (SymbolId symbol_id = 0; symbol_id < symbol_stride_; ++symbol_id) {
+        const Position& p = positions_[static_cast<size_t>(strategy) * symbol_stride_ + symbol_id];
+        if (p.quantity != 0) total += from_price_ticks(symbol_id, unrealized_ticks_x2(p, symbol_id)) / 2;
+    }
+    return total;
+}
+
+void PnLEngine::take_snapshots(Timestamp now) {
+    if (next_snapshot_ == Timestamp::min()) {
+        next_snapshot_ = now + config_.snapshot_interval;
+        return;
+    }
+    // Nothing changed since the last event, so the state now is the state at the last boundary crossed
+    const auto boundaries_crossed = (now - next_snapshot_) / config_.snapshot_interval;
+    const Timestamp boundary = next_snapshot_ + boundaries_crossed * config_.snapshot_interval;
+    for (size_t strategy = 0; strategy < num_strategies_; ++strategy) {
+        const auto index = static_cast<StrategyIndex>(strategy);
+        snapshots_.push_back({boundary, index, realized_pnl(index), unrealized_pnl(index)});
+    }
+    next_snapshot_ = boundary + config_.snapshot_interval;
+}
+
+void PnLEngine::save_state(CheckpointWriter& out) const {
+    out.write_varint(num_strategies_);
+    out.write_varint(symbol_stride_);
+    size_t open_positions = 0;
+    for (const Position& p : positions_) open_positions += (p.fills != 0);
+    out.write_varint(open_positions);
+    for (size_t i = 0; i < positions_.size(); ++i) {
+        const Position& p = positions_[i];
+        if (p.fills == 0) continue;
+        out.write_varint(i);
+        out.write_svarint(p.quantity);
+        out.write_svarint(p.open_cost_ticks);
+        out.write_svarint(p.realized_ticks);
+        out.write_svarint(p.volume_ticks);
+        out.write_varint(p.fills);
+    }
+    size_t marked = 0;
+    for (PriceTicks mark : marks_) marked += (mark != kNoMark);
+    out.write_varint(marked);
+    for (size_t symbol_id = 0; symbol_id < marks_.size(); ++symbol_id) {
+        if (marks_[symbol_id] == kNoMark) continue;
+        out.write_varint(symbol_id);
+        out.write_svarint(marks_[symbol_id]);
+    }
+    out.write_timestamp(next_snapshot_);
+    out.write_varint(snapshots_.size());
+    for (const EquitySnapshot& snapshot : snapshots_) {
+        out.write_timestamp(snapshot.timestamp);
+        out.write_varint(snapshot.strategy_index);
+        out.write_f64(snapshot.realized_pnl);
+        out.write_f64(snapshot.unrealized_pnl);
+    }
+}
+
+void PnLEngine::restore_state(CheckpointReader& in) {
+    reset(static_cast<size_t>(in.read_varint()));
+    symbol_stride_ = static_cast<size_t>(in.read_varint());
+    positions_.assign(num_strategies_ * symbol_stride_, Position{});
+    marks_.assign(symbol_stride_, kNoMark);
+    for (uint64_t open_positions = in.read_varint(); open_positions > 0; --open_positions) {
+        const uint64_t i = in.read_varint();
+        Position p;
+        p.quantity = in.read_svarint();
+        p.open_cost_ticks = in.read_svarint();
+        p.realized_ticks = in.read_svarint();
+        p.volume_ticks = in.read_svarint();
+        p.fills = in.read_varint();
+        if (i < positions_.size()) positions_[i] = p;
+    }
+    for (uint64_t marked = in.read_varint(); marked > 0; --marked) {
+        const uint64_t symbol_id = in.read_varint();
+        const PriceTicks mark = in.read_svarint();
+        if (symbol_id < marks_.size()) marks_[symbol_id] = mark;
+    }
+    const Timestamp next_snapshot = in.read_timestamp();
+    if (config_.snapshot_interval > Duration(0)) {
+        next_snapshot_ = next_snapshot == Timestamp::max() ? Timestamp::min() : next_snapshot;
+    }
+    for (uint64_t count = in.read_varint(); count > 0; --count) {
+        EquitySnapshot snapshot;
+        snapshot.timestamp = in.read_timestamp();
+        snapshot.strategy_index = static_cast<StrategyIndex>(in.read_varint());
+        snapshot.realized_pnl = in.read_f64();
+        snapshot.unrealized_pnl = in.read_f64();
+        snapshots_.push_back(snapshot);
+    }
+}
+
+} // namespace market_replay
@@ -0,0 +1,111 @@
+#include "market_replay/sweep_runner.hpp"
+#include "market_replay/logger.hpp"
+
+#include <algorithm> // For std::min, std::replace
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+namespace market_replay {
+
+SweepRunner::SweepRunner(std::shared_ptr<const MarketDataBuffer> data)
+    : SweepRunner(std::move(data), Config{}) {}
+
+SweepRunner::SweepRunner(std::shared_ptr<const MarketDataBuffer> data, Config config)
+    : data_(std::move(data)), config_(std::move(config)) {
+    if (!data_) {
+        throw std::invalid_argument("SweepRunner: no market data");
+    }
+    if (config_.num_threads == 0) {
+        config_.num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+std::vector<SweepRunner::Result> SweepRunner::run(const std::vector<Scenario>& scenarios) {
+    std::vector<Result> results(scenarios.size());
+    std::ofstream summary(config_.summary_path);
+    if (!summary.is_open()) {
+        LOG_ERROR("SweepRunner: Failed to open summary file: {}", config_.summary_path);
+    } else {
+        summary << "Scenario,Status,WallMs,Trades,Quantity,VolumeTraded,NetPosition,LatencyRecords,MeanLatencyNS,MaxLatencyNS,"
+                   "MarketDataNS,StrategyProcessingNS,OrderNetworkNS,ExchangeAckNS,ExchangeFillNS,AckNetworkNS,Error\n";
+        summary.flush();
+    }
+
+    const size_t num_workers = std::min(config_.num_threads, std::max<size_t>(scenarios.size(), 1));
+    LOG_INFO("SweepRunner: {} scenarios over {} events on {} threads.", scenarios.size(), data_->size(), num_workers);
+
+    std::atomic<size_t> next_scenario{0};
+    auto worker = [&] {
+        for (size_t i = next_scenario.fetch_add(1); i < scenarios.size(); i = next_scenario.fetch_add(1)) {
+            results[i] = run_scenario(scenarios[i]);
+            append_summary_line(summary, scenarios[i], results[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (size_t t = 0; t < num_workers; ++t) workers.emplace_back(worker);
+    for (auto& t : workers) t.join();
+
+    LOG_INFO("SweepRunner: Sweep finished, summary written to {}", config_.summary_path);
+    return results;
+}
+
+SweepRunner::Result SweepRunner::run_scenario(const Scenario& scenario) const {
+    Result result;
+    result.name = scenario.name;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        const bool write_files = !config_.per_run_output_dir.empty();
+        const std::string prefix = write_files ? config_.per_run_output_dir + "/" + scenario.name : std::string();
+        // Empty paths: totals only, nothing written
+        auto metrics = write_files
+            ? std::make_shared<MetricsCollector>(prefix + "_trades.csv", prefix + "_latency.csv", prefix + "_pnl.csv")
+            : std::make_shared<MetricsCollector>("", "", "");
+        {
+            Dispatcher dispatcher(std::make_unique<MarketDataBufferSource>(data_), scenario.latency, metrics, scenario.dispatcher);
+            for (const auto& spec : scenario.strategies) {
+                dispatcher.add_strategy(spec.id, spec.factory, spec.options);
+            }
+            dispatcher.run();
+        } // Strategies are joined and destroyed before the metrics are read
+        if (write_files) metrics->report_final_metrics();
+        result.metrics = metrics->summary();
+        result.latency_histograms = metrics->latency_histograms();
+        result.ok = true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("SweepRunner: Scenario '{}' failed: {}", scenario.name, e.what());
+        result.error = e.what();
+    }
+    result.wall_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+void SweepRunner::append_summary_line(std::ofstream& summary, const Scenario& scenario, const Result& result) {
+    std::lock_guard<std::mutex> lock(summary_mutex_);
+    if (!summary.is_open()) return;
+    const LatencyModel::Config& lat = scenario.latency;
+    std::string error = result.error;
+    std::replace(error.begin(), error.end(), ',', ';'); // Keep the line a single CSV record
+    std::replace(error.begin(), error.end(), '\n', ' ');
+    summary << result.name << ","
+            << (result.ok ? "OK" : "FAILED") << ","
+            << result.wall_time.count() << ","
+            << result.metrics.trade_count << ","
+            << result.metrics.total_quantity << ","
+            << result.metrics.total_volume_traded << ","
+            << result.metrics.net_position << ","
+            << result.metrics.latency_records << ","
+            << result.metrics.mean_latency.count() << ","
+            << result.metrics.max_latency.count() << ","
+            << lat.market_data_feed_latency.count() << ","
+            << lat.strategy_processing_latency.count() << ","
+            << lat.order_network_latency_strat_to_exch.count() << ","
+            << lat.exchange_order_processing_latency.count() << ","
+            << lat.exchange_fill_processing_latency.count() << ","
+            << lat.ack_network_latency_exch_to_strat.count() << ","
+            << error << "\n";
+    summary.flush();
+}
+
+} // namespace market_replay
@@ -0,0 +1,181 @@
+#include "market_replay/timing_wheel_scheduler.hpp"
+#include "market_replay/utils/bit_ops.hpp"
+#include <algorithm>
+
+namespace market_replay {
+
+namespace {
+
+constexpr size_t kBitsPerWord = 64;
+
+struct OverflowLater {
+    template <typename E>
+    bool operator()(const E& a, const E& b) const {
+        if (a.timestamp != b.timestamp) return a.timestamp > b.timestamp;
+        return a.sequence > b.sequence;
+    }
+};
+
+} // namespace
+
+TimingWheelScheduler::TimingWheelScheduler() : TimingWheelScheduler(Config{}) {}
+
+TimingWheelScheduler::TimingWheelScheduler(Config config)
+    : bucket_width_ns_(std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(config.bucket_width).count())) {
+    num_buckets_ = kBitsPerWord;
+    while (num_buckets_ < config.num_buckets) num_buckets_ <<= 1;
+    mask_ = num_buckets_ - 1;
+    buckets_.resize(num_buckets_);
+    occupied_.assign(num_buckets_ / kBitsPerWord, 0);
+    summary_.assign((occupied_.size() + kBitsPerWord - 1) / kBitsPerWord, 0);
+}
+
+int64_t TimingWheelScheduler::tick_of(Timestamp ts) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count() / bucket_width_ns_;
+}
+
+int64_t TimingWheelScheduler::tick_of_bucket(size_t bucket) const {
+    const size_t offset = (bucket - (static_cast<size_t>(cursor_tick_) & mask_)) & mask_;
+    return cursor_tick_ + static_cast<int64_t>(offset);
+}
+
+void TimingWheelScheduler::push(std::unique_ptr<BaseEvent> event) {
+    const Timestamp ts = event->get_effective_timestamp();
+    Entry entry{ts, next_sequence_++, std::move(event)};
+    const int64_t tick = tick_of(ts);
+    if (empty() && tick >= 0) {
+        cursor_tick_ = tick; // Re-anchor an idle wheel on the first event
+    }
+    if (in_horizon(tick)) {
+        insert_into_wheel(std::move(entry), tick);
+    } else {
+        push_overflow(std::move(entry));
+    }
+}
+
+void TimingWheelScheduler::insert_into_wheel(Entry entry, int64_t tick) {
+    const size_t b = static_cast<size_t>(tick) & mask_;
+    Bucket& bucket = buckets_[b];
+    if (bucket.entries.size() == bucket.head || !earlier(entry, bucket.entries.back())) {
+        bucket.entries.push_back(std::move(entry)); // Common case: latest so far
+    } else {
+        auto pos = std::upper_bound(bucket.entries.begin() + static_cast<std::ptrdiff_t>(bucket.head),
+                                    bucket.entries.end(), entry,
+                                    [](const Entry& a, const Entry& b) { return earlier(a, b); });
+        bucket.entries.insert(pos, std::move(entry));
+    }
+    const size_t word = b / kBitsPerWord;
+    occupied_[word] |= (uint64_t{1} << (b % kBitsPerWord));
+    summary_[word / kBitsPerWord] |= (uint64_t{1} << (word % kBitsPerWord));
+    if (first_bucket_valid_ && tick < tick_of_bucket(cached_first_bucket_)) {
+        cached_first_bucket_ = b;
+    }
+    ++wheel_count_;
+}
+
+void TimingWheelScheduler::push_overflow(Entry entry) {
+    overflow_.push_back(std::move(entry));
+    std::push_heap(overflow_.begin(), overflow_.end(), OverflowLater{});
+}
+
+TimingWheelScheduler::Entry TimingWheelScheduler::pop_overflow() {
+    std::pop_heap(overflow_.begin(), overflow_.end(), OverflowLater{});
+    Entry entry = std::move(overflow_.back());
+    overflow_.pop_back();
+    return entry;
+}
+
+void TimingWheelScheduler::migrate_overflow() {
+    while (!overflow_.empty()) {
+        const int64_t tick = tick_of(overflow_.front().timestamp);
+        if (!in_horizon(tick)) break; // Beyond the horizon, or behind the cursor (it wins the next pops anyway)
+        insert_into_wheel(pop_overflow(), tick);
+    }
+}
+
+size_t TimingWheelScheduler::next_occupied_word(size_t from_word) const {
+    const size_t num_words = occupied_.size();
+    const size_t num_summary = summary_.size();
+    size_t s = from_word / kBitsPerWord;
+    uint64_t bits = summary_[s] & (~uint64_t{0} << (from_word % kBitsPerWord));
+    for (size_t scanned = 0; scanned <= num_summary; ++scanned) {
+        if (bits) return s * kBitsPerWord + static_cast<size_t>(utils::count_trailing_zeros(bits));
+        s = (s + 1) % num_summary;
+        bits = summary_[s];
+    }
+    return num_words; // Unreachable while wheel_count_ > 0
+}
+
+size_t TimingWheelScheduler::first_bucket() const {
+    if (first_bucket_valid_) return cached_first_bucket_;
+    const size_t start = static_cast<size_t>(cursor_tick_) & mask_;
+    const size_t start_word = start / kBitsPerWord;
+    size_t bucket = 0;
+    const uint64_t head_bits = occupied_[start_word] & (~uint64_t{0} << (start % kBitsPerWord));
+    if (head_bits) {
+        bucket = start_word * kBitsPerWord + static_cast<size_t>(utils::count_trailing_zeros(head_bits));
+    } else {
+        // Later words first, then wrap; the low bits of start_word (the far end of the horizon) come last
+        const size_t word = next_occupied_word((start_word + 1) % occupied_.size());
+        bucket = word * kBitsPerWord + static_cast<size_t>(utils::count_trailing_zeros(occupied_[word]));
+    }
+    cached_first_bucket_ = bucket;
+    first_bucket_valid_ = true;
+    return bucket;
+}
+
+Timestamp TimingWheelScheduler::top_timestamp() const {
+    if (wheel_count_ == 0) return overflow_.front().timestamp;
+    const Bucket& bucket = buckets_[first_bucket()];
+    const Entry& wheel_min = bucket.entries[bucket.head];
+    if (!overflow_.empty() && earlier(overflow_.front(), wheel_min)) return overflow_.front().timestamp;
+    return wheel_min.timestamp;
+}
+
+std::unique_ptr<BaseEvent> TimingWheelScheduler::pop() {
+    if (wheel_count_ > 0) {
+        const size_t b = first_bucket();
+        Bucket& bucket = buckets_[b];
+        if (overflow_.empty() || earlier(bucket.entries[bucket.head], overflow_.front())) {
+            std::unique_ptr<BaseEvent> event = std::move(bucket.entries[bucket.head].event);
+            ++bucket.head;
+            --wheel_count_;
+            cursor_tick_ = tick_of_bucket(b); // Nothing in the wheel is earlier than this bucket
+            if (bucket.head == bucket.entries.size()) {
+                bucket.entries.clear();
+                bucket.head = 0;
+                const size_t word = b / kBitsPerWord;
+                occupied_[word] &= ~(uint64_t{1} << (b % kBitsPerWord));
+                if (occupied_[word] == 0) {
+                    summary_[word / kBitsPerWord] &= ~(uint64_t{1} << (word % kBitsPerWord));
+                }
+                first_bucket_valid_ = false;
+            }
+            migrate_overflow();
+            return event;
+        }
+    }
+
+    Entry entry = pop_overflow();
+    if (wheel_count_ == 0) {
+        const int64_t tick = tick_of(entry.timestamp);
+        if (tick >= 0) cursor_tick_ = tick; // Idle wheel: follow the simulation clock
+        first_bucket_valid_ = false;
+    }
+    migrate_overflow();
+    return std::move(entry.event);
+}
+
+void TimingWheelScheduler::clear() {
+    for (auto& bucket : buckets_) {
+        bucket.entries.clear();
+        bucket.head = 0;
+    }
+    std::fill(occupied_.begin(), occupied_.end(), 0);
+    std::fill(summary_.begin(), summary_.end(), 0);
+    overflow_.clear();
+    wheel_count_ = 0;
+    first_bucket_valid_ = false;
+}
+
+} // namespace market_replay
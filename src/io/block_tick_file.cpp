@@ -0,0 +1,430 @@
+#include "market_replay/block_tick_file.hpp"
+#include "market_replay/logger.hpp"
+#include <algorithm> // For std::lower_bound, std::upper_bound
+#include <cstring>   // For std::memcmp, std::memcpy
+#include <numeric>   // For std::gcd
+#include <stdexcept>
+
+namespace market_replay {
+
+// --- Block codec ---
+
+namespace {
+
+uint64_t zigzag(int64_t value) {
+    // Unsigned arithmetic, so the left shift of a negative value is well defined
+    return (static_cast<uint64_t>(value) << 1) ^ (value < 0 ? ~uint64_t{0} : 0);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Two's complement arithmetic without signed overflow
+int64_t wrapping_add(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+int64_t wrapping_sub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+int64_t scale(int64_t value, uint64_t quantum) { return static_cast<int64_t>(static_cast<uint64_t>(value) * quantum); }
+uint64_t magnitude(int64_t value) { return value < 0 ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value); }
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Previous price of each file-local symbol within the block being coded. Only the ids a block
+// touches are reset, so a file with many symbols costs nothing extra per block.
+class LastPrices {
+public:
+    int64_t get(uint32_t id) const { return id < prices_.size() ? prices_[id] : 0; }
+    void set(uint32_t id, int64_t price) {
+        if (id >= prices_.size()) prices_.resize(static_cast<size_t>(id) + 1, 0);
+        if (prices_[id] == 0) touched_.push_back(id);
+        prices_[id] = price;
+    }
+    void reset() {
+        for (uint32_t id : touched_) prices_[id] = 0;
+        touched_.clear();
+    }
+
+private:
+    std::vector<int64_t> prices_;
+    std::vector<uint32_t> touched_;
+};
+
+class BlockDecoder {
+public:
+    BlockDecoder(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+    uint8_t byte() {
+        if (p_ >= end_) fail("truncated");
+        return static_cast<uint8_t>(*p_++);
+    }
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return value;
+        }
+        fail("varint too long");
+        return 0;
+    }
+    int64_t signed_varint() { return unzigzag(varint()); }
+    bool at_end() const { return p_ == end_; }
+
+    [[noreturn]] static void fail(const char* why) {
+        throw std::runtime_error(std::string("Corrupt tick block: ") + why);
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+} // namespace
+
+void block_tick_format::encode_block(const tick_format::TickRecord* first, size_t count, std::string& out) {
+    // Timestamps and prices are stored in units of their greatest common divisor over the block:
+    // feeds stamped in microseconds, or prices on a tick grid coarser than price_scale, then keep
+    // their deltas small
+    uint64_t time_quantum = 0;
+    uint64_t price_quantum = 0;
+    for (const tick_format::TickRecord* rec = first; rec != first + count; ++rec) {
+        time_quantum = std::gcd(time_quantum, magnitude(rec->timestamp_ns));
+        price_quantum = std::gcd(price_quantum, magnitude(rec->price));
+        if (rec->type == tick_format::RecordType::QUOTE) price_quantum = std::gcd(price_quantum, magnitude(rec->ask_price));
+    }
+    if (time_quantum == 0) time_quantum = 1;
+    if (price_quantum == 0) price_quantum = 1;
+    put_varint(out, time_quantum);
+    put_varint(out, price_quantum);
+    const auto tq = static_cast<int64_t>(time_quantum);
+    const auto pq = static_cast<int64_t>(price_quantum);
+
+    thread_local LastPrices last_prices;
+    last_prices.reset();
+    int64_t last_time = 0;
+    for (const tick_format::TickRecord* rec = first; rec != first + count; ++rec) {
+        // Quotients can be differenced with wrap-around: the decoder wraps back to the same value
+        const int64_t time = rec->timestamp_ns / tq;
+        const int64_t price = rec->price / pq;
+        out.push_back(static_cast<char>(rec->type));
+        put_varint(out, zigzag(wrapping_sub(time, last_time)));
+        put_varint(out, rec->symbol_id);
+        put_varint(out, zigzag(wrapping_sub(price, last_prices.get(rec->symbol_id))));
+        put_varint(out, rec->size);
+        if (rec->type == tick_format::RecordType::QUOTE) {
+            put_varint(out, zigzag(wrapping_sub(rec->ask_price / pq, price)));
+            put_varint(out, rec->ask_size);
+        }
+        last_time = time;
+        last_prices.set(rec->symbol_id, price);
+    }
+}
+
+void block_tick_format::decode_block(const char* data, size_t size, uint32_t count, uint32_t symbol_count,
+                                     std::vector<tick_format::TickRecord>& out) {
+    BlockDecoder in(data, size);
+    const uint64_t time_quantum = in.varint();
+    const uint64_t price_quantum = in.varint();
+    if (time_quantum == 0 || price_quantum == 0) BlockDecoder::fail("bad quantum");
+
+    thread_local LastPrices last_prices;
+    last_prices.reset();
+    out.resize(count);
+    int64_t last_time = 0;
+    for (tick_format::TickRecord& rec : out) {
+        rec = tick_format::TickRecord{};
+        rec.type = static_cast<tick_format::RecordType>(in.byte());
+        if (rec.type != tick_format::RecordType::QUOTE && rec.type != tick_format::RecordType::TRADE) {
+            BlockDecoder::fail("bad record type");
+        }
+        const int64_t time = wrapping_add(last_time, in.signed_varint());
+        const uint64_t symbol = in.varint();
+        if (symbol >= symbol_count) BlockDecoder::fail("bad symbol id");
+        rec.symbol_id = static_cast<uint32_t>(symbol);
+        const int64_t price = wrapping_add(last_prices.get(rec.symbol_id), in.signed_varint());
+        rec.timestamp_ns = scale(time, time_quantum);
+        rec.price = scale(price, price_quantum);
+        rec.size = in.varint();
+        if (rec.type == tick_format::RecordType::QUOTE) {
+            rec.ask_price = scale(wrapping_add(price, in.signed_varint()), price_quantum);
+            rec.ask_size = in.varint();
+        }
+        last_time = time;
+        last_prices.set(rec.symbol_id, price);
+    }
+    if (!in.at_end()) BlockDecoder::fail("trailing bytes");
+}
+
+// --- BlockTickFileWriter ---
+
+BlockTickFileWriter::BlockTickFileWriter(const std::string& filepath, int64_t price_scale, uint32_t block_records)
+    : filepath_(filepath), price_scale_(price_scale), block_records_(block_records == 0 ? 1 : block_records) {
+    out_.open(filepath_, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        LOG_CRITICAL("BlockTickFileWriter: Failed to open {} for writing", filepath_);
+        throw std::runtime_error("Failed to open tick file for writing: " + filepath_);
+    }
+    // Placeholder header, rewritten by finish() once counts and offsets are known
+    block_tick_format::FileHeader header{};
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+    pending_.reserve(block_records_);
+}
+
+BlockTickFileWriter::~BlockTickFileWriter() {
+    if (!finished_) {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            LOG_ERROR("BlockTickFileWriter: Failed to finalize {}: {}", filepath_, e.what());
+        }
+    }
+}
+
+bool BlockTickFileWriter::add(const BaseEvent& event) {
+    tick_format::TickRecord rec{};
+    if (!tick_format::to_record(event, price_scale_, symbols_, rec)) return false;
+    pending_.push_back(rec);
+    record_count_++;
+    if (pending_.size() == block_records_) flush_block();
+    return true;
+}
+
+void BlockTickFileWriter::flush_block() {
+    if (pending_.empty()) return;
+    encoded_.clear();
+    block_tick_format::encode_block(pending_.data(), pending_.size(), encoded_);
+    if (encoded_.size() > UINT32_MAX) {
+        throw std::runtime_error("Tick block too large; use fewer records per block: " + filepath_);
+    }
+    block_tick_format::BlockIndexEntry entry{};
+    entry.first_timestamp_ns = pending_.front().timestamp_ns;
+    entry.first_record = record_count_ - pending_.size();
+    entry.offset = offset_;
+    entry.compressed_size = static_cast<uint32_t>(encoded_.size());
+    entry.record_count = static_cast<uint32_t>(pending_.size());
+    index_.push_back(entry);
+
+    out_.write(encoded_.data(), static_cast<std::streamsize>(encoded_.size()));
+    offset_ += encoded_.size();
+    pending_.clear();
+}
+
+void BlockTickFileWriter::finish() {
+    if (finished_) return;
+    finished_ = true;
+    flush_block();
+
+    block_tick_format::FileHeader header{};
+    std::memcpy(header.magic, block_tick_format::MAGIC, sizeof(header.magic));
+    header.version = block_tick_format::VERSION;
+    header.block_records = block_records_;
+    header.record_count = record_count_;
+    header.price_scale = price_scale_;
+    header.symbol_table_offset = offset_;
+    header.symbol_count = static_cast<uint32_t>(symbols_.size());
+
+    uint64_t offset = offset_ + symbols_.write(out_, price_scale_);
+    // Keep the block index 8-byte aligned so the reader can use it in place
+    static const char padding[8] = {};
+    uint64_t pad = (8 - offset % 8) % 8;
+    out_.write(padding, static_cast<std::streamsize>(pad));
+    header.block_index_offset = offset + pad;
+    header.block_count = index_.size();
+    out_.write(reinterpret_cast<const char*>(index_.data()),
+               static_cast<std::streamsize>(index_.size() * sizeof(block_tick_format::BlockIndexEntry)));
+
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("Failed to write tick file: " + filepath_);
+    }
+    LOG_INFO("BlockTickFileWriter: Wrote {} records in {} blocks ({} bytes), {} symbols to {}",
+             record_count_, index_.size(), offset_, symbols_.size(), filepath_);
+}
+
+// --- BlockTickFileReader ---
+
+BlockTickFileReader::BlockTickFileReader(const std::string& filepath) : BlockTickFileReader(filepath, Config{}) {}
+
+BlockTickFileReader::BlockTickFileReader(const std::string& filepath, Config config)
+    : config_(config), file_(filepath) {
+    auto fail = [&filepath](const std::string& why) {
+        LOG_CRITICAL("BlockTickFileReader: {}: {}", filepath, why);
+        throw std::runtime_error("Invalid tick file " + filepath + ": " + why);
+    };
+
+    if (file_.size() < sizeof(block_tick_format::FileHeader)) fail("file too small for header");
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, block_tick_format::MAGIC, sizeof(header_.magic)) != 0) fail("bad magic");
+    if (header_.version < block_tick_format::MIN_VERSION || header_.version > block_tick_format::VERSION) {
+        fail("unsupported version " + std::to_string(header_.version));
+    }
+    if (header_.price_scale <= 0) fail("invalid price scale");
+    if (header_.symbol_table_offset > file_.size() || header_.block_index_offset > file_.size() ||
+        header_.block_count > (file_.size() - header_.block_index_offset) / sizeof(block_tick_format::BlockIndexEntry)) {
+        fail("truncated file");
+    }
+    blocks_ = reinterpret_cast<const block_tick_format::BlockIndexEntry*>(file_.data() + header_.block_index_offset);
+
+    // The blocks must tile the records and lie inside the block area, so a decode never reads past it
+    uint64_t records = 0;
+    for (const auto* block = blocks_begin(); block != blocks_end(); ++block) {
+        if (block->first_record != records || block->record_count == 0 ||
+            block->offset < sizeof(block_tick_format::FileHeader) ||
+            block->offset + block->compressed_size > header_.symbol_table_offset) {
+            fail("bad block index");
+        }
+        records += block->record_count;
+    }
+    if (records != header_.record_count) fail("block index does not cover the records");
+
+    if (!tick_format::read_symbol_table(file_.data() + header_.symbol_table_offset, file_.data() + header_.block_index_offset,
+                                        header_.symbol_count, symbols_, symbol_ids_,
+                                        header_.version >= 2 ? header_.price_scale : 0)) {
+        fail("truncated symbol table");
+    }
+    file_.advise_sequential();
+
+    slots_.resize(std::max<size_t>(1, config_.blocks_ahead));
+    for (auto& slot : slots_) slot = std::make_unique<Slot>();
+    if (config_.io_threads > 0) {
+        io_pool_ = std::make_unique<utils::WorkStealingPool>(config_.io_threads);
+    }
+    restart(0);
+    LOG_INFO("BlockTickFileReader: Opened {} ({} records in {} blocks, {} symbols)", filepath, header_.record_count,
+             header_.block_count, symbols_.size());
+}
+
+BlockTickFileReader::~BlockTickFileReader() {
+    wait_idle();
+}
+
+void BlockTickFileReader::decode(uint64_t block, std::vector<tick_format::TickRecord>& records) const {
+    const block_tick_format::BlockIndexEntry& entry = blocks_[block];
+    block_tick_format::decode_block(file_.data() + entry.offset, entry.compressed_size, entry.record_count,
+                                    header_.symbol_count, records);
+}
+
+void BlockTickFileReader::schedule(uint64_t block) {
+    if (!io_pool_ || block >= header_.block_count) return;
+    Slot* slot = slots_[block % slots_.size()].get();
+    slot->scheduled = true;
+    io_pool_->submit([this, slot, block] {
+        std::vector<tick_format::TickRecord> records;
+        std::string error;
+        try {
+            decode(block, records);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            slot->records.swap(records);
+            slot->error = std::move(error);
+            slot->ready = true;
+        }
+        slot->ready_cv.notify_one();
+    });
+}
+
+void BlockTickFileReader::take_next_block() {
+    const uint64_t block = next_block_++;
+    if (block >= header_.block_count) {
+        throw std::runtime_error("Tick file " + file_.path() + " ends before its record count");
+    }
+    Slot& slot = *slots_[block % slots_.size()];
+    current_pos_ = 0;
+    if (!slot.scheduled) {
+        decode(block, current_); // No pool: decode on the calling thread
+        return;
+    }
+    std::string error;
+    {
+        std::unique_lock<std::mutex> lock(slot.mutex);
+        slot.ready_cv.wait(lock, [&slot] { return slot.ready; });
+        current_.swap(slot.records);
+        error.swap(slot.error);
+        slot.ready = false;
+    }
+    slot.scheduled = false;
+    if (!error.empty()) {
+        LOG_ERROR("BlockTickFileReader: Block {} of {}: {}", block, file_.path(), error);
+        throw std::runtime_error(error + " (block " + std::to_string(block) + " of " + file_.path() + ")");
+    }
+    schedule(block + slots_.size()); // The slot is free again: keep the ring blocks_ahead deep
+}
+
+void BlockTickFileReader::wait_idle() {
+    for (auto& slot : slots_) {
+        if (!slot->scheduled) continue;
+        std::unique_lock<std::mutex> lock(slot->mutex);
+        slot->ready_cv.wait(lock, [&slot] { return slot->ready; });
+    }
+}
+
+void BlockTickFileReader::restart(uint64_t block) {
+    wait_idle();
+    for (auto& slot : slots_) {
+        slot->scheduled = false;
+        slot->ready = false;
+        slot->records.clear();
+        slot->error.clear();
+    }
+    current_.clear();
+    current_pos_ = 0;
+    next_block_ = block;
+    next_record_ = block < header_.block_count ? blocks_[block].first_record : header_.record_count;
+    for (uint64_t b = block; b < block + slots_.size(); ++b) schedule(b);
+}
+
+const tick_format::TickRecord* BlockTickFileReader::peek() {
+    if (next_record_ >= header_.record_count) return nullptr;
+    if (current_pos_ >= current_.size()) take_next_block();
+    return &current_[current_pos_];
+}
+
+std::unique_ptr<BaseEvent> BlockTickFileReader::read_next_event() {
+    const tick_format::TickRecord* rec = peek();
+    if (!rec) return nullptr;
+    ++current_pos_;
+    ++next_record_;
+    return tick_format::to_event(*rec, header_.price_scale, symbol_ids_); // Ids and types are checked by the decoder
+}
+
+void BlockTickFileReader::seek(uint64_t position) {
+    if (position >= header_.record_count) {
+        restart(header_.block_count);
+        return;
+    }
+    // The last block starting at or before the record
+    const block_tick_format::BlockIndexEntry* it = std::upper_bound(blocks_begin(), blocks_end(), position,
+        [](uint64_t p, const block_tick_format::BlockIndexEntry& e) { return p < e.first_record; });
+    restart(static_cast<uint64_t>(it - blocks_begin() - 1));
+    if (position == next_record_) return; // On a block boundary: leave the decode to the ring
+    peek();
+    current_pos_ = static_cast<size_t>(position - next_record_);
+    next_record_ = position;
+}
+
+void BlockTickFileReader::seek_to_timestamp(Timestamp ts) {
+    const int64_t target = ts.time_since_epoch().count();
+    // Start from the last block that begins strictly before the target, then scan forward; with
+    // equal timestamps spanning blocks the scan may run into the next one
+    const block_tick_format::BlockIndexEntry* it = std::lower_bound(blocks_begin(), blocks_end(), target,
+        [](const block_tick_format::BlockIndexEntry& e, int64_t t) { return e.first_timestamp_ns < t; });
+    restart(it == blocks_begin() ? 0 : static_cast<uint64_t>(it - blocks_begin() - 1));
+    while (const tick_format::TickRecord* rec = peek()) {
+        if (rec->timestamp_ns >= target) break;
+        ++current_pos_;
+        ++next_record_;
+    }
+}
+
+} // namespace market_replay
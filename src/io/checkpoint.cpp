@@ -0,0 +1,279 @@
+#include "market_replay/checkpoint.hpp"
+#include <cstring> // For std::memcpy, std::memcmp
+#include <fstream>
+#include <iterator> // For std::istreambuf_iterator
+#include <stdexcept>
+
+namespace market_replay {
+
+namespace {
+
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+constexpr bool kFixedPointPrices = true;
+#else
+constexpr bool kFixedPointPrices = false;
+#endif
+
+template <typename T>
+void append_raw(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T load_raw(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+// --- Writer ---
+
+void CheckpointWriter::write_header() {
+    data_.append(checkpoint_format::MAGIC, sizeof(checkpoint_format::MAGIC));
+    append_raw(data_, checkpoint_format::VERSION);
+    append_raw(data_, kFixedPointPrices ? checkpoint_format::FLAG_FIXED_POINT_PRICES : uint32_t{0});
+    append_raw(data_, static_cast<int64_t>(base_time_.time_since_epoch().count()));
+}
+
+void CheckpointWriter::write_varint(uint64_t value) {
+    while (value >= 0x80) {
+        data_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+}
+
+void CheckpointWriter::write_f64(double value) {
+    append_raw(data_, value);
+}
+
+void CheckpointWriter::write_string(std::string_view value) {
+    write_varint(value.size());
+    data_.append(value.data(), value.size());
+}
+
+void CheckpointWriter::write_timestamp(Timestamp ts) {
+    // Wrapping difference, so the extremes round-trip too
+    const uint64_t delta = static_cast<uint64_t>(ts.time_since_epoch().count()) -
+                           static_cast<uint64_t>(base_time_.time_since_epoch().count());
+    write_svarint(static_cast<int64_t>(delta));
+}
+
+void CheckpointWriter::write_event(const BaseEvent& event) {
+    write_u8(static_cast<uint8_t>(event.type));
+    write_timestamp(event.exchange_timestamp);
+    write_timestamp(event.arrival_timestamp);
+    switch (event.type) {
+        case EventType::QUOTE: {
+            const auto& quote = static_cast<const QuoteEvent&>(event);
+            write_varint(quote.symbol_id);
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+            write_svarint(quote.bid_ticks);
+            write_varint(quote.bid_size);
+            write_svarint(quote.ask_ticks);
+            write_varint(quote.ask_size);
+#else
+            write_f64(quote.bid_price);
+            write_varint(quote.bid_size);
+            write_f64(quote.ask_price);
+            write_varint(quote.ask_size);
+#endif
+            break;
+        }
+        case EventType::TRADE: {
+            const auto& trade = static_cast<const TradeEvent&>(event);
+            write_varint(trade.symbol_id);
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+            write_svarint(trade.price_ticks);
+#else
+            write_f64(trade.price);
+#endif
+            write_varint(trade.size);
+            break;
+        }
+        case EventType::ORDER_ACK: {
+            const auto& ack = static_cast<const OrderAckEvent&>(event);
+            write_varint(ack.strategy_index);
+            write_varint(ack.client_order_id);
+            write_varint(ack.exchange_order_id);
+            write_varint(ack.symbol_id);
+            write_u8(static_cast<uint8_t>(ack.status));
+            write_u8(static_cast<uint8_t>(ack.side));
+            write_f64(ack.last_filled_price);
+            write_svarint(ack.last_filled_price_ticks);
+            write_varint(ack.last_filled_quantity);
+            write_varint(ack.cumulative_filled_quantity);
+            write_varint(ack.leaves_quantity);
+            write_string(ack.reject_reason);
+            break;
+        }
+        case EventType::SIM_CONTROL_DISPATCHER:
+        case EventType::SIM_CONTROL_STRATEGY: {
+            const auto& control = static_cast<const SimControlEvent&>(event);
+            write_u8(static_cast<uint8_t>(control.control_type));
+            write_varint(control.target_strategy_index);
+            break;
+        }
+        default:
+            throw std::runtime_error("Checkpoint: cannot encode event type " + std::to_string(static_cast<int>(event.type)));
+    }
+}
+
+// --- Reader ---
+
+void CheckpointReader::fail(const char* what) const {
+    throw std::runtime_error(std::string("Corrupt checkpoint: ") + what + " at byte " + std::to_string(pos_));
+}
+
+uint8_t CheckpointReader::read_u8() {
+    if (pos_ >= data_.size()) fail("truncated");
+    return static_cast<uint8_t>(data_[pos_++]);
+}
+
+uint64_t CheckpointReader::read_varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const uint8_t byte = read_u8();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    fail("varint too long");
+}
+
+double CheckpointReader::read_f64() {
+    if (data_.size() - pos_ < sizeof(double)) fail("truncated");
+    const double value = load_raw<double>(data_.data() + pos_);
+    pos_ += sizeof(double);
+    return value;
+}
+
+std::string_view CheckpointReader::read_string() {
+    const uint64_t size = read_varint();
+    if (data_.size() - pos_ < size) fail("truncated string");
+    const std::string_view value = data_.substr(pos_, static_cast<size_t>(size));
+    pos_ += static_cast<size_t>(size);
+    return value;
+}
+
+Timestamp CheckpointReader::read_timestamp() {
+    const uint64_t ns = static_cast<uint64_t>(base_time_.time_since_epoch().count()) + static_cast<uint64_t>(read_svarint());
+    return Timestamp(Duration(static_cast<int64_t>(ns)));
+}
+
+void CheckpointReader::expect_section(checkpoint_format::Section section) {
+    if (read_u8() != static_cast<uint8_t>(section)) fail("unexpected section");
+}
+
+std::unique_ptr<BaseEvent> CheckpointReader::read_event() {
+    const auto type = static_cast<EventType>(read_u8());
+    const Timestamp exchange_ts = read_timestamp();
+    const Timestamp arrival_ts = read_timestamp();
+    std::unique_ptr<BaseEvent> event;
+    switch (type) {
+        case EventType::QUOTE: {
+            const auto symbol_id = static_cast<SymbolId>(read_varint());
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+            const PriceTicks bid = read_svarint();
+            const Quantity bid_size = read_varint();
+            const PriceTicks ask = read_svarint();
+            const Quantity ask_size = read_varint();
+            event = std::make_unique<QuoteEvent>(exchange_ts, symbol_id, in_ticks, bid, bid_size, ask, ask_size);
+#else
+            const Price bid = read_f64();
+            const Quantity bid_size = read_varint();
+            const Price ask = read_f64();
+            const Quantity ask_size = read_varint();
+            event = std::make_unique<QuoteEvent>(exchange_ts, symbol_id, bid, bid_size, ask, ask_size);
+#endif
+            break;
+        }
+        case EventType::TRADE: {
+            const auto symbol_id = static_cast<SymbolId>(read_varint());
+#if MARKET_REPLAY_FIXED_POINT_PRICES
+            const PriceTicks price = read_svarint();
+            event = std::make_unique<TradeEvent>(exchange_ts, symbol_id, in_ticks, price, read_varint());
+#else
+            const Price price = read_f64();
+            event = std::make_unique<TradeEvent>(exchange_ts, symbol_id, price, read_varint());
+#endif
+            break;
+        }
+        case EventType::ORDER_ACK: {
+            const auto strategy_index = static_cast<StrategyIndex>(read_varint());
+            const OrderId client_order_id = read_varint();
+            const OrderId exchange_order_id = read_varint();
+            const auto symbol_id = static_cast<SymbolId>(read_varint());
+            const auto status = static_cast<OrderStatus>(read_u8());
+            auto ack = std::make_unique<OrderAckEvent>(arrival_ts, strategy_index, client_order_id, exchange_order_id,
+                                                       symbol_id, status);
+            ack->side = static_cast<OrderSide>(read_u8());
+            ack->last_filled_price = read_f64();
+            ack->last_filled_price_ticks = read_svarint();
+            ack->last_filled_quantity = read_varint();
+            ack->cumulative_filled_quantity = read_varint();
+            ack->leaves_quantity = read_varint();
+            ack->reject_reason = std::string(read_string());
+            event = std::move(ack);
+            break;
+        }
+        case EventType::SIM_CONTROL_DISPATCHER:
+        case EventType::SIM_CONTROL_STRATEGY: {
+            const auto control_type = static_cast<SimControlEvent::ControlType>(read_u8());
+            auto control = std::make_unique<SimControlEvent>(arrival_ts, control_type, type);
+            control->target_strategy_index = static_cast<StrategyIndex>(read_varint());
+            event = std::move(control);
+            break;
+        }
+        default:
+            fail("unknown event type");
+    }
+    event->exchange_timestamp = exchange_ts;
+    event->arrival_timestamp = arrival_ts;
+    return event;
+}
+
+// --- Checkpoint ---
+
+void Checkpoint::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Failed to open checkpoint file for writing: " + path);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out) throw std::runtime_error("Failed to write checkpoint file: " + path);
+}
+
+Checkpoint Checkpoint::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open checkpoint file: " + path);
+    Checkpoint checkpoint;
+    checkpoint.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    try {
+        checkpoint.sim_time = parse_header(checkpoint.data);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+    return checkpoint;
+}
+
+Timestamp Checkpoint::parse_header(std::string_view data) {
+    if (data.size() < checkpoint_format::HEADER_SIZE ||
+        std::memcmp(data.data(), checkpoint_format::MAGIC, sizeof(checkpoint_format::MAGIC)) != 0) {
+        throw std::runtime_error("Not a checkpoint");
+    }
+    const auto version = load_raw<uint32_t>(data.data() + 8);
+    if (version != checkpoint_format::VERSION) {
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+    }
+    const auto flags = load_raw<uint32_t>(data.data() + 12);
+    const bool fixed_point = (flags & checkpoint_format::FLAG_FIXED_POINT_PRICES) != 0;
+    if (fixed_point != kFixedPointPrices) {
+        throw std::runtime_error("Checkpoint was taken by a build with ENABLE_FIXED_POINT_PRICES " +
+                                 std::string(fixed_point ? "ON" : "OFF"));
+    }
+    return Timestamp(Duration(load_raw<int64_t>(data.data() + 16)));
+}
+
+} // namespace market_replay
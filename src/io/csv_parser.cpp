@@ -1,19 +1,42 @@
 #include "market_replay/csv_parser.hpp"
 #include "market_replay/common.hpp" // For string_to_timestamp, Price, Quantity
+#include "market_replay/utils/field_parsers.hpp"
+#include <algorithm> // For std::min
+#include <cstring>  // For std::memchr
 #include <iostream> // For std::cerr in case of critical error before logger
 
 namespace market_replay {
 
-CsvParser::CsvParser(const std::string& filepath) : line_number_(0) {
-    file_stream_.open(filepath);
-    if (!file_stream_.is_open()) {
-        LOG_CRITICAL("Failed to open CSV file: {}", filepath);
+CsvParser::CsvParser(const std::string& filepath, Backend backend) : backend_(backend), line_number_(0) {
+    if (backend_ == Backend::STREAM) {
+        file_stream_.open(filepath);
+        if (!file_stream_.is_open()) {
+            LOG_CRITICAL("Failed to open CSV file: {}", filepath);
+            throw std::runtime_error("Failed to open CSV file: " + filepath);
+        }
+        // Skip header line
+        if (std::getline(file_stream_, current_line_)) {
+            line_number_++;
+            LOG_INFO("CSV Parser: Skipped header line: {}", current_line_);
+        } else {
+            LOG_WARN("CSV Parser: File is empty or contains no header: {}", filepath);
+        }
+        return;
+    }
+
+    try {
+        mapped_file_ = std::make_unique<utils::MappedFile>(filepath);
+    } catch (const std::runtime_error& e) {
+        LOG_CRITICAL("Failed to open CSV file: {} ({})", filepath, e.what());
         throw std::runtime_error("Failed to open CSV file: " + filepath);
     }
-    // Skip header line
-    if (std::getline(file_stream_, current_line_)) {
-        line_number_++;
-        LOG_INFO("CSV Parser: Skipped header line: {}", current_line_);
+    mapped_file_->advise_sequential();
+    cursor_ = mapped_file_->data();
+    end_ = cursor_ + mapped_file_->size();
+
+    if (cursor_ != end_) {
+        std::string_view header = next_line();
+        LOG_INFO("CSV Parser: Skipped header line: {}", header);
     } else {
         LOG_WARN("CSV Parser: File is empty or contains no header: {}", filepath);
     }
@@ -26,9 +49,125 @@ CsvParser::~CsvParser() {
 }
 
 bool CsvParser::has_more_events() const {
+    if (backend_ == Backend::MMAP) {
+        return cursor_ != end_;
+    }
     return file_stream_.good() && !file_stream_.eof();
 }
 
+uint64_t CsvParser::position() const {
+    if (backend_ == Backend::MMAP) {
+        return static_cast<uint64_t>(cursor_ - mapped_file_->data());
+    }
+    std::streampos pos = const_cast<std::ifstream&>(file_stream_).tellg();
+    return pos < 0 ? 0 : static_cast<uint64_t>(pos);
+}
+
+void CsvParser::seek(uint64_t position) {
+    if (backend_ == Backend::MMAP) {
+        cursor_ = mapped_file_->data() + std::min<uint64_t>(position, mapped_file_->size());
+        return;
+    }
+    file_stream_.clear(); // An earlier EOF would otherwise stick
+    file_stream_.seekg(static_cast<std::streamoff>(position));
+}
+
+std::unique_ptr<BaseEvent> CsvParser::read_next_event() {
+    return backend_ == Backend::MMAP ? read_next_event_mmap() : read_next_event_stream();
+}
+
+// --- MMAP backend ---
+
+std::string_view CsvParser::next_line() {
+    const char* line_start = cursor_;
+    const char* newline = static_cast<const char*>(std::memchr(cursor_, '\n', static_cast<size_t>(end_ - cursor_)));
+    const char* line_end = newline ? newline : end_;
+    cursor_ = newline ? newline + 1 : end_;
+    if (line_end != line_start && *(line_end - 1) == '\r') {
+        --line_end; // Tolerate CRLF files
+    }
+    return {line_start, static_cast<size_t>(line_end - line_start)};
+}
+
+size_t CsvParser::tokenize(std::string_view line, FieldViews& fields) {
+    size_t count = 0;
+    size_t start = 0;
+    while (count < kNumFields) {
+        size_t comma = line.find(',', start);
+        if (comma == std::string_view::npos) {
+            fields[count++] = line.substr(start);
+            break;
+        }
+        fields[count++] = line.substr(start, comma - start);
+        start = comma + 1;
+    }
+    return count;
+}
+
+std::unique_ptr<BaseEvent> CsvParser::read_next_event_mmap() {
+    if (cursor_ == end_) {
+        return nullptr; // EOF
+    }
+    std::string_view line = next_line();
+    line_number_++;
+
+    if (line.empty()) {
+        LOG_WARN("CSV Parser: Empty line at {}", line_number_);
+        return nullptr;
+    }
+
+    FieldViews fields;
+    size_t num_fields = tokenize(line, fields);
+    return parse_fields(fields, num_fields, line);
+}
+
+std::unique_ptr<BaseEvent> CsvParser::parse_fields(const FieldViews& fields, size_t num_fields, std::string_view line) {
+    if (num_fields < 3) {
+        LOG_WARN("CSV Parser: Unknown event type '{}' or malformed line {} : {}", fields[0], line_number_, line);
+        return nullptr;
+    }
+
+    const std::string_view type_str = fields[0];
+    int64_t ts_ns = 0;
+    if (!utils::parse_int64(fields[1], ts_ns)) {
+        LOG_ERROR("CSV Parser: Error parsing line {}: {} - Error: invalid timestamp '{}'", line_number_, line, fields[1]);
+        return nullptr;
+    }
+    const Timestamp exchange_ts{std::chrono::nanoseconds(ts_ns)};
+    const SymbolId symbol_id = resolve_symbol(fields[2]);
+
+    if (type_str == "QUOTE" && num_fields >= 9) {
+        Price bid_price, ask_price;
+        Quantity bid_size, ask_size;
+        if (!utils::parse_decimal(fields[5], bid_price) || !utils::parse_uint64(fields[6], bid_size) ||
+            !utils::parse_decimal(fields[7], ask_price) || !utils::parse_uint64(fields[8], ask_size)) {
+            LOG_ERROR("CSV Parser: Error parsing line {}: {} - Error: invalid quote fields", line_number_, line);
+            return nullptr;
+        }
+        return std::make_unique<QuoteEvent>(exchange_ts, symbol_id, bid_price, bid_size, ask_price, ask_size);
+    } else if (type_str == "TRADE" && num_fields >= 5) {
+        Price price;
+        Quantity size;
+        if (!utils::parse_decimal(fields[3], price) || !utils::parse_uint64(fields[4], size)) {
+            LOG_ERROR("CSV Parser: Error parsing line {}: {} - Error: invalid trade fields", line_number_, line);
+            return nullptr;
+        }
+        return std::make_unique<TradeEvent>(exchange_ts, symbol_id, price, size);
+    }
+    LOG_WARN("CSV Parser: Unknown event type '{}' or malformed line {} : {}", type_str, line_number_, line);
+    return nullptr;
+}
+
+SymbolId CsvParser::resolve_symbol(std::string_view symbol) {
+    if (last_symbol_id_ == INVALID_SYMBOL_ID || symbol != last_symbol_) {
+        last_symbol_id_ = intern_symbol(symbol);
+        last_symbol_ = symbol_name(last_symbol_id_);
+    }
+    return last_symbol_id_;
+}
+
+// --- STREAM backend ---
+
 std::vector<std::string> CsvParser::split_line(const std::string& line, char delimiter) {
     std::vector<std::string> tokens;
     std::string token;
@@ -39,7 +178,7 @@ std::vector<std::string> CsvParser::split_line(const std::string& line, char del
     return tokens;
 }
 
-std::unique_ptr<BaseEvent> CsvParser::read_next_event() {
+std::unique_ptr<BaseEvent> CsvParser::read_next_event_stream() {
     if (!std::getline(file_stream_, current_line_)) {
         return nullptr; // EOF or error
     }
@@ -77,4 +216,4 @@ std::unique_ptr<BaseEvent> CsvParser::read_next_event() {
         return nullptr;
     }
 }
-} // namespace market_replay
\ No newline at end of file
+} // namespace market_replay
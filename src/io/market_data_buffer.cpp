@@ -0,0 +1,37 @@
+#include "market_replay/market_data_buffer.hpp"
+#include "market_replay/market_data_source.hpp"
+#include "market_replay/logger.hpp"
+
+namespace market_replay {
+
+std::shared_ptr<const MarketDataBuffer> MarketDataBuffer::load(const std::string& path) {
+    std::shared_ptr<MarketDataBuffer> buffer(new MarketDataBuffer());
+    buffer->source_path_ = path;
+
+    std::unique_ptr<IMarketDataSource> source = open_market_data_source(path);
+    while (source->has_more_events()) {
+        std::unique_ptr<BaseEvent> event = source->read_next_event();
+        if (!event) continue;
+        if (event->type == EventType::QUOTE) {
+            buffer->records_.emplace_back(static_cast<const QuoteEvent&>(*event));
+        } else if (event->type == EventType::TRADE) {
+            buffer->records_.emplace_back(static_cast<const TradeEvent&>(*event));
+        }
+    }
+    buffer->records_.shrink_to_fit();
+    LOG_INFO("MarketDataBuffer: Loaded {} events from {} ({} KiB).", buffer->records_.size(), path,
+             buffer->records_.size() * sizeof(Record) / 1024);
+    return buffer;
+}
+
+MarketDataBufferSource::MarketDataBufferSource(std::shared_ptr<const MarketDataBuffer> buffer)
+    : buffer_(std::move(buffer)) {}
+
+std::unique_ptr<BaseEvent> MarketDataBufferSource::read_next_event() {
+    if (!has_more_events()) return nullptr;
+    return std::visit([](const auto& record) -> std::unique_ptr<BaseEvent> {
+        return std::make_unique<std::decay_t<decltype(record)>>(record);
+    }, buffer_->records()[next_++]);
+}
+
+} // namespace market_replay
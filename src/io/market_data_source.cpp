@@ -0,0 +1,91 @@
+#include "market_replay/market_data_source.hpp"
+#include "market_replay/block_tick_file.hpp"
+#include "market_replay/csv_parser.hpp"
+#include "market_replay/tick_file.hpp"
+#include <algorithm> // For std::sort
+#include <filesystem>
+#include <stdexcept>
+
+namespace market_replay {
+
+namespace {
+
+std::unique_ptr<IMarketDataSource> open_file(const std::string& path, const BlockTickFileReader::Config& block_config) {
+    if (tick_format::has_extension(path)) {
+        return std::make_unique<TickFileReader>(path);
+    }
+    if (block_tick_format::has_extension(path)) {
+        return std::make_unique<BlockTickFileReader>(path, block_config);
+    }
+    return std::make_unique<CsvParser>(path);
+}
+
+std::unique_ptr<IMarketDataSource> open_windowed(const std::string& path, const BlockTickFileReader::Config& block_config,
+                                                 const ReplayWindow& window) {
+    std::unique_ptr<IMarketDataSource> source = open_file(path, block_config);
+    if (!window.restricted()) {
+        return source;
+    }
+    std::shared_ptr<const TimeIndex> index;
+    if (window.use_index && source->seekable()) {
+        index = TimeIndex::load_or_build(path, *source, window.index_rows);
+    }
+    return std::make_unique<WindowedMarketDataSource>(std::move(source), window, std::move(index));
+}
+
+} // namespace
+
+std::unique_ptr<IMarketDataSource> open_market_data_source(const std::string& path,
+                                                           MergedMarketDataSource::Config merge_config,
+                                                           const ReplayWindow& window) {
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        return open_market_data_source(list_market_data_files(path), merge_config, window);
+    }
+    return open_windowed(path, BlockTickFileReader::Config{}, window);
+}
+
+std::unique_ptr<IMarketDataSource> open_market_data_source(const std::vector<std::string>& paths,
+                                                           MergedMarketDataSource::Config merge_config,
+                                                           const ReplayWindow& window) {
+    if (paths.empty()) {
+        throw std::runtime_error("No market data files to replay");
+    }
+    if (paths.size() == 1) {
+        return open_market_data_source(paths.front(), merge_config, window);
+    }
+    // The merge reads ahead on its own io_threads for every source: a .mrtz reader with threads of
+    // its own would add two per file and decode a second ring of blocks nobody is waiting for
+    BlockTickFileReader::Config block_config;
+    block_config.io_threads = 0;
+    block_config.blocks_ahead = 1;
+    std::vector<std::unique_ptr<IMarketDataSource>> sources;
+    sources.reserve(paths.size());
+    std::error_code ec;
+    for (const auto& path : paths) {
+        sources.push_back(std::filesystem::is_directory(path, ec)
+                              ? open_market_data_source(path, merge_config, window) // Nested directories merge too
+                              : open_windowed(path, block_config, window));
+    }
+    return std::make_unique<MergedMarketDataSource>(std::move(sources), merge_config);
+}
+
+std::vector<std::string> list_market_data_files(const std::string& directory) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec)) {
+        throw std::runtime_error("Not a directory: " + directory);
+    }
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (!entry.is_regular_file()) continue;
+        const std::string path = entry.path().string();
+        if (tick_format::has_extension(path) || block_tick_format::has_extension(path) ||
+            entry.path().extension() == ".csv") {
+            files.push_back(path);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+} // namespace market_replay
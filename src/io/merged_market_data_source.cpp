@@ -0,0 +1,105 @@
+#include "market_replay/merged_market_data_source.hpp"
+#include "market_replay/logger.hpp"
+#include <algorithm> // For std::max
+
+namespace market_replay {
+
+MergedMarketDataSource::MergedMarketDataSource(std::vector<std::unique_ptr<IMarketDataSource>> sources)
+    : MergedMarketDataSource(std::move(sources), Config{}) {}
+
+MergedMarketDataSource::MergedMarketDataSource(std::vector<std::unique_ptr<IMarketDataSource>> sources, Config config)
+    : config_(config) {
+    config_.block_events = std::max<size_t>(1, config_.block_events);
+    readers_.reserve(sources.size());
+    for (auto& source : sources) {
+        if (!source) continue;
+        auto reader = std::make_unique<Reader>();
+        reader->source = std::move(source);
+        reader->source_done = fill_block(*reader, reader->front); // In source order, on this thread
+        readers_.push_back(std::move(reader));
+    }
+    if (config_.io_threads > 0 && !readers_.empty()) {
+        io_pool_ = std::make_unique<utils::WorkStealingPool>(std::min(config_.io_threads, readers_.size()));
+        for (auto& reader : readers_) {
+            if (!reader->source_done) schedule_fill(reader.get());
+        }
+    }
+
+    std::vector<MergeKey> keys;
+    keys.reserve(readers_.size());
+    for (size_t i = 0; i < readers_.size(); ++i) keys.push_back(head_key(i));
+    tree_.reset(std::move(keys));
+    LOG_INFO("MergedMarketDataSource: Merging {} sources, blocks of {} events, {} I/O threads.",
+             readers_.size(), config_.block_events, io_pool_ ? io_pool_->size() : 0);
+}
+
+MergedMarketDataSource::~MergedMarketDataSource() {
+    io_pool_.reset(); // Lets queued fills finish into their readers, then joins
+}
+
+bool MergedMarketDataSource::fill_block(Reader& reader, std::vector<std::unique_ptr<BaseEvent>>& block) {
+    block.clear(); // Keeps its capacity: the two blocks of a reader are swapped, never reallocated
+    while (block.size() < config_.block_events && reader.source->has_more_events()) {
+        std::unique_ptr<BaseEvent> event = reader.source->read_next_event();
+        if (event) block.push_back(std::move(event));
+    }
+    return !reader.source->has_more_events();
+}
+
+void MergedMarketDataSource::schedule_fill(Reader* reader) {
+    reader->fill_pending = true;
+    io_pool_->submit([this, reader] {
+        const bool done = fill_block(*reader, reader->back);
+        {
+            std::lock_guard<std::mutex> lock(reader->mutex);
+            reader->back_ready = true;
+            reader->back_source_done = done;
+        }
+        reader->ready_cv.notify_one();
+    });
+}
+
+bool MergedMarketDataSource::advance(Reader& reader) {
+    reader.front_pos = 0;
+    reader.front.clear();
+    while (reader.front.empty()) {
+        if (!io_pool_) {
+            if (reader.source_done) return false;
+            reader.source_done = fill_block(reader, reader.front);
+            continue;
+        }
+        if (!reader.fill_pending) return false;
+        {
+            std::unique_lock<std::mutex> lock(reader.mutex);
+            reader.ready_cv.wait(lock, [&reader] { return reader.back_ready; });
+            reader.front.swap(reader.back);
+            reader.back_ready = false;
+            reader.source_done = reader.back_source_done;
+        }
+        reader.fill_pending = false;
+        if (!reader.source_done) schedule_fill(&reader); // Decodes the next block while this one is merged
+    }
+    return true;
+}
+
+MergedMarketDataSource::MergeKey MergedMarketDataSource::head_key(size_t index) const {
+    const Reader& reader = *readers_[index];
+    if (reader.front_pos == reader.front.size()) return {Timestamp::max(), index};
+    return {reader.front[reader.front_pos]->exchange_timestamp, index};
+}
+
+std::unique_ptr<BaseEvent> MergedMarketDataSource::read_next_event() {
+    if (!has_more_events()) return nullptr;
+    const size_t index = tree_.winner();
+    Reader& reader = *readers_[index];
+    std::unique_ptr<BaseEvent> event = std::move(reader.front[reader.front_pos++]);
+    if (reader.front_pos == reader.front.size()) advance(reader);
+    tree_.replace_winner(head_key(index));
+    return event;
+}
+
+bool MergedMarketDataSource::has_more_events() const {
+    return !tree_.empty() && tree_.winner_key().first != Timestamp::max();
+}
+
+} // namespace market_replay
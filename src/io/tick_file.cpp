@@ -0,0 +1,242 @@
+#include "market_replay/tick_file.hpp"
+#include "market_replay/logger.hpp"
+#include <algorithm> // For std::lower_bound
+#include <cmath>     // For std::llround
+#include <cstring>   // For std::memcmp
+#include <stdexcept>
+
+namespace market_replay {
+
+// --- Symbol table ---
+
+uint32_t tick_format::SymbolTableWriter::local_id(SymbolId symbol_id) {
+    if (symbol_id < local_ids_.size() && local_ids_[symbol_id] != UINT32_MAX) {
+        return local_ids_[symbol_id];
+    }
+    const std::string& symbol = symbol_name(symbol_id);
+    if (symbol.size() > UINT16_MAX) {
+        throw std::runtime_error("Symbol too long for tick file: " + symbol.substr(0, 32) + "...");
+    }
+    if (symbol_id >= local_ids_.size()) {
+        local_ids_.resize(static_cast<size_t>(symbol_id) + 1, UINT32_MAX);
+    }
+    uint32_t id = static_cast<uint32_t>(symbols_.size());
+    symbols_.push_back(symbol);
+    symbol_ids_.push_back(symbol_id);
+    local_ids_[symbol_id] = id;
+    return id;
+}
+
+uint64_t tick_format::SymbolTableWriter::write(std::ofstream& out, int64_t tick_size_scale) const {
+    const SymbolRegistry& registry = SymbolRegistry::instance();
+    uint64_t written = 0;
+    for (size_t i = 0; i < symbols_.size(); ++i) {
+        uint16_t len = static_cast<uint16_t>(symbols_[i].size());
+        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        out.write(symbols_[i].data(), len);
+        written += sizeof(len) + len;
+        if (tick_size_scale == 0) continue;
+        const int64_t tick_size = registry.has_tick_size(symbol_ids_[i])
+            ? std::llround(registry.tick_size(symbol_ids_[i]) * static_cast<double>(tick_size_scale))
+            : 0;
+        out.write(reinterpret_cast<const char*>(&tick_size), sizeof(tick_size));
+        written += sizeof(tick_size);
+    }
+    return written;
+}
+
+bool tick_format::read_symbol_table(const char* p, const char* end, uint32_t count,
+                                    std::vector<std::string>& names, std::vector<SymbolId>& ids, int64_t tick_size_scale) {
+    names.reserve(count);
+    ids.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t len = 0;
+        if (p + sizeof(len) > end) return false;
+        std::memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        if (p + len > end) return false;
+        names.emplace_back(p, len);
+        ids.push_back(intern_symbol(names.back()));
+        p += len;
+        if (tick_size_scale == 0) continue;
+        int64_t tick_size = 0;
+        if (p + sizeof(tick_size) > end) return false;
+        std::memcpy(&tick_size, p, sizeof(tick_size));
+        p += sizeof(tick_size);
+        if (tick_size > 0) {
+            SymbolRegistry::instance().set_tick_size_if_unset(
+                ids.back(), static_cast<double>(tick_size) / static_cast<double>(tick_size_scale));
+        }
+    }
+    return true;
+}
+
+// --- Record conversion ---
+
+bool tick_format::to_record(const BaseEvent& event, int64_t price_scale, SymbolTableWriter& symbols, TickRecord& rec) {
+    auto to_ticks = [price_scale](Price price) { return std::llround(price * static_cast<double>(price_scale)); };
+    rec = TickRecord{};
+    rec.timestamp_ns = event.exchange_timestamp.time_since_epoch().count();
+    if (event.type == EventType::QUOTE) {
+        const auto& q = static_cast<const QuoteEvent&>(event);
+        rec.symbol_id = symbols.local_id(q.symbol_id);
+        rec.type = RecordType::QUOTE;
+        rec.price = to_ticks(q.get_bid_price());
+        rec.size = q.bid_size;
+        rec.ask_price = to_ticks(q.get_ask_price());
+        rec.ask_size = q.ask_size;
+        return true;
+    }
+    if (event.type == EventType::TRADE) {
+        const auto& t = static_cast<const TradeEvent&>(event);
+        rec.symbol_id = symbols.local_id(t.symbol_id);
+        rec.type = RecordType::TRADE;
+        rec.price = to_ticks(t.get_price());
+        rec.size = t.size;
+        return true;
+    }
+    return false;
+}
+
+std::unique_ptr<BaseEvent> tick_format::to_event(const TickRecord& rec, int64_t price_scale, const std::vector<SymbolId>& symbol_ids) {
+    if (rec.symbol_id >= symbol_ids.size()) return nullptr;
+    auto to_price = [price_scale](int64_t ticks) { return static_cast<double>(ticks) / static_cast<double>(price_scale); };
+    const Timestamp ts{std::chrono::nanoseconds(rec.timestamp_ns)};
+    switch (rec.type) {
+        case RecordType::QUOTE:
+            return std::make_unique<QuoteEvent>(ts, symbol_ids[rec.symbol_id], to_price(rec.price), rec.size,
+                                                to_price(rec.ask_price), rec.ask_size);
+        case RecordType::TRADE:
+            return std::make_unique<TradeEvent>(ts, symbol_ids[rec.symbol_id], to_price(rec.price), rec.size);
+    }
+    return nullptr;
+}
+
+// --- TickFileWriter ---
+
+TickFileWriter::TickFileWriter(const std::string& filepath, int64_t price_scale, uint32_t index_stride)
+    : filepath_(filepath), price_scale_(price_scale), index_stride_(index_stride == 0 ? 1 : index_stride) {
+    out_.open(filepath_, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        LOG_CRITICAL("TickFileWriter: Failed to open {} for writing", filepath_);
+        throw std::runtime_error("Failed to open tick file for writing: " + filepath_);
+    }
+    // Placeholder header, rewritten by finish() once counts and offsets are known
+    tick_format::FileHeader header{};
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+TickFileWriter::~TickFileWriter() {
+    if (!finished_) {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            LOG_ERROR("TickFileWriter: Failed to finalize {}: {}", filepath_, e.what());
+        }
+    }
+}
+
+bool TickFileWriter::add(const BaseEvent& event) {
+    tick_format::TickRecord rec{};
+    if (!tick_format::to_record(event, price_scale_, symbols_, rec)) return false;
+
+    if (record_count_ % index_stride_ == 0) {
+        index_.push_back({rec.timestamp_ns, record_count_});
+    }
+    out_.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    record_count_++;
+    return true;
+}
+
+void TickFileWriter::finish() {
+    if (finished_) return;
+    finished_ = true;
+
+    tick_format::FileHeader header{};
+    std::memcpy(header.magic, tick_format::MAGIC, sizeof(header.magic));
+    header.version = tick_format::VERSION;
+    header.record_size = sizeof(tick_format::TickRecord);
+    header.record_count = record_count_;
+    header.price_scale = price_scale_;
+    header.records_offset = sizeof(tick_format::FileHeader);
+    header.symbol_table_offset = header.records_offset + record_count_ * sizeof(tick_format::TickRecord);
+    header.symbol_count = static_cast<uint32_t>(symbols_.size());
+    header.index_stride = index_stride_;
+
+    uint64_t offset = header.symbol_table_offset + symbols_.write(out_, price_scale_);
+    // Keep the index 8-byte aligned so the reader can use it in place
+    static const char padding[8] = {};
+    uint64_t pad = (8 - offset % 8) % 8;
+    out_.write(padding, static_cast<std::streamsize>(pad));
+    header.index_offset = offset + pad;
+    header.index_count = index_.size();
+    out_.write(reinterpret_cast<const char*>(index_.data()),
+               static_cast<std::streamsize>(index_.size() * sizeof(tick_format::IndexEntry)));
+
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("Failed to write tick file: " + filepath_);
+    }
+    LOG_INFO("TickFileWriter: Wrote {} records, {} symbols to {}", record_count_, symbols_.size(), filepath_);
+}
+
+// --- TickFileReader ---
+
+TickFileReader::TickFileReader(const std::string& filepath) : file_(filepath) {
+    auto fail = [&filepath](const std::string& why) {
+        LOG_CRITICAL("TickFileReader: {}: {}", filepath, why);
+        throw std::runtime_error("Invalid tick file " + filepath + ": " + why);
+    };
+
+    if (file_.size() < sizeof(tick_format::FileHeader)) fail("file too small for header");
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, tick_format::MAGIC, sizeof(header_.magic)) != 0) fail("bad magic");
+    if (header_.version < tick_format::MIN_VERSION || header_.version > tick_format::VERSION) {
+        fail("unsupported version " + std::to_string(header_.version));
+    }
+    if (header_.record_size != sizeof(tick_format::TickRecord)) fail("unexpected record size");
+    if (header_.price_scale <= 0) fail("invalid price scale");
+    if (header_.records_offset + header_.record_count * sizeof(tick_format::TickRecord) > file_.size() ||
+        header_.symbol_table_offset > file_.size() ||
+        header_.index_offset + header_.index_count * sizeof(tick_format::IndexEntry) > file_.size()) {
+        fail("truncated file");
+    }
+
+    records_ = reinterpret_cast<const tick_format::TickRecord*>(file_.data() + header_.records_offset);
+    index_ = reinterpret_cast<const tick_format::IndexEntry*>(file_.data() + header_.index_offset);
+
+    if (!tick_format::read_symbol_table(file_.data() + header_.symbol_table_offset, file_.data() + header_.index_offset,
+                                        header_.symbol_count, symbols_, symbol_ids_,
+                                        header_.version >= 2 ? header_.price_scale : 0)) {
+        fail("truncated symbol table");
+    }
+    file_.advise_sequential();
+    LOG_INFO("TickFileReader: Opened {} ({} records, {} symbols)", filepath, header_.record_count, symbols_.size());
+}
+
+std::unique_ptr<BaseEvent> TickFileReader::read_next_event() {
+    if (next_record_ >= header_.record_count) return nullptr;
+    const tick_format::TickRecord& rec = records_[next_record_++];
+    std::unique_ptr<BaseEvent> event = tick_format::to_event(rec, header_.price_scale, symbol_ids_);
+    if (!event) {
+        LOG_ERROR("TickFileReader: Record {} has invalid symbol id {} or type {}", next_record_ - 1, rec.symbol_id,
+                  static_cast<int>(rec.type));
+    }
+    return event;
+}
+
+void TickFileReader::seek_to_timestamp(Timestamp ts) {
+    const int64_t target = ts.time_since_epoch().count();
+    // Start from the last index entry strictly before the target, then scan forward within one stride
+    const tick_format::IndexEntry* it = std::lower_bound(index_begin(), index_end(), target,
+        [](const tick_format::IndexEntry& e, int64_t t) { return e.timestamp_ns < t; });
+    uint64_t rec = (it == index_begin()) ? 0 : (it - 1)->record_index;
+    while (rec < header_.record_count && records_[rec].timestamp_ns < target) {
+        ++rec;
+    }
+    next_record_ = rec;
+}
+
+} // namespace market_replay
@@ -0,0 +1,269 @@
+#include "market_replay/time_index.hpp"
+#include "market_replay/logger.hpp"
+#include "market_replay/tick_file.hpp"          // For the symbol table
+#include "market_replay/utils/mapped_file.hpp"
+#include <algorithm> // For std::lower_bound, std::max
+#include <cstring>   // For std::memcmp, std::memcpy
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace market_replay {
+
+namespace {
+
+SymbolId market_data_symbol(const BaseEvent& event) {
+    if (event.type == EventType::QUOTE) return static_cast<const QuoteEvent&>(event).symbol_id;
+    if (event.type == EventType::TRADE) return static_cast<const TradeEvent&>(event).symbol_id;
+    return INVALID_SYMBOL_ID;
+}
+
+} // namespace
+
+// --- TimeIndex ---
+
+TimeIndex TimeIndex::build(IMarketDataSource& source, uint32_t rows_per_entry) {
+    if (!source.seekable()) {
+        throw std::runtime_error("Cannot index a market data source that does not support seeking");
+    }
+    TimeIndex index;
+    index.rows_per_entry_ = std::max<uint32_t>(1, rows_per_entry);
+
+    std::vector<size_t> last_entry; // By index-local bit: last entry the symbol was seen in, + 1
+    std::vector<std::pair<size_t, uint32_t>> present; // (entry, bit), each pair once
+    uint32_t in_entry = 0;
+    while (source.has_more_events()) {
+        const uint64_t position = source.position();
+        std::unique_ptr<BaseEvent> event = source.read_next_event();
+        if (!event) continue;
+        const SymbolId symbol_id = market_data_symbol(*event);
+        if (symbol_id == INVALID_SYMBOL_ID) continue;
+
+        const int64_t ts = event->exchange_timestamp.time_since_epoch().count();
+        if (in_entry == 0) index.entries_.push_back({ts, ts, position, 0});
+        Entry& entry = index.entries_.back();
+        entry.last_timestamp_ns = ts;
+        entry.events++;
+        if (++in_entry == index.rows_per_entry_) in_entry = 0;
+
+        if (symbol_id >= index.bits_.size()) index.bits_.resize(static_cast<size_t>(symbol_id) + 1, UINT32_MAX);
+        uint32_t& bit = index.bits_[symbol_id];
+        if (bit == UINT32_MAX) {
+            bit = static_cast<uint32_t>(index.symbol_ids_.size());
+            index.symbol_ids_.push_back(symbol_id);
+            index.symbols_.push_back(symbol_name(symbol_id));
+            last_entry.push_back(0);
+        }
+        const size_t entry_number = index.entries_.size();
+        if (last_entry[bit] != entry_number) {
+            last_entry[bit] = entry_number;
+            present.emplace_back(entry_number - 1, bit);
+        }
+    }
+
+    index.words_per_entry_ = (index.symbol_ids_.size() + 63) / 64;
+    index.bitmaps_.assign(index.entries_.size() * index.words_per_entry_, 0);
+    for (const auto& [entry, bit] : present) {
+        index.bitmaps_[entry * index.words_per_entry_ + bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+    return index;
+}
+
+TimeIndex TimeIndex::load(const std::string& index_path) {
+    auto fail = [&index_path](const std::string& why) {
+        throw std::runtime_error("Invalid time index " + index_path + ": " + why);
+    };
+    utils::MappedFile file(index_path);
+    FileHeader header{};
+    if (file.size() < sizeof(header)) fail("file too small for header");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0) fail("bad magic");
+    if (header.version != VERSION) fail("unsupported version " + std::to_string(header.version));
+    if (header.words_per_entry != (static_cast<uint64_t>(header.symbol_count) + 63) / 64) fail("bad bitmap width");
+    const uint64_t body = file.size() - sizeof(header);
+    if (header.entry_count > body / (sizeof(Entry) + header.words_per_entry * sizeof(uint64_t))) fail("truncated file");
+
+    TimeIndex index;
+    index.rows_per_entry_ = header.rows_per_entry;
+    index.source_size_ = header.source_size;
+    index.source_mtime_ = header.source_mtime;
+    index.words_per_entry_ = header.words_per_entry;
+    const char* p = file.data() + sizeof(header);
+    index.entries_.resize(header.entry_count);
+    std::memcpy(index.entries_.data(), p, index.entries_.size() * sizeof(Entry));
+    p += index.entries_.size() * sizeof(Entry);
+    index.bitmaps_.resize(header.entry_count * header.words_per_entry);
+    std::memcpy(index.bitmaps_.data(), p, index.bitmaps_.size() * sizeof(uint64_t));
+    p += index.bitmaps_.size() * sizeof(uint64_t);
+    if (!tick_format::read_symbol_table(p, file.data() + file.size(), header.symbol_count, index.symbols_, index.symbol_ids_)) {
+        fail("truncated symbol table");
+    }
+    for (uint32_t bit = 0; bit < index.symbol_ids_.size(); ++bit) {
+        const SymbolId symbol_id = index.symbol_ids_[bit];
+        if (symbol_id >= index.bits_.size()) index.bits_.resize(static_cast<size_t>(symbol_id) + 1, UINT32_MAX);
+        index.bits_[symbol_id] = bit;
+    }
+    return index;
+}
+
+void TimeIndex::save(const std::string& index_path) const {
+    std::ofstream out(index_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open time index for writing: " + index_path);
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.rows_per_entry = rows_per_entry_;
+    header.source_size = source_size_;
+    header.source_mtime = source_mtime_;
+    header.entry_count = entries_.size();
+    header.symbol_count = static_cast<uint32_t>(symbol_ids_.size());
+    header.words_per_entry = static_cast<uint32_t>(words_per_entry_);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries_.data()), static_cast<std::streamsize>(entries_.size() * sizeof(Entry)));
+    out.write(reinterpret_cast<const char*>(bitmaps_.data()), static_cast<std::streamsize>(bitmaps_.size() * sizeof(uint64_t)));
+    tick_format::SymbolTableWriter symbols;
+    for (SymbolId symbol_id : symbol_ids_) symbols.local_id(symbol_id); // In bit order
+    symbols.write(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write time index: " + index_path);
+    }
+}
+
+std::shared_ptr<const TimeIndex> TimeIndex::load_or_build(const std::string& source_path, IMarketDataSource& source,
+                                                          uint32_t rows_per_entry) {
+    rows_per_entry = std::max<uint32_t>(1, rows_per_entry);
+    std::error_code ec;
+    const uint64_t source_size = std::filesystem::file_size(source_path, ec);
+    const int64_t source_mtime = ec ? 0 : std::filesystem::last_write_time(source_path, ec).time_since_epoch().count();
+    const std::string index_path = sidecar_path(source_path);
+
+    std::error_code exists_ec;
+    if (!ec && std::filesystem::exists(index_path, exists_ec)) {
+        try {
+            auto index = std::make_shared<TimeIndex>(load(index_path));
+            if (index->matches(source_size, source_mtime) && index->rows_per_entry_ == rows_per_entry) {
+                LOG_INFO("TimeIndex: Loaded {} ({} entries, {} symbols)", index_path, index->entries_.size(), index->symbols_.size());
+                return index;
+            }
+            LOG_INFO("TimeIndex: {} is out of date, rebuilding", index_path);
+        } catch (const std::runtime_error& e) {
+            LOG_WARN("TimeIndex: Ignoring {}: {}", index_path, e.what());
+        }
+    }
+
+    const uint64_t start = source.position();
+    auto index = std::make_shared<TimeIndex>(build(source, rows_per_entry));
+    source.seek(start);
+    if (ec) {
+        LOG_WARN("TimeIndex: Cannot stat {} ({}); index kept in memory only", source_path, ec.message());
+        return index;
+    }
+    index->source_size_ = source_size;
+    index->source_mtime_ = source_mtime;
+    try {
+        index->save(index_path);
+        LOG_INFO("TimeIndex: Built {} ({} entries, {} symbols)", index_path, index->entries_.size(), index->symbols_.size());
+    } catch (const std::runtime_error& e) {
+        LOG_WARN("TimeIndex: {}; index kept in memory only", e.what());
+    }
+    return index;
+}
+
+size_t TimeIndex::find(Timestamp ts) const {
+    const int64_t target = ts.time_since_epoch().count();
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), target,
+        [](const Entry& e, int64_t t) { return e.first_timestamp_ns < t; });
+    return it == entries_.begin() ? 0 : static_cast<size_t>(it - entries_.begin() - 1);
+}
+
+std::vector<uint64_t> TimeIndex::symbol_mask(const std::vector<SymbolId>& symbols) const {
+    std::vector<uint64_t> mask(words_per_entry_, 0);
+    for (SymbolId symbol_id : symbols) {
+        if (symbol_id < bits_.size() && bits_[symbol_id] != UINT32_MAX) {
+            mask[bits_[symbol_id] / 64] |= uint64_t{1} << (bits_[symbol_id] % 64);
+        }
+    }
+    return mask;
+}
+
+bool TimeIndex::contains(size_t entry, SymbolId symbol_id) const {
+    if (entry >= entries_.size() || symbol_id >= bits_.size() || bits_[symbol_id] == UINT32_MAX) return false;
+    const uint32_t bit = bits_[symbol_id];
+    return (bitmaps_[entry * words_per_entry_ + bit / 64] >> (bit % 64)) & 1;
+}
+
+// --- WindowedMarketDataSource ---
+
+WindowedMarketDataSource::WindowedMarketDataSource(std::unique_ptr<IMarketDataSource> source, ReplayWindow window,
+                                                   std::shared_ptr<const TimeIndex> index)
+    : source_(std::move(source)), window_(std::move(window)), index_(std::move(index)) {
+    for (SymbolId symbol_id : window_.symbols) {
+        if (symbol_id >= wanted_.size()) wanted_.resize(static_cast<size_t>(symbol_id) + 1, false);
+        wanted_[symbol_id] = true;
+    }
+    if (index_ && !source_->seekable()) {
+        LOG_WARN("WindowedMarketDataSource: Source does not support seeking; filtering without the index");
+        index_.reset();
+    }
+    if (index_) {
+        if (!window_.symbols.empty()) mask_ = index_->symbol_mask(window_.symbols);
+        done_ = index_->entries().empty() || !seek_to_entry(index_->find(window_.start));
+    }
+    next_ = fetch();
+}
+
+bool WindowedMarketDataSource::seek_to_entry(size_t entry) {
+    const auto& entries = index_->entries();
+    const int64_t start = window_.start.time_since_epoch().count();
+    const int64_t end = window_.end.time_since_epoch().count();
+    while (entry < entries.size() && (entries[entry].last_timestamp_ns < start ||
+                                      (!mask_.empty() && !index_->intersects(entry, mask_)))) {
+        if (entries[entry].last_timestamp_ns >= start) stats_.entries_skipped++;
+        ++entry;
+    }
+    if (entry >= entries.size() || entries[entry].first_timestamp_ns > end) return false;
+    entry_ = entry;
+    // Reading on is free; a seek may drop read-ahead (e.g. a .mrtz reader's decoded blocks)
+    if (source_->position() != entries[entry].position) source_->seek(entries[entry].position);
+    return true;
+}
+
+std::unique_ptr<BaseEvent> WindowedMarketDataSource::fetch() {
+    while (!done_) {
+        if (index_) {
+            const auto& entries = index_->entries();
+            if (entry_ + 1 < entries.size() && source_->position() >= entries[entry_ + 1].position &&
+                !seek_to_entry(entry_ + 1)) {
+                done_ = true;
+                break;
+            }
+        }
+        if (!source_->has_more_events()) {
+            done_ = true;
+            break;
+        }
+        std::unique_ptr<BaseEvent> event = source_->read_next_event();
+        if (!event) continue;
+        if (event->exchange_timestamp > window_.end) {
+            done_ = true;
+            break;
+        }
+        if (event->exchange_timestamp < window_.start || !wanted(market_data_symbol(*event))) {
+            stats_.events_filtered++;
+            continue;
+        }
+        return event;
+    }
+    return nullptr;
+}
+
+std::unique_ptr<BaseEvent> WindowedMarketDataSource::read_next_event() {
+    std::unique_ptr<BaseEvent> event = std::move(next_);
+    next_ = fetch();
+    return event;
+}
+
+} // namespace market_replay
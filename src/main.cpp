@@ -20,26 +20,51 @@ namespace market_replay {
 
 int main(int argc, char* argv[]) {
     // --- Initialize Logger ---
-    // Async true for performance in main sim, false for tests if easier to debug.
-    market_replay::Logger::init("simulator_log.txt", spdlog::level::info, spdlog::level::debug, true); 
+    // The replay profile keeps file I/O on spdlog's thread; --verbose adds per-order and per-tick
+    // debug lines to the file, which costs far more than the replay does.
+    auto log_cfg = market_replay::Logger::replay_profile("simulator_log.txt");
+    log_cfg.console_level = spdlog::level::info; // Progress and results stay on the console
+    for (int i = 2; i < argc; ++i) {
+        if (std::string(argv[i]) == "--verbose") log_cfg.file_level = spdlog::level::debug;
+    }
+    market_replay::Logger::init(log_cfg);
     LOG_INFO("Market Replay Simulator starting...");
 
     if (argc < 2) {
-        LOG_CRITICAL("Usage: {} <path_to_tick_data.csv> [path_to_config.ini (optional)]", argv[0]);
+        LOG_CRITICAL("Usage: {} <path_to_tick_data.csv|.mrt|.mrtz|directory> [path_to_config.ini (optional)] [--trace trace.json] [--tick-sizes SYM=SIZE,...] [--verbose]", argv[0]);
         market_replay::Logger::shutdown();
         return 1;
     }
     std::string data_file_path = argv[1];
     LOG_INFO("Input data file: {}", data_file_path);
 
+    // --- Profiling: a stage table at the end of the run, and a Chrome trace if asked for ---
+    market_replay::Dispatcher::Config dispatcher_cfg;
+    dispatcher_cfg.profiling.enabled = true;
+    for (int i = 2; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--trace") dispatcher_cfg.profiling.trace_path = argv[i + 1];
+    }
+    if (!dispatcher_cfg.profiling.trace_path.empty()) {
+        LOG_INFO("Writing a trace to {}", dispatcher_cfg.profiling.trace_path);
+    }
+
+    // --- Tick sizes: override those recorded in .mrt/.mrtz files; CSV prices use the default otherwise ---
+    try {
+        for (int i = 2; i + 1 < argc; ++i) {
+            if (std::string(argv[i]) != "--tick-sizes") continue;
+            for (auto& entry : market_replay::parse_tick_sizes(argv[i + 1])) dispatcher_cfg.tick_sizes.push_back(entry);
+        }
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("{}", e.what());
+        market_replay::Logger::shutdown();
+        return 1;
+    }
+    for (const auto& [symbol, tick_size] : dispatcher_cfg.tick_sizes) {
+        LOG_INFO("Tick size for {}: {}", symbol, tick_size);
+    }
+
     // --- Configure Latency Model (Example fixed values, could load from config) ---
-    market_replay::LatencyModel::Config latency_cfg;
-    latency_cfg.market_data_feed_latency = market_replay::string_to_duration_ns("50us");
-    latency_cfg.strategy_processing_latency = market_replay::string_to_duration_ns("5us");
-    latency_cfg.order_network_latency_strat_to_exch = market_replay::string_to_duration_ns("20us");
-    latency_cfg.exchange_order_processing_latency = market_replay::string_to_duration_ns("10us");
-    latency_cfg.exchange_fill_processing_latency = market_replay::string_to_duration_ns("15us");
-    latency_cfg.ack_network_latency_exch_to_strat = market_replay::string_to_duration_ns("20us");
+    const market_replay::LatencyModel::Config latency_cfg = market_replay::LatencyModel::cli_config();
     LOG_INFO("Latency model configured: MD Feed: {}ns, Strat Proc: {}ns, Order Net: {}ns, Exch Ack Proc: {}ns, Exch Fill Proc: {}ns, Ack Net: {}ns",
         latency_cfg.market_data_feed_latency.count(), latency_cfg.strategy_processing_latency.count(),
         latency_cfg.order_network_latency_strat_to_exch.count(), latency_cfg.exchange_order_processing_latency.count(),
@@ -52,7 +77,7 @@ int main(int argc, char* argv[]) {
 
     // --- Create Dispatcher ---
     try {
-        market_replay::Dispatcher dispatcher(data_file_path, latency_cfg, metrics_collector);
+        market_replay::Dispatcher dispatcher(data_file_path, latency_cfg, metrics_collector, dispatcher_cfg);
 
         // --- Add Strategies ---
         // Using the factory function for BasicStrategy
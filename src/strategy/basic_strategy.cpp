@@ -1,5 +1,6 @@
 #include "market_replay/strategy.hpp"
 #include "market_replay/logger.hpp" // Already in strategy.hpp but good practice
+#include <cmath>    // For std::abs, std::isfinite
 #include <iostream> // For console output from strategy if needed
 
 namespace market_replay {
@@ -12,7 +13,8 @@ public:
         : IStrategy(std::move(id), order_submitter, metrics_collector) {}
 
     void on_init(Timestamp current_sim_time) override {
-        LOG_INFO("Strategy [{}]: Initialized at sim time {}", id_, timestamp_to_string(current_sim_time));
+        subscribe(eurusd_id_); // Nothing else is looked at
+        LOG_INFO("Strategy [{}]: Initialized at sim time {}", id_, log_ts(current_sim_time));
         // Example: submit an initial order if needed (though usually based on market data)
     }
 
@@ -30,31 +32,31 @@ public:
 
     void on_quote(const QuoteEvent& quote, Timestamp strategy_arrival_ts) override {
         LOG_DEBUG("Strategy [{}]: Received Quote: Symbol={}, BidPx={}, BidSz={}, AskPx={}, AskSz={}, ArrivalTS={}",
-                  id_, quote.symbol, quote.bid_price, quote.bid_size, quote.ask_price, quote.ask_size,
-                  timestamp_to_string(strategy_arrival_ts));
+                  id_, symbol_name(quote.symbol_id), quote.get_bid_price(), quote.bid_size, quote.get_ask_price(), quote.ask_size,
+                  log_ts(strategy_arrival_ts));
 
         // Example: Simple Market Order on first quote for "EURUSD"
-        if (quote.symbol == "EURUSD" && !eurusd_order_sent_ && quote.ask_price > 0 && quote.ask_size > 0) {
+        if (quote.symbol_id == eurusd_id_ && !eurusd_order_sent_ && quote.get_ask_price() > 0 && quote.ask_size > 0) {
             LOG_INFO("Strategy [{}]: EURUSD quote received, submitting market buy order.", id_);
             // Decision time is the arrival time of the quote that triggered it.
             // Plus any strategy_processing_latency modeled if not done by LatencyModel globally.
             // Here, decision_ts is the quote's arrival time.
-            submit_order(quote.symbol, OrderSide::BUY, OrderType::MARKET, INVALID_PRICE, 1000, strategy_arrival_ts);
+            submit_order(quote.symbol_id, OrderSide::BUY, OrderType::MARKET, INVALID_PRICE, 1000, strategy_arrival_ts);
             eurusd_order_sent_ = true;
         }
     }
 
     void on_trade(const TradeEvent& trade, Timestamp strategy_arrival_ts) override {
         LOG_DEBUG("Strategy [{}]: Received Trade: Symbol={}, Price={}, Size={}, ArrivalTS={}",
-                  id_, trade.symbol, trade.price, trade.size, timestamp_to_string(strategy_arrival_ts));
+                  id_, symbol_name(trade.symbol_id), trade.get_price(), trade.size, log_ts(strategy_arrival_ts));
     }
 
 // Inside BasicStrategy class, in on_order_ack method:
     void on_order_ack(const OrderAckEvent& ack, Timestamp strategy_arrival_ts) override {
-        LOG_INFO("Strategy [{}]: Received OrderAck: ClientID={}, ExchID={}, Symbol={}, Status={}, LastFillPx={}, LastFillQty={}, CumQty={}, Leaves={}, ArrivalTS={}",
-                 id_, ack.client_order_id, ack.exchange_order_id, ack.symbol, static_cast<int>(ack.status),
+        LOG_DEBUG("Strategy [{}]: Received OrderAck: ClientID={}, ExchID={}, Symbol={}, Status={}, LastFillPx={}, LastFillQty={}, CumQty={}, Leaves={}, ArrivalTS={}",
+                 id_, ack.client_order_id, ack.exchange_order_id, symbol_name(ack.symbol_id), static_cast<int>(ack.status),
                  ack.last_filled_price, ack.last_filled_quantity, ack.cumulative_filled_quantity, ack.leaves_quantity,
-                 timestamp_to_string(strategy_arrival_ts));
+                 log_ts(strategy_arrival_ts));
         
         if (ack.status == OrderStatus::REJECTED) {
             LOG_ERROR("Strategy [{}]: Order ClientID={} was REJECTED: {}", id_, ack.client_order_id, ack.reject_reason);
@@ -64,31 +66,16 @@ public:
             (ack.status == OrderStatus::FILLED || ack.status == OrderStatus::PARTIALLY_FILLED) && 
             ack.last_filled_quantity > 0) {
             
-            OrderSide determined_trade_side;
-
-            // --- Simplified logic to determine trade side for BasicStrategy ---
-            // This strategy only sends one specific BUY order for EURUSD.
-            // We assume any fill for EURUSD corresponding to our known client_order_id range 
-            // (or specifically if client_order_id == 1, since it's the first) is that BUY.
-            // This is still a simplification. A real strategy would store details of all sent orders.
-            if (ack.symbol == "EURUSD" && eurusd_order_sent_ && ack.client_order_id == 1) { // Assuming client_order_id 1 was the EURUSD buy
-                determined_trade_side = OrderSide::BUY; 
-            } else {
-                // If we can't determine (e.g., other symbols, or other orders if strategy was more complex)
-                LOG_WARN("Strategy [{}]: Could not reliably determine original side for filled order ClientID={}. Defaulting to BUY for metrics as a placeholder.", id_, ack.client_order_id);
-                determined_trade_side = OrderSide::BUY; // Placeholder - THIS IS NOT ROBUST for a general strategy
-            }
-            // --- End logic to determine trade side ---
-
             SimulatedTrade simulated_trade{
                 /*timestamp*/         strategy_arrival_ts,
                 /*strategy_id*/       id_, 
-                /*symbol*/            ack.symbol,
-                /*side*/              determined_trade_side,
+                /*symbol_id*/         ack.symbol_id,
+                /*side*/              ack.side, // Carried over from the OrderRequest by the exchange
                 /*price*/             ack.last_filled_price,
                 /*quantity*/          ack.last_filled_quantity,
                 /*client_order_id*/   ack.client_order_id,
-                /*exchange_order_id*/ ack.exchange_order_id
+                /*exchange_order_id*/ ack.exchange_order_id,
+                /*price_ticks*/       ack.last_filled_price_ticks
             };
             metrics_collector_->record_trade(simulated_trade);
         }
@@ -96,7 +83,7 @@ public:
 
     void on_sim_control(const SimControlEvent& control_event, Timestamp strategy_arrival_ts) override {
         LOG_INFO("Strategy [{}]: Received SimControlEvent Type={} at {}", 
-                 id_, static_cast<int>(control_event.control_type), timestamp_to_string(strategy_arrival_ts));
+                 id_, static_cast<int>(control_event.control_type), log_ts(strategy_arrival_ts));
         if (control_event.control_type == SimControlEvent::ControlType::STRATEGY_SHUTDOWN) {
             LOG_INFO("Strategy [{}]: Shutdown signal received.", id_);
             // Perform any cleanup before thread exits
@@ -105,23 +92,46 @@ public:
 
 
     void on_shutdown(Timestamp current_sim_time) override {
-        LOG_INFO("Strategy [{}]: Shutting down at sim time {}", id_, timestamp_to_string(current_sim_time));
+        LOG_INFO("Strategy [{}]: Shutting down at sim time {}", id_, log_ts(current_sim_time));
         // Report strategy-specific PnL, etc.
     }
 
+    void save_state(CheckpointWriter& out) const override { out.write_bool(eurusd_order_sent_); }
+    void restore_state(CheckpointReader& in) override { eurusd_order_sent_ = in.read_bool(); }
+
 private:
+    const SymbolId eurusd_id_ = intern_symbol("EURUSD"); // Resolved once; the hot path compares ids
     bool eurusd_order_sent_ = false;
 };
 
+// Fades moves away from a rolling mean: sells when the mid is entry_z deviations above its mean
+// over the last `window` quotes, buys when it is as far below, and flattens once it is back within
+// exit_z. Positions are tracked as targets, so an order that goes unfilled is not retried.
 class MeanReversionStrategy : public IStrategy {
 public:
+    struct Config {
+        size_t window = 200;    // Quotes the mean and deviation are taken over
+        double entry_z = 2.0;
+        double exit_z = 0.5;
+        Quantity quantity = 500; // Per unit of target position
+    };
+
     MeanReversionStrategy(StrategyId id, 
                   IOrderSubmitter* order_submitter, 
                   std::shared_ptr<MetricsCollector> metrics_collector)
-        : IStrategy(std::move(id), order_submitter, metrics_collector) {}
+        : MeanReversionStrategy(std::move(id), order_submitter, std::move(metrics_collector), Config{}) {}
+    MeanReversionStrategy(StrategyId id,
+                  IOrderSubmitter* order_submitter,
+                  std::shared_ptr<MetricsCollector> metrics_collector,
+                  Config config)
+        : IStrategy(std::move(id), order_submitter, metrics_collector),
+          config_(config),
+          signals_(Signal{indicators::RollingVariance(config.window)}) {}
 
     void on_init(Timestamp /*current_sim_time*/) override {
-        LOG_INFO("Strategy [{}]: Mean Reversion Initialized.", id_);
+        subscribe(eurusd_id_);
+        LOG_INFO("Strategy [{}]: Mean Reversion Initialized (window {}, entry z {}, exit z {}).", id_, config_.window,
+                 config_.entry_z, config_.exit_z);
     }
 
     void on_event(const StrategyInputEventVariant& event_variant, Timestamp strategy_arrival_ts) override {
@@ -130,25 +140,40 @@ public:
 
     void on_quote(const QuoteEvent& quote, Timestamp strategy_arrival_ts) override {
         LOG_DEBUG("MeanRev Strat [{}]: Quote: Symbol={}, BidPx={}, AskPx={}, ArrivalTS={}",
-                  id_, quote.symbol, quote.bid_price, quote.ask_price, timestamp_to_string(strategy_arrival_ts));
-        // TODO: Implement actual mean reversion logic
-        // For now, let's make it submit a trade on EURUSD differently than BasicStrategy
-        if (quote.symbol == "EURUSD" && !order_sent_ && quote.bid_price > 0 && quote.bid_size > 0) {
-            LOG_INFO("MeanRev Strat [{}]: EURUSD quote, submitting market SELL.", id_);
-            submit_order(quote.symbol, OrderSide::SELL, OrderType::MARKET, INVALID_PRICE, 500, strategy_arrival_ts);
-            order_sent_ = true;
+                  id_, symbol_name(quote.symbol_id), quote.get_bid_price(), quote.get_ask_price(), log_ts(strategy_arrival_ts));
+        const double mid = mid_price(quote);
+        if (!std::isfinite(mid) || quote.bid_size == 0 || quote.ask_size == 0) return; // One-sided book
+        Signal& signal = signals_[quote.symbol_id];
+        signal.stats.update(mid);
+        if (!signal.stats.ready()) return;
+
+        const double z = signal.stats.zscore(mid);
+        int target = signal.target;
+        if (z >= config_.entry_z) {
+            target = -1;
+        } else if (z <= -config_.entry_z) {
+            target = 1;
+        } else if (std::abs(z) <= config_.exit_z) {
+            target = 0;
         }
+        if (target == signal.target) return;
+
+        const int change = target - signal.target;
+        LOG_DEBUG("MeanRev Strat [{}]: {} z {:.2f} (mean {}), position {} -> {}.", id_, symbol_name(quote.symbol_id), z,
+                  signal.stats.mean(), signal.target, target);
+        submit_order(quote.symbol_id, change > 0 ? OrderSide::BUY : OrderSide::SELL, OrderType::MARKET, INVALID_PRICE,
+                     config_.quantity * static_cast<Quantity>(std::abs(change)), strategy_arrival_ts);
+        signal.target = target;
     }
-    void on_trade(const TradeEvent& trade, Timestamp strategy_arrival_ts) override { /* ... */ }
+    void on_trade(const TradeEvent& /*trade*/, Timestamp /*strategy_arrival_ts*/) override {}
     void on_order_ack(const OrderAckEvent& ack, Timestamp strategy_arrival_ts) override {
-        LOG_INFO("MeanRev Strat [{}]: OrderAck: ClientID={}, Status={}", id_, ack.client_order_id, static_cast<int>(ack.status));
-        // Simplified: just log. Metrics recording would be similar to BasicStrategy
+        LOG_DEBUG("MeanRev Strat [{}]: OrderAck: ClientID={}, Status={}", id_, ack.client_order_id, static_cast<int>(ack.status));
         if (metrics_collector_ && (ack.status == OrderStatus::FILLED || ack.status == OrderStatus::PARTIALLY_FILLED) && ack.last_filled_quantity > 0) {
              SimulatedTrade simulated_trade{
-                strategy_arrival_ts, id_, ack.symbol,
-                OrderSide::SELL, // Assuming this strategy only sells for now
+                strategy_arrival_ts, id_, ack.symbol_id,
+                ack.side,
                 ack.last_filled_price, ack.last_filled_quantity,
-                ack.client_order_id, ack.exchange_order_id
+                ack.client_order_id, ack.exchange_order_id, ack.last_filled_price_ticks
             };
             metrics_collector_->record_trade(simulated_trade);
         }
@@ -157,8 +182,36 @@ public:
     void on_shutdown(Timestamp /*current_sim_time*/) override {
         LOG_INFO("Strategy [{}]: Mean Reversion Shutting down.", id_);
     }
+
+    // Every symbol with quotes in its window: the window, its running sums and the target position
+    void save_state(CheckpointWriter& out) const override {
+        size_t count = 0;
+        for (SymbolId id = 0; id < signals_.size(); ++id) count += signals_.find(id)->stats.count() > 0;
+        out.write_varint(count);
+        for (SymbolId id = 0; id < signals_.size(); ++id) {
+            const Signal& signal = *signals_.find(id);
+            if (signal.stats.count() == 0) continue;
+            out.write_varint(id);
+            signal.stats.save_state(out);
+            out.write_svarint(signal.target);
+        }
+    }
+    void restore_state(CheckpointReader& in) override {
+        for (uint64_t count = in.read_varint(); count > 0; --count) {
+            Signal& signal = signals_[static_cast<SymbolId>(in.read_varint())];
+            signal.stats.restore_state(in);
+            signal.target = static_cast<int>(in.read_svarint());
+        }
+    }
 private:
-    bool order_sent_ = false;
+    struct Signal {
+        indicators::RollingVariance stats;
+        int target = 0; // -1 short, 0 flat, 1 long, in units of config_.quantity
+    };
+
+    Config config_;
+    indicators::PerSymbol<Signal> signals_;
+    const SymbolId eurusd_id_ = intern_symbol("EURUSD");
 };
 
 std::unique_ptr<IStrategy> create_basic_strategy(const StrategyId& id,
@@ -0,0 +1,112 @@
+// market_replay_sweep: runs a batch of latency scenarios over one tick file, several at a time.
+//
+// The scenarios file is a CSV with a header line and one scenario per line:
+//   name,market_data_feed,strategy_processing,order_network,exchange_order_processing,exchange_fill_processing,ack_network
+// Durations use string_to_duration_ns syntax ("50us", "2ms", ...); an empty field keeps the
+// market_replay_sim_cli value. Every scenario runs the same strategy set as market_replay_sim_cli.
+// Tick sizes (--tick-sizes SYM=SIZE,...) apply to the whole sweep: the data is parsed once.
+#include "market_replay/logger.hpp"
+#include "market_replay/sweep_runner.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace market_replay {
+    std::unique_ptr<IStrategy> create_basic_strategy(const StrategyId& id,
+                                                     IOrderSubmitter* order_submitter,
+                                                     std::shared_ptr<MetricsCollector> metrics_collector);
+}
+
+namespace {
+
+using namespace market_replay;
+
+std::vector<SweepRunner::Scenario> load_scenarios(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open scenarios file: " + path);
+    }
+    std::vector<SweepRunner::Scenario> scenarios;
+    std::string line;
+    std::getline(file, line); // Header
+    size_t line_number = 1;
+    while (std::getline(file, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        for (std::string field; std::getline(ss, field, ',');) fields.push_back(field);
+        if (fields.empty() || fields[0].empty()) {
+            throw std::runtime_error("Scenario without a name on line " + std::to_string(line_number));
+        }
+        fields.resize(7);
+
+        SweepRunner::Scenario scenario;
+        scenario.name = fields[0];
+        scenario.latency = LatencyModel::cli_config();
+        Duration* durations[] = {
+            &scenario.latency.market_data_feed_latency, &scenario.latency.strategy_processing_latency,
+            &scenario.latency.order_network_latency_strat_to_exch, &scenario.latency.exchange_order_processing_latency,
+            &scenario.latency.exchange_fill_processing_latency, &scenario.latency.ack_network_latency_exch_to_strat};
+        for (size_t i = 0; i < 6; ++i) {
+            if (!fields[i + 1].empty()) *durations[i] = string_to_duration_ns(fields[i + 1]);
+        }
+        scenario.strategies.push_back({"BasicStrat_EURUSD_1", create_basic_strategy, StrategyOptions{}});
+        scenarios.push_back(std::move(scenario));
+    }
+    return scenarios;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Many dispatchers log at once: keep the console to warnings
+    Logger::init("sweep_log.txt", spdlog::level::warn, spdlog::level::info, true);
+
+    std::vector<std::string> args; // Positional
+    std::string tick_sizes;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--tick-sizes" && i + 1 < argc) {
+            tick_sizes = argv[++i];
+        } else {
+            args.emplace_back(argv[i]);
+        }
+    }
+    if (args.size() < 2) {
+        LOG_CRITICAL("Usage: {} <tick_data.csv|.mrt> <scenarios.csv> [summary.csv] [threads] [per_run_output_dir] "
+                     "[--tick-sizes SYM=SIZE,...]", argv[0]);
+        Logger::shutdown();
+        return 1;
+    }
+
+    try {
+        SweepRunner::Config config;
+        if (args.size() > 2) config.summary_path = args[2];
+        if (args.size() > 3) config.num_threads = std::stoul(args[3]);
+        if (args.size() > 4) config.per_run_output_dir = args[4];
+
+        std::vector<SweepRunner::Scenario> scenarios = load_scenarios(args[1]);
+        auto start = std::chrono::steady_clock::now();
+        apply_tick_sizes(parse_tick_sizes(tick_sizes)); // Before the data is parsed
+        auto data = MarketDataBuffer::load(args[0]); // Parsed once for the whole sweep
+        SweepRunner runner(data, config);
+        std::vector<SweepRunner::Result> results = runner.run(scenarios);
+
+        size_t failed = 0;
+        for (const auto& result : results) failed += !result.ok;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        LOG_WARN("Sweep of {} scenarios finished in {} ms ({} failed). Summary: {}",
+                 results.size(), elapsed.count(), failed, config.summary_path);
+        Logger::shutdown();
+        return failed == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("Sweep failed: {}", e.what());
+        Logger::shutdown();
+        return 1;
+    }
+}
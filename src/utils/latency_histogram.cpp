@@ -0,0 +1,83 @@
+#include "market_replay/latency_histogram.hpp"
+#include "market_replay/checkpoint.hpp"
+#include <algorithm> // For std::min, std::fill
+#include <cmath>     // For std::ceil
+
+namespace market_replay {
+
+uint64_t LatencyHistogram::bucket_lower(size_t index) {
+    if (index < 2 * kSubBuckets) return index;
+    const size_t magnitude = index / kSubBuckets - 1;
+    return static_cast<uint64_t>(index - magnitude * kSubBuckets) << magnitude;
+}
+
+uint64_t LatencyHistogram::bucket_width(size_t index) {
+    if (index < 2 * kSubBuckets) return 1;
+    return uint64_t{1} << (index / kSubBuckets - 1);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.total_count_ == 0) return;
+    for (size_t i = 0; i < kNumBuckets; ++i) counts_[i] += other.counts_[i];
+    min_ns_ = total_count_ == 0 ? other.min_ns_ : std::min(min_ns_, other.min_ns_);
+    max_ns_ = std::max(max_ns_, other.max_ns_);
+    total_count_ += other.total_count_;
+    sum_ns_ += other.sum_ns_;
+}
+
+void LatencyHistogram::save_state(CheckpointWriter& out) const {
+    size_t used = 0;
+    for (uint64_t count : counts_) used += (count != 0);
+    out.write_varint(used);
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        if (counts_[i] == 0) continue;
+        out.write_varint(i);
+        out.write_varint(counts_[i]);
+    }
+    out.write_varint(total_count_);
+    out.write_varint(min_ns_);
+    out.write_varint(max_ns_);
+    out.write_varint(sum_ns_);
+}
+
+void LatencyHistogram::restore_state(CheckpointReader& in) {
+    reset();
+    for (uint64_t used = in.read_varint(); used > 0; --used) {
+        const uint64_t index = in.read_varint();
+        const uint64_t count = in.read_varint();
+        if (index < kNumBuckets) counts_[index] = count;
+    }
+    total_count_ = in.read_varint();
+    min_ns_ = in.read_varint();
+    max_ns_ = in.read_varint();
+    sum_ns_ = in.read_varint();
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_count_ = 0;
+    min_ns_ = max_ns_ = sum_ns_ = 0;
+}
+
+Duration LatencyHistogram::mean() const {
+    if (total_count_ == 0) return Duration(0);
+    return Duration(static_cast<int64_t>(sum_ns_ / total_count_));
+}
+
+Duration LatencyHistogram::value_at_percentile(double percentile) const {
+    if (total_count_ == 0) return Duration(0);
+    const double fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    // Rank of the sample at this percentile, 1-based
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total_count_))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            const uint64_t highest = bucket_lower(i) + bucket_width(i) - 1;
+            return Duration(static_cast<int64_t>(std::min(highest, max_ns_)));
+        }
+    }
+    return max();
+}
+
+} // namespace market_replay
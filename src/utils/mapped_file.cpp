@@ -0,0 +1,101 @@
+#include "market_replay/utils/mapped_file.hpp"
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MARKET_REPLAY_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace market_replay {
+namespace utils {
+
+MappedFile::MappedFile(const std::string& filepath) : path_(filepath) {
+#ifdef MARKET_REPLAY_HAS_MMAP
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + filepath);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to mmap file: " + filepath);
+        }
+        data_ = static_cast<const char*>(addr);
+        is_mapped_ = true;
+    }
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+#else
+    std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+    size_ = static_cast<size_t>(in.tellg());
+    fallback_buffer_.resize(size_);
+    in.seekg(0);
+    in.read(fallback_buffer_.data(), static_cast<std::streamsize>(size_));
+    data_ = fallback_buffer_.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)), data_(other.data_), size_(other.size_),
+      is_mapped_(other.is_mapped_), fallback_buffer_(std::move(other.fallback_buffer_)) {
+    if (!is_mapped_ && size_ > 0) data_ = fallback_buffer_.data();
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.is_mapped_ = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        path_ = std::move(other.path_);
+        data_ = other.data_;
+        size_ = other.size_;
+        is_mapped_ = other.is_mapped_;
+        fallback_buffer_ = std::move(other.fallback_buffer_);
+        if (!is_mapped_ && size_ > 0) data_ = fallback_buffer_.data();
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.is_mapped_ = false;
+    }
+    return *this;
+}
+
+void MappedFile::advise_sequential() const {
+#ifdef MARKET_REPLAY_HAS_MMAP
+    if (is_mapped_ && size_ > 0) {
+        ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+#endif
+}
+
+void MappedFile::release() {
+#ifdef MARKET_REPLAY_HAS_MMAP
+    if (is_mapped_ && data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    is_mapped_ = false;
+    fallback_buffer_.clear();
+}
+
+} // namespace utils
+} // namespace market_replay
@@ -1,134 +1,501 @@
 #include "market_replay/metrics.hpp"
-#include "market_replay/common.hpp" // For timestamp_to_string
-#include <iostream> // For std::cerr
+#include "market_replay/checkpoint.hpp"
+#include "market_replay/common.hpp"
+#include <algorithm> // For std::remove_if
+#include <iterator> // For std::back_inserter
 
 namespace market_replay {
 
-MetricsCollector::MetricsCollector(std::string trades_filepath, 
-                                   std::string latency_filepath, 
+namespace {
+std::atomic<uint64_t> next_collector_uid{1};
+
+std::FILE* open_output(const std::string& path, const char* header) {
+    if (path.empty()) return nullptr;
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR("MetricsCollector: Failed to open output file: {}", path);
+        return nullptr;
+    }
+    std::fputs(header, file);
+    return file;
+}
+} // namespace
+
+MetricsCollector::MetricsCollector(std::string trades_filepath,
+                                   std::string latency_filepath,
                                    std::string pnl_filepath)
+    : MetricsCollector(std::move(trades_filepath), std::move(latency_filepath), std::move(pnl_filepath), Config{}) {
+}
+
+MetricsCollector::MetricsCollector(std::string trades_filepath,
+                                   std::string latency_filepath,
+                                   std::string pnl_filepath,
+                                   Config config)
     : trades_filepath_(std::move(trades_filepath)),
       latency_filepath_(std::move(latency_filepath)),
-      pnl_filepath_(std::move(pnl_filepath)) {
-    LOG_INFO("MetricsCollector initialized. Trades: {}, Latency: {}, PnL: {}", 
+      pnl_filepath_(std::move(pnl_filepath)),
+      config_(config),
+      uid_(next_collector_uid.fetch_add(1, std::memory_order_relaxed)) {
+    if (config_.records_per_buffer == 0) config_.records_per_buffer = 1;
+    key_names_.emplace_back(); // kNoKey
+    key_index_.emplace(std::string(), kNoKey);
+    trades_file_ = open_output(trades_filepath_, "TimestampNS,StrategyID,Symbol,Side,Price,Quantity,ClientOrderID,ExchangeOrderID\n");
+    latency_file_ = open_output(config_.raw_latency_log_path, "EventTimestampNS,SourceDescription,LatencyNS,Notes\n");
+    writer_ = std::thread(&MetricsCollector::writer_loop, this);
+    LOG_INFO("MetricsCollector initialized. Trades: {}, Latency: {}, PnL: {}",
              trades_filepath_, latency_filepath_, pnl_filepath_);
 }
 
 MetricsCollector::~MetricsCollector() {
     // report_final_metrics(); // Optionally report on destruction, but explicit call is better
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        for (auto& buffer : buffers_) {
+            if (buffer->current) full_chunks_.push(std::move(buffer->current));
+            buffer->collector_alive.store(false, std::memory_order_release);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        writer_stopping_ = true;
+    }
+    writer_cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+    if (trades_file_) std::fclose(trades_file_);
+    if (latency_file_) std::fclose(latency_file_);
+}
+
+MetricKey MetricsCollector::intern_key(std::string_view name) {
+    std::lock_guard<std::mutex> lock(keys_mutex_);
+    auto it = key_index_.find(std::string(name));
+    if (it != key_index_.end()) return it->second;
+    const auto key = static_cast<MetricKey>(key_names_.size());
+    key_names_.emplace_back(name);
+    key_index_.emplace(key_names_.back(), key);
+    return key;
+}
+
+const std::string& MetricsCollector::key_name(MetricKey key) {
+    std::lock_guard<std::mutex> lock(keys_mutex_);
+    return key_names_[key]; // Deque elements never move
+}
+
+MetricKey MetricsCollector::intern_cached(ProducerBuffer& buffer, const std::string& name) {
+    auto it = buffer.key_cache.find(name);
+    if (it != buffer.key_cache.end()) return it->second;
+    const MetricKey key = intern_key(name);
+    buffer.key_cache.emplace(name, key);
+    return key;
+}
+
+MetricsCollector::ProducerBuffer& MetricsCollector::local_buffer() {
+    // Shared by every collector the thread records into; a handful at most
+    thread_local std::vector<std::pair<uint64_t, std::shared_ptr<ProducerBuffer>>> handles;
+    for (auto& handle : handles) {
+        if (handle.first == uid_) return *handle.second;
+    }
+    handles.erase(std::remove_if(handles.begin(), handles.end(),
+                                 [](const auto& handle) { return !handle.second->collector_alive.load(std::memory_order_acquire); }),
+                  handles.end());
+    auto buffer = std::make_shared<ProducerBuffer>();
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(buffer);
+    }
+    handles.emplace_back(uid_, buffer);
+    return *buffer;
+}
+
+MetricsCollector::Chunk& MetricsCollector::writable_chunk(ProducerBuffer& buffer) {
+    const uint64_t epoch = flush_epoch_.load(std::memory_order_relaxed);
+    if (epoch != buffer.flush_epoch_seen) {
+        buffer.flush_epoch_seen = epoch;
+        if (buffer.current && (!buffer.current->trades.empty() || !buffer.current->latencies.empty())) {
+            hand_over(buffer); // The writer is asking for partial chunks
+        }
+    }
+    if (!buffer.current) {
+        if (buffer.spare.empty()) buffer.recycled.drain(buffer.spare);
+        if (!buffer.spare.empty()) {
+            buffer.current = std::move(buffer.spare.back());
+            buffer.spare.pop_back();
+        } else {
+            buffer.current = std::make_unique<Chunk>();
+            buffer.current->owner = &buffer;
+            buffer.current->trades.reserve(config_.records_per_buffer);
+            buffer.current->latencies.reserve(config_.records_per_buffer);
+        }
+    }
+    return *buffer.current;
+}
+
+void MetricsCollector::hand_over(ProducerBuffer& buffer) {
+    full_chunks_.push(std::move(buffer.current));
+    writer_cv_.notify_one(); // Without the lock: a missed wake-up only costs one flush_interval
 }
 
 void MetricsCollector::record_trade(const SimulatedTrade& trade) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    trades_log_.push_back(trade);
-    update_pnl(trade.strategy_id, trade.symbol, trade.price, trade.quantity, trade.side);
+    ProducerBuffer& buffer = local_buffer();
+    const MetricKey strategy = intern_cached(buffer, trade.strategy_id);
+    Chunk& chunk = writable_chunk(buffer);
+    chunk.trades.push_back({trade.timestamp, strategy, trade.symbol_id, trade.side, trade.price, trade.price_ticks,
+                            trade.quantity, trade.client_order_id, trade.exchange_order_id});
+    if (chunk.trades.size() >= config_.records_per_buffer) hand_over(buffer);
+}
+
+void MetricsCollector::record_latency(MetricKey source, Duration latency, Timestamp event_time, MetricKey notes) {
+    ProducerBuffer& buffer = local_buffer();
+    Chunk& chunk = writable_chunk(buffer);
+    chunk.latencies.push_back({event_time, source, notes, latency});
+    if (chunk.latencies.size() >= config_.records_per_buffer) hand_over(buffer);
 }
 
 void MetricsCollector::record_latency(const std::string& source_desc, Duration latency, Timestamp event_time, const std::string& notes) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    latency_log_.push_back({event_time, source_desc, latency, notes});
+    ProducerBuffer& buffer = local_buffer();
+    record_latency(intern_cached(buffer, source_desc), latency, event_time,
+                   notes.empty() ? kNoKey : intern_cached(buffer, notes));
 }
 
-void MetricsCollector::update_pnl(const std::string& strategy_id, const std::string& symbol, Price fill_price, Quantity filled_quantity, OrderSide side) {
-    // This is a simplified PnL calculation (no average price for inventory, just FIFO-like realized)
-    // Proper PnL needs careful position tracking.
-    auto& pnl_entry = pnl_by_strategy_symbol_[{strategy_id, symbol}];
+void MetricsCollector::update_pnl(const std::string& strategy_id, SymbolId symbol_id, Price fill_price, Quantity filled_quantity, OrderSide side) {
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    apply_fill(strategy_id, symbol_id, static_cast<double>(fill_price) * filled_quantity, filled_quantity, side);
+}
+
+void MetricsCollector::update_pnl(const std::string& strategy_id, SymbolId symbol_id, PriceTicks fill_price_ticks, Quantity filled_quantity, OrderSide side) {
+    const PriceTicks notional_ticks = fill_price_ticks * static_cast<PriceTicks>(filled_quantity);
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    apply_fill(strategy_id, symbol_id, from_price_ticks(symbol_id, notional_ticks), filled_quantity, side);
+}
 
-    double trade_value = static_cast<double>(fill_price) * filled_quantity;
+void MetricsCollector::apply_fill(const std::string& strategy_id, SymbolId symbol_id, double trade_value, Quantity filled_quantity, OrderSide side) {
+    // Position and volume only: realized and unrealized PnL need marks, and come from the
+    // dispatcher's PnLEngine through record_pnl()
+    auto& pnl_entry = pnl_by_strategy_symbol_[{strategy_id, symbol_id}];
     pnl_entry.total_volume_traded += trade_value;
+    pnl_entry.current_position += (side == OrderSide::BUY ? 1 : -1) * static_cast<long long>(filled_quantity);
+    LOG_DEBUG("Metrics: PnL updated for Strategy {}, Symbol {}. Position: {}", strategy_id, symbol_name(symbol_id), pnl_entry.current_position);
+}
+
+void MetricsCollector::record_pnl(const std::string& strategy_id, SymbolId symbol_id, const PnL& pnl) {
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    published_pnl_[{strategy_id, symbol_id}] = pnl;
+}
+
+std::map<std::pair<StrategyId, SymbolId>, PnL> MetricsCollector::final_pnl() const {
+    std::map<std::pair<StrategyId, SymbolId>, PnL> pnl = pnl_by_strategy_symbol_;
+    for (const auto& entry : published_pnl_) pnl[entry.first] = entry.second;
+    return pnl;
+}
+
+void MetricsCollector::record_equity_snapshot(const std::string& strategy_id, Timestamp timestamp, double realized_pnl, double unrealized_pnl) {
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    equity_curve_.push_back({strategy_id, timestamp, realized_pnl, unrealized_pnl});
+}
+
+void MetricsCollector::writer_loop() {
+    auto last_epoch_bump = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    for (;;) {
+        writer_cv_.wait_for(lock, config_.flush_interval, [this] {
+            return writer_stopping_ || flush_requested_ > flush_completed_ || !full_chunks_.empty();
+        });
+        const uint64_t flush_target = flush_requested_;
+        const bool stopping = writer_stopping_;
+        lock.unlock();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_epoch_bump >= config_.flush_interval) {
+            flush_epoch_.fetch_add(1, std::memory_order_relaxed); // Partial chunks come in with the next record
+            last_epoch_bump = now;
+        }
+        full_chunks_.drain(drained_);
+        for (auto& chunk : drained_) {
+            write_chunk(*chunk);
+            chunk->trades.clear();
+            chunk->latencies.clear();
+            ProducerBuffer* owner = chunk->owner;
+            owner->recycled.push(std::move(chunk));
+        }
+        drained_.clear();
+        write_output();
+
+        lock.lock();
+        if (flush_target > flush_completed_) {
+            flush_completed_ = flush_target;
+            flushed_cv_.notify_all();
+        }
+        if (stopping && full_chunks_.empty()) break;
+    }
+}
 
-    if (side == OrderSide::BUY) {
-        // If previously short, buying back reduces short position / realizes PnL
-        if (pnl_entry.current_position < 0) {
-            Quantity closed_qty = std::min(filled_quantity, static_cast<Quantity>(-pnl_entry.current_position));
-            // PnL realized = (avg_short_price - fill_price) * closed_qty. Needs avg_short_price.
-            // Simplified: for now, just track position. Detailed PnL is complex.
+void MetricsCollector::write_chunk(Chunk& chunk) {
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    for (const auto& trade : chunk.trades) {
+        const std::string& strategy = key_name(trade.strategy);
+        if (trades_file_) {
+            fmt::format_to(std::back_inserter(trades_text_), "{},{},{},{},{:.5f},{},{},{}\n",
+                           trade.timestamp.time_since_epoch().count(), strategy, symbol_name(trade.symbol_id),
+                           (trade.side == OrderSide::BUY ? "BUY" : "SELL"), trade.price, trade.quantity,
+                           trade.client_order_id, trade.exchange_order_id);
+        }
+        totals_.trade_count++;
+        totals_.total_quantity += trade.quantity;
+        if (trade.price_ticks != INVALID_PRICE_TICKS) {
+            const PriceTicks notional_ticks = trade.price_ticks * static_cast<PriceTicks>(trade.quantity);
+            apply_fill(strategy, trade.symbol_id, from_price_ticks(trade.symbol_id, notional_ticks), trade.quantity, trade.side);
+        } else {
+            apply_fill(strategy, trade.symbol_id, static_cast<double>(trade.price) * trade.quantity, trade.quantity, trade.side);
         }
-        pnl_entry.current_position += filled_quantity;
-    } else { // SELL
-        // If previously long, selling reduces long position / realizes PnL
-        if (pnl_entry.current_position > 0) {
-            Quantity closed_qty = std::min(filled_quantity, static_cast<Quantity>(pnl_entry.current_position));
-            // PnL realized = (fill_price - avg_long_price) * closed_qty. Needs avg_long_price.
+    }
+    for (const auto& sample : chunk.latencies) {
+        if (latency_file_) {
+            fmt::format_to(std::back_inserter(latency_text_), "{},{},{},{}\n",
+                           sample.event_time.time_since_epoch().count(), key_name(sample.source),
+                           sample.latency.count(), key_name(sample.notes));
         }
-        pnl_entry.current_position -= filled_quantity;
+        if (sample.source >= histograms_.size()) histograms_.resize(sample.source + 1);
+        auto& histogram = histograms_[sample.source];
+        if (!histogram) histogram = std::make_unique<LatencyHistogram>();
+        histogram->record(sample.latency);
+        totals_.latency_records++;
+        total_latency_ += sample.latency;
+        totals_.max_latency = std::max(totals_.max_latency, sample.latency);
+    }
+}
+
+void MetricsCollector::write_output() {
+    if (trades_file_ && !trades_text_.empty()) {
+        std::fwrite(trades_text_.data(), 1, trades_text_.size(), trades_file_);
+        std::fflush(trades_file_);
+    }
+    if (latency_file_ && !latency_text_.empty()) {
+        std::fwrite(latency_text_.data(), 1, latency_text_.size(), latency_file_);
+        std::fflush(latency_file_);
     }
-    // For now, just log that a PnL update happened. Real PnL is a project in itself.
-    LOG_DEBUG("Metrics: PnL updated for Strategy {}, Symbol {}. Position: {}", strategy_id, symbol, pnl_entry.current_position);
+    trades_text_.clear(); // Capacity kept: one chunk's worth of text, reused
+    latency_text_.clear();
 }
 
+void MetricsCollector::flush() {
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        for (auto& buffer : buffers_) {
+            if (buffer->current) full_chunks_.push(std::move(buffer->current));
+        }
+    }
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    const uint64_t target = ++flush_requested_;
+    writer_cv_.notify_one();
+    flushed_cv_.wait(lock, [&] { return flush_completed_ >= target; });
+}
 
 void MetricsCollector::report_final_metrics() {
-    std::lock_guard<std::mutex> lock(mtx_); // Ensure all data is consistent before writing
     LOG_INFO("MetricsCollector: Generating final reports...");
-    write_trades_log();
-    write_latency_log();
-    write_pnl_summary(); // PnL summary will be very basic for now
+    flush();
+    if (!trades_filepath_.empty()) LOG_INFO("MetricsCollector: Trades log written to {}", trades_filepath_);
+    if (!config_.raw_latency_log_path.empty()) LOG_INFO("MetricsCollector: Raw latency log written to {}", config_.raw_latency_log_path);
+    write_latency_percentiles();
+    write_histogram_dump();
+    write_pnl_summary();
+    write_equity_curve();
     LOG_INFO("MetricsCollector: Final reports generated.");
 }
 
-void MetricsCollector::write_trades_log() {
-    std::ofstream outfile(trades_filepath_);
-    if (!outfile.is_open()) {
-        LOG_ERROR("MetricsCollector: Failed to open trades log file: {}", trades_filepath_);
-        return;
+MetricsSummary MetricsCollector::summary() {
+    flush();
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    MetricsSummary summary = totals_;
+    for (const auto& entry : final_pnl()) {
+        summary.total_volume_traded += entry.second.total_volume_traded;
+        summary.net_position += entry.second.current_position;
+        summary.realized_pnl += entry.second.realized_pnl;
+        summary.unrealized_pnl += entry.second.unrealized_pnl;
     }
+    if (summary.latency_records > 0) summary.mean_latency = total_latency_ / static_cast<Duration::rep>(summary.latency_records);
+    return summary;
+}
 
-    outfile << std::fixed << std::setprecision(5); // For prices
-    outfile << "TimestampNS,StrategyID,Symbol,Side,Price,Quantity,ClientOrderID,ExchangeOrderID\n";
-    for (const auto& trade : trades_log_) {
-        outfile << timestamp_to_string(trade.timestamp) << ","
-                << trade.strategy_id << ","
-                << trade.symbol << ","
-                << (trade.side == OrderSide::BUY ? "BUY" : "SELL") << ","
-                << trade.price << ","
-                << trade.quantity << ","
-                << trade.client_order_id << ","
-                << trade.exchange_order_id << "\n";
+std::map<std::string, LatencyHistogram> MetricsCollector::latency_histograms() {
+    flush();
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    std::map<std::string, LatencyHistogram> histograms;
+    for (size_t key = 0; key < histograms_.size(); ++key) {
+        if (histograms_[key]) histograms[key_name(static_cast<MetricKey>(key))].merge(*histograms_[key]);
     }
-    outfile.close();
-    LOG_INFO("MetricsCollector: Trades log written to {}", trades_filepath_);
+    return histograms;
 }
 
-void MetricsCollector::write_latency_log() {
-    std::ofstream outfile(latency_filepath_);
-    if (!outfile.is_open()) {
-        LOG_ERROR("MetricsCollector: Failed to open latency log file: {}", latency_filepath_);
-        return;
+void MetricsCollector::save_state(CheckpointWriter& out) {
+    flush();
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    out.write_varint(totals_.trade_count);
+    out.write_varint(totals_.total_quantity);
+    out.write_varint(totals_.latency_records);
+    out.write_duration(totals_.max_latency);
+    out.write_duration(total_latency_);
+
+    size_t sources = 0;
+    for (const auto& histogram : histograms_) sources += (histogram != nullptr);
+    out.write_varint(sources);
+    for (size_t key = 0; key < histograms_.size(); ++key) {
+        if (!histograms_[key]) continue;
+        out.write_string(key_name(static_cast<MetricKey>(key))); // Keys are per collector
+        histograms_[key]->save_state(out);
     }
-    
-    outfile << "EventTimestampNS,SourceDescription,LatencyNS,Notes\n";
-    for (const auto& rec : latency_log_) {
-        outfile << timestamp_to_string(rec.event_time) << ","
-                << rec.source_description << ","
-                << rec.latency_value.count() << ","
-                << rec.notes << "\n";
+
+    for (const auto* pnl_map : {&pnl_by_strategy_symbol_, &published_pnl_}) {
+        out.write_varint(pnl_map->size());
+        for (const auto& [key, pnl] : *pnl_map) {
+            out.write_string(key.first);
+            out.write_varint(key.second);
+            out.write_f64(pnl.realized_pnl);
+            out.write_f64(pnl.unrealized_pnl);
+            out.write_f64(pnl.total_volume_traded);
+            out.write_svarint(pnl.current_position);
+        }
+    }
+
+    out.write_varint(equity_curve_.size());
+    for (const auto& point : equity_curve_) {
+        out.write_string(point.strategy_id);
+        out.write_timestamp(point.timestamp);
+        out.write_f64(point.realized_pnl);
+        out.write_f64(point.unrealized_pnl);
     }
-    outfile.close();
-    LOG_INFO("MetricsCollector: Latency log written to {}", latency_filepath_);
+}
+
+void MetricsCollector::restore_state(CheckpointReader& in) {
+    flush(); // Nothing recorded before the restore is still on its way to the totals
+    std::lock_guard<std::mutex> lock(totals_mutex_);
+    totals_ = MetricsSummary{};
+    totals_.trade_count = static_cast<size_t>(in.read_varint());
+    totals_.total_quantity = in.read_varint();
+    totals_.latency_records = static_cast<size_t>(in.read_varint());
+    totals_.max_latency = in.read_duration();
+    total_latency_ = in.read_duration();
+
+    histograms_.clear();
+    for (uint64_t sources = in.read_varint(); sources > 0; --sources) {
+        const MetricKey key = intern_key(in.read_string());
+        if (key >= histograms_.size()) histograms_.resize(static_cast<size_t>(key) + 1);
+        histograms_[key] = std::make_unique<LatencyHistogram>();
+        histograms_[key]->restore_state(in);
+    }
+
+    for (auto* pnl_map : {&pnl_by_strategy_symbol_, &published_pnl_}) {
+        pnl_map->clear();
+        for (uint64_t count = in.read_varint(); count > 0; --count) {
+            StrategyId strategy_id(in.read_string());
+            const auto symbol_id = static_cast<SymbolId>(in.read_varint());
+            PnL& pnl = (*pnl_map)[{std::move(strategy_id), symbol_id}];
+            pnl.realized_pnl = in.read_f64();
+            pnl.unrealized_pnl = in.read_f64();
+            pnl.total_volume_traded = in.read_f64();
+            pnl.current_position = in.read_svarint();
+        }
+    }
+
+    equity_curve_.clear();
+    for (uint64_t count = in.read_varint(); count > 0; --count) {
+        EquityPoint point;
+        point.strategy_id = std::string(in.read_string());
+        point.timestamp = in.read_timestamp();
+        point.realized_pnl = in.read_f64();
+        point.unrealized_pnl = in.read_f64();
+        equity_curve_.push_back(std::move(point));
+    }
+}
+
+void MetricsCollector::write_latency_percentiles() {
+    if (latency_filepath_.empty()) return;
+    std::FILE* file = open_output(latency_filepath_, "SourceDescription,Count,MinNS,MeanNS,P50NS,P90NS,P99NS,P99.9NS,MaxNS\n");
+    if (!file) return;
+
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex_);
+        for (size_t key = 0; key < histograms_.size(); ++key) {
+            const auto& histogram = histograms_[key];
+            if (!histogram) continue;
+            fmt::format_to(std::back_inserter(text), "{},{},{},{},{},{},{},{},{}\n",
+                           key_name(static_cast<MetricKey>(key)), histogram->count(), histogram->min().count(),
+                           histogram->mean().count(), histogram->value_at_percentile(50.0).count(),
+                           histogram->value_at_percentile(90.0).count(), histogram->value_at_percentile(99.0).count(),
+                           histogram->value_at_percentile(99.9).count(), histogram->max().count());
+        }
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+    LOG_INFO("MetricsCollector: Latency percentiles written to {}", latency_filepath_);
+}
+
+void MetricsCollector::write_histogram_dump() {
+    if (config_.histogram_dump_path.empty()) return;
+    std::FILE* file = open_output(config_.histogram_dump_path, "SourceDescription,BucketLowerNS,BucketUpperNS,Count\n");
+    if (!file) return;
+
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex_);
+        for (size_t key = 0; key < histograms_.size(); ++key) {
+            const auto& histogram = histograms_[key];
+            if (!histogram) continue;
+            const std::string& source = key_name(static_cast<MetricKey>(key));
+            for (size_t i = 0; i < LatencyHistogram::kNumBuckets; ++i) {
+                const uint64_t count = histogram->bucket_count(i);
+                if (count == 0) continue;
+                const uint64_t lower = LatencyHistogram::bucket_lower(i);
+                fmt::format_to(std::back_inserter(text), "{},{},{},{}\n", source, lower,
+                               lower + LatencyHistogram::bucket_width(i), count);
+            }
+        }
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+    LOG_INFO("MetricsCollector: Latency histograms written to {}", config_.histogram_dump_path);
 }
 
 void MetricsCollector::write_pnl_summary() {
+    if (pnl_filepath_.empty()) return;
     std::ofstream outfile(pnl_filepath_);
      if (!outfile.is_open()) {
         LOG_ERROR("MetricsCollector: Failed to open PnL summary file: {}", pnl_filepath_);
         return;
     }
 
+    std::lock_guard<std::mutex> lock(totals_mutex_);
     outfile << std::fixed << std::setprecision(2);
-    outfile << "StrategyID,Symbol,FinalPosition,TotalVolumeTraded,RealizedPnL(TODO),UnrealizedPnL(TODO)\n";
-    for (const auto& entry : pnl_by_strategy_symbol_) {
+    outfile << "StrategyID,Symbol,FinalPosition,TotalVolumeTraded,RealizedPnL,UnrealizedPnL\n";
+    for (const auto& entry : final_pnl()) {
         const auto& ids = entry.first; // pair<StrategyId, Symbol>
         const auto& pnl = entry.second;
         outfile << ids.first << ","  // Strategy ID
-                << ids.second << "," // Symbol
+                << symbol_name(ids.second) << "," // Symbol
                 << pnl.current_position << ","
                 << pnl.total_volume_traded << ","
-                << pnl.realized_pnl << ","  // Will be 0 for now
-                << pnl.unrealized_pnl << "\n"; // Will be 0 for now
+                << pnl.realized_pnl << ","
+                << pnl.unrealized_pnl << "\n";
     }
     outfile.close();
     LOG_INFO("MetricsCollector: PnL summary written to {}", pnl_filepath_);
 }
 
-} // namespace market_replay
\ No newline at end of file
+void MetricsCollector::write_equity_curve() {
+    if (config_.equity_curve_path.empty()) return;
+    std::FILE* file = open_output(config_.equity_curve_path, "TimestampNS,StrategyID,RealizedPnL,UnrealizedPnL,Equity\n");
+    if (!file) return;
+
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex_);
+        for (const auto& point : equity_curve_) {
+            fmt::format_to(std::back_inserter(text), "{},{},{:.2f},{:.2f},{:.2f}\n", point.timestamp.time_since_epoch().count(),
+                           point.strategy_id, point.realized_pnl, point.unrealized_pnl, point.realized_pnl + point.unrealized_pnl);
+        }
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+    LOG_INFO("MetricsCollector: Equity curve written to {}", config_.equity_curve_path);
+}
+
+} // namespace market_replay
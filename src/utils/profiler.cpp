@@ -0,0 +1,200 @@
+#include "market_replay/utils/profiler.hpp"
+#include "market_replay/logger.hpp"
+#include <algorithm> // For std::max
+#include <cstdio>    // For std::snprintf
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace market_replay {
+namespace utils {
+
+namespace {
+
+// A session shorter than this is timed out to it, so the tick rate is calibrated over at least 1ms
+constexpr std::chrono::nanoseconds kMinCalibration = std::chrono::milliseconds(1);
+
+void write_json_string(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void write_us(std::ostream& out, double ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", ns / 1000.0);
+    out << buffer;
+}
+
+} // namespace
+
+struct Profiler::Session {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadSlot>> slots; // Owned here, so stats outlive their threads
+    uint32_t next_thread_id = 1;
+    Config config;
+    uint64_t begin_ticks = 0;
+    std::chrono::steady_clock::time_point begin_time;
+};
+
+Profiler::Session& Profiler::session() {
+    static Session instance;
+    return instance;
+}
+
+const char* profile_stage_name(ProfileStage stage) {
+    switch (stage) {
+        case ProfileStage::PARSE: return "parse";
+        case ProfileStage::MEPQ_PUSH: return "mepq_push";
+        case ProfileStage::MEPQ_POP: return "mepq_pop";
+        case ProfileStage::BOOK_UPDATE: return "book_update";
+        case ProfileStage::FAN_OUT: return "fan_out";
+        case ProfileStage::QUEUE_WAIT: return "queue_wait";
+        case ProfileStage::STRATEGY_ON_EVENT: return "strategy_on_event";
+        case ProfileStage::ORDER_LIFECYCLE: return "order_lifecycle";
+        default: return "unknown";
+    }
+}
+
+Profiler::ThreadSlot* Profiler::register_thread() {
+    Session& s = session();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.slots.push_back(std::make_unique<ThreadSlot>());
+    s.slots.back()->thread_id = s.next_thread_id++;
+    return s.slots.back().get();
+}
+
+void Profiler::start(const Config& config) {
+    Session& s = session();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (enabled_.load()) throw std::runtime_error("Profiler: a session is already running");
+    s.slots.erase(std::remove_if(s.slots.begin(), s.slots.end(),
+                                 [](const auto& slot) { return slot->retired.load(std::memory_order_acquire); }),
+                  s.slots.end());
+    for (auto& slot : s.slots) {
+        slot->stages = {};
+        slot->trace.clear();
+        slot->dropped = 0;
+    }
+    s.config = config;
+    max_trace_events_.store(config.max_trace_events);
+    s.begin_time = std::chrono::steady_clock::now();
+    s.begin_ticks = profile_ticks();
+    tracing_.store(!config.trace_path.empty());
+    enabled_.store(true);
+}
+
+Profiler::Summary Profiler::stop() {
+    Session& s = session();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!enabled_.load()) throw std::runtime_error("Profiler: no session is running");
+    enabled_.store(false);
+    tracing_.store(false);
+
+    while (std::chrono::steady_clock::now() - s.begin_time < kMinCalibration) {
+    }
+    const uint64_t end_ticks = profile_ticks();
+    const auto wall = std::chrono::steady_clock::now() - s.begin_time;
+
+    Summary summary;
+    summary.wall_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count());
+    const double ns_per_tick = end_ticks > s.begin_ticks
+        ? static_cast<double>(summary.wall_ns) / static_cast<double>(end_ticks - s.begin_ticks)
+        : 1.0;
+    const auto to_ns = [ns_per_tick](uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick);
+    };
+
+    for (const auto& slot : s.slots) {
+        for (size_t i = 0; i < slot->stages.size(); ++i) {
+            StageStats& merged = summary.stages[i];
+            const StageTicks& local = slot->stages[i];
+            merged.count += local.count;
+            merged.total_ns += to_ns(local.total);
+            merged.max_ns = std::max(merged.max_ns, to_ns(local.max));
+        }
+        summary.trace_events += slot->trace.size();
+        summary.trace_events_dropped += slot->dropped;
+    }
+
+    if (!s.config.trace_path.empty()) {
+        std::ofstream out(s.config.trace_path);
+        if (!out) throw std::runtime_error("Profiler: cannot write trace to " + s.config.trace_path);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        const auto separator = [&out, &first] {
+            if (!first) out << ",\n";
+            first = false;
+        };
+        for (const auto& slot : s.slots) {
+            if (slot->trace.empty()) continue;
+            const std::string tid = std::to_string(slot->thread_id);
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+            write_json_string(out, slot->name.empty() ? "thread " + tid : slot->name);
+            out << "}}";
+            for (const TraceRecord& record : slot->trace) {
+                // TSCs of different cores can disagree by a little; nothing starts before the session
+                const double ts = record.begin > s.begin_ticks ? static_cast<double>(to_ns(record.begin - s.begin_ticks)) : 0.0;
+                separator();
+                if (record.counter) {
+                    out << "{\"name\":";
+                    write_json_string(out, record.counter);
+                    out << ",\"ph\":\"C\",\"ts\":";
+                    write_us(out, ts);
+                    out << ",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"value\":" << static_cast<int64_t>(record.value) << "}}";
+                } else {
+                    out << "{\"name\":\"" << profile_stage_name(record.stage) << "\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":";
+                    write_us(out, ts);
+                    out << ",\"dur\":";
+                    write_us(out, static_cast<double>(to_ns(record.value)));
+                    out << ",\"pid\":1,\"tid\":" << tid << "}";
+                }
+            }
+        }
+        out << "\n]}\n";
+        if (!out) throw std::runtime_error("Profiler: failed writing trace to " + s.config.trace_path);
+        LOG_INFO("Profiler: Wrote {} trace events to {} ({} dropped).", summary.trace_events, s.config.trace_path,
+                 summary.trace_events_dropped);
+    }
+    for (auto& slot : s.slots) std::vector<TraceRecord>().swap(slot->trace); // Release the buffers
+    return summary;
+}
+
+void Profiler::write_summary(std::ostream& out, const Summary& summary) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-18s %12s %12s %10s %12s", "Stage", "Count", "Total ms", "Mean ns", "Max ns");
+    out << line << '\n';
+    for (size_t i = 0; i < summary.stages.size(); ++i) {
+        const StageStats& stats = summary.stages[i];
+        if (stats.count == 0) continue;
+        std::snprintf(line, sizeof(line), "%-18s %12llu %12.3f %10llu %12llu", profile_stage_name(static_cast<ProfileStage>(i)),
+                      static_cast<unsigned long long>(stats.count), static_cast<double>(stats.total_ns) / 1e6,
+                      static_cast<unsigned long long>(stats.mean_ns()), static_cast<unsigned long long>(stats.max_ns));
+        out << line << '\n';
+    }
+}
+
+void Profiler::log_summary(const Summary& summary) {
+    std::ostringstream table;
+    write_summary(table, summary);
+    LOG_INFO("Profiler: {:.3f} ms wall clock, by stage:", static_cast<double>(summary.wall_ns) / 1e6);
+    std::istringstream lines(table.str());
+    for (std::string line; std::getline(lines, line);) LOG_INFO("Profiler: {}", line);
+}
+
+} // namespace utils
+} // namespace market_replay
@@ -0,0 +1,124 @@
+#include "market_replay/symbol_registry.hpp"
+#include <mutex> // For std::unique_lock
+#include <stdexcept>
+
+namespace market_replay {
+
+SymbolRegistry& SymbolRegistry::instance() {
+    static SymbolRegistry registry;
+    return registry;
+}
+
+SymbolId SymbolRegistry::intern(std::string_view name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mtx_);
+    auto it = ids_.find(name); // Another thread may have won the race
+    if (it != ids_.end()) return it->second;
+
+    SymbolId id = static_cast<SymbolId>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(std::string_view(names_.back()), id);
+    return id;
+}
+
+SymbolId SymbolRegistry::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(mtx_);
+    auto it = ids_.find(name);
+    return it == ids_.end() ? INVALID_SYMBOL_ID : it->second;
+}
+
+const std::string& SymbolRegistry::name(SymbolId id) const {
+    static const std::string invalid = "<invalid>";
+    std::shared_lock<std::shared_mutex> lock(mtx_);
+    return id < names_.size() ? names_[id] : invalid;
+}
+
+SymbolRegistry::~SymbolRegistry() {
+    for (auto& chunk : tick_chunks_) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+bool SymbolRegistry::set_tick_size(SymbolId id, Price tick_size) {
+    std::unique_lock<std::shared_mutex> lock(mtx_);
+    return store_tick_size(id, tick_size);
+}
+
+bool SymbolRegistry::set_tick_size_if_unset(SymbolId id, Price tick_size) {
+    std::unique_lock<std::shared_mutex> lock(mtx_);
+    return !(id < tick_size_set_.size() && tick_size_set_[id]) && store_tick_size(id, tick_size);
+}
+
+bool SymbolRegistry::has_tick_size(SymbolId id) const {
+    std::shared_lock<std::shared_mutex> lock(mtx_);
+    return id < tick_size_set_.size() && tick_size_set_[id];
+}
+
+bool SymbolRegistry::store_tick_size(SymbolId id, Price tick_size) {
+    if (!(tick_size > 0) || !std::isfinite(tick_size)) return false;
+    if (id >= names_.size()) return false;
+    const size_t chunk = id / kTickChunkSize;
+    if (chunk >= kMaxTickChunks) return false;
+
+    std::atomic<double>* values = tick_chunks_[chunk].load(std::memory_order_relaxed);
+    if (!values) {
+        values = new std::atomic<double>[kTickChunkSize];
+        for (size_t i = 0; i < kTickChunkSize; ++i) values[i].store(kDefaultTicksPerUnit, std::memory_order_relaxed);
+        tick_chunks_[chunk].store(values, std::memory_order_release);
+    }
+    double per_unit = 1.0 / tick_size;
+    const double whole = std::round(per_unit);
+    if (std::fabs(per_unit - whole) <= 1e-9 * per_unit) per_unit = whole;
+    values[id % kTickChunkSize].store(per_unit, std::memory_order_relaxed);
+    if (id >= tick_size_set_.size()) tick_size_set_.resize(static_cast<size_t>(id) + 1, false);
+    tick_size_set_[id] = true;
+    return true;
+}
+
+size_t SymbolRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(mtx_);
+    return names_.size();
+}
+
+TickSizes parse_tick_sizes(std::string_view spec) {
+    TickSizes tick_sizes;
+    while (!spec.empty()) {
+        const size_t comma = spec.find(',');
+        const std::string_view entry = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+        if (entry.empty()) continue;
+
+        const size_t eq = entry.find('=');
+        if (eq == 0 || eq == std::string_view::npos) {
+            throw std::invalid_argument("Invalid tick size entry (expected SYMBOL=SIZE): " + std::string(entry));
+        }
+        const std::string size_str(entry.substr(eq + 1));
+        size_t parsed = 0;
+        Price tick_size = 0;
+        try {
+            tick_size = std::stod(size_str, &parsed);
+        } catch (const std::exception&) {
+            parsed = 0;
+        }
+        if (parsed == 0 || parsed != size_str.size() || !(tick_size > 0) || !std::isfinite(tick_size)) {
+            throw std::invalid_argument("Invalid tick size: " + std::string(entry));
+        }
+        tick_sizes.emplace_back(std::string(entry.substr(0, eq)), tick_size);
+    }
+    return tick_sizes;
+}
+
+void apply_tick_sizes(const TickSizes& tick_sizes) {
+    SymbolRegistry& registry = SymbolRegistry::instance();
+    for (const auto& [symbol, tick_size] : tick_sizes) {
+        if (!registry.set_tick_size(registry.intern(symbol), tick_size)) {
+            throw std::invalid_argument("Invalid tick size for " + symbol + ": " + std::to_string(tick_size));
+        }
+    }
+}
+
+} // namespace market_replay
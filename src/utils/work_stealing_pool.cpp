@@ -0,0 +1,114 @@
+#include "market_replay/utils/work_stealing_pool.hpp"
+#include <algorithm> // For std::max
+
+namespace market_replay {
+namespace utils {
+
+namespace {
+// Which worker (if any) of which pool the current thread is
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    threads_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    const size_t target = current_pool == this
+        ? current_worker
+        : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    // Counted before it is visible, so queued_ never underflows. Pairs with the sleepers_ increment /
+    // queued_ check in worker_loop: one side always sees the other's write.
+    queued_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->tasks.push_back(std::move(task));
+    }
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+bool WorkStealingPool::pop_local(size_t index, Task& task) {
+    Worker& w = *workers_[index];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.tasks.empty()) return false;
+    task = std::move(w.tasks.front());
+    w.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(thief + offset) % workers_.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) continue; // Busy or nothing there: next victim
+        task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_worker = index;
+    Worker& self = *workers_[index];
+    Task task;
+    for (;;) {
+        bool stolen = false;
+        if (pop_local(index, task) || (stolen = steal(index, task))) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr; // Release captures now, not at the next assignment
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+            if (stolen) self.stolen.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (queued_.load(std::memory_order_seq_cst) > 0) {
+            std::this_thread::yield(); // Queued but not found (victims locked, or mid-submit): retry
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        sleep_cv_.wait(lock, [&] { return stopping_ || queued_.load(std::memory_order_seq_cst) > 0; });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping_ && queued_.load(std::memory_order_seq_cst) == 0) break;
+    }
+    current_pool = nullptr;
+}
+
+WorkStealingPool::Stats WorkStealingPool::stats() const {
+    Stats s;
+    for (const auto& w : workers_) {
+        s.executed += w->executed.load(std::memory_order_relaxed);
+        s.stolen += w->stolen.load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+} // namespace utils
+} // namespace market_replay
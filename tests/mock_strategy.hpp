@@ -0,0 +1,83 @@
+#ifndef MARKET_REPLAY_MOCK_STRATEGY_HPP
+#define MARKET_REPLAY_MOCK_STRATEGY_HPP
+
+#include "market_replay/strategy.hpp"
+#include "market_replay/dispatcher.hpp" // For StrategyFactory
+#include <functional>
+#include <vector>
+
+// Records everything it receives. Only inspect after Dispatcher::run() has joined the strategy thread.
+class MockStrategy : public market_replay::IStrategy {
+public:
+    struct Received {
+        market_replay::EventType type;
+        market_replay::Timestamp exchange_ts;
+        market_replay::Timestamp arrival_ts;
+        const market_replay::BaseEvent* event; // Identity only; the object may be gone by the time it is inspected
+    };
+
+    MockStrategy(market_replay::StrategyId id,
+                 market_replay::IOrderSubmitter* order_submitter,
+                 std::shared_ptr<market_replay::MetricsCollector> metrics_collector)
+        : IStrategy(std::move(id), order_submitter, metrics_collector) {}
+
+    void on_event(const market_replay::StrategyInputEventVariant& event_variant,
+                  market_replay::Timestamp strategy_arrival_ts) override {
+        std::visit(market_replay::StrategyEventVisitor(*this, strategy_arrival_ts), event_variant);
+    }
+    // Only called once set_event_batching() has opted in
+    void on_event_batch(const market_replay::StrategyEventBatch& batch) override {
+        batches.emplace_back();
+        for (size_t i = 0; i < batch.size(); ++i) batches.back().push_back(batch.arrival_ts(i));
+        IStrategy::on_event_batch(batch);
+    }
+
+    void on_quote(const market_replay::QuoteEvent& quote, market_replay::Timestamp strategy_arrival_ts) override {
+        received.push_back({quote.type, quote.exchange_timestamp, strategy_arrival_ts, &quote});
+        if (quote_hook) quote_hook(*this, quote, strategy_arrival_ts);
+    }
+    void on_trade(const market_replay::TradeEvent& trade, market_replay::Timestamp strategy_arrival_ts) override {
+        received.push_back({trade.type, trade.exchange_timestamp, strategy_arrival_ts, &trade});
+    }
+    void on_order_ack(const market_replay::OrderAckEvent& ack, market_replay::Timestamp strategy_arrival_ts) override {
+        acks.push_back(ack);
+        received.push_back({ack.type, ack.exchange_timestamp, strategy_arrival_ts, &ack});
+    }
+    void on_sim_control(const market_replay::SimControlEvent& control_event, market_replay::Timestamp strategy_arrival_ts) override {
+        received.push_back({control_event.type, control_event.exchange_timestamp, strategy_arrival_ts, &control_event});
+    }
+
+    // A checkpoint carries how much had been received by then, so a resumed run lines up with a full one
+    void save_state(market_replay::CheckpointWriter& out) const override { out.write_varint(received.size()); }
+    void restore_state(market_replay::CheckpointReader& in) override { received_before_resume = in.read_varint(); }
+
+    using IStrategy::submit_order; // For quote_hook
+    using IStrategy::subscribe;    // Before Dispatcher::run()
+    using IStrategy::set_event_batching;
+
+    size_t count(market_replay::EventType type) const {
+        size_t n = 0;
+        for (const auto& r : received) n += (r.type == type);
+        return n;
+    }
+
+    std::vector<Received> received;
+    std::vector<market_replay::OrderAckEvent> acks;
+    std::vector<std::vector<market_replay::Timestamp>> batches; // Arrival timestamps, per on_event_batch call
+    size_t received_before_resume = 0; // Set when resumed from a checkpoint
+    // Runs on the strategy's thread after each quote is recorded; set before Dispatcher::run()
+    std::function<void(MockStrategy&, const market_replay::QuoteEvent&, market_replay::Timestamp)> quote_hook;
+};
+
+// Builds a StrategyFactory that hands back a MockStrategy and keeps a non-owning pointer to it for assertions.
+inline market_replay::StrategyFactory make_mock_factory(MockStrategy*& out) {
+    return [&out](const market_replay::StrategyId& id,
+                  market_replay::IOrderSubmitter* order_submitter,
+                  std::shared_ptr<market_replay::MetricsCollector> metrics_collector) {
+        auto strategy = std::make_unique<MockStrategy>(id, order_submitter, metrics_collector);
+        out = strategy.get();
+        return strategy;
+    };
+}
+
+#endif // MARKET_REPLAY_MOCK_STRATEGY_HPP
@@ -0,0 +1,190 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "market_replay/block_tick_file.hpp"
+#include "market_replay/logger.hpp"
+#include "market_replay/market_data_source.hpp"
+#include "market_replay/tick_file.hpp"
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+using market_replay::Timestamp;
+
+Timestamp at(int64_t ns) { return Timestamp(std::chrono::nanoseconds(ns)); }
+
+// A two-symbol stream of quotes with one-tick moves, every tenth event a trade. Timestamps repeat
+// in pairs so equal times straddle some block boundaries.
+std::vector<std::unique_ptr<market_replay::BaseEvent>> make_events(size_t count) {
+    const market_replay::SymbolId eur = market_replay::intern_symbol("BLK_EURUSD");
+    const market_replay::SymbolId spx = market_replay::intern_symbol("BLK_SPX");
+    std::vector<std::unique_ptr<market_replay::BaseEvent>> events;
+    for (size_t i = 0; i < count; ++i) {
+        const Timestamp ts = at(1678886400000000000LL + static_cast<int64_t>((i + 1) / 2) * 1000);
+        const bool even = i % 2 == 0;
+        const double bid = even ? 1.07100 + 0.00001 * static_cast<double>(i % 7) : 4000.25 - 0.25 * static_cast<double>(i % 5);
+        const double tick = even ? 0.00001 : 0.25;
+        if (i % 10 == 9) {
+            events.push_back(std::make_unique<market_replay::TradeEvent>(ts, even ? eur : spx, bid + tick, 100 + i));
+        } else {
+            events.push_back(std::make_unique<market_replay::QuoteEvent>(ts, even ? eur : spx, bid, 1000 + i, bid + tick, 2000 + i));
+        }
+    }
+    return events;
+}
+
+void require_same_event(const market_replay::BaseEvent& expected, const market_replay::BaseEvent& actual) {
+    REQUIRE(actual.type == expected.type);
+    REQUIRE(actual.exchange_timestamp == expected.exchange_timestamp);
+    if (expected.type == market_replay::EventType::QUOTE) {
+        const auto& e = static_cast<const market_replay::QuoteEvent&>(expected);
+        const auto& a = static_cast<const market_replay::QuoteEvent&>(actual);
+        REQUIRE(a.symbol_id == e.symbol_id);
+        REQUIRE(a.get_bid_price() == e.get_bid_price());
+        REQUIRE(a.bid_size == e.bid_size);
+        REQUIRE(a.get_ask_price() == e.get_ask_price());
+        REQUIRE(a.ask_size == e.ask_size);
+    } else {
+        const auto& e = static_cast<const market_replay::TradeEvent&>(expected);
+        const auto& a = static_cast<const market_replay::TradeEvent&>(actual);
+        REQUIRE(a.symbol_id == e.symbol_id);
+        REQUIRE(a.get_price() == e.get_price());
+        REQUIRE(a.size == e.size);
+    }
+}
+
+long file_size(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(in.tellg());
+}
+
+} // namespace
+
+TEST_CASE("Block-compressed tick file", "[block_tick_file]") {
+    const std::string mrt_file = "test_block_tick_file.mrt";
+    const std::string mrtz_file = "test_block_tick_file.mrtz";
+    market_replay::Logger::init("test_block_tick_file_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    const size_t num_events = 1000;
+    {
+        auto events = make_events(num_events);
+        market_replay::TickFileWriter plain(mrt_file);
+        market_replay::BlockTickFileWriter blocked(mrtz_file, market_replay::tick_format::DEFAULT_PRICE_SCALE, 64);
+        for (const auto& ev : events) {
+            REQUIRE(plain.add(*ev));
+            REQUIRE(blocked.add(*ev));
+        }
+        plain.finish();
+        blocked.finish();
+        REQUIRE(blocked.record_count() == num_events);
+    }
+
+    SECTION("Replays the same events as the .mrt file, with or without background decoding") {
+        for (size_t io_threads : {0, 1, 2}) {
+            for (size_t blocks_ahead : {1, 3}) {
+                market_replay::TickFileReader expected(mrt_file);
+                market_replay::BlockTickFileReader reader(mrtz_file, {io_threads, blocks_ahead});
+                REQUIRE(reader.record_count() == num_events);
+                REQUIRE(reader.block_count() == 16); // 15 full blocks of 64 and one of 40
+                REQUIRE(reader.symbols().size() == 2);
+                while (expected.has_more_events()) {
+                    REQUIRE(reader.has_more_events());
+                    auto e = expected.read_next_event();
+                    auto a = reader.read_next_event();
+                    REQUIRE(a);
+                    require_same_event(*e, *a);
+                }
+                REQUIRE_FALSE(reader.has_more_events());
+                REQUIRE(reader.read_next_event() == nullptr);
+            }
+        }
+    }
+
+    SECTION("Blocks compress well below the fixed-size records") {
+        REQUIRE(file_size(mrtz_file) * 4 < file_size(mrt_file));
+    }
+
+    SECTION("Seek decodes from the block holding the target") {
+        market_replay::BlockTickFileReader reader(mrtz_file);
+        // Records 63 and 64 share a timestamp across the first block boundary
+        const Timestamp target = at(1678886400000000000LL + 32 * 1000);
+        reader.seek_to_timestamp(target);
+        auto ev = reader.read_next_event();
+        REQUIRE(ev);
+        REQUIRE(ev->exchange_timestamp == target);
+        REQUIRE(reader.read_next_event()->exchange_timestamp == target);
+        REQUIRE(reader.read_next_event()->exchange_timestamp > target);
+
+        reader.seek_to_timestamp(at(1678886400000000000LL + 400 * 1000 + 1)); // Between records 800 and 801
+        market_replay::TickFileReader expected(mrt_file);
+        expected.seek_to_timestamp(at(1678886400000000000LL + 400 * 1000 + 1));
+        size_t remaining = 0;
+        while (expected.has_more_events()) {
+            auto e = expected.read_next_event();
+            auto a = reader.read_next_event();
+            REQUIRE(a);
+            require_same_event(*e, *a);
+            ++remaining;
+        }
+        REQUIRE(remaining == 199);
+        REQUIRE_FALSE(reader.has_more_events());
+
+        reader.seek_to_timestamp(Timestamp::min());
+        REQUIRE(reader.read_next_event()->exchange_timestamp == at(1678886400000000000LL));
+        reader.seek_to_timestamp(Timestamp::max());
+        REQUIRE_FALSE(reader.has_more_events());
+    }
+
+    SECTION("Reader is selected by extension") {
+        auto source = market_replay::open_market_data_source(mrtz_file);
+        REQUIRE(dynamic_cast<market_replay::BlockTickFileReader*>(source.get()) != nullptr);
+    }
+
+    SECTION("Corrupt blocks are reported, not replayed") {
+        uint64_t second_block = 0;
+        {
+            market_replay::BlockTickFileReader reader(mrtz_file);
+            second_block = reader.blocks_begin()[1].offset;
+        }
+        {
+            std::fstream file(mrtz_file, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(second_block));
+            file.put(static_cast<char>(0x7F)); // Not a record type
+        }
+        market_replay::BlockTickFileReader reader(mrtz_file, {2, 4});
+        for (int i = 0; i < 64; ++i) REQUIRE(reader.read_next_event());
+        REQUIRE_THROWS_AS(reader.read_next_event(), std::runtime_error);
+
+        REQUIRE_THROWS_AS(market_replay::BlockTickFileReader(mrt_file), std::runtime_error);
+    }
+
+    SECTION("A truncated block fails to decode") {
+        std::vector<market_replay::tick_format::TickRecord> records(3);
+        records[0] = {5, 0, market_replay::tick_format::RecordType::TRADE, {}, 100, 7, 0, 0};
+        records[1] = {9, 1, market_replay::tick_format::RecordType::QUOTE, {}, -300, 1, -299, 2};
+        records[2] = {8, 0, market_replay::tick_format::RecordType::TRADE, {}, INT64_MAX, UINT64_MAX, 0, 0};
+        std::string encoded;
+        market_replay::block_tick_format::encode_block(records.data(), records.size(), encoded);
+
+        std::vector<market_replay::tick_format::TickRecord> decoded;
+        market_replay::block_tick_format::decode_block(encoded.data(), encoded.size(), 3, 2, decoded);
+        REQUIRE(decoded.size() == 3);
+        REQUIRE(decoded[1].price == -300);
+        REQUIRE(decoded[1].ask_price == -299);
+        REQUIRE(decoded[2].timestamp_ns == 8);
+        REQUIRE(decoded[2].price == INT64_MAX);
+        REQUIRE(decoded[2].size == UINT64_MAX);
+
+        REQUIRE_THROWS_AS(market_replay::block_tick_format::decode_block(encoded.data(), encoded.size() - 1, 3, 2, decoded),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(market_replay::block_tick_format::decode_block(encoded.data(), encoded.size(), 2, 2, decoded),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(market_replay::block_tick_format::decode_block(encoded.data(), encoded.size(), 3, 1, decoded),
+                          std::runtime_error);
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(mrt_file.c_str());
+    std::remove(mrtz_file.c_str());
+}
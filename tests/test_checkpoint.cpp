@@ -0,0 +1,127 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "market_replay/checkpoint.hpp"
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+using namespace std::chrono_literals;
+using market_replay::CheckpointReader;
+using market_replay::CheckpointWriter;
+using market_replay::Timestamp;
+
+TEST_CASE("Checkpoint field encoding", "[checkpoint]") {
+    const Timestamp base = Timestamp(std::chrono::nanoseconds(1678886400000000000LL));
+
+    SECTION("Fields round-trip, extremes included") {
+        CheckpointWriter out(base);
+        const uint64_t unsigned_values[] = {0, 1, 127, 128, 300, std::numeric_limits<uint64_t>::max()};
+        const int64_t signed_values[] = {0, -1, 1, -64, 64, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+        const Timestamp timestamps[] = {base, base + 1us, base - 1ms, Timestamp::min(), Timestamp::max(), Timestamp{}};
+        for (uint64_t value : unsigned_values) out.write_varint(value);
+        for (int64_t value : signed_values) out.write_svarint(value);
+        for (Timestamp ts : timestamps) out.write_timestamp(ts);
+        out.write_f64(-0.1);
+        out.write_string("EURUSD");
+        out.write_string("");
+        out.write_bool(true);
+
+        CheckpointReader in(out.data(), base);
+        for (uint64_t value : unsigned_values) REQUIRE(in.read_varint() == value);
+        for (int64_t value : signed_values) REQUIRE(in.read_svarint() == value);
+        for (Timestamp ts : timestamps) REQUIRE(in.read_timestamp() == ts);
+        REQUIRE(in.read_f64() == -0.1);
+        REQUIRE(in.read_string() == "EURUSD");
+        REQUIRE(in.read_string().empty());
+        REQUIRE(in.read_bool());
+        REQUIRE(in.at_end());
+    }
+
+    SECTION("Small values and times near the checkpoint take a byte or two") {
+        CheckpointWriter out(base);
+        out.write_varint(127);
+        out.write_svarint(-64);
+        out.write_timestamp(base + 8us);
+        REQUIRE(out.data().size() == 1 + 1 + 2);
+    }
+
+    SECTION("Events round-trip with both timestamps") {
+        const market_replay::SymbolId symbol = market_replay::intern_symbol("CKPT_SYM");
+        market_replay::QuoteEvent quote(base, symbol, 99.99, 500, 100.01, 700);
+        quote.arrival_timestamp = base + 50us;
+        market_replay::OrderAckEvent ack(base + 80us, 1, 7, 42, symbol, market_replay::OrderStatus::REJECTED);
+        ack.side = market_replay::OrderSide::SELL;
+        ack.leaves_quantity = 10;
+        ack.reject_reason = "No liquidity";
+        market_replay::SimControlEvent control(base + 1ms, market_replay::SimControlEvent::ControlType::END_OF_DATA_FEED,
+                                               market_replay::EventType::SIM_CONTROL_STRATEGY);
+
+        CheckpointWriter out(base);
+        out.write_event(quote);
+        out.write_event(ack);
+        out.write_event(control);
+        CheckpointReader in(out.data(), base);
+
+        auto quote_back = in.read_event();
+        REQUIRE(quote_back->type == market_replay::EventType::QUOTE);
+        REQUIRE(quote_back->exchange_timestamp == base);
+        REQUIRE(quote_back->arrival_timestamp == base + 50us);
+        const auto& q = static_cast<const market_replay::QuoteEvent&>(*quote_back);
+        REQUIRE(q.symbol_id == symbol);
+        REQUIRE(q.get_bid_price() == quote.get_bid_price());
+        REQUIRE(q.ask_size == 700);
+
+        auto ack_back = in.read_event();
+        const auto& a = static_cast<const market_replay::OrderAckEvent&>(*ack_back);
+        REQUIRE(a.arrival_timestamp == base + 80us);
+        REQUIRE(a.client_order_id == 7);
+        REQUIRE(a.exchange_order_id == 42);
+        REQUIRE(a.status == market_replay::OrderStatus::REJECTED);
+        REQUIRE(a.side == market_replay::OrderSide::SELL);
+        REQUIRE(a.leaves_quantity == 10);
+        REQUIRE(a.reject_reason == "No liquidity");
+
+        auto control_back = in.read_event();
+        REQUIRE(control_back->type == market_replay::EventType::SIM_CONTROL_STRATEGY);
+        REQUIRE(static_cast<const market_replay::SimControlEvent&>(*control_back).control_type ==
+                market_replay::SimControlEvent::ControlType::END_OF_DATA_FEED);
+        REQUIRE(in.at_end());
+    }
+
+    SECTION("Truncated input is an error, not a garbage value") {
+        CheckpointWriter out(base);
+        out.write_varint(std::numeric_limits<uint64_t>::max());
+        out.write_string("EURUSD");
+        const std::string data = out.data();
+        CheckpointReader varint_in(std::string_view(data).substr(0, 5), base);
+        REQUIRE_THROWS_AS(varint_in.read_varint(), std::runtime_error);
+        CheckpointReader string_in(std::string_view(data).substr(0, data.size() - 1), base);
+        string_in.read_varint();
+        REQUIRE_THROWS_AS(string_in.read_string(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Checkpoint files", "[checkpoint]") {
+    const std::string path = "test_checkpoint.mrck";
+    const Timestamp sim_time = Timestamp(std::chrono::nanoseconds(1678886400000000000LL));
+
+    CheckpointWriter out(sim_time);
+    out.write_header();
+    out.write_section(market_replay::checkpoint_format::Section::END);
+    const market_replay::Checkpoint checkpoint{sim_time, out.take()};
+    REQUIRE(checkpoint.data.size() == market_replay::checkpoint_format::HEADER_SIZE + 1);
+    REQUIRE(market_replay::Checkpoint::parse_header(checkpoint.data) == sim_time);
+
+    checkpoint.save(path);
+    const market_replay::Checkpoint loaded = market_replay::Checkpoint::load(path);
+    REQUIRE(loaded.sim_time == sim_time);
+    REQUIRE(loaded.data == checkpoint.data);
+
+    std::string bad_version = checkpoint.data;
+    bad_version[8] = 99;
+    REQUIRE_THROWS_AS(market_replay::Checkpoint::parse_header(bad_version), std::runtime_error);
+    REQUIRE_THROWS_AS(market_replay::Checkpoint::parse_header("MRCKPT01"), std::runtime_error);
+    REQUIRE_THROWS_AS(market_replay::Checkpoint::load("does_not_exist.mrck"), std::runtime_error);
+
+    std::remove(path.c_str());
+}
@@ -2,6 +2,7 @@
 #include "test_utils.hpp"
 #include "market_replay/csv_parser.hpp"
 #include "market_replay/event.hpp"
+#include "market_replay/utils/field_parsers.hpp"
 #include <fstream> 
 
 void create_dummy_csv(const std::string& filename, const std::vector<std::string>& lines) {
@@ -31,8 +32,8 @@ TEST_CASE("CsvParser Functionality", "[csv_parser]") {
         REQUIRE(event1->type == market_replay::EventType::QUOTE);
         auto quote_event = dynamic_cast<market_replay::QuoteEvent*>(event1.get());
         REQUIRE(quote_event != nullptr);
-        REQUIRE(quote_event->symbol == "EURUSD");
-        REQUIRE(quote_event->bid_price == 1.07100);
+        REQUIRE(market_replay::symbol_name(quote_event->symbol_id) == "EURUSD");
+        REQUIRE(quote_event->get_bid_price() == 1.07100);
         REQUIRE(quote_event->ask_size == 100000);
         REQUIRE(quote_event->exchange_timestamp == market_replay::string_to_timestamp("1678886400000000000"));
 
@@ -41,8 +42,8 @@ TEST_CASE("CsvParser Functionality", "[csv_parser]") {
         REQUIRE(event2->type == market_replay::EventType::TRADE);
         auto trade_event = dynamic_cast<market_replay::TradeEvent*>(event2.get());
         REQUIRE(trade_event != nullptr);
-        REQUIRE(trade_event->symbol == "EURUSD");
-        REQUIRE(trade_event->price == 1.07105);
+        REQUIRE(market_replay::symbol_name(trade_event->symbol_id) == "EURUSD");
+        REQUIRE(trade_event->get_price() == 1.07105);
         REQUIRE(trade_event->size == 10000);
         
         REQUIRE_FALSE(parser.read_next_event()); // EOF
@@ -64,4 +65,81 @@ TEST_CASE("CsvParser Functionality", "[csv_parser]") {
 }
     market_replay::Logger::shutdown();
     std::remove(test_csv_file.c_str()); // Clean up
-}
\ No newline at end of file
+}
+TEST_CASE("CsvParser backends agree", "[csv_parser]") {
+    const std::string test_csv_file = "test_data_backends.csv";
+    market_replay::Logger::init("test_parser_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    create_dummy_csv(test_csv_file, {
+        "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE",
+        "QUOTE,1672583400262892188,SYNTH,,,99.99,4060,100.01,6800",
+        "TRADE,1672583400764029073,SYNTH,100.01,31,,,,",
+        "QUOTE,1672583400978019349,SYNTH,,,0.00001,1,123456.789012,18446744073709551615",
+        "QUOTE,1672583401000000000,SYNTH,,,1.5e2,10,-0.25,10\r",
+        "TRADE,1672583401100000000,SYNTH,not_a_price,31,,,,"
+    });
+
+    market_replay::CsvParser stream_parser(test_csv_file, market_replay::CsvParser::Backend::STREAM);
+    market_replay::CsvParser mmap_parser(test_csv_file, market_replay::CsvParser::Backend::MMAP);
+    REQUIRE(mmap_parser.backend() == market_replay::CsvParser::Backend::MMAP);
+
+    for (int row = 0; row < 5; ++row) {
+        auto expected = stream_parser.read_next_event();
+        auto actual = mmap_parser.read_next_event();
+        REQUIRE((expected == nullptr) == (actual == nullptr));
+        if (!expected) continue;
+        REQUIRE(actual->type == expected->type);
+        REQUIRE(actual->exchange_timestamp == expected->exchange_timestamp);
+        if (auto* q = dynamic_cast<market_replay::QuoteEvent*>(expected.get())) {
+            auto* mq = dynamic_cast<market_replay::QuoteEvent*>(actual.get());
+            REQUIRE(mq != nullptr);
+            REQUIRE(mq->symbol_id == q->symbol_id);
+            REQUIRE(mq->get_bid_price() == q->get_bid_price()); // Bit-exact, not approximately equal
+            REQUIRE(mq->bid_size == q->bid_size);
+            REQUIRE(mq->get_ask_price() == q->get_ask_price());
+            REQUIRE(mq->ask_size == q->ask_size);
+        } else {
+            auto* t = dynamic_cast<market_replay::TradeEvent*>(expected.get());
+            auto* mt = dynamic_cast<market_replay::TradeEvent*>(actual.get());
+            REQUIRE(mt != nullptr);
+            REQUIRE(mt->get_price() == t->get_price());
+            REQUIRE(mt->size == t->size);
+        }
+    }
+    REQUIRE_FALSE(mmap_parser.has_more_events());
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+}
+
+TEST_CASE("Field parsers", "[csv_parser]") {
+    using namespace market_replay::utils;
+    double d = 0.0;
+    REQUIRE(parse_decimal("1.07105", d));
+    REQUIRE(d == 1.07105);
+    REQUIRE(parse_decimal("-0.5", d));
+    REQUIRE(d == -0.5);
+    REQUIRE(parse_decimal("100", d));
+    REQUIRE(d == 100.0);
+    REQUIRE(parse_decimal("2.5E-3", d)); // Exponent form takes the fallback path
+    REQUIRE(d == 0.0025);
+    REQUIRE_FALSE(parse_decimal("", d));
+    REQUIRE_FALSE(parse_decimal("-", d));
+    REQUIRE_FALSE(parse_decimal(".", d));
+    REQUIRE_FALSE(parse_decimal("1.2.3", d));
+    REQUIRE_FALSE(parse_decimal("12abc", d));
+
+    uint64_t u = 0;
+    REQUIRE(parse_uint64("4060", u));
+    REQUIRE(u == 4060);
+    REQUIRE_FALSE(parse_uint64("", u));
+    REQUIRE_FALSE(parse_uint64("-1", u));
+    REQUIRE_FALSE(parse_uint64("10 ", u));
+
+    int64_t i = 0;
+    REQUIRE(parse_int64("1678886400000000000", i));
+    REQUIRE(i == 1678886400000000000LL);
+    REQUIRE(parse_int64("+42", i));
+    REQUIRE(i == 42);
+    REQUIRE_FALSE(parse_int64("bad_timestamp", i));
+}
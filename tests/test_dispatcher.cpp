@@ -0,0 +1,805 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "mock_strategy.hpp"
+#include "market_replay/dispatcher.hpp"
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <cstdio>
+#include <iomanip>
+
+using namespace std::chrono_literals;
+
+namespace market_replay {
+    std::unique_ptr<IStrategy> create_mean_reversion_strategy(const StrategyId& id,
+                                                             IOrderSubmitter* order_submitter,
+                                                             std::shared_ptr<MetricsCollector> metrics_collector);
+}
+
+namespace {
+
+void write_ticks_csv(const std::string& filename, const std::vector<long long>& timestamps) {
+    std::ofstream file(filename);
+    file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        if (i % 3 == 2) {
+            file << "TRADE," << timestamps[i] << ",SYNTH,100.01,25,,,,\n";
+        } else {
+            file << "QUOTE," << timestamps[i] << ",SYNTH,,,99.99,500,100.01,700\n";
+        }
+    }
+}
+
+market_replay::LatencyModel::Config test_latency_config() {
+    market_replay::LatencyModel::Config config;
+    config.market_data_feed_latency = 50us;
+    return config;
+}
+
+} // namespace
+
+TEST_CASE("Dispatcher market data ingestion", "[dispatcher]") {
+    const std::string test_csv_file = "test_dispatcher_ticks.csv";
+    market_replay::Logger::init("test_dispatcher_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    std::vector<long long> timestamps;
+    for (int i = 0; i < 50; ++i) timestamps.push_back(1678886400000000000LL + i * 1000000LL);
+    write_ticks_csv(test_csv_file, timestamps);
+
+    auto run_with = [&](market_replay::Dispatcher::Config config) {
+        MockStrategy* mock = nullptr;
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, config);
+        dispatcher.add_strategy("Mock_1", make_mock_factory(mock));
+        dispatcher.run();
+        REQUIRE(mock != nullptr);
+        return mock->received;
+    };
+
+    SECTION("Streaming delivers every tick in order with market data latency applied") {
+        market_replay::Dispatcher::Config config;
+        config.ingestion_mode = market_replay::Dispatcher::IngestionMode::STREAMING;
+        config.market_data_window_size = 4; // Much smaller than the file
+        auto received = run_with(config);
+
+        std::vector<MockStrategy::Received> market_data;
+        for (const auto& r : received) {
+            if (r.type == market_replay::EventType::QUOTE || r.type == market_replay::EventType::TRADE) market_data.push_back(r);
+        }
+        REQUIRE(market_data.size() == timestamps.size());
+        for (size_t i = 0; i < market_data.size(); ++i) {
+            REQUIRE(market_data[i].exchange_ts == market_replay::Timestamp(std::chrono::nanoseconds(timestamps[i])));
+            REQUIRE(market_data[i].arrival_ts == market_data[i].exchange_ts + 50us);
+        }
+    }
+
+    SECTION("A list of files is replayed as one merged feed") {
+        // Every other tick in each of two files: the merge must reproduce the single-file run
+        std::vector<long long> even, odd;
+        for (size_t i = 0; i < timestamps.size(); ++i) (i % 2 ? odd : even).push_back(timestamps[i]);
+        const std::vector<std::string> files = {"test_dispatcher_ticks_even.csv", "test_dispatcher_ticks_odd.csv"};
+        write_ticks_csv(files[0], even);
+        write_ticks_csv(files[1], odd);
+
+        MockStrategy* mock = nullptr;
+        market_replay::Dispatcher::Config config;
+        config.merge.block_events = 3;
+        market_replay::Dispatcher dispatcher(files, test_latency_config(), nullptr, config);
+        dispatcher.add_strategy("Mock_1", make_mock_factory(mock));
+        dispatcher.run();
+        std::vector<market_replay::Timestamp> merged;
+        for (const auto& r : mock->received) {
+            if (r.type == market_replay::EventType::QUOTE || r.type == market_replay::EventType::TRADE) merged.push_back(r.exchange_ts);
+        }
+        REQUIRE(merged.size() == timestamps.size());
+        for (size_t i = 0; i < merged.size(); ++i) {
+            REQUIRE(merged[i] == market_replay::Timestamp(std::chrono::nanoseconds(timestamps[i])));
+        }
+        for (const auto& file : files) std::remove(file.c_str());
+    }
+
+    SECTION("A replay window starts and stops mid-file") {
+        market_replay::Dispatcher::Config config;
+        config.replay_window.start = market_replay::Timestamp(std::chrono::nanoseconds(timestamps[10]));
+        config.replay_window.end = market_replay::Timestamp(std::chrono::nanoseconds(timestamps[19]));
+        config.replay_window.index_rows = 4;
+        auto received = run_with(config);
+        std::vector<market_replay::Timestamp> replayed;
+        for (const auto& r : received) {
+            if (r.type == market_replay::EventType::QUOTE || r.type == market_replay::EventType::TRADE) replayed.push_back(r.exchange_ts);
+        }
+        REQUIRE(replayed.size() == 10);
+        for (size_t i = 0; i < replayed.size(); ++i) {
+            REQUIRE(replayed[i] == market_replay::Timestamp(std::chrono::nanoseconds(timestamps[10 + i])));
+        }
+        std::remove(market_replay::TimeIndex::sidecar_path(test_csv_file).c_str());
+    }
+
+    SECTION("Streaming and preload produce the same event sequence") {
+        market_replay::Dispatcher::Config streaming;
+        streaming.market_data_window_size = 8;
+        market_replay::Dispatcher::Config preload;
+        preload.ingestion_mode = market_replay::Dispatcher::IngestionMode::PRELOAD;
+
+        auto a = run_with(streaming);
+        auto b = run_with(preload);
+        REQUIRE(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            REQUIRE(a[i].type == b[i].type);
+            REQUIRE(a[i].arrival_ts == b[i].arrival_ts);
+        }
+    }
+
+    SECTION("Heap and timing wheel schedulers produce the same event sequence") {
+        for (auto ingestion : {market_replay::Dispatcher::IngestionMode::STREAMING, market_replay::Dispatcher::IngestionMode::PRELOAD}) {
+            market_replay::Dispatcher::Config heap;
+            heap.ingestion_mode = ingestion;
+            market_replay::Dispatcher::Config wheel = heap;
+            wheel.scheduler = market_replay::Dispatcher::SchedulerType::TIMING_WHEEL;
+            wheel.timing_wheel.num_buckets = 64; // 64us horizon: the 1ms tick spacing goes through overflow
+
+            auto a = run_with(heap);
+            auto b = run_with(wheel);
+            REQUIRE(a.size() == b.size());
+            for (size_t i = 0; i < a.size(); ++i) {
+                REQUIRE(a[i].type == b[i].type);
+                REQUIRE(a[i].arrival_ts == b[i].arrival_ts);
+            }
+        }
+    }
+
+    SECTION("Out-of-order ticks are still replayed in time order") {
+        std::vector<long long> shuffled = timestamps;
+        std::swap(shuffled[10], shuffled[20]);
+        write_ticks_csv(test_csv_file, shuffled);
+
+        market_replay::Dispatcher::Config config;
+        config.market_data_window_size = 16;
+        auto received = run_with(config);
+
+        market_replay::Timestamp last = market_replay::Timestamp::min();
+        size_t market_events = 0;
+        for (const auto& r : received) {
+            if (r.type != market_replay::EventType::QUOTE && r.type != market_replay::EventType::TRADE) continue;
+            REQUIRE(r.arrival_ts >= last);
+            last = r.arrival_ts;
+            market_events++;
+        }
+        REQUIRE(market_events == shuffled.size());
+    }
+
+    SECTION("Blocking and SPSC ring channels deliver the same sequence") {
+        MockStrategy* ring = nullptr;
+        MockStrategy* blocking = nullptr;
+        market_replay::StrategyOptions ring_options;
+        ring_options.queue_type = market_replay::StrategyOptions::QueueType::SPSC_RING;
+        ring_options.queue_capacity = 4; // Forces the dispatcher to wait on a full ring
+        market_replay::StrategyOptions blocking_options;
+        blocking_options.queue_type = market_replay::StrategyOptions::QueueType::BLOCKING;
+
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, market_replay::Dispatcher::Config{});
+        dispatcher.add_strategy("Ring", make_mock_factory(ring), ring_options);
+        dispatcher.add_strategy("Blocking", make_mock_factory(blocking), blocking_options);
+        dispatcher.run();
+        REQUIRE(ring != nullptr);
+        REQUIRE(blocking != nullptr);
+
+        REQUIRE(ring->count(market_replay::EventType::QUOTE) + ring->count(market_replay::EventType::TRADE) == timestamps.size());
+        REQUIRE(ring->received.size() == blocking->received.size());
+        for (size_t i = 0; i < ring->received.size(); ++i) {
+            REQUIRE(ring->received[i].type == blocking->received[i].type);
+            REQUIRE(ring->received[i].arrival_ts == blocking->received[i].arrival_ts);
+        }
+    }
+
+    SECTION("Market data is shared across strategies, not copied per strategy") {
+        MockStrategy* first = nullptr;
+        MockStrategy* second = nullptr;
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, market_replay::Dispatcher::Config{});
+        dispatcher.add_strategy("Mock_1", make_mock_factory(first));
+        dispatcher.add_strategy("Mock_2", make_mock_factory(second));
+        dispatcher.run();
+        REQUIRE(first != nullptr);
+        REQUIRE(second != nullptr);
+
+        REQUIRE(first->received.size() == second->received.size());
+        size_t market_events = 0;
+        for (size_t i = 0; i < first->received.size(); ++i) {
+            const auto& a = first->received[i];
+            const auto& b = second->received[i];
+            REQUIRE(a.type == b.type);
+            if (a.type != market_replay::EventType::QUOTE && a.type != market_replay::EventType::TRADE) continue;
+            REQUIRE(a.event == b.event); // Same object delivered to both queues
+            market_events++;
+        }
+        REQUIRE(market_events == timestamps.size());
+    }
+
+    SECTION("Pooled strategies each see the thread-per-strategy sequence") {
+        auto reference = run_with(market_replay::Dispatcher::Config{});
+
+        market_replay::Dispatcher::Config pooled;
+        pooled.strategy_execution = market_replay::Dispatcher::StrategyExecution::POOLED;
+        pooled.strategy_pool_threads = 2;
+        market_replay::StrategyOptions small_ring;
+        small_ring.queue_capacity = 4; // Forces the dispatcher to wait on tasks that have not run yet
+        market_replay::StrategyOptions blocking;
+        blocking.queue_type = market_replay::StrategyOptions::QueueType::BLOCKING;
+
+        std::vector<MockStrategy*> mocks(12, nullptr);
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, pooled);
+        for (size_t i = 0; i < mocks.size(); ++i) {
+            dispatcher.add_strategy("Pooled_" + std::to_string(i), make_mock_factory(mocks[i]), i % 2 ? small_ring : blocking);
+        }
+        dispatcher.run();
+
+        for (MockStrategy* mock : mocks) {
+            REQUIRE(mock != nullptr);
+            REQUIRE(mock->received.size() == reference.size());
+            for (size_t i = 0; i < reference.size(); ++i) {
+                REQUIRE(mock->received[i].type == reference[i].type);
+                REQUIRE(mock->received[i].arrival_ts == reference[i].arrival_ts);
+            }
+        }
+    }
+
+    SECTION("Delivery latency is measured for every event each queued strategy runs") {
+        for (auto execution : {market_replay::Dispatcher::StrategyExecution::THREADED,
+                               market_replay::Dispatcher::StrategyExecution::POOLED}) {
+            market_replay::Dispatcher::Config config;
+            config.strategy_execution = execution;
+            config.measure_delivery_latency = true;
+            market_replay::StrategyOptions small_ring;
+            small_ring.queue_capacity = 4; // The ring of push times wraps many times
+            MockStrategy* ring = nullptr;
+            MockStrategy* blocking = nullptr;
+            market_replay::StrategyOptions blocking_options;
+            blocking_options.queue_type = market_replay::StrategyOptions::QueueType::BLOCKING;
+            market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, config);
+            dispatcher.add_strategy("Ring", make_mock_factory(ring), small_ring);
+            dispatcher.add_strategy("Blocking", make_mock_factory(blocking), blocking_options);
+            dispatcher.run();
+
+            for (market_replay::StrategyIndex i = 0; i < 2; ++i) {
+                const market_replay::LatencyHistogram* latency = dispatcher.delivery_latency(i);
+                REQUIRE(latency != nullptr);
+                const MockStrategy* mock = i == 0 ? ring : blocking;
+                REQUIRE(latency->count() >= mock->received.size()); // The shutdown signal is timed too
+                REQUIRE(latency->count() <= mock->received.size() + 2);
+                REQUIRE(latency->max() < std::chrono::seconds(10));
+            }
+        }
+
+        market_replay::Dispatcher::Config inline_config;
+        inline_config.strategy_execution = market_replay::Dispatcher::StrategyExecution::INLINE;
+        inline_config.measure_delivery_latency = true;
+        MockStrategy* mock = nullptr;
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, inline_config);
+        dispatcher.add_strategy("Inline", make_mock_factory(mock));
+        dispatcher.run();
+        REQUIRE(dispatcher.delivery_latency(0) == nullptr); // Called straight from the dispatcher
+
+        market_replay::Dispatcher unmeasured(test_csv_file, test_latency_config(), nullptr, market_replay::Dispatcher::Config{});
+        unmeasured.add_strategy("Mock", make_mock_factory(mock));
+        unmeasured.run();
+        REQUIRE(unmeasured.delivery_latency(0) == nullptr);
+    }
+
+    SECTION("Batched strategies see the per-event sequence, grouped as they asked") {
+        // Three ticks per timestamp
+        const std::string batch_csv_file = "test_dispatcher_batch_ticks.csv";
+        std::vector<long long> repeated;
+        for (int i = 0; i < 150; ++i) repeated.push_back(1678886400000000000LL + (i / 3) * 1000000LL);
+        write_ticks_csv(batch_csv_file, repeated);
+
+        using Batching = market_replay::IStrategy::EventBatching;
+        for (auto execution : {market_replay::Dispatcher::StrategyExecution::THREADED,
+                               market_replay::Dispatcher::StrategyExecution::POOLED,
+                               market_replay::Dispatcher::StrategyExecution::INLINE}) {
+            market_replay::Dispatcher::Config config;
+            config.strategy_execution = execution;
+            MockStrategy* reference = nullptr;
+            MockStrategy* same_timestamp = nullptr;
+            MockStrategy* drained = nullptr;
+            market_replay::Dispatcher dispatcher(batch_csv_file, test_latency_config(), nullptr, config);
+            dispatcher.add_strategy("PerEvent", make_mock_factory(reference));
+            dispatcher.add_strategy("SameTimestamp", make_mock_factory(same_timestamp));
+            dispatcher.add_strategy("Drained", make_mock_factory(drained));
+            same_timestamp->set_event_batching(Batching::SAME_TIMESTAMP);
+            drained->set_event_batching(Batching::DRAINED);
+            dispatcher.run();
+
+            REQUIRE(reference->batches.empty());
+            REQUIRE(reference->received.size() >= repeated.size());
+            for (const MockStrategy* mock : {same_timestamp, drained}) {
+                REQUIRE(mock->received.size() == reference->received.size());
+                for (size_t i = 0; i < reference->received.size(); ++i) {
+                    REQUIRE(mock->received[i].type == reference->received[i].type);
+                    REQUIRE(mock->received[i].arrival_ts == reference->received[i].arrival_ts);
+                }
+                size_t batched = 0;
+                for (const auto& batch : mock->batches) {
+                    REQUIRE_FALSE(batch.empty());
+                    REQUIRE(batch.size() <= market_replay::Dispatcher::kStrategyPopBatchSize);
+                    if (execution == market_replay::Dispatcher::StrategyExecution::INLINE) REQUIRE(batch.size() == 1);
+                    batched += batch.size();
+                }
+                REQUIRE(batched == mock->received.size());
+            }
+            for (const auto& batch : same_timestamp->batches) {
+                for (auto ts : batch) REQUIRE(ts == batch.front());
+            }
+        }
+        std::remove(batch_csv_file.c_str());
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+}
+
+TEST_CASE("Dispatcher inline strategy execution", "[dispatcher]") {
+    const std::string test_csv_file = "test_dispatcher_inline_ticks.csv";
+    market_replay::Logger::init("test_dispatcher_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    const long long base_ns = 1678886400000000000LL;
+    std::vector<long long> timestamps;
+    for (int i = 0; i < 30; ++i) timestamps.push_back(base_ns + i * 1000000LL);
+    write_ticks_csv(test_csv_file, timestamps); // Quotes 99.99 x 500 / 100.01 x 700, every third tick a trade at 100.01
+
+    // On the first quote: a market buy that takes the ask, and a sell limit improving the ask that
+    // rests until the next print through it
+    auto run_with = [&](market_replay::Dispatcher::Config config,
+                        std::function<void(const market_replay::Dispatcher&)> inspect = nullptr) {
+        MockStrategy* mock = nullptr;
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, config);
+        dispatcher.add_strategy("Mock_1", make_mock_factory(mock));
+        REQUIRE(mock != nullptr);
+        bool sent = false;
+        mock->quote_hook = [&sent](MockStrategy& self, const market_replay::QuoteEvent& quote, market_replay::Timestamp ts) {
+            if (sent) return;
+            sent = true;
+            self.submit_order(quote.symbol_id, market_replay::OrderSide::BUY, market_replay::OrderType::MARKET,
+                              market_replay::INVALID_PRICE, 100, ts);
+            self.submit_order(quote.symbol_id, market_replay::OrderSide::SELL, market_replay::OrderType::LIMIT,
+                              100.00, 10, ts);
+        };
+        dispatcher.run();
+        if (inspect) inspect(dispatcher);
+        return std::make_pair(mock->received, mock->acks);
+    };
+
+    market_replay::Dispatcher::Config inline_config;
+    inline_config.strategy_execution = market_replay::Dispatcher::StrategyExecution::INLINE;
+    auto [received, acks] = run_with(inline_config);
+
+    SECTION("Orders are matched as soon as they are submitted") {
+        const market_replay::Timestamp decision_ts = market_replay::Timestamp(std::chrono::nanoseconds(base_ns)) + 50us;
+        REQUIRE(acks.size() == 4);
+        // Strategy 5us + order network 20us + exchange 10us (ack) / 15us (fill) + ack network 20us
+        REQUIRE(acks[0].status == market_replay::OrderStatus::ACKNOWLEDGED);
+        REQUIRE(acks[0].client_order_id == 1);
+        REQUIRE(acks[0].arrival_timestamp == decision_ts + 55us);
+        REQUIRE(acks[1].status == market_replay::OrderStatus::ACKNOWLEDGED);
+        REQUIRE(acks[1].client_order_id == 2);
+        REQUIRE(acks[2].status == market_replay::OrderStatus::FILLED);
+        REQUIRE(acks[2].client_order_id == 1);
+        REQUIRE(acks[2].last_filled_price == 100.01);
+        REQUIRE(acks[2].arrival_timestamp == decision_ts + 60us);
+        // The trade at 100.01 (third tick) prints through the resting 100.00 offer
+        REQUIRE(acks[3].status == market_replay::OrderStatus::FILLED);
+        REQUIRE(acks[3].client_order_id == 2);
+        REQUIRE(acks[3].last_filled_price == 100.00);
+        REQUIRE(acks[3].arrival_timestamp == market_replay::Timestamp(std::chrono::nanoseconds(timestamps[2])) + 50us);
+        REQUIRE(acks[2].side == market_replay::OrderSide::BUY);
+        REQUIRE(acks[3].side == market_replay::OrderSide::SELL);
+    }
+
+    SECTION("Fills and marks keep positions and PnL up to date") {
+        for (size_t shards : {1, 2}) {
+            market_replay::Dispatcher::Config config = inline_config;
+            config.num_shards = shards;
+            config.pnl.snapshot_interval = 5ms;
+            run_with(config, [&](const market_replay::Dispatcher& dispatcher) {
+                const auto& engine = dispatcher.pnl_engine();
+                const market_replay::SymbolId symbol = market_replay::intern_symbol("SYNTH");
+                // Bought 100 @ 100.01, sold 10 @ 100.00; marked to the 100.00 mid
+                const market_replay::PnL pnl = engine.pnl(0, symbol);
+                REQUIRE(pnl.current_position == 90);
+                REQUIRE(std::abs(pnl.realized_pnl - (-0.10)) < 1e-9);
+                REQUIRE(std::abs(pnl.unrealized_pnl - (-0.90)) < 1e-9);
+                REQUIRE(std::abs(pnl.total_volume_traded - 11001.0) < 1e-9);
+                REQUIRE(engine.position(0, symbol).fills == 2);
+
+                // Ticks span 29ms from the first arrival: boundaries at 5, 10, 15, 20 and 25ms
+                const auto& snapshots = engine.snapshots();
+                REQUIRE(snapshots.size() == 5);
+                const market_replay::Timestamp first_arrival = market_replay::Timestamp(std::chrono::nanoseconds(base_ns)) + 50us;
+                REQUIRE(snapshots[0].timestamp == first_arrival + 5ms);
+                REQUIRE(snapshots[4].timestamp == first_arrival + 25ms);
+                REQUIRE(std::abs(snapshots[4].realized_pnl + snapshots[4].unrealized_pnl - (-1.0)) < 1e-9);
+            });
+        }
+    }
+
+    SECTION("Runs are reproducible, sharded or not") {
+        market_replay::Dispatcher::Config sharded_config = inline_config;
+        sharded_config.num_shards = 2;
+        for (const auto& config : {inline_config, sharded_config}) {
+            auto [again_received, again_acks] = run_with(config);
+            REQUIRE(again_received.size() == received.size());
+            for (size_t i = 0; i < received.size(); ++i) {
+                REQUIRE(again_received[i].type == received[i].type);
+                REQUIRE(again_received[i].arrival_ts == received[i].arrival_ts);
+            }
+            REQUIRE(again_acks.size() == acks.size());
+            for (size_t i = 0; i < acks.size(); ++i) {
+                REQUIRE(again_acks[i].status == acks[i].status);
+                REQUIRE(again_acks[i].exchange_order_id == acks[i].exchange_order_id);
+                REQUIRE(again_acks[i].arrival_timestamp == acks[i].arrival_timestamp);
+                REQUIRE(again_acks[i].last_filled_quantity == acks[i].last_filled_quantity);
+            }
+        }
+    }
+
+    SECTION("Inline and threaded strategies see the same market data") {
+        auto [threaded_received, threaded_acks] = run_with(market_replay::Dispatcher::Config{});
+        (void)threaded_acks; // Ack timing on the threaded path depends on thread scheduling
+        std::vector<market_replay::Timestamp> inline_md, threaded_md;
+        for (const auto& r : received) {
+            if (r.type != market_replay::EventType::ORDER_ACK) inline_md.push_back(r.arrival_ts);
+        }
+        for (const auto& r : threaded_received) {
+            if (r.type != market_replay::EventType::ORDER_ACK) threaded_md.push_back(r.arrival_ts);
+        }
+        REQUIRE(inline_md == threaded_md);
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+}
+
+TEST_CASE("Dispatcher checkpoints", "[dispatcher]") {
+    const std::string test_csv_file = "test_dispatcher_checkpoint_ticks.csv";
+    const std::string checkpoint_prefix = "test_dispatcher_checkpoint_";
+    market_replay::Logger::init("test_dispatcher_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    const long long base_ns = 1678886400000000000LL;
+    const market_replay::Timestamp base_ts = market_replay::Timestamp(std::chrono::nanoseconds(base_ns));
+    std::vector<long long> timestamps;
+    for (int i = 0; i < 30; ++i) timestamps.push_back(base_ns + i * 1000000LL);
+    write_ticks_csv(test_csv_file, timestamps);
+
+    struct Result {
+        std::vector<MockStrategy::Received> received;
+        std::vector<market_replay::OrderAckEvent> acks;
+        size_t received_before_resume = 0;
+        std::vector<market_replay::Checkpoint> checkpoints;
+        market_replay::PnL pnl;
+    };
+    // The same orders as the inline test, keyed off the first tick so a resumed strategy does not repeat them
+    auto run_with = [&](const market_replay::Dispatcher::Config& config, const market_replay::Checkpoint* resume,
+                        const std::string& strategy_id = "Mock_1") {
+        MockStrategy* mock = nullptr;
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, config);
+        dispatcher.add_strategy(strategy_id, make_mock_factory(mock));
+        REQUIRE(mock != nullptr);
+        mock->quote_hook = [&](MockStrategy& self, const market_replay::QuoteEvent& quote, market_replay::Timestamp ts) {
+            if (quote.exchange_timestamp != base_ts) return;
+            self.submit_order(quote.symbol_id, market_replay::OrderSide::BUY, market_replay::OrderType::MARKET,
+                              market_replay::INVALID_PRICE, 100, ts);
+            self.submit_order(quote.symbol_id, market_replay::OrderSide::SELL, market_replay::OrderType::LIMIT,
+                              100.00, 10, ts);
+        };
+        if (resume) dispatcher.resume_from(*resume);
+        dispatcher.run();
+        return Result{mock->received, mock->acks, mock->received_before_resume, dispatcher.checkpoints(),
+                      dispatcher.pnl_engine().pnl(0, market_replay::intern_symbol("SYNTH"))};
+    };
+    // A resumed run must see exactly what the full run saw from the checkpoint on
+    auto require_continues = [](const Result& full, const Result& resumed) {
+        REQUIRE(resumed.received_before_resume > 0);
+        REQUIRE(resumed.received.size() == full.received.size() - resumed.received_before_resume);
+        size_t acks_before = 0;
+        for (size_t i = 0; i < resumed.received_before_resume; ++i) {
+            acks_before += full.received[i].type == market_replay::EventType::ORDER_ACK;
+        }
+        for (size_t i = 0; i < resumed.received.size(); ++i) {
+            const auto& expected = full.received[resumed.received_before_resume + i];
+            REQUIRE(resumed.received[i].type == expected.type);
+            REQUIRE(resumed.received[i].exchange_ts == expected.exchange_ts);
+            REQUIRE(resumed.received[i].arrival_ts == expected.arrival_ts);
+        }
+        REQUIRE(resumed.acks.size() == full.acks.size() - acks_before);
+        for (size_t i = 0; i < resumed.acks.size(); ++i) {
+            const auto& expected = full.acks[acks_before + i];
+            REQUIRE(resumed.acks[i].client_order_id == expected.client_order_id);
+            REQUIRE(resumed.acks[i].exchange_order_id == expected.exchange_order_id);
+            REQUIRE(resumed.acks[i].status == expected.status);
+            REQUIRE(resumed.acks[i].last_filled_price == expected.last_filled_price);
+            REQUIRE(resumed.acks[i].arrival_timestamp == expected.arrival_timestamp);
+        }
+        REQUIRE(resumed.pnl.current_position == full.pnl.current_position);
+        REQUIRE(resumed.pnl.realized_pnl == full.pnl.realized_pnl);
+        REQUIRE(resumed.pnl.total_volume_traded == full.pnl.total_volume_traded);
+    };
+
+    market_replay::Dispatcher::Config inline_config;
+    inline_config.strategy_execution = market_replay::Dispatcher::StrategyExecution::INLINE;
+
+    SECTION("A resumed run carries on exactly where the checkpoint was taken") {
+        market_replay::Dispatcher::Config streaming_config = inline_config;
+        streaming_config.ingestion_mode = market_replay::Dispatcher::IngestionMode::STREAMING;
+        streaming_config.market_data_window_size = 4;
+        for (auto config : {inline_config, streaming_config}) {
+            const Result plain = run_with(config, nullptr);
+            // Between the first two ticks: the sell limit is resting, filled by the trade at 2ms
+            config.checkpoints.at = {base_ts + 1500us};
+            config.checkpoints.keep_in_memory = true;
+            const Result full = run_with(config, nullptr);
+            REQUIRE(full.checkpoints.size() == 1);
+            REQUIRE(full.checkpoints[0].sim_time == base_ts + 1500us);
+            REQUIRE(full.received.size() == plain.received.size()); // Taking one changes nothing
+
+            const Result resumed = run_with(config, &full.checkpoints[0]);
+            require_continues(full, resumed);
+            REQUIRE(resumed.checkpoints.empty()); // Not taken again
+            REQUIRE(resumed.acks.size() == 1);
+            REQUIRE(resumed.acks[0].client_order_id == 2);
+            REQUIRE(resumed.acks[0].status == market_replay::OrderStatus::FILLED);
+        }
+    }
+
+    SECTION("Periodic checkpoints written to files fork into identical runs") {
+        market_replay::Dispatcher::Config config = inline_config;
+        config.checkpoints.interval = 10ms;
+        config.checkpoints.path_prefix = checkpoint_prefix;
+        const Result full = run_with(config, nullptr);
+        // From the first event, at base + 50us
+        const std::string first = market_replay::Dispatcher::checkpoint_file_path(checkpoint_prefix, base_ts + 10050us);
+        const std::string second = market_replay::Dispatcher::checkpoint_file_path(checkpoint_prefix, base_ts + 20050us);
+        const market_replay::Checkpoint checkpoint = market_replay::Checkpoint::load(first);
+        REQUIRE(checkpoint.sim_time == base_ts + 10050us);
+        REQUIRE(market_replay::Checkpoint::load(second).sim_time == base_ts + 20050us);
+
+        market_replay::Dispatcher::Config fork_config = inline_config;
+        const Result fork_a = run_with(fork_config, &checkpoint);
+        const Result fork_b = run_with(fork_config, &checkpoint);
+        require_continues(full, fork_a);
+        require_continues(full, fork_b);
+        REQUIRE(fork_a.pnl.current_position == 90);
+        std::remove(first.c_str());
+        std::remove(second.c_str());
+    }
+
+    SECTION("A stateful strategy resumes with its indicator windows and positions") {
+        // MeanReversionStrategy over its default 200-quote window: spikes either way on a gentle
+        // wave, so it trades on both sides of the checkpoint and needs its window to do so
+        const std::string mr_csv_file = "test_dispatcher_checkpoint_mr_ticks.csv";
+        {
+            std::ofstream file(mr_csv_file);
+            file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n" << std::fixed
+                 << std::setprecision(5);
+            for (int i = 0; i < 800; ++i) {
+                double mid = 1.07 + 0.0001 * std::sin(i / 10.0);
+                if (i % 97 == 50) mid += 0.001;
+                if (i % 89 == 40) mid -= 0.001;
+                file << "QUOTE," << base_ns + i * 1000000LL << ",EURUSD,,," << mid - 0.00001 << ",100000,"
+                     << mid + 0.00001 << ",100000\n";
+            }
+        }
+        auto run_mr = [&](const market_replay::Dispatcher::Config& config, const market_replay::Checkpoint* resume) {
+            market_replay::Dispatcher dispatcher(mr_csv_file, test_latency_config(), nullptr, config);
+            dispatcher.add_strategy("MeanRev_1", market_replay::create_mean_reversion_strategy);
+            if (resume) dispatcher.resume_from(*resume);
+            dispatcher.run();
+            return std::make_pair(dispatcher.checkpoints(),
+                                  dispatcher.pnl_engine().pnl(0, market_replay::intern_symbol("EURUSD")));
+        };
+        market_replay::Dispatcher::Config config = inline_config;
+        config.checkpoints.at = {base_ts + 500ms};
+        config.checkpoints.keep_in_memory = true;
+        const auto full = run_mr(config, nullptr);
+        REQUIRE(full.first.size() == 1);
+        market_replay::Dispatcher::Config until_checkpoint_config = inline_config;
+        until_checkpoint_config.replay_window.end = base_ts + 500ms;
+        until_checkpoint_config.replay_window.use_index = false;
+        const auto until_checkpoint = run_mr(until_checkpoint_config, nullptr);
+        REQUIRE(until_checkpoint.second.total_volume_traded > 0);
+        REQUIRE(full.second.total_volume_traded > until_checkpoint.second.total_volume_traded);
+
+        const auto resumed = run_mr(inline_config, &full.first[0]);
+        REQUIRE(resumed.second.current_position == full.second.current_position);
+        REQUIRE(resumed.second.realized_pnl == full.second.realized_pnl);
+        REQUIRE(resumed.second.total_volume_traded == full.second.total_volume_traded);
+        std::remove(mr_csv_file.c_str());
+    }
+
+    SECTION("Resuming needs the same strategies and a valid checkpoint") {
+        market_replay::Dispatcher::Config config = inline_config;
+        config.checkpoints.at = {base_ts + 1500us};
+        config.checkpoints.keep_in_memory = true;
+        const Result full = run_with(config, nullptr);
+        REQUIRE_THROWS_AS(run_with(inline_config, &full.checkpoints[0], "Mock_2"), std::runtime_error);
+
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, inline_config);
+        REQUIRE_THROWS_AS(dispatcher.resume_from(market_replay::Checkpoint{base_ts, "not a checkpoint"}), std::runtime_error);
+        market_replay::Checkpoint truncated = full.checkpoints[0];
+        truncated.data.resize(truncated.data.size() / 2);
+        MockStrategy* mock = nullptr;
+        dispatcher.add_strategy("Mock_1", make_mock_factory(mock));
+        dispatcher.resume_from(truncated);
+        REQUIRE_THROWS_AS(dispatcher.run(), std::runtime_error);
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+}
+
+TEST_CASE("Dispatcher sharded replay", "[dispatcher]") {
+    const std::string test_csv_file = "test_dispatcher_sharded_ticks.csv";
+    market_replay::Logger::init("test_dispatcher_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    // Several symbols interleaved, some ticks closer together than the lookahead (25us)
+    const char* symbols[] = {"SHARD_A", "SHARD_B", "SHARD_C", "SHARD_D", "SHARD_E"};
+    {
+        std::ofstream file(test_csv_file);
+        file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+        long long ts = 1678886400000000000LL;
+        for (int i = 0; i < 200; ++i) {
+            ts += (i % 4 == 0) ? 1000000LL : 7000LL;
+            const char* symbol = symbols[(i * 3) % 5];
+            if (i % 5 == 4) {
+                file << "TRADE," << ts << "," << symbol << ",100.01,25,,,,\n";
+            } else {
+                file << "QUOTE," << ts << "," << symbol << ",,,99.99,500,100.01,700\n";
+            }
+        }
+    }
+
+    // With only_a, the strategy sees SHARD_A alone but also rests an order on SHARD_C, where the
+    // trades print: windows stretch over the other symbols, and over SHARD_C until the order arrives
+    auto run_with = [&](size_t num_shards, market_replay::LatencyModel::Config latency, bool only_a = false) {
+        MockStrategy* mock = nullptr;
+        market_replay::Dispatcher::Config config;
+        config.num_shards = num_shards;
+        config.market_data_window_size = 16;
+        // Threaded single-shard runs pick orders up on a timer; inline ones match them as they are sent
+        if (only_a) config.strategy_execution = market_replay::Dispatcher::StrategyExecution::INLINE;
+        market_replay::Dispatcher dispatcher(test_csv_file, latency, nullptr, config);
+        dispatcher.add_strategy("Mock_1", make_mock_factory(mock));
+        REQUIRE(mock != nullptr);
+        if (only_a) {
+            mock->subscribe(market_replay::intern_symbol("SHARD_A"));
+            bool sent = false;
+            mock->quote_hook = [&sent](MockStrategy& self, const market_replay::QuoteEvent& /*quote*/, market_replay::Timestamp ts) {
+                if (sent) return;
+                sent = true;
+                for (const char* symbol : {"SHARD_A", "SHARD_C"}) {
+                    self.submit_order(market_replay::intern_symbol(symbol), market_replay::OrderSide::SELL,
+                                      market_replay::OrderType::LIMIT, 100.00, 10, ts);
+                }
+            };
+        }
+        dispatcher.run();
+        return mock->received;
+    };
+
+    // Jittered market data reorders ticks 7us apart; each tick's draw is keyed by its sequence.
+    // The spread (about 40us) stays inside what a 16-event window looks ahead.
+    market_replay::LatencyModel::Config jittered = test_latency_config();
+    jittered.distributions.set(market_replay::LatencyModel::Leg::MARKET_DATA_FEED,
+                               market_replay::LatencyDistribution::lognormal(20us, 0.25, 30us));
+
+    for (const auto& latency : {test_latency_config(), jittered}) {
+        auto single = run_with(1, latency);
+        REQUIRE(single.size() == 200);
+        for (size_t num_shards : {2, 3, 8}) {
+            auto sharded = run_with(num_shards, latency);
+            REQUIRE(sharded.size() == single.size());
+            for (size_t i = 0; i < single.size(); ++i) {
+                REQUIRE(sharded[i].type == single[i].type);
+                REQUIRE(sharded[i].exchange_ts == single[i].exchange_ts);
+                REQUIRE(sharded[i].arrival_ts == single[i].arrival_ts);
+            }
+        }
+    }
+
+    // Acks and fills for both orders arrive at the same times however many ticks a window batches
+    auto single = run_with(1, test_latency_config(), true);
+    REQUIRE(single.size() > 40 + 2); // SHARD_A's quotes, both acks and at least one fill
+    for (size_t num_shards : {2, 5}) {
+        auto sharded = run_with(num_shards, test_latency_config(), true);
+        REQUIRE(sharded.size() == single.size());
+        for (size_t i = 0; i < single.size(); ++i) {
+            REQUIRE(sharded[i].type == single[i].type);
+            REQUIRE(sharded[i].exchange_ts == single[i].exchange_ts);
+            REQUIRE(sharded[i].arrival_ts == single[i].arrival_ts);
+        }
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+}
+
+TEST_CASE("Dispatcher symbol subscriptions", "[dispatcher]") {
+    const std::string test_csv_file = "test_dispatcher_subscriptions.csv";
+    market_replay::Logger::init("test_dispatcher_log.txt", spdlog::level::off, spdlog::level::off, false);
+    {
+        // SUB_X, SUB_Y, SUB_Z in turn: 10 ticks each
+        std::ofstream file(test_csv_file);
+        file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+        const char* symbols[] = {"SUB_X", "SUB_Y", "SUB_Z"};
+        for (int i = 0; i < 30; ++i) {
+            file << "QUOTE," << 1678886400000000000LL + i * 1000000LL << "," << symbols[i % 3] << ",,,99.99,500,100.01,700\n";
+        }
+    }
+    const auto x = market_replay::intern_symbol("SUB_X");
+    const auto y = market_replay::intern_symbol("SUB_Y");
+
+    // Symbols as they reach a strategy; the events themselves are gone by the time a run returns
+    auto record_symbols = [](MockStrategy* mock, std::vector<market_replay::SymbolId>& seen) {
+        mock->quote_hook = [&seen](MockStrategy&, const market_replay::QuoteEvent& q, market_replay::Timestamp) {
+            seen.push_back(q.symbol_id);
+        };
+    };
+
+    SECTION("Each strategy only gets the symbols it subscribed to") {
+        market_replay::Dispatcher::Config threaded;
+        market_replay::Dispatcher::Config inline_config;
+        inline_config.strategy_execution = market_replay::Dispatcher::StrategyExecution::INLINE;
+        market_replay::Dispatcher::Config pooled;
+        pooled.strategy_execution = market_replay::Dispatcher::StrategyExecution::POOLED;
+        pooled.strategy_pool_threads = 2;
+        market_replay::Dispatcher::Config sharded = inline_config;
+        sharded.num_shards = 2;
+
+        for (const auto& config : {threaded, inline_config, pooled, sharded}) {
+            MockStrategy* only_x = nullptr;
+            MockStrategy* only_y = nullptr;
+            MockStrategy* everything = nullptr;
+            market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, config);
+            market_replay::StrategyOptions x_options;
+            x_options.symbols = {"SUB_X"};
+            dispatcher.add_strategy("Mock_X", make_mock_factory(only_x), x_options);
+            dispatcher.add_strategy("Mock_Y", make_mock_factory(only_y));
+            dispatcher.add_strategy("Mock_All", make_mock_factory(everything));
+            only_y->subscribe(y);
+            std::vector<market_replay::SymbolId> x_seen, y_seen, all_seen;
+            record_symbols(only_x, x_seen);
+            record_symbols(only_y, y_seen);
+            record_symbols(everything, all_seen);
+            dispatcher.run();
+
+            REQUIRE(x_seen == std::vector<market_replay::SymbolId>(10, x));
+            REQUIRE(y_seen == std::vector<market_replay::SymbolId>(10, y));
+            REQUIRE(all_seen.size() == 30);
+        }
+    }
+
+    SECTION("Subscriptions made in on_init narrow what is read") {
+        market_replay::Dispatcher::Config config;
+        config.strategy_execution = market_replay::Dispatcher::StrategyExecution::INLINE;
+        config.read_subscribed_symbols_only = true;
+        config.replay_window.index_rows = 4;
+        MockStrategy* only_x = nullptr;
+        MockStrategy* only_y = nullptr;
+        std::vector<market_replay::SymbolId> x_seen, y_seen;
+        market_replay::Dispatcher dispatcher(test_csv_file, test_latency_config(), nullptr, config);
+        dispatcher.add_strategy("Mock_X", make_mock_factory(only_x));
+        dispatcher.add_strategy("Mock_Y", make_mock_factory(only_y));
+        only_x->subscribe(x);
+        only_y->subscribe(y);
+        record_symbols(only_x, x_seen);
+        record_symbols(only_y, y_seen);
+        dispatcher.run();
+
+        REQUIRE(x_seen == std::vector<market_replay::SymbolId>(10, x));
+        REQUIRE(y_seen == std::vector<market_replay::SymbolId>(10, y));
+        // The union was handed to the reader as a replay window, which indexed the file to skip SUB_Z
+        const std::string sidecar = market_replay::TimeIndex::sidecar_path(test_csv_file);
+        REQUIRE(std::ifstream(sidecar).good());
+        std::remove(sidecar.c_str());
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+}
@@ -0,0 +1,129 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/event_heap.hpp"
+#include "market_replay/timing_wheel_scheduler.hpp"
+#include <random>
+
+using namespace market_replay;
+
+namespace {
+
+std::unique_ptr<BaseEvent> make_control(long long ts_ns, SimControlEvent::ControlType ct) {
+    return std::make_unique<SimControlEvent>(Timestamp(std::chrono::nanoseconds(ts_ns)), ct);
+}
+
+std::unique_ptr<BaseEvent> make_ack(long long ts_ns, OrderId client_order_id) {
+    return std::make_unique<OrderAckEvent>(Timestamp(std::chrono::nanoseconds(ts_ns)), 0, client_order_id, 0,
+                                           INVALID_SYMBOL_ID, OrderStatus::ACKNOWLEDGED);
+}
+
+} // namespace
+
+TEST_CASE("EventHeap ordering", "[event_heap]") {
+    EventHeap heap;
+
+    SECTION("Pops in timestamp order") {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<long long> dist(0, 1000);
+        for (int i = 0; i < 500; ++i) heap.push(make_control(dist(rng), SimControlEvent::ControlType::PROCESS_ORDER_REQUESTS));
+        REQUIRE(heap.size() == 500);
+
+        Timestamp last = Timestamp::min();
+        while (!heap.empty()) {
+            Timestamp top = heap.top_timestamp();
+            auto event = heap.pop();
+            REQUIRE(event->get_effective_timestamp() == top);
+            REQUIRE(top >= last);
+            last = top;
+        }
+    }
+
+    SECTION("Equal timestamps pop in insertion order") {
+        for (OrderId id = 1; id <= 50; ++id) {
+            heap.push(make_ack(id % 2 == 0 ? 100 : 200, id)); // Interleave two timestamps
+        }
+        std::vector<OrderId> order;
+        while (!heap.empty()) {
+            auto event = heap.pop();
+            order.push_back(static_cast<OrderAckEvent*>(event.get())->client_order_id);
+        }
+        std::vector<OrderId> expected;
+        for (OrderId id = 2; id <= 50; id += 2) expected.push_back(id);
+        for (OrderId id = 1; id <= 50; id += 2) expected.push_back(id);
+        REQUIRE(order == expected);
+    }
+
+    SECTION("Interleaved push and pop") {
+        heap.push(make_ack(300, 1));
+        heap.push(make_ack(100, 2));
+        REQUIRE(static_cast<OrderAckEvent*>(heap.pop().get())->client_order_id == 2);
+        heap.push(make_ack(300, 3));
+        heap.push(make_ack(200, 4));
+        REQUIRE(static_cast<const OrderAckEvent&>(heap.top()).client_order_id == 4);
+        REQUIRE(static_cast<OrderAckEvent*>(heap.pop().get())->client_order_id == 4);
+        REQUIRE(static_cast<OrderAckEvent*>(heap.pop().get())->client_order_id == 1);
+        REQUIRE(static_cast<OrderAckEvent*>(heap.pop().get())->client_order_id == 3);
+        REQUIRE(heap.empty());
+    }
+}
+
+TEST_CASE("TimingWheelScheduler matches EventHeap order", "[event_heap][timing_wheel]") {
+    TimingWheelScheduler::Config config;
+    config.bucket_width = std::chrono::microseconds(1);
+    config.num_buckets = 256; // Small horizon (256us) so overflow and migration are exercised
+
+    SECTION("Capacity is rounded to a power of two") {
+        config.num_buckets = 100;
+        REQUIRE(TimingWheelScheduler(config).num_buckets() == 128);
+    }
+
+    SECTION("Random mix of near, far and equal timestamps") {
+        TimingWheelScheduler wheel(config);
+        EventHeap heap;
+        std::mt19937_64 rng(11);
+        std::uniform_int_distribution<int> kind(0, 9);
+        std::uniform_int_distribution<long long> near_us(0, 150);
+        std::uniform_int_distribution<long long> far_ms(1, 20);
+
+        long long now_ns = 1'000'000'000LL;
+        OrderId next_id = 1;
+        auto push_both = [&](long long ts_ns) {
+            OrderId id = next_id++;
+            wheel.push(make_ack(ts_ns, id));
+            heap.push(make_ack(ts_ns, id));
+        };
+        for (int i = 0; i < 64; ++i) push_both(now_ns + far_ms(rng) * 1'000'000LL);
+
+        size_t popped = 0;
+        while (!heap.empty()) {
+            REQUIRE(wheel.size() == heap.size());
+            REQUIRE(wheel.top_timestamp() == heap.top_timestamp());
+            auto a = wheel.pop();
+            auto b = heap.pop();
+            REQUIRE(static_cast<OrderAckEvent*>(a.get())->client_order_id == static_cast<OrderAckEvent*>(b.get())->client_order_id);
+            now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(b->get_effective_timestamp().time_since_epoch()).count();
+            ++popped;
+
+            if (popped < 5000) {
+                int k = kind(rng);
+                if (k < 6) push_both(now_ns + near_us(rng) * 1000); // Inside the horizon
+                if (k == 6) push_both(now_ns);                      // Same time as the current event
+                if (k == 7) push_both(now_ns + far_ms(rng) * 1'000'000LL); // Beyond the horizon
+                if (k >= 8) { push_both(now_ns + 5000); push_both(now_ns + 5000); } // Ties
+            }
+        }
+        REQUIRE(wheel.empty());
+        REQUIRE(wheel.overflow_size() == 0);
+    }
+
+    SECTION("Events behind the cursor still pop first") {
+        TimingWheelScheduler wheel(config);
+        wheel.push(make_ack(10'000'000, 1));
+        wheel.push(make_ack(10'050'000, 2));
+        REQUIRE(static_cast<OrderAckEvent*>(wheel.pop().get())->client_order_id == 1); // Cursor now at 10ms
+        wheel.push(make_ack(9'000'000, 3)); // Earlier than the cursor
+        REQUIRE(wheel.top_timestamp() == Timestamp(std::chrono::nanoseconds(9'000'000)));
+        REQUIRE(static_cast<OrderAckEvent*>(wheel.pop().get())->client_order_id == 3);
+        REQUIRE(static_cast<OrderAckEvent*>(wheel.pop().get())->client_order_id == 2);
+        REQUIRE(wheel.empty());
+    }
+}
@@ -0,0 +1,132 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/event_pool.hpp"
+#include "market_replay/event.hpp"
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using market_replay::EventPool;
+
+namespace {
+
+// Frees its slot however the section ends, so one failed assertion does not leave the pool with
+// live objects for the sections after it
+struct PooledSlot {
+    PooledSlot(EventPool& pool, size_t size) : pool(pool), size(size), p(pool.allocate(size)) {}
+    ~PooledSlot() { pool.deallocate(p, size); }
+    PooledSlot(const PooledSlot&) = delete;
+    PooledSlot& operator=(const PooledSlot&) = delete;
+    EventPool& pool;
+    size_t size;
+    void* p;
+};
+
+} // namespace
+
+TEST_CASE("EventPool recycling", "[event_pool]") {
+    EventPool& pool = EventPool::instance();
+
+    SECTION("A freed slot is handed out again for the same size class") {
+        { PooledSlot a(pool, 72); }
+        const auto before = pool.stats();
+        PooledSlot b(pool, 100); // Same 128-byte class: a recycled slot, whichever one it is
+        const auto after = pool.stats().since(before);
+        REQUIRE(after.allocations == 1);
+        REQUIRE(after.reused == 1);
+        REQUIRE(after.bytes_reused == 128);
+        REQUIRE(after.chunks_allocated == 0);
+    }
+
+    SECTION("Slots are cache-line aligned and distinct while alive") {
+        std::vector<std::unique_ptr<PooledSlot>> slots;
+        for (int i = 0; i < 1000; ++i) slots.push_back(std::make_unique<PooledSlot>(pool, 40));
+        std::vector<void*> addresses;
+        for (const auto& slot : slots) {
+            CHECK(reinterpret_cast<uintptr_t>(slot->p) % EventPool::kSlotAlign == 0);
+            addresses.push_back(slot->p);
+        }
+        std::sort(addresses.begin(), addresses.end());
+        REQUIRE(std::adjacent_find(addresses.begin(), addresses.end()) == addresses.end());
+    }
+
+    SECTION("Oversize requests fall back to the heap") {
+        const auto before = pool.stats();
+        PooledSlot big(pool, EventPool::kMaxPooledSize + 1);
+        REQUIRE(pool.stats().since(before).fallback_allocations == 1);
+        REQUIRE(pool.stats().live == before.live);
+    }
+
+    SECTION("Slots freed on other threads are recycled") {
+        REQUIRE(pool.release_if_idle()); // Nothing cached anywhere: what follows can only reuse the freed slots
+        std::vector<std::unique_ptr<PooledSlot>> slots;
+        for (int i = 0; i < 64; ++i) slots.push_back(std::make_unique<PooledSlot>(pool, 64));
+        std::thread freer([&]() { slots.clear(); }); // Its cache hands them back when the thread exits
+        freer.join();
+        const auto before = pool.stats();
+        std::vector<std::unique_ptr<PooledSlot>> again;
+        for (int i = 0; i < 64; ++i) again.push_back(std::make_unique<PooledSlot>(pool, 64));
+        REQUIRE(pool.stats().since(before).reused == 64);
+        REQUIRE(pool.stats().since(before).chunks_allocated == 0);
+    }
+
+    SECTION("Threads allocate and free concurrently, and their counts add up") {
+        const auto before = pool.stats();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&pool]() {
+                std::vector<std::unique_ptr<PooledSlot>> slots;
+                for (int round = 0; round < 20; ++round) {
+                    for (int i = 0; i < 500; ++i) slots.push_back(std::make_unique<PooledSlot>(pool, 64 + i % 192));
+                    slots.clear();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        const auto delta = pool.stats().since(before);
+        REQUIRE(delta.allocations == 4 * 20 * 500);
+        REQUIRE(delta.reused >= 4 * 19 * 500); // Every round after a thread's first reuses its own slots
+        REQUIRE(pool.stats().live == before.live);
+    }
+
+    SECTION("Chunks are only released once nothing is alive") {
+        {
+            PooledSlot p(pool, 64);
+            REQUIRE_FALSE(pool.release_if_idle());
+        }
+        REQUIRE(pool.release_if_idle());
+        REQUIRE(pool.stats().bytes_reserved == 0);
+        REQUIRE(pool.stats().live == 0);
+        PooledSlot after(pool, 64); // The calling thread's cache starts over rather than reuse freed chunks
+        REQUIRE(pool.stats().bytes_reserved == EventPool::kChunkSize);
+    }
+
+#if MARKET_REPLAY_EVENT_POOL
+    SECTION("Events allocate through the pool") {
+        const auto before = pool.stats();
+        {
+            auto quote = std::make_unique<market_replay::QuoteEvent>(market_replay::Timestamp{}, "POOLTEST", 1.0, 1, 1.1, 1);
+            std::shared_ptr<const market_replay::QuoteEvent> shared(std::move(quote));
+            auto ack = std::make_unique<market_replay::OrderAckEvent>(market_replay::Timestamp{}, 0, 1, 2, shared->symbol_id,
+                                                                     market_replay::OrderStatus::FILLED);
+            REQUIRE(pool.stats().live == before.live + 2);
+        }
+        REQUIRE(pool.stats().live == before.live);
+        REQUIRE(pool.stats().allocations == before.allocations + 2);
+    }
+
+    SECTION("A shared event keeps its reference count in the pool too") {
+        const auto before = pool.stats();
+        {
+            std::unique_ptr<market_replay::BaseEvent> quote =
+                std::make_unique<market_replay::QuoteEvent>(market_replay::Timestamp{}, "POOLTEST", 1.0, 1, 1.1, 1);
+            auto shared = market_replay::share_event<market_replay::QuoteEvent>(std::move(quote));
+            auto copy = shared;
+            REQUIRE(copy->ask_size == 1);
+            REQUIRE(pool.stats().live == before.live + 2);
+        }
+        REQUIRE(pool.stats().live == before.live);
+        REQUIRE(pool.stats().fallback_allocations == before.fallback_allocations);
+    }
+#endif
+}
@@ -0,0 +1,196 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/indicators.hpp"
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace market_replay::indicators;
+
+namespace {
+
+bool close_to(double actual, double expected, double tolerance) {
+    return std::abs(actual - expected) <= tolerance * std::max(1.0, std::abs(expected));
+}
+
+struct WindowStats {
+    double mean = 0.0;
+    double variance = 0.0;
+};
+WindowStats brute_force(const std::vector<double>& xs, size_t end, size_t window) {
+    const size_t begin = end > window ? end - window : 0;
+    WindowStats stats;
+    for (size_t i = begin; i < end; ++i) stats.mean += xs[i];
+    stats.mean /= static_cast<double>(end - begin);
+    for (size_t i = begin; i < end; ++i) stats.variance += (xs[i] - stats.mean) * (xs[i] - stats.mean);
+    stats.variance /= static_cast<double>(end - begin);
+    return stats;
+}
+
+// A random walk in small steps far from zero, where a naive sum of squares loses the variance
+std::vector<double> random_walk(size_t n, double start, double step, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> move(0.0, step);
+    std::vector<double> xs(n);
+    double x = start;
+    for (auto& value : xs) value = x += move(rng);
+    return xs;
+}
+
+} // namespace
+
+TEST_CASE("Streaming indicators", "[indicators]") {
+    SECTION("A ring window holds the last values, oldest first") {
+        RingWindow<int> window(3);
+        REQUIRE(window.push(1) == 0);
+        window.push(2);
+        window.push(3);
+        REQUIRE(window.full());
+        REQUIRE(window.push(4) == 1);
+        REQUIRE(window[0] == 2);
+        REQUIRE(window.newest() == 4);
+        REQUIRE_THROWS_AS(RingWindow<int>(0), std::invalid_argument);
+    }
+
+    SECTION("Rolling mean and variance match a rescan of the window") {
+        const auto xs = random_walk(20000, 1.1, 1e-5, 3);
+        const size_t window = 64;
+        RollingMean mean(window);
+        RollingVariance variance(window);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            mean.update(xs[i]);
+            variance.update(xs[i]);
+            if (i % 97 != 0 && i + 1 != xs.size()) continue;
+            const WindowStats expected = brute_force(xs, i + 1, window);
+            REQUIRE(close_to(mean.value(), expected.mean, 1e-12));
+            REQUIRE(close_to(variance.mean(), expected.mean, 1e-12));
+            REQUIRE(std::abs(variance.variance() - expected.variance) <= 1e-6 * expected.variance + 1e-30);
+        }
+        REQUIRE(variance.ready());
+        const double sd = std::sqrt(brute_force(xs, xs.size(), window).variance);
+        REQUIRE(close_to(variance.zscore(variance.mean() + 2 * sd), 2.0, 1e-6));
+
+        RollingVariance flat(4);
+        for (int i = 0; i < 10; ++i) flat.update(100.0);
+        REQUIRE(flat.variance() == 0.0);
+        REQUIRE(flat.zscore(101.0) == 0.0);
+    }
+
+    SECTION("A restored rolling variance carries on bit for bit") {
+        const auto xs = random_walk(1000, 1.1, 1e-5, 5);
+        const market_replay::Timestamp at{};
+        RollingVariance original(64);
+        for (size_t i = 0; i < 300; ++i) original.update(xs[i]); // Mid-way round the ring
+        market_replay::CheckpointWriter out(at);
+        original.save_state(out);
+
+        RollingVariance restored(64);
+        market_replay::CheckpointReader in(out.data(), at);
+        restored.restore_state(in);
+        REQUIRE(in.at_end());
+        for (size_t i = 300; i < xs.size(); ++i) {
+            original.update(xs[i]);
+            restored.update(xs[i]);
+            REQUIRE(restored.mean() == original.mean());
+            REQUIRE(restored.variance() == original.variance());
+        }
+
+        RollingVariance other_window(32);
+        market_replay::CheckpointReader again(out.data(), at);
+        REQUIRE_THROWS_AS(other_window.restore_state(again), std::runtime_error);
+    }
+
+    SECTION("EWMA is seeded with its first input") {
+        Ewma ewma(0.5);
+        ewma.update(10.0);
+        REQUIRE(ewma.value() == 10.0);
+        ewma.update(20.0);
+        REQUIRE(ewma.value() == 15.0);
+        REQUIRE(close_to(Ewma::alpha_for_span(19.0), 0.1, 1e-15));
+        REQUIRE(close_to(Ewma::alpha_for_half_life(1.0), 0.5, 1e-15));
+        REQUIRE_THROWS_AS(Ewma(0.0), std::invalid_argument);
+    }
+
+    SECTION("VWAP over a session and over a trade window") {
+        Vwap vwap;
+        REQUIRE(std::isnan(vwap.value()));
+        RollingVwap rolling(2);
+        const std::vector<std::pair<double, market_replay::Quantity>> trades = {{100.0, 10}, {101.0, 30}, {99.0, 10}};
+        for (const auto& [price, size] : trades) {
+            vwap.update(price, size);
+            rolling.update(price, size);
+        }
+        REQUIRE(close_to(vwap.value(), (1000.0 + 3030.0 + 990.0) / 50.0, 1e-15));
+        REQUIRE(close_to(rolling.value(), (3030.0 + 990.0) / 40.0, 1e-15));
+        REQUIRE(vwap.volume() == 50.0);
+    }
+
+    SECTION("Microprice leans towards the thinner side") {
+        REQUIRE(mid_price(99.0, 101.0) == 100.0);
+        REQUIRE(microprice(99.0, 100, 101.0, 100) == 100.0);
+        REQUIRE(microprice(99.0, 300, 101.0, 100) == 100.5); // Thin offer: likely to tick up
+        REQUIRE(microprice(99.0, 0, 101.0, 0) == 100.0);
+        REQUIRE(std::isnan(mid_price(market_replay::INVALID_PRICE, 101.0)));
+    }
+
+    SECTION("Per-symbol indicators start from the prototype") {
+        PerSymbol<Ewma> ewmas(Ewma(0.5));
+        REQUIRE(ewmas.find(3) == nullptr);
+        ewmas[3].update(4.0);
+        ewmas[1].update(8.0);
+        REQUIRE(ewmas[3].value() == 4.0);
+        REQUIRE(ewmas.find(1)->value() == 8.0);
+        REQUIRE(ewmas[0].count() == 0);
+        REQUIRE(ewmas.size() == 4);
+    }
+}
+
+TEST_CASE("Basket indicators", "[indicators]") {
+    // Not a multiple of any vector width, so the kernels' tails run too
+    const size_t lanes = 7;
+    const size_t window = 5;
+    const size_t samples = 53;
+    std::vector<std::vector<double>> paths;
+    for (size_t lane = 0; lane < lanes; ++lane) paths.push_back(random_walk(samples, 50.0 + lane * 10.0, 0.01 * (lane + 1), lane));
+
+    SECTION("Every lane of an EWMA basket matches its own EWMA") {
+        const double alpha = Ewma::alpha_for_span(9.0);
+        EwmaBasket basket(lanes, alpha);
+        std::vector<Ewma> reference(lanes, Ewma(alpha));
+        std::vector<double> sample(lanes);
+        for (size_t t = 0; t < samples; ++t) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                sample[lane] = paths[lane][t];
+                reference[lane].update(sample[lane]);
+            }
+            basket.update(sample);
+            for (size_t lane = 0; lane < lanes; ++lane) REQUIRE(close_to(basket.value(lane), reference[lane].value(), 1e-12));
+        }
+        REQUIRE_THROWS_AS(basket.update(std::vector<double>(lanes + 1)), std::invalid_argument);
+    }
+
+    SECTION("Every lane of a z-score basket matches its own rolling variance") {
+        RollingZScoreBasket basket(lanes, window);
+        std::vector<RollingVariance> reference(lanes, RollingVariance(window));
+        std::vector<double> sample(lanes);
+        REQUIRE(basket.zscores() == std::vector<double>(lanes, 0.0));
+        for (size_t t = 0; t < samples; ++t) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                sample[lane] = paths[lane][t];
+                reference[lane].update(sample[lane]);
+            }
+            basket.update(sample);
+            REQUIRE(basket.ready() == (t + 1 >= window));
+            const std::vector<double> z = basket.zscores();
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                REQUIRE(close_to(basket.mean(lane), reference[lane].mean(), 1e-12));
+                REQUIRE(close_to(basket.variance(lane), reference[lane].variance(), 1e-6));
+                REQUIRE(std::abs(z[lane] - reference[lane].zscore(sample[lane])) <= 1e-6);
+            }
+        }
+
+        RollingZScoreBasket flat(lanes, window);
+        for (int t = 0; t < 8; ++t) flat.update(std::vector<double>(lanes, 1.0));
+        REQUIRE(flat.zscores() == std::vector<double>(lanes, 0.0));
+    }
+}
@@ -0,0 +1,88 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/latency_histogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std::chrono_literals;
+using market_replay::LatencyHistogram;
+
+TEST_CASE("LatencyHistogram buckets", "[latency_histogram]") {
+    SECTION("Buckets tile the value range without gaps") {
+        for (size_t i = 1; i < LatencyHistogram::kNumBuckets; ++i) {
+            REQUIRE(LatencyHistogram::bucket_lower(i) ==
+                    LatencyHistogram::bucket_lower(i - 1) + LatencyHistogram::bucket_width(i - 1));
+        }
+        REQUIRE(LatencyHistogram::bucket_index(0) == 0);
+        REQUIRE(LatencyHistogram::bucket_index(UINT64_MAX) == LatencyHistogram::kNumBuckets - 1);
+    }
+
+    SECTION("Every value lands in the bucket that covers it") {
+        std::mt19937_64 rng(7);
+        for (int i = 0; i < 100000; ++i) {
+            const uint64_t value = rng() >> (rng() % 64);
+            const size_t index = LatencyHistogram::bucket_index(value);
+            const uint64_t lower = LatencyHistogram::bucket_lower(index);
+            REQUIRE(value >= lower);
+            REQUIRE(value - lower < LatencyHistogram::bucket_width(index));
+        }
+    }
+}
+
+TEST_CASE("LatencyHistogram statistics", "[latency_histogram]") {
+    LatencyHistogram histogram;
+    REQUIRE(histogram.count() == 0);
+    REQUIRE(histogram.value_at_percentile(99.0) == 0ns);
+
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> draw(std::log(50'000.0), 1.0); // ~50us median, long tail
+    std::vector<int64_t> values;
+    for (int i = 0; i < 200000; ++i) {
+        values.push_back(static_cast<int64_t>(draw(rng)));
+        histogram.record_ns(values.back());
+    }
+    std::sort(values.begin(), values.end());
+
+    REQUIRE(histogram.count() == values.size());
+    REQUIRE(histogram.min().count() == values.front());
+    REQUIRE(histogram.max().count() == values.back());
+    REQUIRE(histogram.value_at_percentile(100.0).count() == values.back());
+    for (double pct : {1.0, 50.0, 90.0, 99.0, 99.9, 99.99}) {
+        const auto rank = static_cast<size_t>(std::ceil(pct / 100.0 * static_cast<double>(values.size())));
+        const double exact = static_cast<double>(values[rank - 1]);
+        const double reported = static_cast<double>(histogram.value_at_percentile(pct).count());
+        REQUIRE(reported >= exact);
+        REQUIRE((reported - exact) / exact < 1.0 / 64);
+    }
+
+    SECTION("Merging equals recording everything into one") {
+        LatencyHistogram first, second, combined;
+        for (size_t i = 0; i < values.size(); ++i) {
+            (i % 3 ? first : second).record_ns(values[i]);
+            combined.record_ns(values[i]);
+        }
+        first.merge(second);
+        REQUIRE(first.count() == combined.count());
+        REQUIRE(first.min() == combined.min());
+        REQUIRE(first.max() == combined.max());
+        REQUIRE(first.mean() == combined.mean());
+        for (size_t i = 0; i < LatencyHistogram::kNumBuckets; ++i) {
+            REQUIRE(first.bucket_count(i) == combined.bucket_count(i));
+        }
+
+        LatencyHistogram empty;
+        empty.merge(first);
+        REQUIRE(empty.min() == combined.min());
+        first.reset();
+        REQUIRE(first.count() == 0);
+        REQUIRE(first.value_at_percentile(50.0) == 0ns);
+    }
+
+    SECTION("Negative latencies count as zero") {
+        LatencyHistogram clamped;
+        clamped.record(-5us);
+        REQUIRE(clamped.count() == 1);
+        REQUIRE(clamped.max() == 0ns);
+    }
+}
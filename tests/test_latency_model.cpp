@@ -2,6 +2,9 @@
 #include "test_utils.hpp" 
 #include "market_replay/latency_model.hpp"
 #include "market_replay/event.hpp" // For dummy event
+#include <cstdio>
+#include <fstream>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -26,6 +29,10 @@ TEST_CASE("LatencyModel Calculations", "[latency_model]") {
         REQUIRE(model.get_strategy_processing_latency() == 10us);
     }
 
+    SECTION("Decision to exchange lookahead") {
+        REQUIRE(model.min_decision_to_exchange_latency() == 60us);
+    }
+
     SECTION("Order Arrival at Exchange") {
         // strategy_decision_ts is t0.
         // This function expects decision_ts to already include strategy processing time.
@@ -60,4 +67,94 @@ TEST_CASE("LatencyModel Calculations", "[latency_model]") {
         REQUIRE(model.get_fill_arrival_at_strategy_ts(order_arrival_exchange) == expected_fill_arrival_strategy);
         REQUIRE(model.get_fill_arrival_at_strategy_ts(order_arrival_exchange) == t0 + 50us + 30us + 50us); // 130us total
     }
-}
\ No newline at end of file
+}
+TEST_CASE("LatencyModel distributions", "[latency_model]") {
+    using market_replay::LatencyDistribution;
+    using Leg = market_replay::LatencyModel::Leg;
+
+    SECTION("Lognormal samples stay in the table's range around the median") {
+        auto dist = LatencyDistribution::lognormal(20us, 0.5, 5us);
+        REQUIRE_FALSE(dist.is_constant());
+        REQUIRE(dist.min() > 5us);
+        REQUIRE(dist.max() > 25us * 4);
+        std::vector<market_replay::Duration> samples(20000);
+        dist.sample_batch(42, 0, 0, samples.data(), samples.size());
+        size_t below_median = 0;
+        for (auto d : samples) {
+            REQUIRE(d >= dist.min());
+            REQUIRE(d <= dist.max());
+            if (d < 25us) below_median++;
+        }
+        REQUIRE(below_median > 9600);
+        REQUIRE(below_median < 10400);
+    }
+
+    SECTION("Empirical histogram draws buckets in proportion to their counts") {
+        const std::string path = "test_latency_histogram.csv";
+        {
+            std::ofstream file(path);
+            file << "# captured round trips\nlower_ns,upper_ns,count\n10000,11000,1\n11000,12000,3\n30000,40000,0\n";
+        }
+        auto dist = LatencyDistribution::load_histogram(path);
+        std::remove(path.c_str());
+        REQUIRE(dist.min() == 10us);
+        REQUIRE(dist.max() == 12us);
+
+        size_t first_bucket = 0;
+        const size_t n = 40000;
+        for (size_t i = 0; i < n; ++i) {
+            auto d = dist.sample(market_replay::keyed_draw(7, 0, i));
+            REQUIRE(d >= 10us);
+            REQUIRE(d < 12us);
+            if (d < 11us) first_bucket++;
+        }
+        REQUIRE(first_bucket > n / 4 - 600);
+        REQUIRE(first_bucket < n / 4 + 600);
+
+        REQUIRE_THROWS_AS(LatencyDistribution::load_histogram("no_such_histogram.csv"), std::runtime_error);
+    }
+
+    SECTION("Samples depend only on seed, leg and key") {
+        market_replay::LatencyModel::Config config;
+        config.distributions.set(Leg::ORDER_NETWORK, LatencyDistribution::lognormal(20us, 0.3));
+        market_replay::LatencyModel a(config), b(config);
+        config.seed = 99;
+        market_replay::LatencyModel c(config);
+
+        market_replay::Timestamp t0 = market_replay::Timestamp(0ns);
+        size_t differs = 0;
+        std::vector<market_replay::Duration> batch(100);
+        a.sample_batch(Leg::ORDER_NETWORK, market_replay::INVALID_SYMBOL_ID, 0, batch.data(), batch.size());
+        for (uint64_t key = 0; key < 100; ++key) {
+            auto t = a.get_order_arrival_at_exchange_ts(t0, market_replay::INVALID_SYMBOL_ID, key);
+            REQUIRE(t == b.get_order_arrival_at_exchange_ts(t0, market_replay::INVALID_SYMBOL_ID, key));
+            REQUIRE(t - t0 == batch[key]);
+            if (t != c.get_order_arrival_at_exchange_ts(t0, market_replay::INVALID_SYMBOL_ID, key)) differs++;
+        }
+        REQUIRE(differs > 90);
+        REQUIRE(a.get_ack_arrival_at_strategy_ts(t0, market_replay::INVALID_SYMBOL_ID, 3) == t0 + 30us); // Fixed legs unchanged
+    }
+
+    SECTION("Symbol overrides win over venue overrides and the defaults") {
+        market_replay::LatencyModel::Config config;
+        config.strategy_processing_latency = 5us;
+        config.order_network_latency_strat_to_exch = 20us;
+        market_replay::LatencyModel::LegDistributions near_venue;
+        near_venue.set(Leg::ORDER_NETWORK, LatencyDistribution::constant(2us));
+        near_venue.set(Leg::MARKET_DATA_FEED, LatencyDistribution::constant(3us));
+        market_replay::LatencyModel::LegDistributions one_symbol;
+        one_symbol.set(Leg::MARKET_DATA_FEED, LatencyDistribution::constant(1us));
+        config.venue_overrides["NEAR"] = near_venue;
+        config.symbol_venues["LAT_A"] = "NEAR";
+        config.symbol_venues["LAT_B"] = "NEAR";
+        config.symbol_overrides["LAT_B"] = one_symbol;
+        market_replay::LatencyModel model(config);
+
+        market_replay::Timestamp t0 = market_replay::Timestamp(0ns);
+        REQUIRE(model.get_market_data_latency(market_replay::QuoteEvent(t0, "LAT_A", 1.0, 1, 1.1, 1)) == 3us);
+        REQUIRE(model.get_market_data_latency(market_replay::QuoteEvent(t0, "LAT_B", 1.0, 1, 1.1, 1)) == 1us);
+        REQUIRE(model.get_market_data_latency(market_replay::QuoteEvent(t0, "LAT_C", 1.0, 1, 1.1, 1)) == 50us);
+        REQUIRE(model.get_order_arrival_at_exchange_ts(t0, market_replay::intern_symbol("LAT_B"), 0) == t0 + 2us); // Inherited from the venue
+        REQUIRE(model.min_decision_to_exchange_latency() == 7us); // The fastest symbol bounds the lookahead
+    }
+}
@@ -0,0 +1,61 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/logger.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+TEST_CASE("Logger", "[logger]") {
+    const std::string log_file = "test_logger_log.txt";
+    const market_replay::Timestamp ts = market_replay::string_to_timestamp("1678886400000000123");
+
+#if MARKET_REPLAY_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+    SECTION("A disabled level does not evaluate its arguments") {
+        market_replay::Logger::init(log_file, spdlog::level::off, spdlog::level::info, false);
+        int evaluated = 0;
+        const auto argument = [&evaluated] { return ++evaluated; };
+        LOG_DEBUG("Not logged: {}", argument());
+        LOG_TRACE("Not logged: {}", argument());
+        REQUIRE(evaluated == 0);
+        LOG_INFO("Logged: {} at {}", argument(), market_replay::log_ts(ts));
+        REQUIRE(evaluated == 1);
+
+        // Each macro is one statement
+        bool took_else = false;
+        if (evaluated == 0)
+            LOG_INFO("Unreachable");
+        else
+            took_else = true;
+        REQUIRE(took_else);
+        market_replay::Logger::shutdown();
+
+        std::ifstream in(log_file);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        REQUIRE(contents.str().find("Logged: 1 at 1678886400000000123") != std::string::npos);
+        REQUIRE(contents.str().find("Not logged") == std::string::npos);
+        std::remove(log_file.c_str());
+    }
+#endif
+
+    SECTION("Timestamps format as timestamp_to_string does") {
+        REQUIRE(fmt::format("{}", market_replay::log_ts(ts)) == market_replay::timestamp_to_string(ts));
+        REQUIRE(fmt::format("{:>22}", market_replay::log_ts(ts)) == "   " + market_replay::timestamp_to_string(ts));
+    }
+
+    SECTION("The replay profile never blocks on a full queue and flushes only warnings") {
+        const auto config = market_replay::Logger::replay_profile(log_file);
+        REQUIRE(config.log_file_name == log_file);
+        REQUIRE(config.async);
+        REQUIRE(config.overflow_policy == spdlog::async_overflow_policy::overrun_oldest);
+        REQUIRE(config.flush_level == spdlog::level::warn);
+        REQUIRE(config.flush_interval.count() > 0);
+        REQUIRE(config.file_level == spdlog::level::info);
+
+        market_replay::Logger::init(config);
+        REQUIRE(market_replay::Logger::is_initialized());
+        REQUIRE_FALSE(market_replay::Logger::should_log(spdlog::level::debug));
+        REQUIRE(market_replay::Logger::should_log(spdlog::level::info));
+        market_replay::Logger::shutdown();
+        std::remove(log_file.c_str());
+    }
+}
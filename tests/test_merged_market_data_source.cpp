@@ -0,0 +1,141 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "market_replay/market_data_source.hpp"
+#include "market_replay/utils/loser_tree.hpp"
+#include "market_replay/logger.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Quotes for `symbol` at the given timestamps; the bid size carries the row number for identification
+void write_symbol_csv(const std::string& filename, const std::string& symbol, const std::vector<long long>& timestamps) {
+    std::ofstream file(filename);
+    file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        file << "QUOTE," << timestamps[i] << "," << symbol << ",,,99.99," << (i + 1) << ",100.01,700\n";
+    }
+}
+
+struct Replayed {
+    long long timestamp_ns;
+    std::string symbol;
+    long long row;
+    bool operator==(const Replayed& other) const {
+        return timestamp_ns == other.timestamp_ns && symbol == other.symbol && row == other.row;
+    }
+};
+
+std::vector<Replayed> drain(market_replay::IMarketDataSource& source) {
+    std::vector<Replayed> out;
+    while (source.has_more_events()) {
+        auto event = source.read_next_event();
+        if (!event) continue;
+        REQUIRE(event->type == market_replay::EventType::QUOTE);
+        const auto& quote = static_cast<const market_replay::QuoteEvent&>(*event);
+        out.push_back({quote.exchange_timestamp.time_since_epoch().count(), market_replay::symbol_name(quote.symbol_id),
+                       static_cast<long long>(quote.bid_size)});
+    }
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("LoserTree merges like a sort", "[merge]") {
+    std::mt19937 rng(3);
+    for (size_t k : {1, 2, 3, 7, 64, 100}) {
+        std::vector<std::vector<int>> runs(k);
+        std::vector<int> expected;
+        for (auto& run : runs) {
+            run.resize(rng() % 20);
+            for (auto& v : run) v = static_cast<int>(rng() % 50);
+            std::sort(run.begin(), run.end());
+            expected.insert(expected.end(), run.begin(), run.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        using Key = std::pair<int, size_t>; // (value, run); INT_MAX once the run is drained
+        std::vector<size_t> cursor(k, 0);
+        auto head = [&](size_t i) { return Key{cursor[i] < runs[i].size() ? runs[i][cursor[i]] : INT_MAX, i}; };
+        std::vector<Key> keys;
+        for (size_t i = 0; i < k; ++i) keys.push_back(head(i));
+        market_replay::utils::LoserTree<Key> tree(std::move(keys));
+
+        std::vector<int> merged;
+        while (tree.winner_key().first != INT_MAX) {
+            const size_t i = tree.winner();
+            merged.push_back(runs[i][cursor[i]++]);
+            tree.replace_winner(head(i));
+        }
+        REQUIRE(merged == expected);
+    }
+}
+
+TEST_CASE("MergedMarketDataSource replays many files in time order", "[merge]") {
+    market_replay::Logger::init("test_merge_log.txt", spdlog::level::off, spdlog::level::off, false);
+    const std::string dir = "test_merge_ticks";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+
+    // Overlapping per-symbol files with ties across them, an empty one, and a non-tick file to skip
+    std::mt19937 rng(11);
+    std::vector<std::string> paths;
+    std::vector<Replayed> expected;
+    for (int f = 0; f < 12; ++f) {
+        const std::string symbol = "MRG" + std::to_string(f);
+        std::vector<long long> timestamps;
+        long long ts = 1'000'000;
+        const int rows = f == 5 ? 0 : 50 + static_cast<int>(rng() % 200);
+        for (int i = 0; i < rows; ++i) {
+            ts += rng() % 4; // Repeats within and across files
+            timestamps.push_back(ts);
+            expected.push_back({ts, symbol, i + 1});
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "/day_%02d.csv", f);
+        paths.push_back(dir + name);
+        write_symbol_csv(paths.back(), symbol, timestamps);
+    }
+    std::ofstream(dir + "/README.txt") << "not market data\n";
+    // Timestamp order; ties in file (list) order, then row order within a file
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const Replayed& a, const Replayed& b) { return a.timestamp_ns < b.timestamp_ns; });
+
+    SECTION("Prefetched and synchronous blocks of any size give the same stream") {
+        for (size_t io_threads : {0, 1, 3}) {
+            for (size_t block_events : {1, 7, 4096}) {
+                market_replay::MergedMarketDataSource::Config config;
+                config.io_threads = io_threads;
+                config.block_events = block_events;
+                auto source = market_replay::open_market_data_source(paths, config);
+                REQUIRE(drain(*source) == expected);
+                REQUIRE_FALSE(source->has_more_events());
+                REQUIRE(source->read_next_event() == nullptr);
+            }
+        }
+    }
+
+    SECTION("A directory is opened as the merge of its tick files") {
+        REQUIRE(market_replay::list_market_data_files(dir) == paths);
+        auto source = market_replay::open_market_data_source(dir);
+        REQUIRE(drain(*source) == expected);
+        REQUIRE_THROWS_AS(market_replay::list_market_data_files(paths.front()), std::runtime_error);
+    }
+
+    SECTION("Dropping a source mid-replay waits for its prefetches") {
+        market_replay::MergedMarketDataSource::Config config;
+        config.block_events = 4;
+        auto source = market_replay::open_market_data_source(paths, config);
+        for (int i = 0; i < 100; ++i) REQUIRE(source->read_next_event() != nullptr);
+        source.reset();
+    }
+
+    market_replay::Logger::shutdown();
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,146 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/metrics.hpp"
+#include "market_replay/checkpoint.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+size_t count_lines(const std::string& path) {
+    std::ifstream file(path);
+    size_t lines = 0;
+    for (std::string line; std::getline(file, line);) lines++;
+    return lines;
+}
+
+} // namespace
+
+TEST_CASE("MetricsCollector streams records from many threads", "[metrics]") {
+    const std::string trades_path = "test_metrics_trades.csv";
+    const std::string latency_path = "test_metrics_latency.csv";
+    const std::string pnl_path = "test_metrics_pnl.csv";
+    const std::string raw_path = "test_metrics_raw_latency.csv";
+    const std::string dump_path = "test_metrics_histograms.csv";
+    const market_replay::SymbolId symbol = market_replay::intern_symbol("METRICSTEST");
+
+    market_replay::MetricsCollector::Config config;
+    config.records_per_buffer = 16; // Many hand-overs and recycled buffers
+    config.flush_interval = 1ms;
+    config.raw_latency_log_path = raw_path;
+    config.histogram_dump_path = dump_path;
+
+    const int num_threads = 4;
+    const int per_thread = 1000;
+    {
+        market_replay::MetricsCollector metrics(trades_path, latency_path, pnl_path, config);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t] {
+                const std::string strategy = "Strat_" + std::to_string(t);
+                const market_replay::MetricKey key = metrics.intern_key(strategy + "_Latency");
+                for (int i = 0; i < per_thread; ++i) {
+                    const market_replay::Timestamp ts(std::chrono::nanoseconds(1'000'000LL * i));
+                    metrics.record_latency(key, std::chrono::microseconds(1 + i % 10), ts);
+                    if (i % 10 == 0) {
+                        metrics.record_trade({ts, strategy, symbol, (t % 2 ? market_replay::OrderSide::SELL : market_replay::OrderSide::BUY),
+                                              100.0, 10, static_cast<market_replay::OrderId>(i), static_cast<market_replay::OrderId>(i)});
+                    }
+                }
+                metrics.record_latency(strategy + "_Done", 0us, market_replay::Timestamp(0ns), "marker");
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        const auto summary = metrics.summary();
+        REQUIRE(summary.trade_count == num_threads * per_thread / 10);
+        REQUIRE(summary.total_quantity == num_threads * per_thread);
+        REQUIRE(summary.net_position == 0); // Two buyers, two sellers of the same size
+        REQUIRE(summary.latency_records == num_threads * (per_thread + 1));
+        REQUIRE(summary.max_latency == 10us);
+
+        metrics.report_final_metrics();
+        REQUIRE(count_lines(trades_path) == 1 + summary.trade_count);
+        REQUIRE(count_lines(raw_path) == 1 + summary.latency_records);
+        REQUIRE(count_lines(latency_path) == 1 + 2 * num_threads); // One line per source
+        REQUIRE(count_lines(dump_path) == 1 + num_threads * 11); // Ten distinct latencies and one marker each
+        REQUIRE(count_lines(pnl_path) == 1 + num_threads);
+
+        std::ifstream raw(raw_path);
+        bool marker_found = false;
+        for (std::string line; std::getline(raw, line);) {
+            if (line == "0,Strat_2_Done,0,marker") marker_found = true;
+        }
+        REQUIRE(marker_found);
+
+        // Latencies 1..10us, equally often; percentiles report the top of their bucket (5us -> [4992, 5056))
+        std::ifstream percentiles(latency_path);
+        bool row_found = false;
+        for (std::string line; std::getline(percentiles, line);) {
+            if (line.rfind("Strat_1_Latency,", 0) == 0) {
+                row_found = true;
+                REQUIRE(line == "Strat_1_Latency,1000,1000,5500,5055,9087,10000,10000,10000");
+            }
+        }
+        REQUIRE(row_found);
+
+        const auto histograms = metrics.latency_histograms();
+        REQUIRE(histograms.size() == 2 * num_threads);
+        REQUIRE(histograms.at("Strat_0_Latency").count() == per_thread);
+        REQUIRE(histograms.at("Strat_0_Done").max() == 0us);
+    }
+
+    SECTION("Empty paths keep totals without writing files") {
+        market_replay::MetricsCollector metrics("", "", "", config);
+        metrics.record_latency("Only_Totals", 5us, market_replay::Timestamp(0ns));
+        metrics.report_final_metrics();
+        REQUIRE(metrics.summary().latency_records == 1);
+        REQUIRE(metrics.summary().mean_latency == 5us);
+    }
+
+    std::remove(trades_path.c_str());
+    std::remove(latency_path.c_str());
+    std::remove(pnl_path.c_str());
+    std::remove(raw_path.c_str());
+    std::remove(dump_path.c_str());
+}
+
+TEST_CASE("MetricsCollector state survives a checkpoint", "[metrics]") {
+    const market_replay::SymbolId symbol = market_replay::intern_symbol("METRICSTEST");
+    const market_replay::Timestamp ts(std::chrono::nanoseconds(1'000'000LL));
+
+    market_replay::MetricsCollector metrics("", "", "");
+    for (int i = 0; i < 100; ++i) metrics.record_latency("Checkpointed", std::chrono::microseconds(1 + i), ts);
+    metrics.record_trade({ts, "Strat_0", symbol, market_replay::OrderSide::BUY, 100.0, 10, 1, 1});
+    market_replay::PnL pnl;
+    pnl.current_position = 10;
+    pnl.realized_pnl = 1.5;
+    metrics.record_pnl("Strat_0", symbol, pnl);
+    market_replay::CheckpointWriter out(ts);
+    metrics.save_state(out);
+
+    // Restored into a collector that had already recorded something else, which it replaces
+    market_replay::MetricsCollector restored("", "", "");
+    restored.record_latency("Other", 1us, ts);
+    market_replay::CheckpointReader in(out.data(), ts);
+    restored.restore_state(in);
+    REQUIRE(in.at_end());
+
+    const auto before = metrics.summary();
+    const auto after = restored.summary();
+    REQUIRE(after.trade_count == before.trade_count);
+    REQUIRE(after.total_quantity == before.total_quantity);
+    REQUIRE(after.latency_records == before.latency_records);
+    REQUIRE(after.mean_latency == before.mean_latency);
+    REQUIRE(after.max_latency == before.max_latency);
+    REQUIRE(after.net_position == 10);
+    REQUIRE(after.realized_pnl == 1.5);
+    const auto histograms = restored.latency_histograms();
+    REQUIRE(histograms.size() == 1);
+    REQUIRE(histograms.at("Checkpointed").count() == 100);
+    REQUIRE(histograms.at("Checkpointed").max() == metrics.latency_histograms().at("Checkpointed").max());
+}
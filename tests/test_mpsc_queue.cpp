@@ -0,0 +1,79 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/utils/mpsc_queue.hpp"
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using market_replay::utils::MpscQueue;
+
+TEST_CASE("MpscQueue Basic Operations", "[mpsc_queue]") {
+    MpscQueue<int> queue;
+
+    SECTION("Drain returns items in push order") {
+        REQUIRE(queue.empty());
+        std::vector<int> out;
+        REQUIRE(queue.drain(out) == 0);
+
+        for (int i = 0; i < 5; ++i) queue.push(i);
+        REQUIRE_FALSE(queue.empty());
+        REQUIRE(queue.drain(out) == 5);
+        REQUIRE(out == std::vector<int>{0, 1, 2, 3, 4});
+        REQUIRE(queue.empty());
+
+        queue.push(5);
+        REQUIRE(queue.drain(out) == 1); // Appends
+        REQUIRE(out.back() == 5);
+    }
+
+    SECTION("Shutdown drops new pushes") {
+        queue.push(1);
+        queue.shutdown();
+        queue.push(2);
+        std::vector<int> out;
+        REQUIRE(queue.drain(out) == 1);
+        REQUIRE(out == std::vector<int>{1});
+    }
+
+    SECTION("Move-only payloads and undrained items are released") {
+        MpscQueue<std::unique_ptr<int>> ptr_queue;
+        ptr_queue.push(std::make_unique<int>(1));
+        ptr_queue.push(std::make_unique<int>(2));
+        std::vector<std::unique_ptr<int>> out;
+        REQUIRE(ptr_queue.drain(out) == 2);
+        REQUIRE(*out[0] == 1);
+        ptr_queue.push(std::make_unique<int>(3)); // Freed by the destructor
+    }
+}
+
+TEST_CASE("MpscQueue Multithreaded", "[mpsc_queue]") {
+    MpscQueue<int> queue;
+    const int num_producers = 4;
+    const int items_per_producer = 5000;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < items_per_producer; ++i) queue.push(p * items_per_producer + i);
+        });
+    }
+
+    std::vector<int> consumed;
+    while (consumed.size() < static_cast<size_t>(num_producers * items_per_producer)) {
+        if (queue.drain(consumed) == 0) std::this_thread::yield();
+    }
+    for (auto& t : producers) t.join();
+
+    // Per-producer order is preserved
+    std::vector<int> last(num_producers, -1);
+    bool per_producer_fifo = true;
+    for (int v : consumed) {
+        int p = v / items_per_producer;
+        per_producer_fifo = per_producer_fifo && v > last[p];
+        last[p] = v;
+    }
+    REQUIRE(per_producer_fifo);
+    std::sort(consumed.begin(), consumed.end());
+    REQUIRE(std::adjacent_find(consumed.begin(), consumed.end()) == consumed.end());
+    REQUIRE(consumed.back() == num_producers * items_per_producer - 1);
+}
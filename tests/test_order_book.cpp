@@ -0,0 +1,204 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/order_book.hpp"
+#include <vector>
+
+using namespace market_replay;
+
+namespace {
+
+const Timestamp kTs = Timestamp(std::chrono::nanoseconds(1'000'000'000LL));
+
+QuoteEvent quote(Price bid, Quantity bid_size, Price ask, Quantity ask_size) {
+    return QuoteEvent(kTs, "BOOKTEST", bid, bid_size, ask, ask_size);
+}
+
+TradeEvent trade(Price price, Quantity size) {
+    return TradeEvent(kTs, "BOOKTEST", price, size);
+}
+
+SymbolId book_symbol() {
+    const SymbolId id = intern_symbol("BOOKTEST");
+    SymbolRegistry::instance().set_tick_size(id, 0.01); // Before any BOOKTEST event is built
+    return id;
+}
+
+} // namespace
+
+TEST_CASE("SimpleOrderBook top of book and immediate matching", "[order_book]") {
+    SimpleOrderBook book(book_symbol());
+    std::vector<SimpleOrderBook::Fill> fills;
+    book.update_quote(quote(99.99, 500, 100.01, 700), fills);
+
+    REQUIRE(book.get_bid_price() == 99.99);
+    REQUIRE(book.get_ask_size() == Quantity{700});
+    REQUIRE(book.market_depth(OrderSide::BUY, 99.99) == 500);
+    REQUIRE(book.best_bid_ticks() == 9999);
+
+    SECTION("Market order takes the best level") {
+        auto [price, qty] = book.match_market_order(OrderSide::BUY, 200);
+        REQUIRE(price == 100.01);
+        REQUIRE(qty == 200);
+        REQUIRE(book.get_ask_size() == Quantity{500});
+        REQUIRE(book.market_depth(OrderSide::SELL, 100.01) == 500);
+    }
+
+    SECTION("Passive limit order does not match") {
+        auto [price, qty] = book.match_limit_order(OrderSide::BUY, 100.00, 100);
+        (void)price;
+        REQUIRE(qty == 0);
+    }
+
+    SECTION("Marketable limit order fills at the opposite best") {
+        auto [price, qty] = book.match_limit_order(OrderSide::SELL, 99.98, 800);
+        REQUIRE(price == 99.99);
+        REQUIRE(qty == 500);
+        REQUIRE_FALSE(book.get_bid_price().has_value());
+    }
+}
+
+TEST_CASE("SimpleOrderBook resting orders and queue position", "[order_book]") {
+    SimpleOrderBook book(book_symbol());
+    std::vector<SimpleOrderBook::Fill> fills;
+    book.update_quote(quote(99.99, 500, 100.01, 700), fills);
+
+    SECTION("Joining a level queues behind the displayed size") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        REQUIRE(book.queue_ahead(1) == Quantity{500});
+        REQUIRE(book.add_limit_order(2, 0, 12, OrderSide::BUY, 100.00, 100)); // Improves the bid
+        REQUIRE(book.queue_ahead(2) == Quantity{0});
+        REQUIRE(book.resting_order_count() == 2);
+    }
+
+    SECTION("Trades at our price eat the queue ahead first, then fill FIFO") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        REQUIRE(book.add_limit_order(2, 1, 21, OrderSide::BUY, 99.99, 100));
+
+        book.apply_trade(trade(99.99, 450), fills);
+        REQUIRE(fills.empty());
+        REQUIRE(book.queue_ahead(1) == Quantity{50});
+
+        book.apply_trade(trade(99.99, 120), fills);
+        REQUIRE(fills.size() == 1);
+        REQUIRE(fills[0].exchange_order_id == 1);
+        REQUIRE(fills[0].quantity == 70);
+        REQUIRE(fills[0].leaves_quantity == 30);
+        REQUIRE(fills[0].price == 99.99);
+
+        fills.clear();
+        book.apply_trade(trade(99.99, 80), fills);
+        REQUIRE(fills.size() == 2);
+        REQUIRE(fills[0].exchange_order_id == 1);
+        REQUIRE(fills[0].quantity == 30);
+        REQUIRE(fills[0].cumulative_quantity == 100);
+        REQUIRE(fills[0].leaves_quantity == 0);
+        REQUIRE(fills[1].exchange_order_id == 2);
+        REQUIRE(fills[1].strategy_index == 1);
+        REQUIRE(fills[1].quantity == 50);
+        REQUIRE_FALSE(book.queue_ahead(1).has_value());
+        REQUIRE(book.resting_order_count() == 1);
+    }
+
+    SECTION("Trades at other prices leave the order alone") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::SELL, 100.01, 100));
+        book.apply_trade(trade(100.00, 1000), fills);
+        REQUIRE(fills.empty());
+        REQUIRE(book.queue_ahead(1) == Quantity{700});
+    }
+
+    SECTION("A trade through our price fills us regardless of queue") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::SELL, 100.01, 100, 25));
+        book.apply_trade(trade(100.03, 60), fills);
+        REQUIRE(fills.size() == 1);
+        REQUIRE(fills[0].quantity == 60);
+        REQUIRE(fills[0].price == 100.01);
+        REQUIRE(fills[0].cumulative_quantity == 85);
+    }
+
+    SECTION("Shrinking displayed size only moves us forward") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        book.update_quote(quote(99.99, 200, 100.01, 700), fills);
+        REQUIRE(book.queue_ahead(1) == Quantity{200});
+        book.update_quote(quote(99.99, 900, 100.01, 700), fills);
+        REQUIRE(book.queue_ahead(1) == Quantity{200});
+    }
+
+    SECTION("Market retreating past our level puts us at the front") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        book.update_quote(quote(99.97, 300, 100.01, 700), fills);
+        REQUIRE(book.queue_ahead(1) == Quantity{0});
+        REQUIRE(book.market_depth(OrderSide::BUY, 99.99) == 0);
+        REQUIRE(fills.empty());
+    }
+
+    SECTION("An opposite quote crossing us fills at our limit") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        REQUIRE(book.add_limit_order(2, 0, 12, OrderSide::BUY, 99.97, 100));
+        book.update_quote(quote(99.96, 500, 99.98, 150), fills);
+        REQUIRE(fills.size() == 1); // 99.97 is not crossed
+        REQUIRE(fills[0].exchange_order_id == 1);
+        REQUIRE(fills[0].price == 99.99);
+        REQUIRE(fills[0].quantity == 100);
+        REQUIRE(book.resting_order_count() == 1);
+
+        fills.clear();
+        book.update_quote(quote(99.90, 500, 99.95, 40), fills);
+        REQUIRE(fills.size() == 1);
+        REQUIRE(fills[0].exchange_order_id == 2);
+        REQUIRE(fills[0].quantity == 40);
+        REQUIRE(fills[0].leaves_quantity == 60);
+    }
+
+    SECTION("Cancel removes the order and its queue slot") {
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        REQUIRE(book.add_limit_order(2, 0, 12, OrderSide::BUY, 99.99, 100));
+        REQUIRE(book.cancel_order(1));
+        REQUIRE_FALSE(book.cancel_order(1));
+        book.apply_trade(trade(99.99, 600), fills);
+        REQUIRE(fills.size() == 1);
+        REQUIRE(fills[0].exchange_order_id == 2);
+        REQUIRE(fills[0].quantity == 100);
+    }
+
+    SECTION("Invalid and duplicate orders are refused") {
+        REQUIRE_FALSE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 0.0, 100));
+        REQUIRE_FALSE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 0));
+        REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.99, 100));
+        REQUIRE_FALSE(book.add_limit_order(1, 0, 11, OrderSide::BUY, 99.98, 100));
+    }
+}
+
+TEST_CASE("SimpleOrderBook ladder follows a drifting market", "[order_book]") {
+    SimpleOrderBook::Config config;
+    config.max_levels = 2048;
+    SimpleOrderBook book(book_symbol(), config);
+    std::vector<SimpleOrderBook::Fill> fills;
+
+    // Walk far beyond the initial ladder in both directions with nothing resting
+    for (int i = 0; i < 5000; ++i) {
+        const Price mid = 100.0 + i * 0.05;
+        book.update_quote(quote(mid - 0.01, 100, mid + 0.01, 100), fills);
+    }
+    REQUIRE(book.get_bid_price().has_value());
+    REQUIRE(book.market_depth(OrderSide::BUY, *book.get_bid_price()) == 100);
+
+    // A resting order pins the ladder: levels out of span are kept sparsely, still tradeable
+    const Price bid = *book.get_bid_price();
+    REQUIRE(book.add_limit_order(1, 0, 11, OrderSide::BUY, bid, 10));
+    book.update_quote(quote(bid + 100.0, 100, bid + 100.02, 100), fills);
+    REQUIRE(book.get_bid_price() == bid + 100.0);
+    REQUIRE(book.market_depth(OrderSide::BUY, bid + 100.0) == 100);
+    REQUIRE(book.add_limit_order(2, 0, 12, OrderSide::SELL, bid + 100.04, 10));
+    REQUIRE(book.add_limit_order(3, 0, 13, OrderSide::BUY, bid + 99.98, 10));
+    REQUIRE(fills.empty());
+
+    // Trades at the far levels fill ours there, and the pinned order is still reachable
+    book.apply_trade(trade(bid + 100.06, 10), fills);
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].exchange_order_id == 2);
+    fills.clear();
+    book.apply_trade(trade(bid + 99.98, 10), fills);
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].exchange_order_id == 3);
+    REQUIRE(book.cancel_order(1));
+    REQUIRE_FALSE(book.cancel_order(2));
+}
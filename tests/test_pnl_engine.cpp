@@ -0,0 +1,113 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "market_replay/pnl_engine.hpp"
+#include <cmath>
+
+using namespace std::chrono_literals;
+using market_replay::OrderSide;
+using market_replay::PnLEngine;
+
+TEST_CASE("PnLEngine accounting", "[pnl_engine]") {
+    const market_replay::SymbolId symbol = market_replay::intern_symbol("PNLTEST");
+    const market_replay::SymbolId other = market_replay::intern_symbol("PNLTEST_OTHER");
+    PnLEngine engine;
+    engine.reset(2);
+
+    SECTION("Partial closes realize against the average cost") {
+        engine.on_fill(0, symbol, OrderSide::BUY, 1000, 10);
+        engine.on_fill(0, symbol, OrderSide::BUY, 1003, 20); // Average 1002
+        engine.on_fill(0, symbol, OrderSide::SELL, 1005, 15);
+        const auto& position = engine.position(0, symbol);
+        REQUIRE(position.quantity == 15);
+        REQUIRE(position.realized_ticks == 15 * (1005 - 1002));
+        REQUIRE(position.open_cost_ticks == 15 * 1002);
+        REQUIRE(position.volume_ticks == 10 * 1000 + 20 * 1003 + 15 * 1005);
+        REQUIRE(position.fills == 3);
+
+        engine.on_fill(0, symbol, OrderSide::SELL, 1001, 15);
+        REQUIRE(engine.position(0, symbol).quantity == 0);
+        REQUIRE(engine.position(0, symbol).open_cost_ticks == 0);
+        REQUIRE(engine.position(0, symbol).realized_ticks == 45 - 15);
+        REQUIRE(engine.position(1, symbol).fills == 0); // Other strategy untouched
+    }
+
+    SECTION("Partial closes of a large short position neither overflow nor drift") {
+        // Cost basis times closed quantity is beyond 64 bits; the basis rounds toward zero
+        const market_replay::PriceTicks price = 3'000'000'000'000LL; // e.g. 30000.0 at 1e-8
+        engine.on_fill(0, symbol, OrderSide::SELL, price, 1'000'001);
+        engine.on_fill(0, symbol, OrderSide::SELL, price + 1, 2);
+        engine.on_fill(0, symbol, OrderSide::BUY, price, 1'000'000);
+        const auto& position = engine.position(0, symbol);
+        REQUIRE(position.quantity == -3);
+        REQUIRE(position.open_cost_ticks == -(3 * price + 1)); // -(3p + 2 - 1'000'000 * 2 / 1'000'003)
+        REQUIRE(position.realized_ticks == 1);
+        engine.on_fill(0, symbol, OrderSide::BUY, price, 3);
+        REQUIRE(position.open_cost_ticks == 0);
+        REQUIRE(position.realized_ticks == 2);
+    }
+
+    SECTION("A fill through flat flips the position at the fill price") {
+        engine.on_fill(0, symbol, OrderSide::SELL, 500, 4);
+        engine.on_fill(0, symbol, OrderSide::BUY, 490, 10);
+        const auto& position = engine.position(0, symbol);
+        REQUIRE(position.quantity == 6);
+        REQUIRE(position.realized_ticks == 4 * (500 - 490));
+        REQUIRE(position.open_cost_ticks == 6 * 490);
+    }
+
+    SECTION("Unrealized PnL follows the mid, half ticks included") {
+        engine.on_fill(1, symbol, OrderSide::SELL, 200, 3);
+        // Before any quote the fill price is the mark
+        REQUIRE(engine.unrealized_pnl(1) == 0.0);
+
+        engine.on_quote(symbol, 198, 199); // Mid 198.5 ticks
+        const double tick = market_replay::from_price_ticks(symbol, 1);
+        REQUIRE(std::abs(engine.unrealized_pnl(1) - 3 * 1.5 * tick) < 1e-12);
+        engine.on_quote(symbol, market_replay::INVALID_PRICE_TICKS, 199); // One-sided: mark kept
+        REQUIRE(std::abs(engine.unrealized_pnl(1) - 3 * 1.5 * tick) < 1e-12);
+
+        engine.on_fill(1, other, OrderSide::BUY, 50, 2);
+        engine.on_quote(other, 52, 52);
+        const double other_tick = market_replay::from_price_ticks(other, 1);
+        REQUIRE(std::abs(engine.unrealized_pnl(1) - (3 * 1.5 * tick + 2 * 2 * other_tick)) < 1e-12);
+        REQUIRE(engine.realized_pnl(1) == 0.0);
+        REQUIRE(engine.pnl(1, other).current_position == 2);
+    }
+
+    SECTION("Rows survive symbols appearing mid-run") {
+        engine.on_fill(1, symbol, OrderSide::BUY, 100, 7);
+        const market_replay::SymbolId late = static_cast<market_replay::SymbolId>(engine.symbol_capacity() + 40);
+        engine.on_fill(0, late, OrderSide::BUY, 100, 1);
+        REQUIRE(engine.symbol_capacity() > late);
+        REQUIRE(engine.position(1, symbol).quantity == 7);
+        REQUIRE(engine.position(0, late).quantity == 1);
+    }
+}
+
+TEST_CASE("PnLEngine equity snapshots", "[pnl_engine]") {
+    const market_replay::SymbolId symbol = market_replay::intern_symbol("PNLTEST");
+    PnLEngine::Config config;
+    config.snapshot_interval = 10ms;
+    PnLEngine engine(config);
+    engine.reset(1);
+
+    const market_replay::Timestamp start(std::chrono::nanoseconds(1'000'000'000LL));
+    engine.advance_to(start); // Starts the clock
+    engine.on_fill(0, symbol, OrderSide::BUY, 100, 1);
+    engine.advance_to(start + 4ms);
+    REQUIRE(engine.snapshots().empty());
+    engine.advance_to(start + 10ms);
+    engine.on_quote(symbol, 110, 110);
+    engine.advance_to(start + 37ms); // Crossed 20 and 30ms with nothing in between: one snapshot
+    REQUIRE(engine.snapshots().size() == 2);
+    REQUIRE(engine.snapshots()[0].timestamp == start + 10ms);
+    REQUIRE(engine.snapshots()[0].unrealized_pnl == 0.0);
+    REQUIRE(engine.snapshots()[1].timestamp == start + 30ms);
+    REQUIRE(std::abs(engine.snapshots()[1].unrealized_pnl - market_replay::from_price_ticks(symbol, 10)) < 1e-12);
+    engine.advance_to(start + 39ms);
+    REQUIRE(engine.snapshots().size() == 2);
+
+    engine.reset(1);
+    REQUIRE(engine.snapshots().empty());
+    REQUIRE(engine.position(0, symbol).fills == 0);
+}
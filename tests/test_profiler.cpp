@@ -0,0 +1,169 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "mock_strategy.hpp"
+#include "market_replay/dispatcher.hpp"
+#include "market_replay/logger.hpp"
+#include "market_replay/utils/profiler.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using market_replay::utils::ProfileStage;
+using market_replay::utils::Profiler;
+using market_replay::utils::ScopedProfile;
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+size_t occurrences(const std::string& text, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+void spin_for(std::chrono::microseconds duration) {
+    const auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+} // namespace
+
+TEST_CASE("Profiler", "[profiler]") {
+    market_replay::Logger::init("test_profiler_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    SECTION("Stages are merged across threads, exited ones included") {
+        { ScopedProfile before_start(ProfileStage::PARSE); } // Not running yet: not counted
+
+        Profiler::start({});
+        std::thread worker([] {
+            for (int i = 0; i < 10; ++i) ScopedProfile scope(ProfileStage::STRATEGY_ON_EVENT);
+        });
+        worker.join();
+        for (int i = 0; i < 3; ++i) {
+            ScopedProfile scope(ProfileStage::BOOK_UPDATE);
+            spin_for(std::chrono::microseconds(200));
+        }
+        const auto summary = Profiler::stop();
+
+        REQUIRE(summary[ProfileStage::PARSE].count == 0);
+        REQUIRE(summary[ProfileStage::STRATEGY_ON_EVENT].count == 10);
+        REQUIRE(summary[ProfileStage::BOOK_UPDATE].count == 3);
+        // Ticks are calibrated against the wall clock
+        REQUIRE(summary[ProfileStage::BOOK_UPDATE].total_ns >= 500000);
+        REQUIRE(summary[ProfileStage::BOOK_UPDATE].max_ns >= 150000);
+        REQUIRE(summary[ProfileStage::BOOK_UPDATE].total_ns <= summary.wall_ns);
+        REQUIRE(summary.trace_events == 0);
+
+        std::ostringstream table;
+        Profiler::write_summary(table, summary);
+        REQUIRE(table.str().find("book_update") != std::string::npos);
+        REQUIRE(table.str().find("parse") == std::string::npos); // Stages that never ran are left out
+
+        // A new session starts from zero
+        Profiler::start({});
+        REQUIRE(Profiler::stop()[ProfileStage::BOOK_UPDATE].count == 0);
+    }
+
+    SECTION("Sessions do not nest") {
+        Profiler::start({});
+        REQUIRE_THROWS_AS(Profiler::start({}), std::runtime_error);
+        Profiler::stop();
+        REQUIRE_THROWS_AS(Profiler::stop(), std::runtime_error);
+    }
+
+    SECTION("A trace holds every stage and counter sample, up to the per-thread cap") {
+        const std::string trace_file = "test_profiler_trace.json";
+        Profiler::Config config;
+        config.trace_path = trace_file;
+        config.max_trace_events = 6;
+        Profiler::start(config);
+        Profiler::name_this_thread("main \"thread\"");
+        for (int i = 0; i < 4; ++i) ScopedProfile scope(ProfileStage::FAN_OUT);
+        Profiler::record_counter("depth", 42);
+        std::thread worker([] {
+            for (int i = 0; i < 8; ++i) ScopedProfile scope(ProfileStage::QUEUE_WAIT);
+        });
+        worker.join();
+        const auto summary = Profiler::stop();
+
+        REQUIRE(summary.trace_events == 11); // 5 on this thread, 6 of the worker's 8
+        REQUIRE(summary.trace_events_dropped == 2);
+        REQUIRE(summary[ProfileStage::QUEUE_WAIT].count == 8); // The summary has them all
+
+        const std::string trace = read_file(trace_file);
+        REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+        REQUIRE(occurrences(trace, "\"name\":\"fan_out\"") == 4);
+        REQUIRE(occurrences(trace, "\"name\":\"queue_wait\"") == 6);
+        REQUIRE(trace.find("{\"name\":\"depth\",\"ph\":\"C\"") != std::string::npos);
+        REQUIRE(trace.find("\"args\":{\"value\":42}") != std::string::npos);
+        REQUIRE(trace.find("\"main \\\"thread\\\"\"") != std::string::npos);
+        REQUIRE(occurrences(trace, "\"ph\":\"M\"") == 2); // One track per thread
+        std::remove(trace_file.c_str());
+    }
+
+#ifdef MARKET_REPLAY_PROFILING
+    SECTION("A profiled dispatcher run times each stage it goes through") {
+        const std::string csv_file = "test_profiler_ticks.csv";
+        const std::string trace_file = "test_profiler_run.json";
+        {
+            std::ofstream file(csv_file);
+            file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+            for (int i = 0; i < 600; ++i) {
+                file << "QUOTE," << 1678886400000000000LL + i * 1000000LL << ",SYNTH,,,99.99,500,100.01,700\n";
+            }
+        }
+        market_replay::LatencyModel::Config latency;
+        latency.market_data_feed_latency = std::chrono::microseconds(50);
+
+        for (auto execution : {market_replay::Dispatcher::StrategyExecution::THREADED,
+                               market_replay::Dispatcher::StrategyExecution::INLINE}) {
+            market_replay::Dispatcher::Config config;
+            config.strategy_execution = execution;
+            config.profiling.enabled = true;
+            config.profiling.trace_path = trace_file;
+            MockStrategy* mock = nullptr;
+            market_replay::Dispatcher dispatcher(csv_file, latency, nullptr, config);
+            dispatcher.add_strategy("Profiled", make_mock_factory(mock));
+            mock->quote_hook = [n = 0](MockStrategy& self, const market_replay::QuoteEvent& quote,
+                                       market_replay::Timestamp ts) mutable {
+                if (n++ % 100 == 0) {
+                    self.submit_order(quote.symbol_id, market_replay::OrderSide::BUY, market_replay::OrderType::MARKET,
+                                      0.0, 10, ts);
+                }
+            };
+            dispatcher.run();
+            REQUIRE_FALSE(Profiler::enabled());
+
+            const auto& summary = dispatcher.profile_summary();
+            REQUIRE(summary[ProfileStage::PARSE].count >= 600);
+            REQUIRE(summary[ProfileStage::BOOK_UPDATE].count == 600);
+            REQUIRE(summary[ProfileStage::FAN_OUT].count == 600);
+            const bool threaded = execution == market_replay::Dispatcher::StrategyExecution::THREADED;
+            // A strategy thread can fall far enough behind that its last orders arrive after the run ended
+            REQUIRE(summary[ProfileStage::ORDER_LIFECYCLE].count <= 6);
+            if (!threaded) REQUIRE(summary[ProfileStage::ORDER_LIFECYCLE].count == 6);
+            REQUIRE(summary[ProfileStage::STRATEGY_ON_EVENT].count >= 600); // Ticks, acks and fills, control events
+            REQUIRE(summary[ProfileStage::MEPQ_POP].count > 0);
+            REQUIRE((summary[ProfileStage::QUEUE_WAIT].count > 0) == threaded);
+
+            const std::string trace = read_file(trace_file);
+            REQUIRE(trace.find("\"dispatcher\"") != std::string::npos);
+            REQUIRE(trace.find("\"mepq depth\"") != std::string::npos);
+            REQUIRE((trace.find("\"queue depth Profiled\"") != std::string::npos) == threaded);
+            REQUIRE((trace.find("\"strategy Profiled\"") != std::string::npos) == threaded);
+        }
+        std::remove(csv_file.c_str());
+        std::remove(trace_file.c_str());
+    }
+#endif
+
+    market_replay::Logger::shutdown();
+}
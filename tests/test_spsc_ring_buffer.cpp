@@ -0,0 +1,158 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/utils/spsc_ring_buffer.hpp"
+#include <thread>
+#include <vector>
+#include <memory>
+
+using market_replay::utils::SpscRingBuffer;
+using market_replay::utils::WaitPolicy;
+
+TEST_CASE("SpscRingBuffer Basic Operations", "[spsc_ring_buffer]") {
+    SpscRingBuffer<int> queue(5);
+
+    SECTION("Capacity is rounded up to a power of two") {
+        REQUIRE(queue.capacity() == 8);
+        REQUIRE(SpscRingBuffer<int>(0).capacity() == 2);
+        REQUIRE(SpscRingBuffer<int>(16).capacity() == 16);
+    }
+
+    SECTION("Push and Pop") {
+        queue.push(10);
+        int val;
+        REQUIRE(queue.wait_and_pop(val));
+        REQUIRE(val == 10);
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("Try Pop") {
+        REQUIRE_FALSE(queue.try_pop().has_value());
+        queue.push(20);
+        auto opt_val = queue.try_pop();
+        REQUIRE(opt_val.has_value());
+        REQUIRE(opt_val.value() == 20);
+        REQUIRE_FALSE(queue.try_pop().has_value());
+    }
+
+    SECTION("Wraps around the end of the buffer") {
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 6; ++i) queue.push(round * 10 + i);
+            REQUIRE(queue.size() == 6);
+            for (int i = 0; i < 6; ++i) {
+                int val;
+                REQUIRE(queue.wait_and_pop(val));
+                REQUIRE(val == round * 10 + i);
+            }
+        }
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("Batched push and pop") {
+        std::vector<int> in = {1, 2, 3, 4, 5};
+        queue.push_batch(in);
+        REQUIRE(in.empty());
+        REQUIRE(queue.size() == 5);
+
+        std::vector<int> out;
+        REQUIRE(queue.pop_batch(out, 3) == 3);
+        REQUIRE(queue.pop_batch(out, 10) == 2);
+        REQUIRE(out == std::vector<int>{1, 2, 3, 4, 5});
+    }
+
+    SECTION("Shutdown empty queue") {
+        queue.shutdown();
+        int val;
+        REQUIRE_FALSE(queue.wait_and_pop(val));
+        std::vector<int> out;
+        REQUIRE(queue.pop_batch(out, 4) == 0);
+    }
+
+    SECTION("Shutdown non-empty queue") {
+        queue.push(30);
+        queue.shutdown();
+        queue.push(31); // Dropped
+        int val;
+        REQUIRE(queue.wait_and_pop(val)); // Should pop remaining items
+        REQUIRE(val == 30);
+        REQUIRE_FALSE(queue.wait_and_pop(val)); // Then return false
+    }
+
+    SECTION("Move-only payloads") {
+        SpscRingBuffer<std::unique_ptr<int>> ptr_queue(4);
+        ptr_queue.push(std::make_unique<int>(7));
+        std::unique_ptr<int> out;
+        REQUIRE(ptr_queue.wait_and_pop(out));
+        REQUIRE(*out == 7);
+    }
+}
+
+TEST_CASE("SpscRingBuffer Multithreaded", "[spsc_ring_buffer]") {
+    const int num_items = 20000;
+
+    for (WaitPolicy policy : {WaitPolicy::BUSY_SPIN, WaitPolicy::YIELD, WaitPolicy::PARK}) {
+        DYNAMIC_SECTION("Single Producer, Single Consumer, policy " << static_cast<int>(policy)) {
+            SpscRingBuffer<int> queue(256, policy); // Small enough that both sides wait
+            std::vector<int> consumed;
+            consumed.reserve(num_items);
+
+            std::thread consumer([&]() {
+                int val;
+                while (queue.wait_and_pop(val)) consumed.push_back(val);
+            });
+            std::thread producer([&]() {
+                for (int i = 0; i < num_items; ++i) queue.push(i);
+                while (!queue.empty()) std::this_thread::yield();
+                queue.shutdown();
+            });
+
+            producer.join();
+            consumer.join();
+            REQUIRE(consumed.size() == static_cast<size_t>(num_items));
+            bool in_order = true;
+            for (int i = 0; i < num_items; ++i) in_order = in_order && consumed[i] == i;
+            REQUIRE(in_order);
+        }
+    }
+
+    SECTION("Batched producer and consumer") {
+        SpscRingBuffer<int> queue(16, WaitPolicy::PARK);
+        std::vector<int> consumed;
+
+        std::thread consumer([&]() {
+            std::vector<int> batch;
+            while (queue.pop_batch(batch, 7) > 0) {
+                consumed.insert(consumed.end(), batch.begin(), batch.end());
+                batch.clear();
+            }
+        });
+        std::thread producer([&]() {
+            std::vector<int> chunk;
+            for (int i = 0; i < num_items; ++i) {
+                chunk.push_back(i);
+                if (chunk.size() == 50) queue.push_batch(chunk); // Larger than the ring
+            }
+            queue.push_batch(chunk);
+            while (!queue.empty()) std::this_thread::yield();
+            queue.shutdown();
+        });
+
+        producer.join();
+        consumer.join();
+        REQUIRE(consumed.size() == static_cast<size_t>(num_items));
+        bool in_order = true;
+        for (int i = 0; i < num_items; ++i) in_order = in_order && consumed[i] == i;
+        REQUIRE(in_order);
+    }
+
+    SECTION("Shutdown wakes a parked consumer") {
+        SpscRingBuffer<int> queue(4, WaitPolicy::PARK);
+        bool popped = true;
+        std::thread consumer([&]() {
+            int val;
+            popped = queue.wait_and_pop(val);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.shutdown();
+        consumer.join();
+        REQUIRE_FALSE(popped);
+    }
+}
@@ -0,0 +1,93 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "mock_strategy.hpp"
+#include "market_replay/sweep_runner.hpp"
+#include <array>
+#include <cstdio>
+#include <fstream>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Sweep runs destroy their strategies, so what they saw is kept outside them
+struct QuoteLog {
+    std::vector<std::pair<market_replay::Timestamp, market_replay::Timestamp>> exchange_and_arrival;
+};
+
+class QuoteLoggingStrategy : public MockStrategy {
+public:
+    QuoteLoggingStrategy(market_replay::StrategyId id, market_replay::IOrderSubmitter* order_submitter,
+                         std::shared_ptr<market_replay::MetricsCollector> metrics_collector, QuoteLog& log)
+        : MockStrategy(std::move(id), order_submitter, std::move(metrics_collector)), log_(log) {}
+
+    void on_quote(const market_replay::QuoteEvent& quote, market_replay::Timestamp strategy_arrival_ts) override {
+        log_.exchange_and_arrival.emplace_back(quote.exchange_timestamp, strategy_arrival_ts);
+    }
+
+private:
+    QuoteLog& log_;
+};
+
+} // namespace
+
+TEST_CASE("SweepRunner runs scenarios over shared market data", "[sweep]") {
+    const std::string test_csv_file = "test_sweep_ticks.csv";
+    const std::string summary_file = "test_sweep_summary.csv";
+    market_replay::Logger::init("test_sweep_log.txt", spdlog::level::off, spdlog::level::off, false);
+    {
+        std::ofstream file(test_csv_file);
+        file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+        for (int i = 0; i < 30; ++i) {
+            file << "QUOTE," << (1678886400000000000LL + i * 1000000LL) << ",SWEEP,,,99.99,500,100.01,700\n";
+        }
+    }
+
+    auto data = market_replay::MarketDataBuffer::load(test_csv_file);
+    REQUIRE(data->size() == 30);
+
+    constexpr size_t kScenarios = 4;
+    std::array<QuoteLog, kScenarios> logs;
+    std::vector<market_replay::SweepRunner::Scenario> scenarios;
+    for (size_t i = 0; i < kScenarios; ++i) {
+        market_replay::SweepRunner::Scenario scenario;
+        scenario.name = "md_" + std::to_string(10 * (i + 1)) + "us";
+        scenario.latency.market_data_feed_latency = std::chrono::microseconds(10 * (i + 1));
+        QuoteLog& log = logs[i];
+        auto factory = [&log](const market_replay::StrategyId& id, market_replay::IOrderSubmitter* order_submitter,
+                              std::shared_ptr<market_replay::MetricsCollector> metrics_collector) {
+            return std::make_unique<QuoteLoggingStrategy>(id, order_submitter, std::move(metrics_collector), log);
+        };
+        scenario.strategies.push_back({"Logger", factory, market_replay::StrategyOptions{}});
+        scenarios.push_back(std::move(scenario));
+    }
+
+    market_replay::SweepRunner::Config config;
+    config.num_threads = 3; // Fewer workers than scenarios
+    config.summary_path = summary_file;
+    market_replay::SweepRunner runner(data, config);
+    auto results = runner.run(scenarios);
+
+    REQUIRE(results.size() == kScenarios);
+    for (size_t i = 0; i < kScenarios; ++i) {
+        REQUIRE(results[i].ok);
+        REQUIRE(results[i].name == scenarios[i].name);
+        REQUIRE(logs[i].exchange_and_arrival.size() == 30);
+        for (const auto& [exchange_ts, arrival_ts] : logs[i].exchange_and_arrival) {
+            REQUIRE(arrival_ts == exchange_ts + scenarios[i].latency.market_data_feed_latency);
+        }
+    }
+
+    std::ifstream summary(summary_file);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(summary, line)) {
+        if (lines > 0) REQUIRE(line.find(",OK,") != std::string::npos);
+        lines++;
+    }
+    REQUIRE(lines == kScenarios + 1); // Header plus one line per scenario
+
+    market_replay::Logger::shutdown();
+    std::remove(test_csv_file.c_str());
+    std::remove(summary_file.c_str());
+}
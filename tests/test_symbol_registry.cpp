@@ -0,0 +1,108 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/symbol_registry.hpp"
+#include "market_replay/event.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <string>
+
+using namespace market_replay;
+
+TEST_CASE("SymbolRegistry interning", "[symbol_registry]") {
+    SECTION("Interning is idempotent and ids resolve back to names") {
+        SymbolId a = intern_symbol("REGTEST_A");
+        SymbolId b = intern_symbol("REGTEST_B");
+        REQUIRE(a != b);
+        REQUIRE(intern_symbol("REGTEST_A") == a);
+        REQUIRE(symbol_name(a) == "REGTEST_A");
+        REQUIRE(symbol_name(b) == "REGTEST_B");
+        REQUIRE(SymbolRegistry::instance().find("REGTEST_B") == b);
+    }
+
+    SECTION("Unknown names and ids") {
+        REQUIRE(SymbolRegistry::instance().find("REGTEST_NEVER_INTERNED") == INVALID_SYMBOL_ID);
+        REQUIRE(symbol_name(INVALID_SYMBOL_ID) == "<invalid>");
+    }
+
+    SECTION("Events constructed from names carry the interned id") {
+        QuoteEvent q(Timestamp{}, "REGTEST_EVT", 1.0, 10, 1.1, 20);
+        TradeEvent t(Timestamp{}, "REGTEST_EVT", 1.05, 5);
+        REQUIRE(q.symbol_id == t.symbol_id);
+        REQUIRE(symbol_name(q.symbol_id) == "REGTEST_EVT");
+    }
+
+    SECTION("Concurrent interning agrees on one id per name") {
+        constexpr int kThreads = 4;
+        constexpr int kSymbols = 200;
+        std::vector<std::vector<SymbolId>> ids(kThreads, std::vector<SymbolId>(kSymbols));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&ids, t]() {
+                for (int i = 0; i < kSymbols; ++i) {
+                    ids[t][i] = intern_symbol("REGTEST_MT_" + std::to_string(i));
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        for (int t = 1; t < kThreads; ++t) {
+            REQUIRE(ids[t] == ids[0]);
+        }
+        for (int i = 0; i < kSymbols; ++i) {
+            REQUIRE(symbol_name(ids[0][i]) == "REGTEST_MT_" + std::to_string(i));
+        }
+    }
+}
+
+TEST_CASE("SymbolRegistry tick sizes and fixed-point prices", "[symbol_registry]") {
+    const SymbolId cents = intern_symbol("REGTEST_TICK_CENTS");
+    const SymbolId quarters = intern_symbol("REGTEST_TICK_QUARTERS");
+    const SymbolId untouched = intern_symbol("REGTEST_TICK_DEFAULT");
+    REQUIRE(SymbolRegistry::instance().set_tick_size(cents, 0.01));
+    REQUIRE(SymbolRegistry::instance().set_tick_size(quarters, 0.25));
+
+    SECTION("Tick sizes are per symbol with a default") {
+        REQUIRE(SymbolRegistry::instance().ticks_per_unit(cents) == 100.0);
+        REQUIRE(SymbolRegistry::instance().ticks_per_unit(quarters) == 4.0);
+        REQUIRE(SymbolRegistry::instance().tick_size(untouched) == DEFAULT_TICK_SIZE);
+        REQUIRE_FALSE(SymbolRegistry::instance().set_tick_size(untouched, 0.0));
+        REQUIRE_FALSE(SymbolRegistry::instance().set_tick_size(INVALID_SYMBOL_ID, 0.01));
+        REQUIRE(SymbolRegistry::instance().has_tick_size(cents));
+        REQUIRE_FALSE(SymbolRegistry::instance().has_tick_size(untouched));
+        REQUIRE_FALSE(SymbolRegistry::instance().set_tick_size_if_unset(cents, 0.5));
+        REQUIRE(SymbolRegistry::instance().ticks_per_unit(cents) == 100.0);
+    }
+
+    SECTION("Tick sizes are configured by name") {
+        const TickSizes tick_sizes = parse_tick_sizes("REGTEST_TICK_CFG_A=0.01,,REGTEST_TICK_CFG_B=0.25");
+        REQUIRE(tick_sizes == TickSizes{{"REGTEST_TICK_CFG_A", 0.01}, {"REGTEST_TICK_CFG_B", 0.25}});
+        apply_tick_sizes(tick_sizes);
+        REQUIRE(SymbolRegistry::instance().ticks_per_unit(SymbolRegistry::instance().find("REGTEST_TICK_CFG_B")) == 4.0);
+        REQUIRE(parse_tick_sizes("").empty());
+        for (const char* bad : {"REGTEST_TICK_CFG_A", "=0.01", "REGTEST_TICK_CFG_A=0", "REGTEST_TICK_CFG_A=x",
+                                "REGTEST_TICK_CFG_A=0.01x", "REGTEST_TICK_CFG_A=-1"}) {
+            REQUIRE_THROWS_AS(parse_tick_sizes(bad), std::invalid_argument);
+        }
+    }
+
+    SECTION("Conversions round to the nearest tick and come back exactly") {
+        REQUIRE(to_price_ticks(cents, 99.99) == 9999);
+        REQUIRE(from_price_ticks(cents, 9999) == 99.99); // Bit-exact with the literal
+        REQUIRE(to_price_ticks(quarters, 100.30) == 401);
+        REQUIRE(from_price_ticks(quarters, 401) == 100.25);
+        REQUIRE(to_price_ticks(cents, INVALID_PRICE) == INVALID_PRICE_TICKS);
+        REQUIRE(std::isnan(from_price_ticks(cents, INVALID_PRICE_TICKS)));
+    }
+
+    SECTION("Events expose both representations in either build") {
+        QuoteEvent q(Timestamp{}, cents, 99.99, 10, 100.01, 20);
+        REQUIRE(q.get_bid_ticks() == 9999);
+        REQUIRE(q.get_ask_ticks() == 10001);
+        REQUIRE(q.get_bid_price() == 99.99);
+        QuoteEvent from_ticks(Timestamp{}, cents, in_ticks, 9999, 10, 10001, 20);
+        REQUIRE(from_ticks.get_ask_price() == 100.01);
+        TradeEvent t(Timestamp{}, quarters, in_ticks, 401, 5);
+        REQUIRE(t.get_price() == 100.25);
+        REQUIRE(t.get_price_ticks() == 401);
+    }
+}
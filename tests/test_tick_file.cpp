@@ -0,0 +1,161 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "market_replay/tick_file.hpp"
+#include "market_replay/csv_parser.hpp"
+#include "market_replay/market_data_source.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+void write_lines(const std::string& filename, const std::vector<std::string>& lines) {
+    std::ofstream file(filename);
+    for (const auto& line : lines) file << line << "\n";
+}
+
+} // namespace
+
+TEST_CASE("Binary tick file round trip", "[tick_file]") {
+    const std::string csv_file = "test_tick_file.csv";
+    const std::string mrt_file = "test_tick_file.mrt";
+    market_replay::Logger::init("test_tick_file_log.txt", spdlog::level::off, spdlog::level::off, false);
+
+    write_lines(csv_file, {
+        "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE",
+        "QUOTE,1678886400000000000,EURUSD,0,0,1.07100,100000,1.07105,100000",
+        "TRADE,1678886400000500000,EURUSD,1.07105,10000,,,",
+        "QUOTE,1678886400000600000,SYNTH,,,99.99,4060,100.01,6800",
+        "QUOTE,1678886400000700000,EURUSD,,,1.07101,90000,1.07104,50000",
+        "TRADE,1678886400000800000,SYNTH,100.01,31,,,,"
+    });
+
+    {
+        market_replay::CsvParser parser(csv_file);
+        market_replay::TickFileWriter writer(mrt_file, market_replay::tick_format::DEFAULT_PRICE_SCALE, 2);
+        while (parser.has_more_events()) {
+            auto ev = parser.read_next_event();
+            if (ev) REQUIRE(writer.add(*ev));
+        }
+        writer.finish();
+        REQUIRE(writer.record_count() == 5);
+    }
+
+    SECTION("Reader reproduces the CSV events exactly") {
+        market_replay::CsvParser csv(csv_file);
+        market_replay::TickFileReader reader(mrt_file);
+        REQUIRE(reader.record_count() == 5);
+        REQUIRE(reader.symbols().size() == 2);
+
+        while (csv.has_more_events()) {
+            auto expected = csv.read_next_event();
+            if (!expected) continue;
+            REQUIRE(reader.has_more_events());
+            auto actual = reader.read_next_event();
+            REQUIRE(actual);
+            REQUIRE(actual->type == expected->type);
+            REQUIRE(actual->exchange_timestamp == expected->exchange_timestamp);
+            if (expected->type == market_replay::EventType::QUOTE) {
+                auto& e = static_cast<market_replay::QuoteEvent&>(*expected);
+                auto& a = static_cast<market_replay::QuoteEvent&>(*actual);
+                REQUIRE(a.symbol_id == e.symbol_id);
+                REQUIRE(a.get_bid_price() == e.get_bid_price());
+                REQUIRE(a.bid_size == e.bid_size);
+                REQUIRE(a.get_ask_price() == e.get_ask_price());
+                REQUIRE(a.ask_size == e.ask_size);
+            } else {
+                auto& e = static_cast<market_replay::TradeEvent&>(*expected);
+                auto& a = static_cast<market_replay::TradeEvent&>(*actual);
+                REQUIRE(a.symbol_id == e.symbol_id);
+                REQUIRE(a.get_price() == e.get_price());
+                REQUIRE(a.size == e.size);
+            }
+        }
+        REQUIRE_FALSE(reader.has_more_events());
+        REQUIRE(reader.read_next_event() == nullptr);
+    }
+
+    SECTION("Seek uses the sparse index") {
+        market_replay::TickFileReader reader(mrt_file);
+        REQUIRE(reader.index_end() - reader.index_begin() == 3); // Stride 2 over 5 records
+        reader.seek_to_timestamp(market_replay::string_to_timestamp("1678886400000650000"));
+        auto ev = reader.read_next_event();
+        REQUIRE(ev);
+        REQUIRE(ev->exchange_timestamp == market_replay::string_to_timestamp("1678886400000700000"));
+
+        reader.seek_to_timestamp(market_replay::Timestamp::min());
+        REQUIRE(reader.read_next_event()->exchange_timestamp == market_replay::string_to_timestamp("1678886400000000000"));
+        reader.seek_to_timestamp(market_replay::Timestamp::max());
+        REQUIRE_FALSE(reader.has_more_events());
+    }
+
+    SECTION("Reader is selected by extension") {
+        auto binary = market_replay::open_market_data_source(mrt_file);
+        REQUIRE(dynamic_cast<market_replay::TickFileReader*>(binary.get()) != nullptr);
+        auto text = market_replay::open_market_data_source(csv_file);
+        REQUIRE(dynamic_cast<market_replay::CsvParser*>(text.get()) != nullptr);
+    }
+
+    SECTION("Files that aren't tick files are rejected") {
+        REQUIRE_THROWS_AS(market_replay::TickFileReader(csv_file), std::runtime_error);
+        REQUIRE_THROWS_AS(market_replay::TickFileReader("non_existent_file.mrt"), std::runtime_error);
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(csv_file.c_str());
+    std::remove(mrt_file.c_str());
+}
+
+TEST_CASE("Tick file symbol tables carry tick sizes", "[tick_file]") {
+    using market_replay::SymbolRegistry;
+    const market_replay::SymbolId configured = market_replay::intern_symbol("TF_TICK_CONFIGURED");
+    REQUIRE(SymbolRegistry::instance().set_tick_size(configured, 0.5));
+
+    // {uint16 length, bytes, int64 tick size in units of 1e-8} per symbol
+    std::string table;
+    auto add = [&table](const std::string& name, int64_t tick_size) {
+        const uint16_t len = static_cast<uint16_t>(name.size());
+        table.append(reinterpret_cast<const char*>(&len), sizeof(len));
+        table += name;
+        table.append(reinterpret_cast<const char*>(&tick_size), sizeof(tick_size));
+    };
+    add("TF_TICK_FROM_FILE", 25000000);
+    add("TF_TICK_CONFIGURED", 1000000);
+    add("TF_TICK_NONE", 0);
+
+    std::vector<std::string> names;
+    std::vector<market_replay::SymbolId> ids;
+    const int64_t scale = market_replay::tick_format::DEFAULT_PRICE_SCALE;
+    REQUIRE(market_replay::tick_format::read_symbol_table(table.data(), table.data() + table.size(), 3, names, ids, scale));
+    REQUIRE(names == std::vector<std::string>{"TF_TICK_FROM_FILE", "TF_TICK_CONFIGURED", "TF_TICK_NONE"});
+    REQUIRE(SymbolRegistry::instance().tick_size(ids[0]) == 0.25); // Recorded, nothing configured
+    REQUIRE(SymbolRegistry::instance().tick_size(ids[1]) == 0.5);  // Configuration wins
+    REQUIRE_FALSE(SymbolRegistry::instance().has_tick_size(ids[2]));
+
+    std::vector<std::string> truncated_names;
+    std::vector<market_replay::SymbolId> truncated_ids;
+    REQUIRE_FALSE(market_replay::tick_format::read_symbol_table(table.data(), table.data() + table.size() - 1, 3,
+                                                                truncated_names, truncated_ids, scale));
+
+    SECTION("Writers record the configured tick sizes") {
+        const std::string mrt_file = "test_tick_sizes.mrt";
+        {
+            market_replay::TickFileWriter writer(mrt_file);
+            REQUIRE(writer.add(market_replay::TradeEvent(market_replay::Timestamp{}, configured, 100.5, 1)));
+            writer.finish();
+        }
+        std::ifstream in(mrt_file, std::ios::binary);
+        const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        market_replay::tick_format::FileHeader header{};
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        REQUIRE(header.version == market_replay::tick_format::VERSION);
+        int64_t recorded = 0;
+        std::memcpy(&recorded, bytes.data() + header.symbol_table_offset + sizeof(uint16_t) + std::strlen("TF_TICK_CONFIGURED"),
+                    sizeof(recorded));
+        REQUIRE(recorded == scale / 2);
+        REQUIRE(market_replay::TickFileReader(mrt_file).symbols() == std::vector<std::string>{"TF_TICK_CONFIGURED"});
+        in.close();
+        std::remove(mrt_file.c_str());
+    }
+}
@@ -0,0 +1,196 @@
+#include "catch2/catch_test_macros.hpp"
+#include "test_utils.hpp"
+#include "market_replay/block_tick_file.hpp"
+#include "market_replay/csv_parser.hpp"
+#include "market_replay/logger.hpp"
+#include "market_replay/market_data_source.hpp"
+#include "market_replay/tick_file.hpp"
+#include "market_replay/time_index.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+using market_replay::Timestamp;
+
+constexpr long long kStart = 1678886400000000000LL;
+
+Timestamp at(long long ns) { return Timestamp(std::chrono::nanoseconds(ns)); }
+
+// 200 ticks 1ms apart. IDX_A and IDX_B alternate throughout; IDX_C only trades in rows 150-159.
+void write_csv(const std::string& filename, size_t rows = 200) {
+    std::ofstream file(filename);
+    file << "TYPE,TIMESTAMP_NS,SYMBOL,PRICE,SIZE,BID_PRICE,BID_SIZE,ASK_PRICE,ASK_SIZE\n";
+    for (size_t i = 0; i < rows; ++i) {
+        const long long ts = kStart + static_cast<long long>(i) * 1000000LL;
+        if (i >= 150 && i < 160) {
+            file << "TRADE," << ts << ",IDX_C,50.5," << i << ",,,,\n";
+        } else {
+            file << "QUOTE," << ts << (i % 2 ? ",IDX_B" : ",IDX_A") << ",,,99.99," << i << ",100.01," << i << "\n";
+        }
+    }
+}
+
+struct Tick {
+    Timestamp ts;
+    market_replay::SymbolId symbol_id;
+    bool operator==(const Tick& other) const { return ts == other.ts && symbol_id == other.symbol_id; }
+};
+
+std::vector<Tick> drain(market_replay::IMarketDataSource& source) {
+    std::vector<Tick> ticks;
+    while (source.has_more_events()) {
+        auto ev = source.read_next_event();
+        if (!ev) continue;
+        const auto symbol_id = ev->type == market_replay::EventType::QUOTE
+            ? static_cast<const market_replay::QuoteEvent&>(*ev).symbol_id
+            : static_cast<const market_replay::TradeEvent&>(*ev).symbol_id;
+        ticks.push_back({ev->exchange_timestamp, symbol_id});
+    }
+    return ticks;
+}
+
+// The window applied by brute force over the whole file
+std::vector<Tick> expected_ticks(const std::string& path, const market_replay::ReplayWindow& window) {
+    auto source = market_replay::open_market_data_source(path);
+    std::vector<Tick> ticks;
+    for (const Tick& t : drain(*source)) {
+        if (t.ts < window.start || t.ts > window.end) continue;
+        if (!window.symbols.empty() &&
+            std::find(window.symbols.begin(), window.symbols.end(), t.symbol_id) == window.symbols.end()) continue;
+        ticks.push_back(t);
+    }
+    return ticks;
+}
+
+} // namespace
+
+TEST_CASE("Time index sidecar", "[time_index]") {
+    const std::string csv_file = "test_time_index.csv";
+    const std::string index_file = market_replay::TimeIndex::sidecar_path(csv_file);
+    market_replay::Logger::init("test_time_index_log.txt", spdlog::level::off, spdlog::level::off, false);
+    write_csv(csv_file);
+    std::remove(index_file.c_str());
+
+    SECTION("Entries hold positions, time ranges and the symbols in them") {
+        market_replay::CsvParser parser(csv_file);
+        const uint64_t first = parser.position();
+        auto index = market_replay::TimeIndex::build(parser, 16);
+        REQUIRE(index.entries().size() == 13); // 12 full entries of 16 and one of 8
+        REQUIRE(index.symbols().size() == 3);
+        REQUIRE(index.entries()[0].position == first);
+        REQUIRE(index.entries()[1].first_timestamp_ns == kStart + 16 * 1000000LL);
+        REQUIRE(index.entries()[1].last_timestamp_ns == kStart + 31 * 1000000LL);
+        REQUIRE(index.entries()[12].events == 8);
+
+        const auto c = market_replay::intern_symbol("IDX_C");
+        for (size_t e = 0; e < index.entries().size(); ++e) {
+            REQUIRE(index.contains(e, c) == (e == 9)); // Rows 144-159
+        }
+        REQUIRE(index.find(at(kStart)) == 0);
+        REQUIRE(index.find(at(kStart + 40 * 1000000LL)) == 2);
+        REQUIRE(index.find(at(kStart + 32 * 1000000LL)) == 1); // Exactly at entry 2's start: entry 1 may end on it
+
+        // Every entry's position lands either parser backend on its first event
+        market_replay::CsvParser stream(csv_file, market_replay::CsvParser::Backend::STREAM);
+        REQUIRE(stream.position() == first);
+        for (auto* p : {&parser, &stream}) {
+            for (const auto& entry : index.entries()) {
+                p->seek(entry.position);
+                auto ev = p->read_next_event();
+                REQUIRE(ev);
+                REQUIRE(ev->exchange_timestamp == at(entry.first_timestamp_ns));
+            }
+        }
+    }
+
+    SECTION("The sidecar is saved once, reused, and rebuilt when the file changes") {
+        {
+            market_replay::CsvParser parser(csv_file);
+            auto index = market_replay::TimeIndex::load_or_build(csv_file, parser, 16);
+            REQUIRE(std::filesystem::exists(index_file));
+            REQUIRE(parser.read_next_event()->exchange_timestamp == at(kStart)); // Seeked back after the build
+        }
+        {
+            market_replay::CsvParser parser(csv_file);
+            parser.seek(UINT64_MAX); // Reusing the sidecar must not read the source
+            auto index = market_replay::TimeIndex::load_or_build(csv_file, parser, 16);
+            REQUIRE(index->entries().size() == 13);
+            REQUIRE(index->symbols().size() == 3);
+        }
+        write_csv(csv_file, 210);
+        {
+            market_replay::CsvParser parser(csv_file);
+            auto index = market_replay::TimeIndex::load_or_build(csv_file, parser, 16);
+            REQUIRE(index->entries().size() == 14);
+        }
+        {
+            market_replay::CsvParser parser(csv_file);
+            auto index = market_replay::TimeIndex::load_or_build(csv_file, parser, 50); // A different granularity
+            REQUIRE(index->entries().size() == 5);
+        }
+        REQUIRE_THROWS_AS(market_replay::TimeIndex::load(csv_file), std::runtime_error);
+    }
+
+    SECTION("Windows replay the same events as filtering the whole file, in every format") {
+        std::vector<std::string> files = {csv_file, "test_time_index.mrt", "test_time_index.mrtz"};
+        {
+            market_replay::CsvParser parser(csv_file);
+            market_replay::TickFileWriter mrt(files[1]);
+            market_replay::BlockTickFileWriter mrtz(files[2], market_replay::tick_format::DEFAULT_PRICE_SCALE, 24);
+            while (parser.has_more_events()) {
+                auto ev = parser.read_next_event();
+                if (!ev) continue;
+                mrt.add(*ev);
+                mrtz.add(*ev);
+            }
+        }
+        market_replay::ReplayWindow mid;
+        mid.start = at(kStart + 37 * 1000000LL);
+        mid.end = at(kStart + 121 * 1000000LL);
+        mid.index_rows = 16;
+        market_replay::ReplayWindow only_c;
+        only_c.symbols = {market_replay::intern_symbol("IDX_C")};
+        only_c.index_rows = 16;
+        market_replay::ReplayWindow c_and_a_late = only_c;
+        c_and_a_late.symbols.push_back(market_replay::intern_symbol("IDX_A"));
+        c_and_a_late.start = at(kStart + 155 * 1000000LL);
+
+        for (const auto& file : files) {
+            for (const auto& window : {mid, only_c, c_and_a_late}) {
+                auto source = market_replay::open_market_data_source(file, {}, window);
+                auto* windowed = dynamic_cast<market_replay::WindowedMarketDataSource*>(source.get());
+                REQUIRE(windowed != nullptr);
+                REQUIRE(drain(*windowed) == expected_ticks(file, window));
+            }
+            auto source = market_replay::open_market_data_source(file, {}, only_c);
+            drain(*source);
+            const auto& stats = static_cast<market_replay::WindowedMarketDataSource&>(*source).stats();
+            REQUIRE(stats.entries_skipped == 12); // All but entry 9 are jumped over unread
+            REQUIRE(stats.events_filtered == 6);  // Entry 9's IDX_A and IDX_B rows 144-149
+            std::remove(market_replay::TimeIndex::sidecar_path(file).c_str());
+        }
+        std::remove(files[1].c_str());
+        std::remove(files[2].c_str());
+    }
+
+    SECTION("Without an index the window is applied by filtering") {
+        market_replay::ReplayWindow window;
+        window.start = at(kStart + 190 * 1000000LL);
+        window.use_index = false;
+        auto source = market_replay::open_market_data_source(csv_file, {}, window);
+        REQUIRE(drain(*source).size() == 10);
+        REQUIRE_FALSE(std::filesystem::exists(index_file));
+
+        market_replay::ReplayWindow empty;
+        empty.start = at(kStart + 500 * 1000000LL);
+        REQUIRE_FALSE(market_replay::open_market_data_source(csv_file, {}, empty)->has_more_events());
+    }
+
+    market_replay::Logger::shutdown();
+    std::remove(csv_file.c_str());
+    std::remove(index_file.c_str());
+}
@@ -0,0 +1,48 @@
+#include "catch2/catch_test_macros.hpp"
+#include "market_replay/utils/work_stealing_pool.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using market_replay::utils::WorkStealingPool;
+
+TEST_CASE("WorkStealingPool runs every task", "[work_stealing_pool]") {
+    std::atomic<int> counter{0};
+
+    SECTION("Tasks submitted from outside") {
+        {
+            WorkStealingPool pool(3);
+            REQUIRE(pool.size() == 3);
+            for (int i = 0; i < 1000; ++i) {
+                pool.submit([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+        } // Destructor drains before joining
+        REQUIRE(counter.load() == 1000);
+    }
+
+    SECTION("Tasks resubmitting themselves from a worker") {
+        // Each chain resubmits itself until it has run 100 times, like a strategy draining its mailbox
+        std::vector<std::unique_ptr<std::function<void()>>> chains; // Outlives the pool
+        {
+            WorkStealingPool pool(2);
+            for (int c = 0; c < 8; ++c) {
+                auto remaining = std::make_shared<int>(100);
+                auto step = std::make_unique<std::function<void()>>();
+                std::function<void()>* self = step.get();
+                *step = [&pool, &counter, remaining, self] {
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                    if (--*remaining > 0) pool.submit(*self);
+                };
+                pool.submit(*step);
+                chains.push_back(std::move(step));
+            }
+        }
+        REQUIRE(counter.load() == 800);
+    }
+
+    SECTION("Zero threads means one per hardware thread") {
+        WorkStealingPool pool(0);
+        REQUIRE(pool.size() >= 1);
+    }
+}